@@ -0,0 +1,322 @@
+// 引擎熱點函數基準測試
+// 在三種世界規模（small/medium/large）下量測地圖存取、時間更新、NPC 視圖、
+// 靠近偵測、指令解析與執行等熱點，並可儲存/比較基準線。
+//
+// 用法:
+//   cargo bench --bench engine_bench                          # 執行全部
+//   cargo bench --bench engine_bench -- minimap               # 只執行名稱包含 minimap 的項目
+//   cargo bench --bench engine_bench -- --save-baseline main  # 儲存基準線
+//   cargo bench --bench engine_bench -- --baseline main       # 與基準線比較
+
+use std::collections::BTreeMap;
+use std::hint::black_box;
+use std::time::{Duration, Instant};
+
+use ratamud::command_handler::parse_command;
+use ratamud::event::EventManager;
+use ratamud::event_executor::{EventExecutor, EventOutput};
+use ratamud::event_loader::EventLoader;
+use ratamud::event_scheduler::CronParser;
+use ratamud::item_registry::resolve_item_name;
+use ratamud::map::Map;
+use ratamud::time_updatable::TimeUpdatable;
+use ratamud::world::GameWorld;
+use ratamud::worldgen::{generate_world, WorldGenConfig};
+
+/// 每個項目的取樣數（取中位數）
+const SAMPLES: usize = 15;
+/// 每個樣本的目標時間
+const SAMPLE_TARGET: Duration = Duration::from_millis(20);
+/// 與基準線比較時，超過此比例視為退步
+const REGRESSION_THRESHOLD: f64 = 0.05;
+/// 基準線存放位置
+const BASELINE_DIR: &str = "target/bench-baselines";
+
+/// 命令列選項
+struct Options {
+    filter: Option<String>,
+    save_baseline: Option<String>,
+    baseline: Option<String>,
+}
+
+impl Options {
+    fn parse() -> Self {
+        let mut options = Options { filter: None, save_baseline: None, baseline: None };
+        let mut args = std::env::args().skip(1);
+        while let Some(arg) = args.next() {
+            match arg.as_str() {
+                "--save-baseline" => options.save_baseline = args.next(),
+                "--baseline" => options.baseline = args.next(),
+                // cargo bench 會自動附加 --bench
+                "--bench" => {}
+                other if !other.starts_with("--") => options.filter = Some(other.to_string()),
+                _ => {}
+            }
+        }
+        options
+    }
+}
+
+/// 收集結果並處理篩選、輸出與基準線比較
+struct Bencher {
+    options: Options,
+    baseline: BTreeMap<String, f64>,
+    results: BTreeMap<String, f64>,
+}
+
+impl Bencher {
+    fn new(options: Options) -> Self {
+        let baseline = options.baseline.as_ref()
+            .and_then(|name| std::fs::read_to_string(format!("{BASELINE_DIR}/{name}.json")).ok())
+            .and_then(|json| serde_json::from_str(&json).ok())
+            .unwrap_or_default();
+        Bencher { options, baseline, results: BTreeMap::new() }
+    }
+
+    fn enabled(&self, name: &str) -> bool {
+        match &self.options.filter {
+            Some(filter) => name.contains(filter.as_str()),
+            None => true,
+        }
+    }
+
+    /// 量測 f 的每次呼叫時間（ns）：先校準迭代次數，再取 SAMPLES 個樣本的中位數
+    fn run<F: FnMut()>(&mut self, name: &str, mut f: F) {
+        if !self.enabled(name) {
+            return;
+        }
+        let mut iters: u64 = 1;
+        loop {
+            let start = Instant::now();
+            for _ in 0..iters {
+                f();
+            }
+            if start.elapsed() >= SAMPLE_TARGET / 4 || iters >= 1 << 24 {
+                break;
+            }
+            iters *= 2;
+        }
+        let iters = (iters * 4).max(1);
+
+        let mut samples: Vec<f64> = (0..SAMPLES)
+            .map(|_| {
+                let start = Instant::now();
+                for _ in 0..iters {
+                    f();
+                }
+                start.elapsed().as_nanos() as f64 / iters as f64
+            })
+            .collect();
+        samples.sort_by(|a, b| a.total_cmp(b));
+        let median = samples[SAMPLES / 2];
+
+        let comparison = match self.baseline.get(name) {
+            Some(&base) if base > 0.0 => {
+                let change = (median - base) / base;
+                let mark = if change > REGRESSION_THRESHOLD {
+                    "⚠️ 退步"
+                } else if change < -REGRESSION_THRESHOLD {
+                    "✅ 進步"
+                } else {
+                    "≈"
+                };
+                format!("{:>+8.1}% {mark}", change * 100.0)
+            }
+            _ => String::new(),
+        };
+        println!("{name:<44} {:>14} {comparison}", format_ns(median));
+        self.results.insert(name.to_string(), median);
+    }
+
+    fn finish(&self) {
+        if let Some(name) = &self.options.save_baseline {
+            let path = format!("{BASELINE_DIR}/{name}.json");
+            let saved = std::fs::create_dir_all(BASELINE_DIR)
+                .map_err(|e| e.to_string())
+                .and_then(|_| serde_json::to_string_pretty(&self.results).map_err(|e| e.to_string()))
+                .and_then(|json| std::fs::write(&path, json).map_err(|e| e.to_string()));
+            match saved {
+                Ok(()) => println!("📄 基準線已儲存: {path}"),
+                Err(e) => eprintln!("⚠️  儲存基準線失敗: {e}"),
+            }
+        }
+    }
+}
+
+fn format_ns(ns: f64) -> String {
+    if ns >= 1_000_000.0 {
+        format!("{:.2} ms", ns / 1_000_000.0)
+    } else if ns >= 1_000.0 {
+        format!("{:.2} µs", ns / 1_000.0)
+    } else {
+        format!("{ns:.1} ns")
+    }
+}
+
+/// 丟棄事件輸出，只量測執行本身
+struct NullOutput;
+
+impl EventOutput for NullOutput {
+    fn print(&mut self, message: String) {
+        black_box(message);
+    }
+}
+
+/// 三種世界規模
+fn world_sizes() -> Vec<(&'static str, WorldGenConfig)> {
+    let base = WorldGenConfig::default();
+    vec![
+        ("small", WorldGenConfig { map_count: 1, width: 50, height: 50, npc_count: 20, event_count: 10, ..base.clone() }),
+        ("medium", WorldGenConfig { map_count: 5, width: 100, height: 100, npc_count: 200, event_count: 100, ..base.clone() }),
+        ("large", WorldGenConfig { map_count: 10, width: 200, height: 200, npc_count: 1000, event_count: 500, ..base }),
+    ]
+}
+
+/// 與世界規模無關的項目
+fn bench_stateless(b: &mut Bencher) {
+    let inputs = ["look", "right", "get 蘋果 2", "talk merchant 你好", "set me hp 100", "quest info q1"];
+    b.run("parse_command/common_verbs", || {
+        for input in inputs {
+            black_box(parse_command(black_box(input)));
+        }
+    });
+
+    let schedules = ["*/5 * * * *", "0 9 * * *", "30 */2 * * *", "15,45 8-18 * * *"];
+    b.run("cron_matches/day_of_minutes", || {
+        for minute_of_day in (0..1440u32).step_by(7) {
+            for schedule in schedules {
+                black_box(CronParser::matches(schedule, (minute_of_day % 60) as u8, (minute_of_day / 60) as u8, 1));
+            }
+        }
+    });
+
+    b.run("resolve_item_name/english", || { black_box(resolve_item_name(black_box("apple"))); });
+    b.run("resolve_item_name/chinese", || { black_box(resolve_item_name(black_box("治療藥水"))); });
+    b.run("resolve_item_name/unknown", || { black_box(resolve_item_name(black_box("不存在的物品"))); });
+
+    // 大地圖區塊生成（32×32，每次換一個區塊座標）
+    let generator = ratamud::overworld::OverworldGen::new(42);
+    let mut cx = 0;
+    b.run("overworld/generate_chunk", || {
+        cx += 1;
+        black_box(generator.generate((cx, -cx)));
+    });
+}
+
+/// 事件載入：每個檔案一個事件，比較無快取（全部解析）與快取命中
+fn bench_event_loading(b: &mut Bencher, base_dir: &std::path::Path) -> Result<(), Box<dyn std::error::Error>> {
+    let world_dir = base_dir.join("events").to_string_lossy().to_string();
+    let config = WorldGenConfig { map_count: 1, width: 20, height: 20, npc_count: 0, event_count: 2000, events_per_file: 1, ..WorldGenConfig::default() };
+    generate_world(&world_dir, &config)?;
+    let events_dir = format!("{world_dir}/events");
+    let cache_dir = format!("{world_dir}/.cache");
+
+    b.run("event_load/2000_files_uncached", || {
+        let _ = std::fs::remove_dir_all(&cache_dir);
+        black_box(EventLoader::load_from_directory(&mut EventManager::new(), &events_dir).unwrap());
+    });
+    b.run("event_load/2000_files_cached", || {
+        black_box(EventLoader::load_from_directory(&mut EventManager::new(), &events_dir).unwrap());
+    });
+    Ok(())
+}
+
+/// 依世界規模量測的項目
+fn bench_world(b: &mut Bencher, size: &str, world_dir: &str) -> Result<(), Box<dyn std::error::Error>> {
+    let mut game_world = GameWorld::open_headless(world_dir)?;
+    let map_name = game_world.current_map_name.clone();
+    let map_path = format!("{}/{map_name}.json", game_world.get_maps_dir());
+    let scratch_path = format!("{world_dir}/bench_map.json");
+
+    let map = Map::load(&map_path)?;
+    b.run(&format!("{size}/map_save"), || { map.save(&scratch_path).unwrap(); });
+    b.run(&format!("{size}/map_load"), || { black_box(Map::load(&map_path).unwrap()); });
+
+    let time_info = game_world.get_time_info();
+    let mut map = map;
+    b.run(&format!("{size}/map_on_time_update"), || { map.on_time_update(&time_info); });
+    b.run(&format!("{size}/map_get_stats"), || { black_box(map.get_stats()); });
+    b.run(&format!("{size}/map_walkable_points"), || { black_box(map.get_walkable_points()); });
+
+    // 每次推進一遊戲分鐘，量測所有已載入地圖的天氣網格一步
+    b.run(&format!("{size}/weather_update"), || {
+        game_world.time.advance_secs(60);
+        game_world.update_weather();
+    });
+
+    b.run(&format!("{size}/build_npc_views"), || { black_box(game_world.build_npc_views()); });
+
+    let (x, y) = game_world.npc_manager.get_npc("me").map(|me| (me.x, me.y)).unwrap_or((0, 0));
+    b.run(&format!("{size}/update_proximity"), || {
+        black_box(game_world.npc_manager.update_proximity("me", x, y, &map_name, true));
+    });
+
+    for command in ["look", "status", "npcs"] {
+        b.run(&format!("{size}/execute_command/{command}"), || { game_world.execute_command(command); });
+    }
+    // 來回移動，讓角色維持在原位
+    b.run(&format!("{size}/execute_command/move_pair"), || {
+        game_world.execute_command("right");
+        game_world.execute_command("left");
+    });
+
+    // 合成事件 synth_00001 為天氣隨機動作、synth_00002 為隨機位置生成物品
+    for (event_id, label) in [("synth_00001", "weather"), ("synth_00002", "add_item")] {
+        b.run(&format!("{size}/event_execute/{label}"), || {
+            black_box(EventExecutor::execute_event_by_id(event_id, &mut game_world, &mut NullOutput)).ok();
+        });
+    }
+
+    // 事件 NPC 出現又離開：物件池重用回收的角色，與每次建立新角色比較
+    b.run(&format!("{size}/npc_spawn_despawn/pooled"), || {
+        game_world.spawn_npc("bench_crow", &map_name, x, y);
+        game_world.despawn_npc("bench_crow");
+    });
+    b.run(&format!("{size}/npc_spawn_despawn/fresh"), || {
+        let npc = ratamud::person::Person::new("bench_crow".to_string(), "因事件而出現的bench_crow".to_string());
+        game_world.npc_manager.add_npc("bench_crow".to_string(), npc, Vec::new());
+        black_box(game_world.npc_manager.remove_npc("bench_crow"));
+    });
+
+    // 整個世界（所有地圖載入後）寫成快照與還原；載入其餘地圖會影響前面的項目，所以放在最後
+    let (write_name, read_name) = (format!("{size}/snapshot_write"), format!("{size}/snapshot_read"));
+    if b.enabled(&write_name) || b.enabled(&read_name) {
+        game_world.load_all_maps()?;
+        let mut image = Vec::new();
+        b.run(&write_name, || {
+            image.clear();
+            ratamud::snapshot::write(&game_world, &mut image).unwrap();
+        });
+        println!("  ({size} 快照 {} KiB)", image.len() / 1024);
+        b.run(&read_name, || { black_box(ratamud::snapshot::read(image.as_slice()).unwrap()); });
+    }
+
+    #[cfg(feature = "terminal-ui")]
+    {
+        let mut output_manager = ratamud::output::OutputManager::new();
+        b.run(&format!("{size}/update_minimap_display"), || {
+            ratamud::app::update_minimap_display(&mut output_manager, &game_world);
+        });
+    }
+    Ok(())
+}
+
+fn main() -> Result<(), Box<dyn std::error::Error>> {
+    let mut b = Bencher::new(Options::parse());
+
+    bench_stateless(&mut b);
+
+    let base_dir = std::env::temp_dir().join("ratamud_engine_bench");
+    if b.enabled("event_load") {
+        bench_event_loading(&mut b, &base_dir)?;
+    }
+    for (size, config) in world_sizes() {
+        let world_dir = base_dir.join(size).to_string_lossy().to_string();
+        generate_world(&world_dir, &config)?;
+        bench_world(&mut b, size, &world_dir)?;
+    }
+    let _ = std::fs::remove_dir_all(&base_dir);
+
+    b.finish();
+    Ok(())
+}
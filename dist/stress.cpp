@@ -0,0 +1,504 @@
+/**
+ * RataMUD C API 壓力測試 / 長時間浸泡測試
+ *
+ * 多個客戶端執行緒同時以 ratamud_submit 與 ratamud_input_command 送出混合命令，
+ * 引擎執行緒以 ratamud_pump 推進世界，並定期把世界寫成快照再讀回（新世界取代舊世界），
+ * 完成執行緒收取完成記錄。持續檢查：
+ *   - 每個提交的命令都有完成記錄；hello 與 stress_echo 的輸出回到對應的完成記錄（沒有遺失輸出）
+ *   - 同步命令的輸出經輸出回調送回同一個執行緒，回調中再送出輸出（重入）不會死鎖
+ *   - 沒有事件執行、也沒有載入新地圖時，地圖上與角色身上的物品總數不變（物品守恆）
+ *   - 快照讀回的世界與寫出時的角色數、物品數相同
+ * 每個報告區間印出吞吐量、延遲 p50/p99、配置統計與行程的執行緒數，並與第一個區間比較，
+ * 找出延遲、記憶體與執行緒（例如每次取代世界都多一條時鐘線程）的漂移。
+ * 配置統計在第一個區間讀得到、之後卻讀取失敗時視為檢查失敗。
+ *
+ * 會修改世界資料（create、地圖存檔），請在世界副本上執行：
+ *   make run-stress STRESS_ARGS="--threads 16 --seconds 14400"
+ *
+ * 選項:
+ *   --threads N      客戶端執行緒數（預設 8）
+ *   --seconds N      執行秒數（預設 60）
+ *   --report N       報告區間秒數（預設 10）
+ *   --snapshot N     快照複製世界的間隔秒數（預設 30，0=不複製）
+ *   --budget-us N    每次 ratamud_pump 的時間預算（預設 2000）
+ *   --item NAME      搬動的物品（預設 蘋果）
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ratamud.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    int threads = 8;
+    int seconds = 60;
+    int report = 10;
+    int snapshot = 30;
+    uint64_t budget_us = 2000;
+    std::string item = "蘋果";
+};
+
+/// 已提交、尚未完成的命令
+struct Pending {
+    Clock::time_point sent;
+    std::string expect;  // 完成記錄的 MAIN 輸出必須包含的字串（空=不檢查）
+};
+
+static std::atomic<bool> g_clients_running{true};
+static std::atomic<bool> g_engine_running{true};
+static std::atomic<int> g_failures{0};
+static std::atomic<uint32_t> g_world{0};
+
+static std::mutex g_pending_mutex;
+static std::map<std::pair<uint64_t, uint64_t>, Pending> g_pending;
+
+static std::mutex g_latency_mutex;
+static std::vector<double> g_latencies_us;  // 本區間的延遲
+
+static std::atomic<uint64_t> g_submitted{0};
+static std::atomic<uint64_t> g_completed{0};
+static std::atomic<uint64_t> g_stale{0};          // 提交後世界被快照取代，狀態為 -1
+static std::atomic<uint64_t> g_sync_commands{0};
+static std::atomic<uint64_t> g_callback_lines{0};
+static std::atomic<uint64_t> g_reentrant{0};
+static std::atomic<uint64_t> g_pumps{0};
+static std::atomic<uint64_t> g_events_run{0};
+static std::atomic<uint64_t> g_snapshots{0};
+static std::atomic<int> g_backlog{0};
+
+static void fail(const char* what, const std::string& detail) {
+    g_failures++;
+    fprintf(stderr, "❌ %s: %s\n", what, detail.c_str());
+}
+
+// ============= 輸出回調（同步命令的輸出在呼叫的執行緒上送達）=============
+
+thread_local std::string t_expect;
+thread_local bool t_seen = false;
+thread_local bool t_echo_seen = false;
+
+static void on_output(const char* zone, const char* content) {
+    g_callback_lines++;
+    if (t_expect.empty()) {
+        return;
+    }
+    std::string echo = "echo " + t_expect;
+    if (strcmp(zone, "LOG") == 0 && echo == content) {
+        t_echo_seen = true;
+    } else if (strstr(content, t_expect.c_str()) != nullptr) {
+        t_seen = true;
+        // 在回調中再送出輸出：回調期間不可持有輸出回調的鎖
+        ratamud_emit_output("LOG", echo.c_str());
+        g_reentrant++;
+    }
+}
+
+// ============= 擴充命令與 AI 外掛 =============
+
+/// stress_echo <字串...>：把每個參數送到 MAIN
+static int stress_echo(void*, uint32_t, const char* const* argv, uint32_t argc) {
+    for (uint32_t i = 1; i < argc; i++) {
+        ratamud_emit_output("MAIN", argv[i]);
+    }
+    return 1;
+}
+
+/// NPC 不行動，物品只因玩家命令與事件改變
+static uint32_t idle_ai(void*, const RataAiBatch*, RataAiAction*, uint32_t) {
+    return 0;
+}
+
+// ============= 客戶端 =============
+
+static void client(uint64_t session, const Options& options) {
+    std::mt19937_64 rng(session * 7919 + 1);
+    const char* moves[] = {"up", "down", "left", "right"};
+    uint64_t tag = 0;
+
+    while (g_clients_running) {
+        uint32_t world = g_world.load();
+        int pick = static_cast<int>(rng() % 100);
+        std::string token = "s" + std::to_string(session) + "-" + std::to_string(tag);
+
+        // 同步命令：輸出經回調送回這個執行緒
+        if (pick < 10) {
+            t_expect = "sync-" + token;
+            t_seen = t_echo_seen = false;
+            int rc = ratamud_input_command(("hello " + t_expect).c_str());
+            if (rc == 1 && !(t_seen && t_echo_seen)) {
+                fail("同步輸出遺失", t_expect);
+            }
+            t_expect.clear();
+            g_sync_commands++;
+            tag++;
+            continue;
+        }
+
+        std::string command;
+        std::string expect;
+        if (pick < 30) {
+            command = "hello " + token;
+            expect = token;
+        } else if (pick < 45) {
+            command = "stress_echo " + token + " 完成";
+            expect = token;
+        } else if (pick < 60) {
+            command = moves[rng() % 4];
+        } else if (pick < 75) {
+            command = "get";
+        } else if (pick < 90) {
+            command = "drop " + options.item + " 1";
+        } else if (pick < 95) {
+            command = "look";
+        } else {
+            command = "status";
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_pending_mutex);
+            g_pending[{session, tag}] = Pending{Clock::now(), expect};
+        }
+        if (ratamud_submit(world, session, command.data(), command.size(), tag) != 0) {
+            fail("提交失敗", command);
+        }
+        g_submitted++;
+        tag++;
+
+        // 背壓：未完成的命令太多時稍等
+        while (g_clients_running && g_backlog.load() > 32 * options.threads) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+// ============= 完成記錄 =============
+
+/// buf 中的 "區域\0內容\0" 是否有 MAIN 區域包含 expect
+static bool output_contains(const std::vector<char>& buf, uint32_t len, const std::string& expect) {
+    size_t at = 0;
+    while (at < len) {
+        const char* zone = buf.data() + at;
+        at += strlen(zone) + 1;
+        if (at >= len) {
+            break;
+        }
+        const char* text = buf.data() + at;
+        at += strlen(text) + 1;
+        if (strcmp(zone, "MAIN") == 0 && strstr(text, expect.c_str()) != nullptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void collector() {
+    std::vector<char> buf(4096);
+    while (g_engine_running) {
+        if (ratamud_wait_completion(50) == 0) {
+            continue;
+        }
+        RataCompletion completion;
+        int rc;
+        while ((rc = ratamud_poll_completion(&completion, buf.data(), buf.size())) != 0) {
+            if (rc == -2) {
+                buf.resize(completion.output_len);
+                continue;
+            }
+            Pending pending;
+            {
+                std::lock_guard<std::mutex> lock(g_pending_mutex);
+                auto it = g_pending.find({completion.session, completion.tag});
+                if (it == g_pending.end()) {
+                    fail("未知的完成記錄", std::to_string(completion.session) + "/" + std::to_string(completion.tag));
+                    continue;
+                }
+                pending = std::move(it->second);
+                g_pending.erase(it);
+            }
+            double latency = std::chrono::duration<double, std::micro>(Clock::now() - pending.sent).count();
+            {
+                std::lock_guard<std::mutex> lock(g_latency_mutex);
+                g_latencies_us.push_back(latency);
+            }
+            g_completed++;
+            if (completion.status == -1) {
+                g_stale++;
+            } else if (!pending.expect.empty() && !output_contains(buf, completion.output_len, pending.expect)) {
+                fail("完成記錄的輸出遺失", pending.expect);
+            }
+        }
+    }
+}
+
+// ============= 引擎 =============
+
+static uint64_t item_total(const RataCensus& census) {
+    return census.items_on_maps + census.items_carried;
+}
+
+static int write_snapshot(void* user, const uint8_t* data, size_t len) {
+    auto* out = static_cast<std::vector<uint8_t>*>(user);
+    out->insert(out->end(), data, data + len);
+    return 0;
+}
+
+struct SnapshotReader {
+    const std::vector<uint8_t>* data;
+    size_t at;
+};
+
+static size_t read_snapshot(void* user, uint8_t* buf, size_t cap) {
+    auto* reader = static_cast<SnapshotReader*>(user);
+    size_t n = std::min(cap, reader->data->size() - reader->at);
+    memcpy(buf, reader->data->data() + reader->at, n);
+    reader->at += n;
+    return n;
+}
+
+/// 把世界寫成快照再讀回，讀回的世界取代目前的世界
+static void cycle_world() {
+    uint32_t world = ratamud_world_id();
+    RataCensus before, after;
+    std::vector<uint8_t> data;
+    if (ratamud_world_census(world, &before) != 0 || ratamud_snapshot_write(world, write_snapshot, &data) != 0) {
+        fail("快照寫入失敗", std::to_string(world));
+        return;
+    }
+    SnapshotReader reader{&data, 0};
+    if (ratamud_snapshot_read(read_snapshot, &reader) != 0) {
+        fail("快照讀取失敗", std::to_string(data.size()) + " bytes");
+        return;
+    }
+    world = ratamud_world_id();
+    g_world = world;
+    if (ratamud_world_census(world, &after) != 0) {
+        fail("快照讀回後無法統計", std::to_string(world));
+        return;
+    }
+    // 寫入前的統計與寫入之間可能有同步命令載入新地圖
+    if (before.npcs != after.npcs || (before.maps_loaded == after.maps_loaded && item_total(before) != item_total(after))) {
+        fail("快照前後不一致", std::to_string(item_total(before)) + " -> " + std::to_string(item_total(after)));
+    }
+    g_snapshots++;
+}
+
+static void engine(const Options& options) {
+    auto last_snapshot = Clock::now();
+    while (g_engine_running) {
+        uint32_t world = ratamud_world_id();
+        RataCensus before, after;
+        RataPumpStats stats;
+        bool counted = ratamud_world_census(world, &before) == 0;
+        int backlog = ratamud_pump(world, options.budget_us, &stats);
+        if (backlog < 0) {
+            continue;  // 世界剛被取代
+        }
+        g_backlog = backlog;
+        g_pumps++;
+        g_events_run += stats.events_run;
+
+        // 命令只搬動物品；事件可以產生物品，載入新地圖會帶進該地圖的物品
+        if (counted && ratamud_world_census(world, &after) == 0 && stats.events_run == 0
+            && before.maps_loaded == after.maps_loaded && item_total(before) != item_total(after)) {
+            fail("物品不守恆", std::to_string(item_total(before)) + " -> " + std::to_string(item_total(after)));
+        }
+
+        if (options.snapshot > 0 && g_clients_running
+            && Clock::now() - last_snapshot >= std::chrono::seconds(options.snapshot)) {
+            cycle_world();
+            last_snapshot = Clock::now();
+        }
+        if (backlog == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+}
+
+// ============= 報告 =============
+
+static double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+/// 目前世界的配置中位元組數；快照剛好取代世界時編號會失效，重新取一次編號
+static bool world_live_bytes(int64_t& live) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        RataAllocStats alloc;
+        if (ratamud_world_alloc_stats(ratamud_world_id(), &alloc) == 0) {
+            live = static_cast<int64_t>(alloc.live_bytes);
+            return true;
+        }
+    }
+    return false;
+}
+
+/// 行程的執行緒數（讀 /proc/self/status，無法讀取時返回 -1）
+static int thread_count() {
+    FILE* status = fopen("/proc/self/status", "r");
+    if (!status) {
+        return -1;
+    }
+    char line[256];
+    int threads = -1;
+    while (fgets(line, sizeof line, status)) {
+        if (sscanf(line, "Threads: %d", &threads) == 1) {
+            break;
+        }
+    }
+    fclose(status);
+    return threads;
+}
+
+static void report(double elapsed, double interval, uint64_t completed, double& first_p99, int64_t& first_live,
+                   int& first_threads) {
+    std::vector<double> latencies;
+    {
+        std::lock_guard<std::mutex> lock(g_latency_mutex);
+        latencies.swap(g_latencies_us);
+    }
+    double p50 = percentile(latencies, 0.50) / 1000.0;
+    double p99 = percentile(latencies, 0.99) / 1000.0;
+    if (first_p99 == 0.0 && p99 > 0.0) {
+        first_p99 = p99;
+    }
+
+    // 第一個區間讀不到統計表示未啟用 host-alloc，之後的區間讀不到則是錯誤
+    int64_t live = -1;
+    if (!world_live_bytes(live) && first_live >= 0) {
+        fail("配置統計讀取失敗", "ratamud_world_alloc_stats 在第 " + std::to_string(static_cast<int>(elapsed)) + " 秒失敗");
+    }
+    if (first_live < 0) {
+        first_live = live;
+    }
+    int threads = thread_count();
+    if (first_threads < 0) {
+        first_threads = threads;
+    }
+
+    printf("[%7.0fs] %8.0f cmd/s  p50 %7.3f ms  p99 %7.3f ms (x%.2f)  backlog %5d  pumps %8" PRIu64
+           "  events %5" PRIu64 "  snapshots %3" PRIu64,
+           elapsed, completed / interval, p50, p99, first_p99 > 0.0 ? p99 / first_p99 : 1.0,
+           g_backlog.load(), g_pumps.load(), g_events_run.load(), g_snapshots.load());
+    if (live >= 0) {
+        printf("  live %8.1f KiB (%+.1f KiB)", live / 1024.0, (live - first_live) / 1024.0);
+    }
+    if (threads >= 0) {
+        printf("  threads %3d (%+d)", threads, threads - first_threads);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+static Options parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        const char* value = argv[i + 1];
+        if (name == "--threads") options.threads = std::max(1, atoi(value));
+        else if (name == "--seconds") options.seconds = std::max(1, atoi(value));
+        else if (name == "--report") options.report = std::max(1, atoi(value));
+        else if (name == "--snapshot") options.snapshot = std::max(0, atoi(value));
+        else if (name == "--budget-us") options.budget_us = strtoull(value, nullptr, 10);
+        else if (name == "--item") options.item = value;
+        else fprintf(stderr, "未知選項: %s\n", name.c_str());
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    Options options = parse_options(argc, argv);
+    printf("🔥 RataMUD 壓力測試：%d 個客戶端執行緒，%d 秒，快照間隔 %d 秒\n",
+           options.threads, options.seconds, options.snapshot);
+
+    ratamud_register_output_callback(on_output);
+    if (ratamud_init_game() != 0) {
+        fprintf(stderr, "❌ 遊戲初始化失敗（需在含 worlds 目錄的位置執行）\n");
+        return 1;
+    }
+    ratamud_register_command("stress_echo", stress_echo, nullptr);
+    ratamud_set_ai_plugin(idle_ai, nullptr);
+    g_world = ratamud_world_id();
+
+    // 在起點放幾個物品讓 get/drop 有東西可搬
+    for (int i = 0; i < 8; i++) {
+        ratamud_input_command(("create item " + options.item).c_str());
+    }
+
+    std::thread engine_thread(engine, std::cref(options));
+    std::thread collector_thread(collector);
+    std::vector<std::thread> clients;
+    for (int i = 0; i < options.threads; i++) {
+        clients.emplace_back(client, static_cast<uint64_t>(i + 1), std::cref(options));
+    }
+
+    auto start = Clock::now();
+    auto last_report = start;
+    uint64_t last_completed = 0;
+    double first_p99 = 0.0;
+    int64_t first_live = -1;
+    int first_threads = -1;
+    while (Clock::now() - start < std::chrono::seconds(options.seconds)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = Clock::now();
+        double interval = std::chrono::duration<double>(now - last_report).count();
+        if (interval >= options.report) {
+            uint64_t completed = g_completed.load();
+            report(std::chrono::duration<double>(now - start).count(), interval, completed - last_completed,
+                   first_p99, first_live, first_threads);
+            last_completed = completed;
+            last_report = now;
+        }
+    }
+
+    // 停止提交，等待所有已提交的命令完成
+    g_clients_running = false;
+    for (auto& thread : clients) {
+        thread.join();
+    }
+    auto drain_start = Clock::now();
+    size_t outstanding = 1;
+    while (outstanding > 0 && Clock::now() - drain_start < std::chrono::seconds(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::lock_guard<std::mutex> lock(g_pending_mutex);
+        outstanding = g_pending.size();
+    }
+    g_engine_running = false;
+    engine_thread.join();
+    collector_thread.join();
+    if (outstanding > 0) {
+        fail("命令沒有完成記錄", std::to_string(outstanding) + " 個");
+    }
+
+    ratamud_set_ai_plugin(nullptr, nullptr);
+    ratamud_register_command("stress_echo", nullptr, nullptr);
+    ratamud_clear_output_callback();
+
+    printf("\n📊 提交 %" PRIu64 "，完成 %" PRIu64 "（世界被取代 %" PRIu64 "），同步命令 %" PRIu64
+           "，回調 %" PRIu64 " 行（重入 %" PRIu64 "）\n",
+           g_submitted.load(), g_completed.load(), g_stale.load(), g_sync_commands.load(),
+           g_callback_lines.load(), g_reentrant.load());
+    if (g_failures > 0) {
+        printf("❌ %d 個檢查失敗\n", g_failures.load());
+        return 1;
+    }
+    printf("✅ 所有檢查通過\n");
+    return 0;
+}
@@ -17,6 +17,7 @@ use crate::person::Person;
 use crate::input::CommandResult;
 use crate::quest::{QuestReward};
 use crate::item_registry;
+use crate::rng::RngStream;
 use crate::ui::{InputDisplay, HeaderDisplay, Menu};
 
 
@@ -46,24 +47,23 @@ fn clamp_rect(rect: Rect, max_width: u16, max_height: u16) -> Rect {
 fn create_npc_thread(
     npc_view_rx: mpsc::Receiver<std::collections::HashMap<String, crate::npc_view::NpcView>>,
     npc_event_tx: mpsc::Sender<crate::game_event::GameEvent>,
+    rng: crate::rng::Rng,
 ) -> thread::JoinHandle<()> {
     thread::spawn(move || {
-        let ai_controller = crate::npc_ai::NpcAiController::new();
+        let ai_controller = crate::npc_ai::NpcAiController::with_rng(&rng);
         
         while let Ok(npc_views) = npc_view_rx.recv() {
-            // 為每個 NPC 決定行為
-            for (npc_id, view) in npc_views {
-                if let Some(action) = ai_controller.decide_action(&view) {
-                    // 發送行為事件回主執行緒
-                    let event = crate::game_event::GameEvent::NpcActions {
-                        npc_id,
-                        actions: vec![action],
-                    };
-                    
-                    if npc_event_tx.send(event).is_err() {
-                        // 主執行緒已關閉，退出
-                        return;
-                    }
+            // 為每個 NPC 決定行為（設定了原生 AI 外掛時整批交給外掛）
+            for (npc_id, action) in crate::native_ai::decide_all(&npc_views, &ai_controller) {
+                // 發送行為事件回主執行緒
+                let event = crate::game_event::GameEvent::NpcActions {
+                    npc_id,
+                    actions: vec![action],
+                };
+                
+                if npc_event_tx.send(event).is_err() {
+                    // 主執行緒已關閉，退出
+                    return;
                 }
             }
             
@@ -134,7 +134,8 @@ pub fn run_main_loop(
     let (npc_event_tx, npc_event_rx) = mpsc::channel();
     
     // 啟動 NPC AI 執行緒（新架構）
-    let _npc_thread_handle = create_npc_thread(npc_view_rx, npc_event_tx);
+    let npc_rng = game_world.rng.stream(RngStream::NpcAi).split();
+    let _npc_thread_handle = create_npc_thread(npc_view_rx, npc_event_tx, npc_rng);
     
     'main_loop: loop {
         // --- 1. 處理 NPC AI 事件 ---
@@ -260,6 +261,7 @@ pub fn run_main_loop(
     let game_settings = GameSettings {
         show_minimap: output_manager.is_minimap_open(),
         show_log: output_manager.is_log_open(),
+        ..GameSettings::load()
     };
     let _ = game_settings.save();
 
@@ -425,7 +427,7 @@ fn handle_command_result(
     
     if is_sleeping {
         match result {
-            CommandResult::Dream(content) => handle_dream(content, output_manager),
+            CommandResult::Dream(content) => handle_dream(content, output_manager, game_world.rng.stream(RngStream::Dialogue)),
             CommandResult::WakeUp => handle_wakeup(output_manager, game_world),
             _ => {
                 output_manager.print("你正在睡覺，只能使用 dream 或 wakeup 指令！".to_string());
@@ -478,6 +480,7 @@ fn handle_command_result(
         CommandResult::Name(target, name) => handle_name(target, name, output_manager, game_world)?,
         CommandResult::Destroy(target) => handle_destroy(target, output_manager, game_world)?,
         CommandResult::Create(obj_type, item_type, name) => handle_create(obj_type, item_type, name, output_manager, game_world)?,
+        CommandResult::Region(command) => handle_region(command, output_manager, game_world),
         CommandResult::Set(target, attribute, value) => handle_set(target, attribute, value, output_manager, game_world)?,
         CommandResult::SwitchControl(npc_name) => {
             // TODO: handle_switch_control 需要完全重构以适应新架构
@@ -501,6 +504,8 @@ fn handle_command_result(
         CommandResult::Kick(target) => handle_kick(target, output_manager, game_world)?,
         CommandResult::Escape => handle_escape(output_manager, game_world)?,
         CommandResult::ListNpcs => handle_list_npcs(output_manager, game_world),
+        CommandResult::Memory => handle_memory(output_manager, game_world),
+        CommandResult::Registered(args) => handle_registered(args, output_manager, game_world),
         CommandResult::CheckNpc(npc_name) => handle_check_npc(npc_name, output_manager, game_world),
         CommandResult::ToggleTypewriter => handle_toggle_typewriter(output_manager),
         // 任務系統
@@ -552,7 +557,7 @@ fn handle_exit(
     // 保存遊戲設置
     let game_settings = GameSettings {
         show_minimap: output_manager.is_minimap_open(),
-        ..Default::default()
+        ..GameSettings::load()
     };
     let _ = game_settings.save();
     
@@ -652,6 +657,49 @@ fn handle_show_world(output_manager: &mut OutputManager, game_world: &GameWorld)
     output_manager.set_status(String::new());
 }
 
+/// 處理區域編輯（建造者指令，整個操作只存檔一次）
+fn handle_region(command: crate::map_edit::RegionCommand, output_manager: &mut OutputManager, game_world: &mut GameWorld) {
+    match game_world.edit_region(command) {
+        Ok(message) => {
+            output_manager.log(format!("區域編輯: {message}"));
+            output_manager.print(message);
+        }
+        Err(e) => output_manager.set_status(e),
+    }
+}
+
+/// 處理記憶體報告（世界各子系統 + 輸出緩衝區）
+fn handle_memory(output_manager: &mut OutputManager, game_world: &GameWorld) {
+    use crate::mem_stats::HeapSize;
+    let mut report = game_world.memory_report();
+    report.add("output", output_manager.heap_size());
+    for line in report.to_lines() {
+        output_manager.print(line);
+    }
+}
+
+/// 處理登錄表中的擴充命令
+/// 
+/// 命令經核心輸出送出的內容在這裡攔截，轉到對應的輸出區
+/// 終端模式只以 exit 命令離開，擴充命令的退出狀態不結束主循環
+fn handle_registered(
+    args: Vec<String>,
+    output_manager: &mut OutputManager,
+    game_world: &mut GameWorld,
+) {
+    use crate::core_output::{capture_output, OutputZone};
+    let args: Vec<&str> = args.iter().map(String::as_str).collect();
+    let (_, output) = capture_output(|| crate::command_registry::dispatch(game_world, &args));
+    for (zone, text) in output {
+        match zone {
+            OutputZone::Main => output_manager.print(text),
+            OutputZone::Log => output_manager.log(text),
+            OutputZone::Status => output_manager.set_status(text),
+            OutputZone::Side => output_manager.add_side_message(text),
+        }
+    }
+}
+
 /// 處理顯示小地圖
 /// 
 /// 打開小地圖並更新顯示內容
@@ -825,18 +873,28 @@ fn display_look_location(
         output_manager.print(format!("此處是【{}】", point.name));
     }
     
+    // 顯示所在區域的天氣
+    if let Some(weather) = game_world.weather_at(&current_map.name, me.x, me.y) {
+        output_manager.print(weather.describe());
+    }
+    
     // 顯示物品
-    display_location_items(point, output_manager);
+    display_location_items(&point, output_manager);
     
     // 顯示 NPC
     display_location_npcs(me, game_world, output_manager);
     
+    // 顯示視野內（牆後看不到）的角色與物品
+    for line in game_world.describe_visible(&game_world.current_controlled_id) {
+        output_manager.print(line);
+    }
+    
     output_manager.print("".to_string());
 }
 
 /// 顯示位置的物品列表
 fn display_location_items(
-    point: &crate::map::Point,
+    point: &crate::map::PointRef,
     output_manager: &mut OutputManager,
 ) {
     if point.objects.is_empty() {
@@ -844,7 +902,7 @@ fn display_location_items(
     }
     
     output_manager.print("\n🎁 此處物品:".to_string());
-    for (obj, count) in &point.objects {
+    for (obj, count) in point.objects {
         let display_name = item_registry::get_item_display_name(obj);
         
         if let Some(ages) = point.object_ages.get(obj) {
@@ -892,7 +950,7 @@ fn display_location_npcs(
         output_manager.print(desc);
         
         // 觸發見面對話
-        if let Some(greeting) = npc.try_talk("見面", me) {
+        if let Some(greeting) = npc.try_talk("見面", me, game_world.rng.stream(RngStream::Dialogue)) {
             output_manager.print(format!("💬 {} 說：「{}」", npc.name, greeting));
         }
     }
@@ -939,7 +997,7 @@ fn check_and_handle_proximity(
             if let Some(npc) = game_world.npc_manager.get_npc(&npc_id) {
                 // 檢查是否有"見面"對話
                 if let Some(controlled) = controlled_person {
-                    if let Some(greeting) = npc.get_weighted_dialogue("見面", controlled) {
+                    if let Some(greeting) = npc.get_weighted_dialogue("見面", controlled, game_world.rng.stream(RngStream::Dialogue)) {
                         output_manager.print(format!("{} 說：「{}」", npc.name, greeting));
                     }
                 }
@@ -1117,6 +1175,7 @@ pub fn update_minimap_display(
 
 /// 移動組隊的NPC跟隨玩家
 fn move_party_npcs(
+    from_map: &str,
     player_new_x: usize,
     player_new_y: usize,
     game_world: &mut GameWorld,
@@ -1127,9 +1186,10 @@ fn move_party_npcs(
     
     for npc_id in npc_ids {
         if let Some(npc) = game_world.npc_manager.get_npc_mut(&npc_id) {
-            // 只移動與玩家組隊的NPC
-            if npc.party_leader == Some("me".to_string()) && npc.map == current_map {
+            // 只移動與玩家組隊的NPC（走進相鄰的大地圖區塊時一起換地圖）
+            if npc.party_leader == Some("me".to_string()) && npc.map == from_map {
                 // NPC 移動到玩家的新位置（同一位置）
+                npc.map = current_map.clone();
                 npc.x = player_new_x;
                 npc.y = player_new_y;
                 
@@ -1177,23 +1237,42 @@ fn handle_movement(
         };
         (me.x, me.y)
     };
-    
-    let new_x = (current_x as i32 + dx) as usize;
-    let new_y = (current_y as i32 + dy) as usize;
-    
-    // 檢查邊界和可走性
-    if !can_move_to(new_x, new_y, game_world, output_manager) {
-        return Ok(());
-    }
-    
-    // 執行移動
+    let controlled_id = game_world.current_controlled_id.clone();
+    let from_map = game_world.current_map_name.clone();
     let person_dir = format!("{}/persons", game_world.world_dir);
-    if let Some(me) = get_current_controlled_mut(game_world) {
-        me.move_to(new_x, new_y);
-        
-        // 保存新位置
-        let _ = me.save(&person_dir, "me");
-    }
+    
+    let (new_x, new_y) = match game_world.overworld_step(&controlled_id, dx, dy) {
+        // 大地圖區塊邊緣：已走進相鄰區塊
+        Some(true) => {
+            let Some(me) = get_current_controlled(game_world) else {
+                return Ok(());
+            };
+            let _ = me.save(&person_dir, "me");
+            (me.x, me.y)
+        }
+        Some(false) => {
+            output_manager.set_status("前方無法通行".to_string());
+            return Ok(());
+        }
+        None => {
+            let new_x = (current_x as i32 + dx) as usize;
+            let new_y = (current_y as i32 + dy) as usize;
+            
+            // 檢查邊界和可走性
+            if !can_move_to(new_x, new_y, game_world, output_manager) {
+                return Ok(());
+            }
+            
+            // 執行移動
+            if let Some(me) = get_current_controlled_mut(game_world) {
+                me.move_to(new_x, new_y);
+                
+                // 保存新位置
+                let _ = me.save(&person_dir, "me");
+            }
+            (new_x, new_y)
+        }
+    };
     
     // 顯示移動方向
     let direction = match (dx, dy) {
@@ -1206,7 +1285,7 @@ fn handle_movement(
     output_manager.set_status(format!("往 {direction} 移動"));
     
     // 移動組隊的 NPC 跟隨
-    move_party_npcs(new_x, new_y, game_world, output_manager);
+    move_party_npcs(&from_map, new_x, new_y, game_world, output_manager);
     
     // 移動後執行 look
     display_look(None, output_manager, game_world);
@@ -1243,6 +1322,10 @@ fn can_move_to(
             output_manager.set_status("前方是牆壁，無法通過".to_string());
             return false;
         }
+        if game_world.weather_at(&current_map.name, x, y).is_some_and(|w| w.blocks_movement()) {
+            output_manager.set_status("前方狂風暴雨，無法前進".to_string());
+            return false;
+        }
         true
     } else {
         false
@@ -1276,7 +1359,7 @@ fn handle_get(
     
     // 收集要撿起的物品（先從地圖移除，記錄下來）
     let items_to_pickup: Vec<(String, u32)> = if let Some(current_map) = game_world.get_current_map_mut() {
-        if let Some(point) = current_map.get_point_mut(x, y) {
+        if let Some(point) = current_map.items_mut(x, y) {
             if point.objects.is_empty() {
                 output_manager.print("此處沒有物品。".to_string());
                 Vec::new()
@@ -1402,7 +1485,7 @@ fn handle_drop(
     // 放到地圖
     if should_save_map {
         if let Some(current_map) = game_world.get_current_map_mut() {
-            if let Some(point) = current_map.get_point_mut(x, y) {
+            if let Some(point) = current_map.items_mut(x, y) {
                 point.add_objects(resolved_name.clone(), actual_quantity);
                 let display_name = item_registry::get_item_display_name(&resolved_name);
                 output_manager.print(format!("✓ 放下了: {display_name} x{actual_quantity}"));
@@ -1590,6 +1673,7 @@ fn handle_sleep(
 fn handle_dream(
     content: Option<String>,
     output_manager: &mut OutputManager,
+    rng: &crate::rng::Rng,
 ) {
     if let Some(dream_content) = content {
         output_manager.print(format!("💭 你夢見了：{dream_content}"));
@@ -1600,10 +1684,7 @@ fn handle_dream(
             "你夢見了童年的回憶...",
             "你夢見了一座神秘的城堡...",
             "你夢見自己成為了英雄..."];
-        use rand::Rng;
-        let mut rng = rand::thread_rng();
-        let idx = rng.gen_range(0..dreams.len());
-        output_manager.print(format!("💭 {}", dreams[idx]));
+        output_manager.print(format!("💭 {}", dreams[rng.below(dreams.len())]));
     }
 }
 
@@ -1732,17 +1813,13 @@ fn handle_conquer(
             return Ok(())
         }
         
-        // 獲取目標點
-        if let Some(point) = current_map.get_point_mut(target_x, target_y) {
-            if point.walkable {
-                output_manager.set_status(format!("{dir_name} 方已經是可行走的了"));
-            } else {
-                // 設置為可行走
-                point.walkable = true;
-                output_manager.print(format!("你征服了 {dir_name} 方的障礙！"));
-                output_manager.print(format!("位置 ({target_x}, {target_y}) 現在可以行走了"));
-                output_manager.log(format!("玩家在 ({}, {}) 征服了 {} 方 ({}, {})", x, y, dir_name, target_x, target_y));
-            }
+        // 設置為可行走（記錄牆的變化，附近角色的視野會重新計算）
+        if current_map.set_walkable(target_x, target_y, true) {
+            output_manager.print(format!("你征服了 {dir_name} 方的障礙！"));
+            output_manager.print(format!("位置 ({target_x}, {target_y}) 現在可以行走了"));
+            output_manager.log(format!("玩家在 ({}, {}) 征服了 {} 方 ({}, {})", x, y, dir_name, target_x, target_y));
+        } else {
+            output_manager.set_status(format!("{dir_name} 方已經是可行走的了"));
         }
     }
     
@@ -1837,8 +1914,7 @@ fn try_flyto_map(
     output_manager: &mut OutputManager,
     game_world: &mut GameWorld,
 ) -> Result<bool, Box<dyn std::error::Error>> {
-    if game_world.maps.contains_key(target) {
-        game_world.current_map_name = target.to_string();
+    if game_world.change_map(target) {
         
         let (center_x, center_y) = if let Some(new_map) = game_world.get_current_map() {
             (new_map.width / 2, new_map.height / 2)
@@ -1870,26 +1946,24 @@ fn try_flyto_location(
     output_manager: &mut OutputManager,
     game_world: &mut GameWorld,
 ) -> Result<bool, Box<dyn std::error::Error>> {
-    if let Some(current_map) = game_world.get_current_map() {
-        for row in &current_map.points {
-            for point in row {
-                if !point.name.is_empty() && point.name == target {
-                    let (x, y) = (point.x, point.y);
-                    let person_dir = format!("{}/persons", game_world.world_dir);
-                    
-                    let Some(me) = get_current_controlled_mut(game_world) else {
-                        return Ok(false);
-                    };
-                    me.move_to(x, y);
-                    me.save(&person_dir, "me")?;
-                    
-                    output_manager.print(format!("你飛到了地點「{target}」({x}, {y})"));
-                    output_manager.log(format!("玩家傳送到地點「{target}」({x}, {y})"));
-                    display_look(None, output_manager, game_world);
-                    return Ok(true);
-                }
-            }
-        }
+    let spot = game_world.get_current_map().and_then(|current_map| {
+        current_map.points()
+            .find(|point| !point.name.is_empty() && point.name == target)
+            .map(|point| (point.x, point.y))
+    });
+    if let Some((x, y)) = spot {
+        let person_dir = format!("{}/persons", game_world.world_dir);
+        
+        let Some(me) = get_current_controlled_mut(game_world) else {
+            return Ok(false);
+        };
+        me.move_to(x, y);
+        me.save(&person_dir, "me")?;
+        
+        output_manager.print(format!("你飛到了地點「{target}」({x}, {y})"));
+        output_manager.log(format!("玩家傳送到地點「{target}」({x}, {y})"));
+        display_look(None, output_manager, game_world);
+        return Ok(true);
     }
     Ok(false)
 }
@@ -1918,14 +1992,14 @@ fn handle_namehere(
     };
     
     if let Some(current_map) = game_world.get_current_map_mut() {
-        if let Some(point) = current_map.get_point_mut(x, y) {
-            let old_name = if point.name.is_empty() {
+        if let Some(cell) = current_map.cell_mut(x, y) {
+            let old_name = if cell.name.is_empty() {
                 "（無名）".to_string()
             } else {
-                point.name.clone()
+                cell.name.clone()
             };
             
-            point.name = name.clone();
+            cell.name = name.clone();
             output_manager.print(format!("你將此地命名為「{name}」"));
             output_manager.log(format!("位置 ({x}, {y}) 從 {old_name} 更名為「{name}」"));
         }
@@ -1961,14 +2035,14 @@ fn handle_name(
         
         if let Some(current_map) = game_world.get_current_map_mut() {
             if x < current_map.width && y < current_map.height {
-                if let Some(point) = current_map.get_point_mut(x, y) {
-                    let old_name = if point.name.is_empty() {
+                if let Some(cell) = current_map.cell_mut(x, y) {
+                    let old_name = if cell.name.is_empty() {
                         "（無名）".to_string()
                     } else {
-                        point.name.clone()
+                        cell.name.clone()
                     };
                     
-                    point.name = new_name.clone();
+                    cell.name = new_name.clone();
                     output_manager.print(format!("你將位置 ({x}, {y}) 命名為「{new_name}」"));
                     output_manager.log(format!("位置 ({x}, {y}) 從 {old_name} 更名為「{new_name}」"));
                 }
@@ -2056,7 +2130,7 @@ fn destroy_item_at_location(
     let map_name = game_world.current_map_name.clone();
     
     if let Some(current_map) = game_world.get_current_map_mut() {
-        if let Some(point) = current_map.get_point_mut(x, y) {
+        if let Some(point) = current_map.items_mut(x, y) {
             if let Some(count) = point.objects.get(&item_name) {
                 let count_value = *count;
                 point.objects.remove(&item_name);
@@ -2100,81 +2174,22 @@ fn check_and_execute_events(
     game_world: &mut GameWorld,
     output_manager: &mut OutputManager,
 ) {
-    let current_day = game_world.time.day;
-    let current_hour = game_world.time.hour;
-    let current_minute = game_world.time.minute;
-    
-    // 如果是同一分鐘，不重複檢查
-    if (current_day, current_hour, current_minute) == game_world.event_scheduler.last_check_time {
-        return;
-    }
-    
-    game_world.event_scheduler.last_check_time = (current_day, current_hour, current_minute);
-    
-    // === 檢查事件 ===
-    let events: Vec<&crate::event::GameEvent> = game_world.event_manager.list_events(); // 取得事件的參考
-    let mut triggered_event_ids = Vec::new();
-    for event in &events {
-        let event_id = event.id.clone();
-        if let Some(runtime_state) = game_world.event_manager.get_runtime_state(&event_id) {
-            if !event.can_trigger(runtime_state) {
-                continue;
-            }
-        }
-        let trigger_check = crate::event_scheduler::EventScheduler::new()
-            .check_trigger(event, game_world);
-        
-        // 從 NpcManager 獲取 me 來檢查條件
-        let condition_check = if let Some(me) = game_world.npc_manager.get_npc("me") {
-            crate::event_scheduler::EventScheduler::new()
-                .check_conditions(event, game_world, me)
-        } else {
-            false
-        };
-        
-        if trigger_check && condition_check {
-            triggered_event_ids.push(event_id.clone());
-        }
+    // 天氣網格改變了目前地圖的天氣或溫度時先描述
+    let narration = game_world.take_weather_narration();
+    if !narration.is_empty() {
+        output_manager.print(narration.join("\n"));
     }
-    for event_id in triggered_event_ids {
-        game_world.event_manager.trigger_event(&event_id);
-        if let Some(event) = game_world.event_manager.get_event(&event_id) {
-            let event_clone = event.clone();
-            let location_info = get_event_location_info(&event_clone, game_world);
-            output_manager.log(format!("🎭 事件: {}{}", event_clone.name, location_info));
-            
-            // 執行事件（內部會從 NpcManager 獲取 me）
-            if let Err(e) = crate::event_executor::EventExecutor::execute_event(
-                &event_clone,
-                game_world,
-                output_manager
-            ) {
-                output_manager.log(format!("⚠️  事件執行錯誤: {e}"));
-            }
-        }
-    }
-}
 
-/// 獲取事件位置信息字符串
-fn get_event_location_info(event: &crate::event::GameEvent, game_world: &GameWorld) -> String {
-    if let Some(map_name) = &event.r#where.map {
-        if let Some(positions) = &event.r#where.positions {
-            if !positions.is_empty() {
-                if let Some(map) = game_world.maps.get(map_name) {
-                    if let Some(point) = map.get_point(positions[0][0], positions[0][1]) {
-                        return format!(" 在 {}({}, {}) - {}", 
-                            map_name, positions[0][0], positions[0][1], point.description);
-                    }
-                }
-                return format!(" 在 {}({}, {})", map_name, positions[0][0], positions[0][1]);
-            }
-        } else if let Some(area) = &event.r#where.area {
-            return format!(" 在 {} 區域({}-{}, {}-{})", 
-                map_name, area.x[0], area.x[1], area.y[0], area.y[1]);
-        }
-        return format!(" 在 {map_name}");
+    // 收集本分鐘到期的事件，整批執行後一次輸出
+    let due = game_world.collect_due_events();
+    if due.is_empty() {
+        return;
     }
-    String::new()
+    
+    let mut logs: Vec<String> = due.iter().filter_map(|event_id| game_world.event_log_line(event_id)).collect();
+    let report = crate::event_executor::EventExecutor::execute_batch(&due, game_world, output_manager);
+    logs.extend(report.failures.into_iter().map(|(_, e)| format!("⚠️  事件執行錯誤: {e}")));
+    output_manager.log(logs.join("\n"));
 }
 
 /// 解析 NPC 類型簡稱
@@ -2280,7 +2295,7 @@ fn create_item(
     let map_name = game_world.current_map_name.clone();
     
     if let Some(current_map) = game_world.get_current_map_mut() {
-        if let Some(point) = current_map.get_point_mut(x, y) {
+        if let Some(point) = current_map.items_mut(x, y) {
             *point.objects.entry(item_name.clone()).or_insert(0) += 1;
             
             output_manager.print(format!("你創建了物品「{display_name}」(類型: {item_type})"));
@@ -3203,7 +3218,7 @@ fn handle_talk(
             return Ok(());
         };
         
-        if let Some(dialogue) = npc.try_talk(&topic, me) {
+        if let Some(dialogue) = npc.try_talk(&topic, me, game_world.rng.stream(RngStream::Dialogue)) {
             output_manager.print(format!("💬 跟{}開始{topic}...", npc.name));
             output_manager.print(format!("{} 說：「{}」", npc.name, dialogue));
         } else {
@@ -3222,19 +3237,17 @@ fn handle_talk(
 /// 嘗試叫住單個 NPC，返回是否成功
 fn try_stop_npc(
     npc: &mut crate::person::Person,
+    rng: &crate::rng::Rng,
     output_manager: &mut OutputManager,
 ) -> bool {
-    use rand::Rng;
-    
     let success_rate = (50 + npc.relationship / 2).clamp(0, 100);
-    let mut rng = rand::thread_rng();
-    let roll = rng.gen_range(0..100);
+    let roll = rng.below(100) as i32;
     
     if roll < success_rate {
         npc.is_interacting = true;
         output_manager.print(format!("你叫住了 {}", npc.name));
         
-        if let Some(response) = npc.get_weighted_dialogue("被叫住", npc) {
+        if let Some(response) = npc.get_weighted_dialogue("被叫住", npc, rng) {
             output_manager.print(format!("{} 說：「{}」", npc.name, response));
         }
         true
@@ -3300,7 +3313,7 @@ fn wait_all_npcs_at_location(
     
     for name in npc_names {
         if let Some(npc) = game_world.npc_manager.get_npc_mut(&name) {
-            if try_stop_npc(npc, output_manager) {
+            if try_stop_npc(npc, game_world.rng.stream(RngStream::Dialogue), output_manager) {
                 success_count += 1;
             }
         }
@@ -3338,7 +3351,7 @@ fn wait_specific_npc(
         return Ok(());
     }
     
-    try_stop_npc(npc, output_manager);
+    try_stop_npc(npc, game_world.rng.stream(RngStream::Dialogue), output_manager);
     Ok(())
 }
 
@@ -3688,7 +3701,7 @@ fn execute_attack(
             return Ok(());
         }
         
-        let dialogue = me.get_skill_dialogue(skill_name);
+        let dialogue = me.get_skill_dialogue(skill_name, game_world.rng.stream(RngStream::Combat));
         let damage = me.combat_skills.get(skill_name)
             .map(|s| s.damage)
             .unwrap_or(1);
@@ -3700,7 +3713,7 @@ fn execute_attack(
             return Ok(()); // NPC冷卻中，跳過
         }
         
-        let dialogue = npc.get_skill_dialogue(skill_name);
+        let dialogue = npc.get_skill_dialogue(skill_name, game_world.rng.stream(RngStream::Combat));
         let damage = npc.combat_skills.get(skill_name)
             .map(|s| s.damage)
             .unwrap_or(1);
@@ -3833,12 +3846,11 @@ fn execute_combat_round(
         }
         
         // 每個NPC有50%機率執行戰鬥指令
-        use rand::Rng;
-        let mut rng = rand::thread_rng();
-        if rng.gen_bool(0.5) {
+        let rng = game_world.rng.stream(RngStream::Combat);
+        if rng.chance(0.5) {
             // 隨機選擇戰鬥技能
             let skills = ["punch", "kick"];
-            let skill_name = skills[rng.gen_range(0..skills.len())];
+            let skill_name = skills[rng.below(skills.len())];
             
             // 執行NPC攻擊玩家
             execute_attack(skill_name, participant, "me", output_manager, game_world)?;
@@ -0,0 +1,424 @@
+// 唯讀資源包：把不會變動的資源（角色描述表、各世界的基礎地圖）編譯成一個檔案，
+// 每個行程以唯讀方式映射（mmap）。同一台主機上的多個引擎行程共用頁面快取中的同一份資料，
+// 不必各自讀檔、解析 JSON，再在自己的堆積中保存一份。
+//
+// 格式（小端序；所有位移都相對於檔案開頭，不含指標，可以映射到任何位址）：
+// - 檔頭：魔數 "RMPACK\0\0"、版本 (u32)、資源數 (u32)、字串數 (u32)
+// - 資源表：每筆 32 位元組 = 種類 (u32)、鍵的字串編號 (u32)、內容位移 (u32)、內容長度 (u32)、
+//   來源檔案長度 (u64)、來源檔案修改時間 (u64，奈秒)
+// - 字串表：每個字串的 位移 (u32) + 長度 (u32)，之後是 UTF-8 內容；編號 0 固定為空字串
+// - 各資源的內容
+//
+// 地圖內容：地圖設定 (JSON)、有物品的格子 (JSON)，兩者都以 u32 長度開頭；
+// 之後每格 描述編號 (u32)、地點名稱編號 (u32)、旗標 (u8，與快照相同)。
+// 描述佔了地圖的大部分，由資源包載入的格子直接借用映射頁面中的字串，不再複製。
+//
+// 每個資源記錄來源檔案的長度與修改時間：來源在打包之後被修改（例如遊戲存檔改寫了地圖）時
+// 該資源視為過期，照常讀取 JSON 檔。資源包不存在或損壞時同樣回到讀檔。
+// 映射在行程結束前不會解除；打包時先寫暫存檔再改名取代，不會改寫其他行程正在映射的檔案。
+
+use std::collections::HashMap;
+use std::error::Error;
+use std::fs;
+use std::path::Path;
+use std::time::UNIX_EPOCH;
+use once_cell::sync::Lazy;
+
+use crate::map::{Cell, Map, PointItems};
+use crate::shared_assets::SharedStr;
+use crate::snapshot::{cell_flags, terrain_from_flags, MapRecord};
+
+/// 預設的資源包路徑（由 packassets 產生）
+pub const PACK_PATH: &str = "worlds/assets.pack";
+
+pub const KIND_PERSON_DESCRIPTIONS: u32 = 1;  // 角色描述表（原始 JSON）
+pub const KIND_MAP: u32 = 2;                  // 地圖
+
+const MAGIC: &[u8; 8] = b"RMPACK\0\0";
+const VERSION: u32 = 1;
+const HEADER_SIZE: usize = 20;
+const ENTRY_SIZE: usize = 32;
+const CELL_SIZE: usize = 9;
+
+static PACK: Lazy<Option<AssetPack>> = Lazy::new(|| AssetPack::open(PACK_PATH).ok());
+
+/// 全域資源包（第一次使用時映射 PACK_PATH）
+pub fn global() -> Option<&'static AssetPack> {
+    PACK.as_ref()
+}
+
+/// 由全域資源包取得資源內容（不存在或已過期時返回 None）
+pub fn asset(kind: u32, key: &str) -> Option<&'static [u8]> {
+    global()?.get(kind, key)
+}
+
+/// 由全域資源包載入地圖（不存在或已過期時返回 None）
+pub fn load_map(path: &str) -> Option<Map> {
+    global()?.load_map(path)
+}
+
+struct Entry {
+    kind: u32,
+    data: &'static [u8],
+    source: (u64, u64),  // 來源檔案的 (長度, 修改時間)
+}
+
+/// 已映射的資源包
+pub struct AssetPack {
+    strings: Vec<&'static str>,
+    entries: HashMap<&'static str, Entry>,
+}
+
+impl AssetPack {
+    /// 映射並檢查資源包
+    pub fn open(path: &str) -> Result<Self, Box<dyn Error>> {
+        Self::parse(map_file(path)?)
+    }
+
+    fn parse(bytes: &'static [u8]) -> Result<Self, Box<dyn Error>> {
+        if bytes.get(..MAGIC.len()) != Some(&MAGIC[..]) {
+            return Err("不是資源包".into());
+        }
+        let version = u32_at(bytes, 8)?;
+        if version != VERSION {
+            return Err(format!("不支援的資源包版本 {version}").into());
+        }
+        let entry_count = u32_at(bytes, 12)? as usize;
+        let string_count = u32_at(bytes, 16)? as usize;
+        let strings_at = HEADER_SIZE + entry_count * ENTRY_SIZE;
+        if strings_at + string_count * 8 > bytes.len() {
+            return Err("資源包不完整".into());
+        }
+
+        let mut strings = Vec::with_capacity(string_count);
+        for i in 0..string_count {
+            let at = strings_at + i * 8;
+            strings.push(std::str::from_utf8(slice_at(bytes, u32_at(bytes, at)?, u32_at(bytes, at + 4)?)?)?);
+        }
+
+        let mut entries = HashMap::with_capacity(entry_count);
+        for i in 0..entry_count {
+            let at = HEADER_SIZE + i * ENTRY_SIZE;
+            let key = *strings.get(u32_at(bytes, at + 4)? as usize).ok_or("資源包中的字串編號無效")?;
+            entries.insert(key, Entry {
+                kind: u32_at(bytes, at)?,
+                data: slice_at(bytes, u32_at(bytes, at + 8)?, u32_at(bytes, at + 12)?)?,
+                source: (u64_at(bytes, at + 16)?, u64_at(bytes, at + 24)?),
+            });
+        }
+        Ok(AssetPack { strings, entries })
+    }
+
+    /// 取得資源內容；來源檔案在打包後被修改過或已不存在時返回 None
+    pub fn get(&self, kind: u32, key: &str) -> Option<&'static [u8]> {
+        let entry = self.entries.get(key).filter(|entry| entry.kind == kind)?;
+        (source_stamp(key).ok()? == entry.source).then_some(entry.data)
+    }
+
+    /// 解碼地圖；地點描述借用映射的頁面
+    pub fn load_map(&self, path: &str) -> Option<Map> {
+        self.decode_map(self.get(KIND_MAP, path)?).ok()
+    }
+
+    fn decode_map(&self, data: &'static [u8]) -> Result<Map, Box<dyn Error>> {
+        let mut cells = data;
+        let header = take_blob(&mut cells)?;
+        let objects = take_blob(&mut cells)?;
+        let MapRecord { name, width, height, map_type, description, properties } = serde_json::from_slice(header)?;
+        if cells.len() != width * height * CELL_SIZE {
+            return Err(format!("資源包中地圖 {name} 的格數不符").into());
+        }
+
+        let mut base = Vec::with_capacity(width * height);
+        for at in (0..cells.len()).step_by(CELL_SIZE) {
+            let flags = cells[at + 8];
+            base.push(Cell {
+                walkable: flags & 1 != 0,
+                terrain_type: terrain_from_flags(flags)?,
+                description: SharedStr::Static(self.string(u32_at(cells, at)?)?),
+                name: self.string(u32_at(cells, at + 4)?)?.to_string(),
+            });
+        }
+
+        let mut map = Map::from_cells(name, map_type, width, base);
+        type Objects = Vec<(usize, usize, HashMap<String, u32>, HashMap<String, Vec<u64>>)>;
+        for (x, y, objects, object_ages) in serde_json::from_slice::<Objects>(objects)? {
+            if !map.set_items(x, y, PointItems { objects, object_ages }) {
+                return Err("資源包中的物品位置超出地圖".into());
+            }
+        }
+        map.description = description;
+        map.properties = properties;
+        Ok(map)
+    }
+
+    fn string(&self, id: u32) -> Result<&'static str, Box<dyn Error>> {
+        Ok(*self.strings.get(id as usize).ok_or("資源包中的字串編號無效")?)
+    }
+}
+
+fn u32_at(bytes: &[u8], at: usize) -> Result<u32, Box<dyn Error>> {
+    Ok(u32::from_le_bytes(bytes.get(at..at + 4).ok_or("資源包不完整")?.try_into()?))
+}
+
+fn u64_at(bytes: &[u8], at: usize) -> Result<u64, Box<dyn Error>> {
+    Ok(u64::from_le_bytes(bytes.get(at..at + 8).ok_or("資源包不完整")?.try_into()?))
+}
+
+fn slice_at(bytes: &'static [u8], offset: u32, len: u32) -> Result<&'static [u8], Box<dyn Error>> {
+    let offset = offset as usize;
+    Ok(bytes.get(offset..offset + len as usize).ok_or("資源包不完整")?)
+}
+
+/// 取出一段以 u32 長度開頭的內容，data 前進到其後
+fn take_blob(data: &mut &'static [u8]) -> Result<&'static [u8], Box<dyn Error>> {
+    let len = u32_at(data, 0)? as usize;
+    let rest = &data[4..];
+    if len > rest.len() {
+        return Err("資源包不完整".into());
+    }
+    let (blob, rest) = rest.split_at(len);
+    *data = rest;
+    Ok(blob)
+}
+
+fn put_blob(out: &mut Vec<u8>, blob: &[u8]) {
+    out.extend_from_slice(&(blob.len() as u32).to_le_bytes());
+    out.extend_from_slice(blob);
+}
+
+/// 來源檔案的 (長度, 修改時間奈秒)
+fn source_stamp(path: &str) -> std::io::Result<(u64, u64)> {
+    let meta = fs::metadata(path)?;
+    let mtime = meta.modified()?.duration_since(UNIX_EPOCH).map_or(0, |d| d.as_nanos() as u64);
+    Ok((meta.len(), mtime))
+}
+
+#[cfg(unix)]
+mod sys {
+    use std::os::raw::{c_int, c_void};
+
+    extern "C" {
+        pub fn mmap(addr: *mut c_void, len: usize, prot: c_int, flags: c_int, fd: c_int, offset: isize) -> *mut c_void;
+    }
+
+    pub const PROT_READ: c_int = 1;
+    pub const MAP_SHARED: c_int = 1;
+    pub const MAP_FAILED: *mut c_void = !0usize as *mut c_void;
+}
+
+/// 以唯讀方式映射整個檔案（不解除映射，借出的內容在行程結束前都有效）
+#[cfg(unix)]
+fn map_file(path: &str) -> Result<&'static [u8], Box<dyn Error>> {
+    use std::os::unix::io::AsRawFd;
+
+    let file = fs::File::open(path)?;
+    let len = file.metadata()?.len() as usize;
+    if len == 0 {
+        return Err("資源包是空的".into());
+    }
+    let ptr = unsafe { sys::mmap(std::ptr::null_mut(), len, sys::PROT_READ, sys::MAP_SHARED, file.as_raw_fd(), 0) };
+    if ptr == sys::MAP_FAILED {
+        return Err(std::io::Error::last_os_error().into());
+    }
+    Ok(unsafe { std::slice::from_raw_parts(ptr as *const u8, len) })
+}
+
+/// 沒有 mmap 的平台：讀進一塊不釋放的緩衝區（仍省下 JSON 解析與字串配置）
+#[cfg(not(unix))]
+fn map_file(path: &str) -> Result<&'static [u8], Box<dyn Error>> {
+    Ok(Box::leak(fs::read(path)?.into_boxed_slice()))
+}
+
+/// 打包結果
+#[derive(Debug, Default)]
+pub struct PackReport {
+    pub maps: usize,
+    pub points: usize,
+    pub skipped: Vec<String>,  // 無法解析的地圖（遊戲同樣無法載入，不打包）
+    pub strings: usize,
+    pub bytes: usize,
+}
+
+/// 待寫出的資源
+struct PackEntry {
+    kind: u32,
+    key: u32,
+    data: Vec<u8>,
+    source: (u64, u64),
+}
+
+/// 資源包寫入端
+#[derive(Default)]
+struct PackBuilder {
+    strings: Vec<String>,
+    string_ids: HashMap<String, u32>,
+    entries: Vec<PackEntry>,
+}
+
+impl PackBuilder {
+    fn string_id(&mut self, s: &str) -> u32 {
+        if let Some(&id) = self.string_ids.get(s) {
+            return id;
+        }
+        let id = self.strings.len() as u32;
+        self.strings.push(s.to_string());
+        self.string_ids.insert(s.to_string(), id);
+        id
+    }
+
+    fn add(&mut self, kind: u32, path: &str, data: Vec<u8>) -> Result<(), Box<dyn Error>> {
+        let source = source_stamp(path)?;
+        let key = self.string_id(path);
+        self.entries.push(PackEntry { kind, key, data, source });
+        Ok(())
+    }
+
+    fn add_map(&mut self, path: &str, map: &Map) -> Result<(), Box<dyn Error>> {
+        let mut data = Vec::with_capacity(map.width * map.height * CELL_SIZE + 1024);
+        put_blob(&mut data, &serde_json::to_vec(&MapRecord::of(map))?);
+        let objects: Vec<_> = map.points_with_items()
+            .map(|((x, y), items)| (x, y, &items.objects, &items.object_ages))
+            .collect();
+        put_blob(&mut data, &serde_json::to_vec(&objects)?);
+        for cell in map.cells() {
+            let description = self.string_id(&cell.description);
+            let name = self.string_id(&cell.name);
+            data.extend_from_slice(&description.to_le_bytes());
+            data.extend_from_slice(&name.to_le_bytes());
+            data.push(cell_flags(cell));
+        }
+        self.add(KIND_MAP, path, data)
+    }
+
+    /// 寫出資源包（先寫暫存檔再改名取代），返回檔案大小
+    fn write(self, out: &str) -> Result<usize, Box<dyn Error>> {
+        let string_index_at = HEADER_SIZE + self.entries.len() * ENTRY_SIZE;
+        let string_bytes_at = string_index_at + self.strings.len() * 8;
+        let data_at = string_bytes_at + self.strings.iter().map(String::len).sum::<usize>();
+        let total = data_at + self.entries.iter().map(|entry| entry.data.len()).sum::<usize>();
+        if total > u32::MAX as usize {
+            return Err("資源包超過 4 GB".into());
+        }
+
+        let mut bytes = Vec::with_capacity(total);
+        bytes.extend_from_slice(MAGIC);
+        for value in [VERSION, self.entries.len() as u32, self.strings.len() as u32] {
+            bytes.extend_from_slice(&value.to_le_bytes());
+        }
+        let mut offset = data_at;
+        for entry in &self.entries {
+            for value in [entry.kind, entry.key, offset as u32, entry.data.len() as u32] {
+                bytes.extend_from_slice(&value.to_le_bytes());
+            }
+            bytes.extend_from_slice(&entry.source.0.to_le_bytes());
+            bytes.extend_from_slice(&entry.source.1.to_le_bytes());
+            offset += entry.data.len();
+        }
+        let mut offset = string_bytes_at;
+        for s in &self.strings {
+            bytes.extend_from_slice(&(offset as u32).to_le_bytes());
+            bytes.extend_from_slice(&(s.len() as u32).to_le_bytes());
+            offset += s.len();
+        }
+        for s in &self.strings {
+            bytes.extend_from_slice(s.as_bytes());
+        }
+        for entry in &self.entries {
+            bytes.extend_from_slice(&entry.data);
+        }
+
+        let tmp = format!("{out}.tmp");
+        fs::write(&tmp, &bytes)?;
+        fs::rename(&tmp, out)?;
+        Ok(bytes.len())
+    }
+}
+
+/// 打包 worlds_dir 下的角色描述表與每個世界 maps 資料夾中的地圖
+/// 資源以檔案路徑為鍵，遊戲以相同的路徑讀取時才會命中（預設皆為 "worlds"）
+pub fn build(worlds_dir: &str, out: &str) -> Result<PackReport, Box<dyn Error>> {
+    let mut builder = PackBuilder::default();
+    builder.string_id("");
+    let mut report = PackReport::default();
+
+    let person = format!("{worlds_dir}/person_descriptions.json");
+    if Path::new(&person).exists() {
+        builder.add(KIND_PERSON_DESCRIPTIONS, &person, fs::read(&person)?)?;
+    }
+
+    let mut worlds: Vec<String> = fs::read_dir(worlds_dir)?
+        .filter_map(Result::ok)
+        .filter(|entry| entry.path().is_dir())
+        .map(|entry| entry.file_name().to_string_lossy().to_string())
+        .collect();
+    worlds.sort();
+    for world in worlds {
+        let maps_dir = format!("{worlds_dir}/{world}/maps");
+        let Ok(files) = fs::read_dir(&maps_dir) else {
+            continue;
+        };
+        let mut files: Vec<String> = files
+            .filter_map(Result::ok)
+            .map(|entry| entry.file_name().to_string_lossy().to_string())
+            .filter(|name| name.ends_with(".json"))
+            .collect();
+        files.sort();
+        for file in files {
+            let path = format!("{maps_dir}/{file}");
+            let Ok(map) = serde_json::from_str::<Map>(&fs::read_to_string(&path)?) else {
+                report.skipped.push(path);
+                continue;
+            };
+            builder.add_map(&path, &map)?;
+            report.maps += 1;
+            report.points += map.width * map.height;
+        }
+    }
+
+    report.strings = builder.strings.len();
+    report.bytes = builder.write(out)?;
+    Ok(report)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::map::MapType;
+    use crate::rng::WorldRng;
+
+    #[test]
+    fn test_pack_round_trip_and_staleness() {
+        let dir = std::env::temp_dir().join(format!("ratamud_asset_pack_{}", std::process::id()));
+        let dir = dir.to_string_lossy().to_string();
+        fs::create_dir_all(format!("{dir}/w/maps")).unwrap();
+        fs::write(format!("{dir}/person_descriptions.json"), r#"{"appearance":{}}"#).unwrap();
+
+        let mut map = Map::new_with_type("m".to_string(), 7, 5, MapType::Forest, &WorldRng::new(3));
+        map.items_mut(4, 2).unwrap().add_objects("蘋果".to_string(), 2);
+        map.cell_mut(3, 1).unwrap().name = "小屋".to_string();
+        let map_path = format!("{dir}/w/maps/m.json");
+        map.save(&map_path).unwrap();
+
+        let pack_path = format!("{dir}/assets.pack");
+        let report = build(&dir, &pack_path).unwrap();
+        assert_eq!((report.maps, report.points), (1, 35));
+
+        let pack = AssetPack::open(&pack_path).unwrap();
+        assert!(pack.get(KIND_PERSON_DESCRIPTIONS, &format!("{dir}/person_descriptions.json")).is_some());
+        let loaded = pack.load_map(&map_path).unwrap();
+        assert_eq!((loaded.width, loaded.height, &loaded.description), (7, 5, &map.description));
+        for (p, q) in map.points().zip(loaded.points()) {
+            assert_eq!((p.walkable, p.description, p.name, p.terrain_type), (q.walkable, q.description, q.name, q.terrain_type));
+            assert_eq!(p.objects, q.objects);
+        }
+        assert!(loaded.cells().iter().all(|cell| matches!(cell.description, SharedStr::Static(_))));
+
+        // 來源檔案被改寫後資源過期
+        map.items_mut(0, 0).unwrap().add_objects("石子".to_string(), 1);
+        map.save(&map_path).unwrap();
+        assert!(pack.load_map(&map_path).is_none());
+
+        fs::remove_dir_all(&dir).unwrap();
+    }
+}
@@ -0,0 +1,26 @@
+// 資源包打包工具：把角色描述表與各世界的地圖編譯成可映射的唯讀資源包
+// 用法: cargo run --release --bin packassets -- [worlds_dir] [out]
+// 預設打包 worlds 並寫到 worlds/assets.pack；地圖或描述檔被修改後，對應的資源自動改回讀檔，重新打包即可
+
+use ratamud::asset_pack::{build, PACK_PATH};
+
+fn main() -> Result<(), Box<dyn std::error::Error>> {
+    let args: Vec<String> = std::env::args().skip(1).collect();
+    if args.len() > 2 || args.first().is_some_and(|a| a.starts_with('-')) {
+        eprintln!("用法: packassets [worlds_dir] [out]");
+        std::process::exit(2);
+    }
+    let worlds_dir = args.first().map_or("worlds", String::as_str);
+    let out = args.get(1).map_or(PACK_PATH, String::as_str);
+
+    let report = build(worlds_dir, out)?;
+
+    println!("✅ 已產生資源包: {out}");
+    println!("  地圖: {} 張 (共 {} 點)", report.maps, report.points);
+    println!("  字串: {} 個", report.strings);
+    for path in &report.skipped {
+        println!("  ⚠️  無法解析，已略過: {path}");
+    }
+    println!("  檔案大小: {} KB", report.bytes / 1024);
+    Ok(())
+}
@@ -0,0 +1,146 @@
+// 規模基準測試
+// 對每個維度（地圖數、地圖大小、NPC 數、事件數、物品密度）逐一放大，
+// 其餘維度維持預設值，量測載入時間、tick 時間、常駐記憶體與指令延遲。
+//
+// 用法: cargo run --release --features count-alloc --bin scale_bench -- [--quick] [--dir DIR] [--csv FILE]
+// 啟用 count-alloc 時記憶體欄位為分配器的實際配置量，否則退回常駐記憶體（RSS）差值
+
+use std::time::Instant;
+
+use ratamud::core_output::CoreOutputManager;
+use ratamud::mem_stats::alloc_stats;
+use ratamud::world::GameWorld;
+use ratamud::worldgen::{generate_world, WorldGenConfig};
+
+/// 每個樣本執行的 tick 數（每 tick 推進 1 遊戲分鐘）
+const TICKS: u32 = 60;
+/// 每個指令重複次數
+const COMMAND_REPEAT: u32 = 10;
+/// 量測延遲的指令（包含查看、移動與角色資訊）
+const COMMANDS: &[&str] = &["look", "right", "down", "left", "up", "status", "npcs"];
+
+/// 單一樣本的量測結果
+struct Sample {
+    dimension: &'static str,
+    value: String,
+    load_ms: f64,
+    tick_ms: f64,
+    mem_kb: u64,
+    heap_kb: u64,
+    cmd_avg_us: f64,
+    cmd_max_us: f64,
+}
+
+/// 目前使用的記憶體（KB）：優先使用計數分配器，否則讀取常駐記憶體（非 Linux 平台返回 0）
+fn used_kb() -> u64 {
+    if let Some(stats) = alloc_stats() {
+        return stats.live_bytes as u64 / 1024;
+    }
+    std::fs::read_to_string("/proc/self/statm")
+        .ok()
+        .and_then(|s| s.split_whitespace().nth(1).and_then(|v| v.parse::<u64>().ok()))
+        .map(|pages| pages * 4)
+        .unwrap_or(0)
+}
+
+/// 產生世界並量測一個樣本
+fn run_sample(
+    base_dir: &str,
+    dimension: &'static str,
+    value: String,
+    config: &WorldGenConfig,
+) -> Result<Sample, Box<dyn std::error::Error>> {
+    let world_dir = format!("{base_dir}/{dimension}_{value}");
+    generate_world(&world_dir, config)?;
+
+    // 載入（open_headless 只載入目前地圖，這裡載入全部地圖以量測完整世界的成本）
+    let mem_before = used_kb();
+    let start = Instant::now();
+    let mut game_world = GameWorld::open_headless(&world_dir)?;
+    game_world.load_all_maps()?;
+    let load_ms = start.elapsed().as_secs_f64() * 1000.0;
+    let mem_kb = used_kb().saturating_sub(mem_before);
+    let heap_kb = game_world.memory_report().total() as u64 / 1024;
+
+    // tick：時間推進 + 物品/NPC 老化 + 事件排程 + NPC 視圖建立（主循環每幀的工作）
+    let start = Instant::now();
+    for _ in 0..TICKS {
+        game_world.time.advance_secs(60);
+        game_world.update_time();
+        let mut output = CoreOutputManager::new();
+        game_world.run_scheduled_events(&mut output);
+        std::hint::black_box(game_world.build_npc_views());
+    }
+    let tick_ms = start.elapsed().as_secs_f64() * 1000.0 / TICKS as f64;
+
+    // 指令延遲
+    let mut total_us = 0.0;
+    let mut cmd_max_us: f64 = 0.0;
+    for _ in 0..COMMAND_REPEAT {
+        for command in COMMANDS {
+            let start = Instant::now();
+            game_world.execute_command(command);
+            let us = start.elapsed().as_secs_f64() * 1_000_000.0;
+            total_us += us;
+            cmd_max_us = cmd_max_us.max(us);
+        }
+    }
+    let cmd_avg_us = total_us / (COMMAND_REPEAT as usize * COMMANDS.len()) as f64;
+
+    drop(game_world);
+    let _ = std::fs::remove_dir_all(&world_dir);
+
+    Ok(Sample { dimension, value, load_ms, tick_ms, mem_kb, heap_kb, cmd_avg_us, cmd_max_us })
+}
+
+/// 各維度的放大序列（quick 模式只取前三個）
+fn scaling_plan(quick: bool) -> Vec<(&'static str, String, WorldGenConfig)> {
+    let base = WorldGenConfig::default();
+    let take = if quick { 3 } else { usize::MAX };
+    let mut plan = Vec::new();
+
+    for maps in [1usize, 5, 20, 50].into_iter().take(take) {
+        plan.push(("maps", maps.to_string(), WorldGenConfig { map_count: maps, ..base.clone() }));
+    }
+    for size in [50usize, 100, 200, 400].into_iter().take(take) {
+        plan.push(("size", format!("{size}x{size}"), WorldGenConfig { width: size, height: size, ..base.clone() }));
+    }
+    for npcs in [10usize, 100, 1000, 5000].into_iter().take(take) {
+        plan.push(("npcs", npcs.to_string(), WorldGenConfig { npc_count: npcs, ..base.clone() }));
+    }
+    for events in [10usize, 100, 1000, 5000].into_iter().take(take) {
+        plan.push(("events", events.to_string(), WorldGenConfig { event_count: events, ..base.clone() }));
+    }
+    for density in [0.01f32, 0.05, 0.2, 0.5].into_iter().take(take) {
+        plan.push(("items", density.to_string(), WorldGenConfig { item_density: density, ..base.clone() }));
+    }
+    plan
+}
+
+fn main() -> Result<(), Box<dyn std::error::Error>> {
+    let args: Vec<String> = std::env::args().skip(1).collect();
+    let quick = args.iter().any(|a| a == "--quick");
+    let flag_value = |flag: &str| args.iter().position(|a| a == flag).and_then(|i| args.get(i + 1)).cloned();
+    let base_dir = flag_value("--dir").unwrap_or_else(|| {
+        std::env::temp_dir().join("ratamud_scale_bench").to_string_lossy().to_string()
+    });
+    let csv_path = flag_value("--csv");
+
+    println!("{:<8} {:>10} {:>10} {:>10} {:>10} {:>10} {:>12} {:>12}",
+        "維度", "數值", "載入ms", "tick ms", "記憶體KB", "估算KB", "指令avg µs", "指令max µs");
+    let mut csv = String::from("dimension,value,load_ms,tick_ms,mem_kb,heap_kb,cmd_avg_us,cmd_max_us\n");
+    for (dimension, value, config) in scaling_plan(quick) {
+        let s = run_sample(&base_dir, dimension, value, &config)?;
+        println!("{:<8} {:>10} {:>10.2} {:>10.3} {:>10} {:>10} {:>12.1} {:>12.1}",
+            s.dimension, s.value, s.load_ms, s.tick_ms, s.mem_kb, s.heap_kb, s.cmd_avg_us, s.cmd_max_us);
+        csv.push_str(&format!("{},{},{:.3},{:.4},{},{},{:.2},{:.2}\n",
+            s.dimension, s.value, s.load_ms, s.tick_ms, s.mem_kb, s.heap_kb, s.cmd_avg_us, s.cmd_max_us));
+    }
+    let _ = std::fs::remove_dir_all(&base_dir);
+
+    if let Some(path) = csv_path {
+        std::fs::write(&path, csv)?;
+        println!("📄 結果已寫入 {path}");
+    }
+    Ok(())
+}
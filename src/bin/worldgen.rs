@@ -0,0 +1,24 @@
+// 合成世界產生器 CLI
+// 用法: cargo run --release --bin worldgen -- <world_dir> [--maps N] [--size WxH]
+//       [--npcs N] [--events N] [--items F] [--seed N] [--name S]
+
+use ratamud::worldgen::{generate_world, WorldGenConfig};
+
+fn main() -> Result<(), Box<dyn std::error::Error>> {
+    let args: Vec<String> = std::env::args().skip(1).collect();
+    let Some(world_dir) = args.first() else {
+        eprintln!("用法: worldgen <world_dir> [--maps N] [--size WxH] [--npcs N] [--events N] [--items F] [--seed N] [--name S]");
+        std::process::exit(2);
+    };
+    let config = WorldGenConfig::from_args(&args[1..])?;
+
+    let report = generate_world(world_dir, &config)?;
+
+    println!("✅ 已產生世界: {world_dir}");
+    println!("  地圖: {} 張 ({}x{}, 共 {} 點)", report.maps, config.width, config.height, report.points);
+    println!("  物品堆: {}", report.items);
+    println!("  NPC: {}", report.npcs);
+    println!("  事件: {}", report.events);
+    println!("  地圖+事件檔案大小: {} KB", report.bytes_written / 1024);
+    Ok(())
+}
@@ -0,0 +1,131 @@
+// 批次查詢（C API：渲染器與遙測每幀取得整張地圖的狀態）
+// 把角色與格子狀態直接寫入呼叫者提供的陣列，不經過文字指令（list npcs、look）也不配置記憶體。
+// - 角色：以 NpcManager 配發的數字代號識別，附座標、HP 與旗標
+// - 格子：可行走性位元（每列補齊到整數位元組）與顯示字元（Unicode 碼位）兩層
+
+use crate::map::Map;
+use crate::map_edit::Rect;
+use crate::world::GameWorld;
+
+pub const ENTITY_PLAYER: u32 = 1 << 0;       // 玩家本人（me）
+pub const ENTITY_CONTROLLED: u32 = 1 << 1;   // 目前操控中的角色
+pub const ENTITY_TRANSIENT: u32 = 1 << 2;    // 事件生成的暫時 NPC
+pub const ENTITY_IN_PARTY: u32 = 1 << 3;     // 已組隊
+pub const ENTITY_SLEEPING: u32 = 1 << 4;     // 睡眠中
+pub const ENTITY_INTERACTING: u32 = 1 << 5;  // 交易、對話中
+
+/// 一個角色的查詢結果
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct EntityRecord {
+    pub handle: u32,
+    pub x: usize,
+    pub y: usize,
+    pub hp: i32,
+    pub max_hp: i32,
+    pub flags: u32,
+}
+
+/// 地圖上矩形範圍（含邊界）內的所有角色
+pub fn entities_in<'a>(world: &'a GameWorld, map_name: &'a str, rect: Rect) -> impl Iterator<Item = EntityRecord> + 'a {
+    let npcs = &world.npc_manager;
+    npcs.iter()
+        .filter(move |(_, person)| {
+            person.map == map_name
+                && (rect.x0..=rect.x1).contains(&person.x)
+                && (rect.y0..=rect.y1).contains(&person.y)
+        })
+        .map(move |(id, person)| {
+            let flags = [
+                (id == "me", ENTITY_PLAYER),
+                (*id == world.current_controlled_id, ENTITY_CONTROLLED),
+                (npcs.is_transient(id), ENTITY_TRANSIENT),
+                (person.party_leader.is_some(), ENTITY_IN_PARTY),
+                (person.is_sleeping, ENTITY_SLEEPING),
+                (person.is_interacting, ENTITY_INTERACTING),
+            ].iter().filter(|(set, _)| *set).fold(0, |flags, (_, bit)| flags | bit);
+            EntityRecord {
+                handle: npcs.handle(id).unwrap_or(0),
+                x: person.x,
+                y: person.y,
+                hp: person.hp,
+                max_hp: person.max_hp,
+                flags,
+            }
+        })
+}
+
+/// 每列可行走位元佔用的位元組數
+pub fn walk_row_bytes(width: usize) -> usize {
+    width.div_ceil(8)
+}
+
+/// 把矩形內的可行走性寫入 out：每列 walk_row_bytes(寬) 個位元組，x 由小到大對應位元由低到高，地圖外為 0
+/// out 不夠大時不寫入並返回 false
+pub fn write_walk_bits(map: &Map, rect: Rect, out: &mut [u8]) -> bool {
+    let stride = walk_row_bytes(rect.width());
+    let Some(out) = out.get_mut(..stride * rect.height()) else {
+        return false;
+    };
+    for (row, y) in out.chunks_exact_mut(stride).zip(rect.y0..) {
+        map.walkable_bits().copy_row(y, rect.x0, rect.width(), row);
+    }
+    true
+}
+
+/// 把矩形內每格的顯示字元（Unicode 碼位，列優先）寫入 out，地圖外為 0
+/// out 不夠大時不寫入並返回 false
+pub fn write_glyphs(map: &Map, rect: Rect, out: &mut [u32]) -> bool {
+    let Some(out) = out.get_mut(..rect.area()) else {
+        return false;
+    };
+    for (row, y) in out.chunks_exact_mut(rect.width()).zip(rect.y0..) {
+        for (cell, x) in row.iter_mut().zip(rect.x0..) {
+            *cell = map.get_point(x, y).map_or(0, |point| map.glyph(&point) as u32);
+        }
+    }
+    true
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::person::Person;
+    use crate::rng::WorldRng;
+
+    #[test]
+    fn test_bulk_query() {
+        let mut world = GameWorld::new_with_dir("unused");
+        let mut map = Map::new("field".to_string(), 10, 4, &WorldRng::new(1));
+        for x in 0..10 {
+            map.set_walkable(x, 1, x % 3 != 0);
+        }
+        world.add_map(map);
+        for (id, x) in [("me", 2), ("guard", 5), ("far", 9)] {
+            let mut person = Person::new(id.to_string(), String::new());
+            (person.map, person.x, person.y) = ("field".to_string(), x, 1);
+            world.npc_manager.add_npc(id.to_string(), person, Vec::new());
+        }
+
+        let mut found: Vec<EntityRecord> = entities_in(&world, "field", Rect::new(0, 0, 5, 3)).collect();
+        found.sort_by_key(|record| record.x);
+        assert_eq!(found.len(), 2);
+        assert_eq!(found[0].flags, ENTITY_PLAYER | ENTITY_CONTROLLED);
+        assert_eq!(world.npc_manager.id_for_handle(found[1].handle), Some("guard"));
+
+        // 第 1 列從 x = 1 開始的 10 格：x = 1..=9 在地圖內，x = 10 在地圖外
+        let map = &world.maps["field"];
+        let rect = Rect::new(1, 1, 10, 1);
+        let mut bits = [0u8; 2];
+        assert!(write_walk_bits(map, rect, &mut bits));
+        assert_eq!(bits, [0b1101_1011, 0]);
+        let mut glyphs = [0u32; 10];
+        assert!(write_glyphs(map, rect, &mut glyphs));
+        assert_eq!(glyphs[2], map.wall_glyph() as u32);
+        assert_eq!(glyphs[9], 0);
+        assert!(!write_glyphs(map, rect, &mut [0u32; 9]));
+
+        // C API 的整張地圖矩形裁切成地圖大小
+        assert_eq!(Rect::new(0, 0, usize::MAX, usize::MAX).clamp(map), Some(Rect::new(0, 0, 9, 3)));
+        assert_eq!(Rect::new(10, 0, usize::MAX, 0).clamp(map), None);
+    }
+}
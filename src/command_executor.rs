@@ -11,7 +11,12 @@ use crate::core_output::{OutputZone, trigger_output};
 pub fn execute_command(game_world: &mut GameWorld, command: &str) -> bool {
     use crate::command_handler;
     
-    let result = command_handler::parse_command(command);
+    // 登錄表只查一次：登錄的命令直接以切分好的參數執行，其餘交給內建命令的解析
+    let parts: Vec<&str> = command.split_whitespace().collect();
+    if let Some(handler) = parts.first().and_then(|name| crate::command_registry::lookup(name)) {
+        return handler(game_world, &parts);
+    }
+    let result = command_handler::parse_builtin(&parts);
     let current_id = game_world.current_controlled_id.clone();
     
     match result {
@@ -71,6 +76,17 @@ pub fn execute_command(game_world: &mut GameWorld, command: &str) -> bool {
             handle_show_world(game_world);
             true
         },
+        CommandResult::Memory => {
+            for line in game_world.memory_report().to_lines() {
+                trigger_output(OutputZone::Main, &line);
+            }
+            true
+        },
+        CommandResult::Registered(args) => {
+            // parse_builtin 不會返回此結果；保留給由 parse_tokens 解析的呼叫者
+            let args: Vec<&str> = args.iter().map(String::as_str).collect();
+            crate::command_registry::dispatch(game_world, &args).unwrap_or(true)
+        },
         CommandResult::SwitchControl(npc_name) => {
             handle_switch_control(game_world, npc_name);
             true
@@ -99,6 +115,13 @@ pub fn execute_command(game_world: &mut GameWorld, command: &str) -> bool {
             handle_create(game_world, &current_id, obj_type, item_type, name);
             true
         },
+        CommandResult::Region(command) => {
+            match game_world.edit_region(command) {
+                Ok(message) => trigger_output(OutputZone::Main, &message),
+                Err(e) => trigger_output(OutputZone::Status, &format!("錯誤: {}", e)),
+            }
+            true
+        },
         CommandResult::Set(target, attribute, value) => {
             handle_set(game_world, &current_id, target, attribute, value);
             true
@@ -191,16 +214,24 @@ fn handle_look(game_world: &GameWorld, current_id: &str, _target: Option<String>
         trigger_output(OutputZone::Main, &format!("📍 {}", map.name));
         trigger_output(OutputZone::Main, &map.description);
         trigger_output(OutputZone::Main, &format!("你在 ({}, {})", x, y));
+        if let Some(weather) = game_world.weather_at(&map.name, x, y) {
+            trigger_output(OutputZone::Main, &weather.describe());
+        }
         
         // 顯示當前位置的物品
         if let Some(point) = map.get_point(x, y) {
             if !point.objects.is_empty() {
                 trigger_output(OutputZone::Main, "\n這裡有：");
-                for (item, count) in &point.objects {
+                for (item, count) in point.objects {
                     trigger_output(OutputZone::Main, &format!("  {} x{}", item, count));
                 }
             }
         }
+
+        // 顯示視野內（牆後看不到）的角色與物品
+        for line in game_world.describe_visible(current_id) {
+            trigger_output(OutputZone::Main, &line);
+        }
     }
 }
 
@@ -213,19 +244,28 @@ fn handle_move(game_world: &mut GameWorld, current_id: &str, dx: i32, dy: i32) {
         return;
     };
     
+    // 大地圖區塊邊緣：走進相鄰區塊
+    match game_world.overworld_step(current_id, dx, dy) {
+        Some(true) => {
+            if let Some(me) = game_world.npc_manager.get_npc(current_id) {
+                trigger_output(OutputZone::Main, &format!("你走進了 {} ({}, {})", me.map, me.x, me.y));
+                let person_dir = format!("{}/persons", game_world.world_dir);
+                let _ = me.save(&person_dir, &format!("{}.json", current_id));
+            }
+            return;
+        }
+        Some(false) => {
+            trigger_output(OutputZone::Status, "那個方向無法通行");
+            return;
+        }
+        None => {}
+    }
+    
     let new_x = (old_x as i32 + dx) as usize;
     let new_y = (old_y as i32 + dy) as usize;
     
-    // 檢查是否可行走
-    let can_walk = if let Some(map) = game_world.get_current_map() {
-        if let Some(point) = map.get_point(new_x, new_y) {
-            point.walkable
-        } else {
-            false
-        }
-    } else {
-        false
-    };
+    // 檢查是否可行走（含暴風雨區域）
+    let can_walk = game_world.is_passable(&game_world.current_map_name, new_x, new_y);
     
     if can_walk {
         // 更新位置
@@ -270,7 +310,7 @@ fn handle_get(game_world: &mut GameWorld, current_id: &str, item_name: Option<St
         let mut items_to_get = vec![];
         if let Some(map) = game_world.get_current_map() {
             if let Some(point) = map.get_point(x, y) {
-                for (item, count) in &point.objects {
+                for (item, count) in point.objects {
                     items_to_get.push((item.clone(), *count));
                 }
             }
@@ -286,7 +326,7 @@ fn handle_get(game_world: &mut GameWorld, current_id: &str, item_name: Option<St
                 *me.items.entry(item.clone()).or_insert(0) += count;
             }
             if let Some(map) = game_world.get_current_map_mut() {
-                if let Some(point) = map.get_point_mut(x, y) {
+                if let Some(point) = map.items_mut(x, y) {
                     point.objects.remove(&item);
                 }
             }
@@ -309,7 +349,7 @@ fn handle_get(game_world: &mut GameWorld, current_id: &str, item_name: Option<St
     let resolved_item = crate::item_registry::resolve_item_name(&item_name);
     
     if let Some(map) = game_world.get_current_map_mut() {
-        if let Some(point) = map.get_point_mut(x, y) {
+        if let Some(point) = map.items_mut(x, y) {
             if let Some(available) = point.objects.get_mut(&resolved_item) {
                 let to_get = quantity.min(*available);
                 *available -= to_get;
@@ -365,7 +405,7 @@ fn handle_drop(game_world: &mut GameWorld, current_id: &str, item_name: String,
     // 放到地圖上
     let map_name = game_world.current_map_name.clone();
     if let Some(map) = game_world.get_current_map_mut() {
-        if let Some(point) = map.get_point_mut(x, y) {
+        if let Some(point) = map.items_mut(x, y) {
             *point.objects.entry(resolved_item.clone()).or_insert(0) += to_drop;
         }
     }
@@ -470,7 +510,7 @@ fn handle_show_world(game_world: &GameWorld) {
     trigger_output(OutputZone::Main, &format!("=== {} ===", game_world.metadata.name));
     trigger_output(OutputZone::Main, &game_world.metadata.description);
     trigger_output(OutputZone::Main, &format!("\n時間: {}", game_world.format_time()));
-    trigger_output(OutputZone::Main, &format!("地圖數量: {}", game_world.maps.len()));
+    trigger_output(OutputZone::Main, &format!("地圖數量: {}", game_world.metadata.maps.len()));
     trigger_output(OutputZone::Main, &format!("NPC 數量: {}", game_world.npc_manager.get_all_npcs().len()));
 }
 
@@ -507,8 +547,8 @@ fn handle_conquer(game_world: &mut GameWorld, current_id: &str, direction: Strin
     
     let map_name = game_world.current_map_name.clone();
     if let Some(map) = game_world.get_current_map_mut() {
-        if let Some(point) = map.get_point_mut(new_x, new_y) {
-            point.walkable = true;
+        if map.get_point(new_x, new_y).is_some() {
+            map.set_walkable(new_x, new_y, true);
             trigger_output(OutputZone::Main, &format!("你征服了 {} 方向，現在可以通行了", direction));
             
             // 保存地圖
@@ -535,9 +575,18 @@ fn handle_flyto(game_world: &mut GameWorld, current_id: &str, target: String) {
         return;
     }
     
-    // 嘗試作為地圖名稱
-    if game_world.maps.contains_key(&target) {
-        game_world.current_map_name = target.clone();
+    // 嘗試作為地圖名稱：切換目前地圖，角色也移到新地圖的中央（與終端的 flyto 相同）
+    if game_world.change_map(&target) {
+        let Some((center_x, center_y)) = game_world.get_current_map().map(|map| (map.width / 2, map.height / 2)) else {
+            return;
+        };
+        let person_dir = format!("{}/persons", game_world.world_dir);
+        if let Some(me) = game_world.npc_manager.get_npc_mut(current_id) {
+            me.map = target.clone();
+            me.move_to(center_x, center_y);
+            let _ = me.save(&person_dir, &format!("{}.json", current_id));
+        }
+        let _ = game_world.save_metadata();
         trigger_output(OutputZone::Main, &format!("你傳送到了地圖 {}", target));
         return;
     }
@@ -567,8 +616,8 @@ fn handle_namehere(game_world: &mut GameWorld, current_id: &str, name: String) {
     
     let map_name = game_world.current_map_name.clone();
     if let Some(map) = game_world.get_current_map_mut() {
-        if let Some(point) = map.get_point_mut(x, y) {
-            point.name = name.clone();
+        if let Some(cell) = map.cell_mut(x, y) {
+            cell.name = name.clone();
             trigger_output(OutputZone::Main, &format!("你將這裡命名為「{}」", name));
             
             // 保存地圖
@@ -617,7 +666,7 @@ fn handle_destroy(game_world: &mut GameWorld, current_id: &str, target: String)
     let resolved_item = crate::item_registry::resolve_item_name(&target);
     let map_name = game_world.current_map_name.clone();
     if let Some(map) = game_world.get_current_map_mut() {
-        if let Some(point) = map.get_point_mut(x, y) {
+        if let Some(point) = map.items_mut(x, y) {
             if point.objects.remove(&resolved_item).is_some() {
                 trigger_output(OutputZone::Main, &format!("你刪除了物品 {}", target));
                 
@@ -664,7 +713,7 @@ fn handle_create(game_world: &mut GameWorld, current_id: &str, obj_type: String,
             let map_name = game_world.current_map_name.clone();
             
             if let Some(map) = game_world.get_current_map_mut() {
-                if let Some(point) = map.get_point_mut(x, y) {
+                if let Some(point) = map.items_mut(x, y) {
                     *point.objects.entry(item_name.clone()).or_insert(0) += 1;
                     trigger_output(OutputZone::Main, &format!("你創建了物品「{}」", item_name));
                     
@@ -858,3 +907,29 @@ fn handle_wakeup(game_world: &mut GameWorld, current_id: &str) {
         }
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::map::Map;
+    use crate::rng::WorldRng;
+
+    #[test]
+    fn test_flyto_map_moves_controlled_person() {
+        let world_dir = std::env::temp_dir().join(format!("ratamud_flyto_{}", std::process::id()));
+        let mut world = GameWorld::new_with_dir(&world_dir.to_string_lossy());
+        world.add_map(Map::new("初始之地".to_string(), 10, 10, &WorldRng::new(1)));
+        world.add_map(Map::new("森林".to_string(), 20, 8, &WorldRng::new(2)));
+        world.current_map_name = "初始之地".to_string();
+        let mut me = Person::new("me".to_string(), String::new());
+        (me.map, me.x, me.y) = ("初始之地".to_string(), 1, 1);
+        world.npc_manager.add_npc("me".to_string(), me, Vec::new());
+
+        assert!(execute_command(&mut world, "flyto 森林"));
+        assert_eq!(world.current_map_name, "森林");
+        let me = world.npc_manager.get_npc("me").unwrap();
+        assert_eq!((me.map.as_str(), me.x, me.y), ("森林", 10, 4));
+
+        let _ = std::fs::remove_dir_all(&world_dir);
+    }
+}
@@ -33,6 +33,7 @@ pub enum CommandResult {
     Name(String, String),            // 命名 NPC 或地點 (目標, 新名稱)
     Destroy(String),                 // 刪除指定的 NPC 或物品 (NPC名稱/物品名稱)
     Create(String, String, Option<String>), // 創建物件 (類型, 物件類型, 可選名稱)
+    Region(crate::map_edit::RegionCommand), // 區域編輯 (fill/paint/scatter/copy/paste/undo)
     Set(String, String, i32),        // 設置角色屬性 (目標人物, 屬性, 數值)
     SwitchControl(String),           // 切換操控的角色 (NPC名稱/ID)
     Trade(String),                   // 查看 NPC 商品 (NPC名稱/ID)
@@ -52,6 +53,7 @@ pub enum CommandResult {
     Kick(Option<String>),            // 踢擊 (可選：目標)
     Escape,                          // 逃離戰鬥
     ListNpcs,                        // 列出所有 NPC
+    Memory,                          // 顯示各子系統記憶體使用
     CheckNpc(String),                // 查看 NPC 詳細資訊 (NPC名稱/ID)
     ToggleTypewriter,                // 切換打字機效果
     // 任務系統
@@ -64,6 +66,7 @@ pub enum CommandResult {
     QuestComplete(String),           // 完成任務 (任務ID)
     QuestAbandon(String),            // 放棄任務 (任務ID)
     Help,                            // 顯示幫助訊息
+    Registered(Vec<String>),         // 登錄表中的擴充命令 (切分好的參數，第一個為命令名稱)
 }
 
 impl CommandResult {
@@ -98,6 +101,7 @@ impl CommandResult {
             CommandResult::ShowMap => Some(("show map / sm", "顯示大地圖 (↑↓←→移動, q退出", "🗺️  介面控制")),
             CommandResult::Destroy(..) => Some(("destroy / ds <目標>", "刪除NPC或物品", "🛠️  其他")),
             CommandResult::Create(..) => Some(("create / cr <類型> <物件類型> [名稱]", "創建物件 (item/npc)", "🛠️  其他")),
+            CommandResult::Region(..) => Some(("region / rg <fill|paint|scatter|copy|paste|undo> ...", "區域編輯（一次存檔，可復原）", "🛠️  其他")),
             CommandResult::Set(..) => Some(("set <人物> <屬性> <數值> 或 set item <物品> <價格>", "設置角色屬性 (hp/mp/strength/knowledge/sociality/gold) 或物品價格", "🛠️  其他")),
             CommandResult::SwitchControl(..) => Some(("ctrl / control <npc>", "切換操控的角色", "👥 NPC互動")),
             CommandResult::Trade(..) => Some(("trade <npc>", "查看NPC商品", "💰 交易")),
@@ -111,6 +115,7 @@ impl CommandResult {
             CommandResult::Kick(..) => Some(("kick / kk [目標]", "踢擊（無目標=練習）", "⚔️  戰鬥")),
             CommandResult::Escape => Some(("escape / esc", "逃離戰鬥", "⚔️  戰鬥")),
             CommandResult::ListNpcs => Some(("npcs", "列出所有NPC", "👥 NPC互動")),
+            CommandResult::Memory => Some(("mem / memory", "顯示各子系統記憶體使用", "ℹ️  資訊查詢")),
             _ => None,
         }
     }
@@ -145,6 +150,7 @@ impl CommandResult {
             CommandResult::Clear,
             CommandResult::Destroy(String::new()),
             CommandResult::Create(String::new(), String::new(), None),
+            CommandResult::Region(crate::map_edit::RegionCommand::Undo),
             CommandResult::Set(String::new(), String::new(), 0),
             CommandResult::SwitchControl(String::new()),
             CommandResult::Trade(String::new()),
@@ -152,6 +158,7 @@ impl CommandResult {
             CommandResult::Sell(String::new(), String::new(), 1),
             CommandResult::Give(String::new(), String::new(), 1),
             CommandResult::ListNpcs,
+            CommandResult::Memory,
             CommandResult::SetDialogue(String::new(), String::new(), String::new()),
             CommandResult::SetDialogueWithConditions(String::new(), String::new(), String::new(), String::new()),
             CommandResult::SetEagerness(String::new(), 0),
@@ -215,7 +222,19 @@ impl CommandResult {
 /// 命令解析器 - 將文字命令轉換為 CommandResult
 pub fn parse_command(input: &str) -> CommandResult {
     let parts: Vec<&str> = input.split_whitespace().collect();
-    
+    parse_tokens(&parts)
+}
+
+/// 解析已切分的命令；登錄表中的命令（見 command_registry）優先於內建命令
+pub fn parse_tokens(parts: &[&str]) -> CommandResult {
+    if parts.first().is_some_and(|name| crate::command_registry::is_registered(name)) {
+        return CommandResult::Registered(parts.iter().map(|part| part.to_string()).collect());
+    }
+    parse_builtin(parts)
+}
+
+/// 只解析內建命令（呼叫者已查過登錄表）
+pub fn parse_builtin(parts: &[&str]) -> CommandResult {
     if parts.is_empty() {
         return CommandResult::Error("No command provided".to_string());
     }
@@ -328,6 +347,7 @@ pub fn parse_command(input: &str) -> CommandResult {
             }
         },
         "npcs" | "listnpcs" => CommandResult::ListNpcs,
+        "mem" | "memory" => CommandResult::Memory,
         "sleep" => CommandResult::Sleep,
         "dream" => {
             if parts.len() < 2 {
@@ -401,6 +421,10 @@ pub fn parse_command(input: &str) -> CommandResult {
                 CommandResult::Create(obj_type, subtype, name)
             }
         },
+        "region" | "rg" => match crate::map_edit::RegionCommand::parse(&parts[1..]) {
+            Ok(command) => CommandResult::Region(command),
+            Err(e) => CommandResult::Error(e),
+        },
         "set" => {
             if parts.len() < 4 {
                 CommandResult::Error("Usage: set <人物> <屬性> <數值>".to_string())
@@ -0,0 +1,256 @@
+// 非同步命令佇列（C API：多個網路執行緒同時送出命令，並取回各自的輸出）
+// 提交：任何執行緒都可以呼叫 submit，命令經 mpsc 通道（無鎖的串列佇列）送往引擎，不會等待世界鎖。
+// 執行：引擎執行緒在每個 tick 呼叫 run，依提交順序取出命令並執行；
+// 執行期間的輸出被攔截到該命令的完成記錄，不經過全域輸出回調，因此輸出與命令一一對應。
+// 完成：完成記錄依完成順序排隊，宿主以 poll 取出、以 wait 等待，
+// 或在 Linux 上把 notify_fd 加入自己的 epoll 迴圈（佇列非空時可讀）。
+
+use std::collections::VecDeque;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::sync::{Condvar, Mutex};
+use std::time::Duration;
+
+use crate::core_output::{self, OutputZone};
+
+/// 一個提交的命令
+#[derive(Debug, Clone)]
+pub struct Submission {
+    pub world: u32,     // 目標世界的配置計數編號
+    pub session: u64,   // 宿主的連線編號（原樣帶回）
+    pub tag: u64,       // 宿主的請求編號（原樣帶回）
+    pub command: String,
+}
+
+/// 一個命令的執行結果
+#[derive(Debug, Clone, PartialEq)]
+pub struct Completion {
+    pub session: u64,
+    pub tag: u64,
+    pub status: i32,                        // 同 ratamud_input_command：1=繼續, 0=退出, -1=錯誤, -2=超過預算
+    pub output: Vec<(OutputZone, String)>,  // 執行期間的輸出（依產生順序）
+}
+
+impl Completion {
+    /// 輸出編碼後的長度（見 encode_output）
+    pub fn output_len(&self) -> usize {
+        self.output.iter().map(|(zone, text)| zone.as_str().len() + text.len() + 2).sum()
+    }
+
+    /// 把輸出編碼為連續的 "區域\0內容\0" 寫入 out 開頭（out 至少 output_len 位元組）
+    pub fn encode_output(&self, out: &mut [u8]) {
+        let mut at = 0;
+        for (zone, text) in &self.output {
+            for part in [zone.as_str().as_bytes(), text.as_bytes()] {
+                out[at..at + part.len()].copy_from_slice(part);
+                out[at + part.len()] = 0;
+                at += part.len() + 1;
+            }
+        }
+    }
+}
+
+/// 提交佇列與完成佇列
+pub struct CommandQueue {
+    submit_tx: Sender<Submission>,
+    submit_rx: Mutex<Receiver<Submission>>,
+    queued: AtomicUsize,
+    completions: Mutex<VecDeque<Completion>>,
+    ready: Condvar,
+    notify: EventFd,
+}
+
+impl Default for CommandQueue {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl CommandQueue {
+    pub fn new() -> Self {
+        let (submit_tx, submit_rx) = mpsc::channel();
+        CommandQueue {
+            submit_tx,
+            submit_rx: Mutex::new(submit_rx),
+            queued: AtomicUsize::new(0),
+            completions: Mutex::new(VecDeque::new()),
+            ready: Condvar::new(),
+            notify: EventFd::new(),
+        }
+    }
+
+    /// 提交命令（任何執行緒，不阻塞）
+    pub fn submit(&self, submission: Submission) {
+        self.queued.fetch_add(1, Ordering::Relaxed);
+        // 接收端與佇列同生命週期，送出不會失敗
+        let _ = self.submit_tx.send(submission);
+    }
+
+    /// 已提交、尚未執行的命令數
+    pub fn queued(&self) -> usize {
+        self.queued.load(Ordering::Relaxed)
+    }
+
+    /// 依序執行最多 max 個已提交的命令（0=目前佇列中的全部），返回執行的數量
+    /// execute 返回命令的狀態碼，期間的輸出收進完成記錄
+    pub fn run(&self, max: usize, mut execute: impl FnMut(&Submission) -> i32) -> usize {
+        let Ok(submissions) = self.submit_rx.lock() else {
+            return 0;
+        };
+        let limit = if max == 0 { self.queued() } else { max };
+        let mut done = 0;
+        while done < limit {
+            let Ok(submission) = submissions.try_recv() else {
+                break;
+            };
+            self.queued.fetch_sub(1, Ordering::Relaxed);
+            let (status, output) = core_output::capture_output(|| execute(&submission));
+            self.complete(Completion { session: submission.session, tag: submission.tag, status, output });
+            done += 1;
+        }
+        done
+    }
+
+    fn complete(&self, completion: Completion) {
+        if let Ok(mut completions) = self.completions.lock() {
+            completions.push_back(completion);
+            self.notify.signal();
+            self.ready.notify_all();
+        }
+    }
+
+    /// 取出最早的完成記錄；accept 返回 false 時保留在佇列中（C API 的緩衝區不足時）
+    pub fn poll_if(&self, accept: impl FnOnce(&Completion) -> bool) -> Option<Completion> {
+        let mut completions = self.completions.lock().ok()?;
+        if !accept(completions.front()?) {
+            return None;
+        }
+        let completion = completions.pop_front();
+        if completions.is_empty() {
+            self.notify.reset();
+        }
+        completion
+    }
+
+    /// 取出最早的完成記錄
+    #[allow(dead_code)]
+    pub fn poll(&self) -> Option<Completion> {
+        self.poll_if(|_| true)
+    }
+
+    /// 等待到有完成記錄或逾時，返回是否有完成記錄
+    pub fn wait(&self, timeout: Duration) -> bool {
+        let Ok(completions) = self.completions.lock() else {
+            return false;
+        };
+        self.ready.wait_timeout_while(completions, timeout, |c| c.is_empty())
+            .is_ok_and(|(completions, _)| !completions.is_empty())
+    }
+
+    /// 完成佇列非空時可讀的 eventfd（Linux 以外為 -1）
+    pub fn notify_fd(&self) -> i32 {
+        self.notify.0
+    }
+}
+
+/// 完成通知用的 eventfd（非阻塞；寫入使其可讀，讀取歸零）
+struct EventFd(i32);
+
+#[cfg(target_os = "linux")]
+mod sys {
+    use std::os::raw::{c_int, c_uint, c_void};
+
+    extern "C" {
+        pub fn eventfd(initval: c_uint, flags: c_int) -> c_int;
+        pub fn read(fd: c_int, buf: *mut c_void, count: usize) -> isize;
+        pub fn write(fd: c_int, buf: *const c_void, count: usize) -> isize;
+        pub fn close(fd: c_int) -> c_int;
+    }
+
+    pub const EFD_CLOEXEC: c_int = 0o2000000;
+    pub const EFD_NONBLOCK: c_int = 0o4000;
+}
+
+#[cfg(target_os = "linux")]
+impl EventFd {
+    fn new() -> Self {
+        EventFd(unsafe { sys::eventfd(0, sys::EFD_CLOEXEC | sys::EFD_NONBLOCK) })
+    }
+
+    fn signal(&self) {
+        if self.0 >= 0 {
+            let one = 1u64;
+            unsafe { sys::write(self.0, &one as *const u64 as *const _, 8) };
+        }
+    }
+
+    fn reset(&self) {
+        if self.0 >= 0 {
+            let mut count = 0u64;
+            unsafe { sys::read(self.0, &mut count as *mut u64 as *mut _, 8) };
+        }
+    }
+}
+
+#[cfg(target_os = "linux")]
+impl Drop for EventFd {
+    fn drop(&mut self) {
+        if self.0 >= 0 {
+            unsafe { sys::close(self.0) };
+        }
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+impl EventFd {
+    fn new() -> Self {
+        EventFd(-1)
+    }
+
+    fn signal(&self) {}
+
+    fn reset(&self) {}
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Arc;
+
+    #[test]
+    fn test_submissions_complete_with_their_output() {
+        let queue = Arc::new(CommandQueue::new());
+        let producers: Vec<_> = (0..4u64).map(|session| {
+            let queue = Arc::clone(&queue);
+            std::thread::spawn(move || {
+                for tag in 0..25 {
+                    queue.submit(Submission { world: 1, session, tag, command: format!("say {session}-{tag}") });
+                }
+            })
+        }).collect();
+        for producer in producers {
+            producer.join().unwrap();
+        }
+        assert_eq!(queue.queued(), 100);
+        assert!(!queue.wait(Duration::from_millis(1)));
+
+        let ran = queue.run(0, |submission| {
+            core_output::trigger_output(OutputZone::Main, &submission.command);
+            1
+        });
+        assert_eq!((ran, queue.queued()), (100, 0));
+        assert!(queue.wait(Duration::from_millis(1)));
+
+        let mut seen = 0;
+        while let Some(completion) = queue.poll() {
+            let expected = format!("say {}-{}", completion.session, completion.tag);
+            assert_eq!(completion.output, vec![(OutputZone::Main, expected)]);
+            let mut encoded = vec![0u8; completion.output_len()];
+            completion.encode_output(&mut encoded);
+            assert!(encoded.starts_with(b"MAIN\0say "));
+            seen += 1;
+        }
+        assert_eq!(seen, 100);
+        assert!(queue.poll_if(|_| false).is_none());
+    }
+}
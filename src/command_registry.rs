@@ -0,0 +1,131 @@
+// 命令擴充登錄表：以雜湊表依命令名稱分派，不需修改 parse_command 與 CommandResult
+// - Rust 端以 register 註冊閉包；C/C++ 宿主以 ratamud_register_command 註冊原生函數
+// - 輸入只切分一次，處理函數直接取得切好的參數（C 端為 NUL 結尾的 argv），
+//   不必把結果印成字串再解析一次
+// - 登錄的命令優先於同名的內建命令，宿主可以藉此覆寫內建行為
+// 處理函數執行時不持有登錄表的鎖，因此可以在處理函數中註冊或移除命令。
+// 每個命令只查表一次（lookup）；沒有任何登錄命令時連鎖都不取，內建命令不必為登錄表付出成本。
+
+use std::collections::HashMap;
+use std::ffi::c_void;
+use std::os::raw::{c_char, c_int};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use once_cell::sync::Lazy;
+
+use crate::world::GameWorld;
+
+/// 命令處理函數：args[0] 為命令名稱，返回 true=繼續, false=退出
+pub type Handler = Arc<dyn Fn(&mut GameWorld, &[&str]) -> bool + Send + Sync>;
+
+/// 原生命令函數：返回 1=繼續, 0=退出, 負數=錯誤（顯示在狀態列）
+pub type NativeCommandFn = unsafe extern "C" fn(*mut c_void, u32, *const *const c_char, u32) -> c_int;
+
+static COMMANDS: Lazy<Mutex<HashMap<String, Handler>>> = Lazy::new(|| Mutex::new(HashMap::new()));
+/// 已登錄的命令數（在鎖內更新，查表前先檢查）
+static REGISTERED: AtomicUsize = AtomicUsize::new(0);
+
+/// 註冊命令（同名的舊命令被取代）
+pub fn register(name: &str, handler: impl Fn(&mut GameWorld, &[&str]) -> bool + Send + Sync + 'static) {
+    if let Ok(mut commands) = COMMANDS.lock() {
+        commands.insert(name.to_string(), Arc::new(handler));
+        REGISTERED.store(commands.len(), Ordering::Release);
+    }
+}
+
+/// 註冊原生命令；user 原樣傳給 command
+pub fn register_native(name: &str, command: NativeCommandFn, user: *mut c_void) {
+    let user = user as usize;
+    register(name, move |world, args| {
+        let argv = Argv::new(args);
+        let status = unsafe { command(user as *mut c_void, world.alloc_scope.id(), argv.as_ptr(), args.len() as u32) };
+        if status < 0 {
+            use crate::core_output::{trigger_output, OutputZone};
+            trigger_output(OutputZone::Status, &format!("錯誤: {} 返回 {status}", args[0]));
+        }
+        status != 0
+    });
+}
+
+/// 移除命令，返回是否存在
+pub fn unregister(name: &str) -> bool {
+    COMMANDS.lock().is_ok_and(|mut commands| {
+        let removed = commands.remove(name).is_some();
+        REGISTERED.store(commands.len(), Ordering::Release);
+        removed
+    })
+}
+
+/// 查詢命令的處理函數（登錄表為空時不取鎖）
+pub fn lookup(name: &str) -> Option<Handler> {
+    if REGISTERED.load(Ordering::Acquire) == 0 {
+        return None;
+    }
+    COMMANDS.lock().ok()?.get(name).cloned()
+}
+
+/// 命令是否已註冊
+pub fn is_registered(name: &str) -> bool {
+    lookup(name).is_some()
+}
+
+/// 以 args[0] 查表並執行；未註冊時返回 None（交給內建命令）
+pub fn dispatch(world: &mut GameWorld, args: &[&str]) -> Option<bool> {
+    let handler = lookup(args.first()?)?;
+    Some(handler(world, args))
+}
+
+/// 切好的參數轉成 C 的 argv：全部參數放在同一塊 NUL 分隔的緩衝區
+struct Argv {
+    _buf: Vec<u8>,
+    ptrs: Vec<*const c_char>,
+}
+
+impl Argv {
+    fn new(args: &[&str]) -> Self {
+        let mut buf = Vec::with_capacity(args.iter().map(|a| a.len() + 1).sum());
+        let mut starts = Vec::with_capacity(args.len());
+        for arg in args {
+            starts.push(buf.len());
+            buf.extend_from_slice(arg.as_bytes());
+            buf.push(0);
+        }
+        let ptrs = starts.iter().map(|&start| buf[start..].as_ptr() as *const c_char).collect();
+        Argv { _buf: buf, ptrs }
+    }
+
+    fn as_ptr(&self) -> *const *const c_char {
+        self.ptrs.as_ptr()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::ffi::CStr;
+
+    /// 把參數個數與最後一個參數寫進 user 指向的字串
+    unsafe extern "C" fn test_command(user: *mut c_void, _world: u32, argv: *const *const c_char, argc: u32) -> c_int {
+        let out = &mut *(user as *mut String);
+        let last = CStr::from_ptr(*argv.add(argc as usize - 1)).to_str().unwrap();
+        *out = format!("{argc}:{last}");
+        1
+    }
+
+    #[test]
+    fn test_registered_commands_dispatch() {
+        let mut world = GameWorld::new_with_dir("unused");
+        register("test_quit", |_, args| args.len() != 2);
+        assert_eq!(dispatch(&mut world, &["test_quit"]), Some(true));
+        assert_eq!(dispatch(&mut world, &["test_quit", "now"]), Some(false));
+        assert_eq!(dispatch(&mut world, &["test_unknown"]), None);
+
+        let mut seen = String::new();
+        register_native("test_native", test_command, &mut seen as *mut String as *mut c_void);
+        assert_eq!(dispatch(&mut world, &["test_native", "a", "最後"]), Some(true));
+        assert_eq!(seen, "3:最後");
+
+        assert!(unregister("test_native") && unregister("test_quit"));
+        assert!(!is_registered("test_native"));
+    }
+}
@@ -1,4 +1,5 @@
-use std::sync::Mutex;
+use std::cell::RefCell;
+use std::sync::{Arc, Mutex};
 use once_cell::sync::Lazy;
 
 /// Output zones for different types of game messages
@@ -22,11 +23,16 @@ impl OutputZone {
 }
 
 /// Callback function type for output
-pub type OutputCallback = Box<dyn Fn(OutputZone, &str) + Send + Sync>;
+pub type OutputCallback = Arc<dyn Fn(OutputZone, &str) + Send + Sync>;
 
 /// Global output callback storage
 static OUTPUT_CALLBACK: Lazy<Mutex<Option<OutputCallback>>> = Lazy::new(|| Mutex::new(None));
 
+thread_local! {
+    /// Output captured on this thread instead of going to the callback (see capture_output)
+    static CAPTURED: RefCell<Option<Vec<(OutputZone, String)>>> = const { RefCell::new(None) };
+}
+
 /// Core output manager for non-UI mode
 pub struct CoreOutputManager {
     messages: Vec<String>,
@@ -57,6 +63,15 @@ impl CoreOutputManager {
         trigger_output(OutputZone::Main, &msg);
     }
 
+    /// Add several messages to the main output (one callback for the whole batch)
+    pub fn add_messages(&mut self, msgs: Vec<String>) {
+        if msgs.is_empty() {
+            return;
+        }
+        trigger_output(OutputZone::Main, &msgs.join("\n"));
+        self.messages.extend(msgs);
+    }
+
     /// Add a log message
     pub fn add_log(&mut self, msg: String) {
         self.log_messages.push(msg.clone());
@@ -118,23 +133,50 @@ where
     F: Fn(OutputZone, &str) + Send + Sync + 'static,
 {
     let mut cb = OUTPUT_CALLBACK.lock().unwrap();
-    *cb = Some(Box::new(callback));
+    *cb = Some(Arc::new(callback));
 }
 
 /// Trigger the output callback
 pub fn trigger_output(zone: OutputZone, content: &str) {
-    let cb = OUTPUT_CALLBACK.lock().unwrap();
-    if let Some(callback) = cb.as_ref() {
+    let captured = CAPTURED.with(|captured| match captured.borrow_mut().as_mut() {
+        Some(output) => {
+            output.push((zone, content.to_string()));
+            true
+        }
+        None => false,
+    });
+    if captured {
+        return;
+    }
+    // Call without holding the lock so the callback may itself produce output
+    let callback = OUTPUT_CALLBACK.lock().unwrap().clone();
+    if let Some(callback) = callback {
         callback(zone, content);
     }
 }
 
+/// Run f and collect everything it outputs on this thread instead of calling the callback
+/// (used to attach output to the queued command that produced it)
+pub fn capture_output<T>(f: impl FnOnce() -> T) -> (T, Vec<(OutputZone, String)>) {
+    let previous = CAPTURED.with(|captured| captured.replace(Some(Vec::new())));
+    let result = f();
+    let output = CAPTURED.with(|captured| captured.replace(previous)).unwrap_or_default();
+    (result, output)
+}
+
 /// Clear the output callback
 pub fn clear_output_callback() {
     let mut cb = OUTPUT_CALLBACK.lock().unwrap();
     *cb = None;
 }
 
+impl crate::mem_stats::HeapSize for CoreOutputManager {
+    fn heap_size(&self) -> usize {
+        self.messages.heap_size() + self.log_messages.heap_size()
+            + self.status.heap_size() + self.side_content.heap_size()
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -1,5 +1,8 @@
 use serde::{Deserialize, Serialize};
 use std::collections::HashMap;
+use std::sync::Arc;
+use crate::event_vm::CompiledEvent;
+use crate::map_property::PropertySchema;
 
 /// 事件觸發器類型
 #[derive(Debug, Clone, Serialize, Deserialize, PartialEq)]
@@ -61,20 +64,10 @@ pub enum Position {
 
 impl Position {
     /// 解析位置，如果是隨機則從地圖中選擇一個可行走的位置
-    pub fn resolve(&self, map: &crate::map::Map) -> Option<[usize; 2]> {
+    pub fn resolve(&self, map: &crate::map::Map, rng: &crate::rng::Rng) -> Option<[usize; 2]> {
         match self {
             Position::Fixed(pos) => Some(*pos),
-            Position::Random(_) => {
-                let walkable_points = map.get_walkable_points();
-                if walkable_points.is_empty() {
-                    None
-                } else {
-                    use rand::Rng;
-                    let mut rng = rand::thread_rng();
-                    let idx = rng.gen_range(0..walkable_points.len());
-                    Some([walkable_points[idx].0, walkable_points[idx].1])
-                }
-            }
+            Position::Random(_) => map.random_walkable_point(rng).map(|(x, y)| [x, y]),
         }
     }
 }
@@ -270,6 +263,8 @@ impl EventRuntimeState {
 pub struct EventManager {
     events: HashMap<String, GameEvent>,
     runtime_states: HashMap<String, EventRuntimeState>,
+    compiled: HashMap<String, Arc<CompiledEvent>>,  // 載入時編譯的動作位元組碼
+    property_schema: Arc<PropertySchema>,  // 編譯地圖屬性動作時使用的宣告表
 }
 
 impl EventManager {
@@ -277,11 +272,14 @@ impl EventManager {
         EventManager {
             events: HashMap::new(),
             runtime_states: HashMap::new(),
+            compiled: HashMap::new(),
+            property_schema: Arc::new(PropertySchema::builtin()),
         }
     }
     
     pub fn add_event(&mut self, event: GameEvent) {
         let id = event.id.clone();
+        self.compiled.insert(id.clone(), Arc::new(CompiledEvent::compile(&event, &self.property_schema)));
         self.events.insert(id.clone(), event);
         self.runtime_states.entry(id).or_default();
     }
@@ -290,6 +288,19 @@ impl EventManager {
         self.events.get(id)
     }
     
+    /// 更換屬性宣告表並重新編譯所有事件（屬性編號隨宣告表而定）
+    pub fn set_property_schema(&mut self, schema: Arc<PropertySchema>) {
+        self.property_schema = schema;
+        for (id, event) in &self.events {
+            self.compiled.insert(id.clone(), Arc::new(CompiledEvent::compile(event, &self.property_schema)));
+        }
+    }
+    
+    /// 取得事件編譯後的動作（以 Arc 共用，執行時不需複製事件）
+    pub fn get_compiled(&self, id: &str) -> Option<Arc<CompiledEvent>> {
+        self.compiled.get(id).cloned()
+    }
+    
     pub fn get_runtime_state(&self, id: &str) -> Option<&EventRuntimeState> {
         self.runtime_states.get(id)
     }
@@ -324,3 +335,75 @@ impl Default for EventManager {
         Self::new()
     }
 }
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for TriggerType {
+    fn heap_size(&self) -> usize {
+        match self {
+            TriggerType::Time { schedule, time_range, .. } => schedule.heap_size() + time_range.heap_size(),
+            TriggerType::Location { positions } => positions.heap_size(),
+            TriggerType::Condition { conditions } => conditions.heap_size(),
+            TriggerType::Random { .. } | TriggerType::Manual => 0,
+        }
+    }
+}
+
+impl HeapSize for Position {
+    fn heap_size(&self) -> usize {
+        match self {
+            Position::Fixed(_) => 0,
+            Position::Random(s) => s.heap_size(),
+        }
+    }
+}
+
+impl HeapSize for EventAction {
+    fn heap_size(&self) -> usize {
+        match self {
+            EventAction::SpawnNpc { npc_id, position, dialogue } => {
+                npc_id.heap_size() + position.heap_size() + dialogue.heap_size()
+            }
+            EventAction::RemoveNpc { npc_id } => npc_id.heap_size(),
+            EventAction::Message { text } => text.heap_size(),
+            EventAction::Dialogue { npc_id, text } => npc_id.heap_size() + text.heap_size(),
+            EventAction::AddItem { item, position } | EventAction::RemoveItem { item, position } => {
+                item.heap_size() + position.heap_size()
+            }
+            EventAction::Teleport { map, position } => map.heap_size() + position.heap_size(),
+            EventAction::SetMapProperty { map, property, value } => {
+                map.heap_size() + property.heap_size() + value.heap_size()
+            }
+            EventAction::RandomAction { actions } => actions.heap_size(),
+        }
+    }
+}
+
+impl HeapSize for WeightedAction {
+    fn heap_size(&self) -> usize {
+        self.action.heap_size()
+    }
+}
+
+impl HeapSize for GameEvent {
+    fn heap_size(&self) -> usize {
+        self.id.heap_size() + self.name.heap_size() + self.description.heap_size()
+            + self.trigger.heap_size()
+            + self.who.npcs.heap_size()
+            + self.r#where.map.heap_size() + self.r#where.positions.heap_size()
+            + self.what.required_items.heap_size() + self.what.map_objects.heap_size()
+            + self.actions.heap_size() + self.state.prerequisites.heap_size()
+    }
+}
+
+impl HeapSize for EventRuntimeState {
+    fn heap_size(&self) -> usize {
+        self.completed_prerequisites.heap_size()
+    }
+}
+
+impl HeapSize for EventManager {
+    fn heap_size(&self) -> usize {
+        self.events.heap_size() + self.runtime_states.heap_size() + self.compiled.heap_size()
+    }
+}
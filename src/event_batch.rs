@@ -0,0 +1,279 @@
+// 事件批次執行
+// 同一 tick 觸發的事件收集成一個批次：
+// 1. 規劃：依序執行各事件的位元組碼，只驗證並記錄寫入（Effect）與輸出訊息，不修改世界；
+//    後面的事件看得到前面事件尚未套用的寫入（物品增減、傳送後的所在地圖）
+// 2. 每個事件是一個交易：任一動作失敗時捨棄該事件的所有寫入與訊息（只保留標題），錯誤記錄在 BatchReport
+// 3. 套用：寫入依地圖分組，每張地圖只借用一次；角色傳送只套用最後一次；屬性變化最後一起通知；
+//    NPC 生成與離開依序套用（經由 GameWorld 的物件池，重用回收的角色）
+// 4. 輸出：所有訊息合併為一批，由呼叫者一次送出
+
+use std::collections::HashMap;
+use crate::event_vm::CompiledEvent;
+use crate::map_property::{PropertyChange, PropertyId, PropertyValue};
+use crate::world::GameWorld;
+
+/// 事件對世界的寫入（規劃階段記錄，套用階段執行）
+#[derive(Debug, Clone, PartialEq)]
+pub enum Effect {
+    AddItem { map: String, x: usize, y: usize, item: String },
+    RemoveItem { map: String, x: usize, y: usize, item: String },
+    SetProperty { map: String, property: PropertyId, value: PropertyValue },
+    SetUntypedProperty { map: String, name: String, value: String },
+    /// 傳送目前操控的角色
+    Teleport { map: String, x: usize, y: usize },
+    /// 生成（或移動已生成的）事件 NPC
+    SpawnNpc { npc: String, map: String, x: usize, y: usize },
+    /// 回收事件生成的 NPC
+    DespawnNpc { npc: String },
+}
+
+impl Effect {
+    /// 依地圖分組套用的寫入所屬的地圖；角色與 NPC 的寫入不分組，返回 None
+    fn map(&self) -> Option<&str> {
+        match self {
+            Effect::AddItem { map, .. } | Effect::RemoveItem { map, .. } |
+            Effect::SetProperty { map, .. } | Effect::SetUntypedProperty { map, .. } => Some(map),
+            Effect::Teleport { .. } | Effect::SpawnNpc { .. } | Effect::DespawnNpc { .. } => None,
+        }
+    }
+}
+
+/// (地圖, x, y, 物品)
+type ItemKey = (String, usize, usize, String);
+
+/// 交易起點：回滾時截斷到這裡並還原規劃狀態
+#[derive(Debug, Default)]
+struct Checkpoint {
+    effects: usize,
+    messages: usize,
+    undo: Vec<(ItemKey, i64)>,          // 物品增減的舊值
+    current_map: Option<Option<String>>,  // 傳送前的待定地圖（None 表示本交易未傳送）
+}
+
+/// 批次執行的結果
+#[derive(Debug, Default)]
+pub struct BatchReport {
+    pub executed: usize,
+    pub failures: Vec<(String, String)>,  // (事件 ID, 錯誤)
+}
+
+/// 一個 tick 的事件批次
+#[derive(Debug, Default)]
+pub struct EventBatch {
+    effects: Vec<Effect>,
+    messages: Vec<String>,
+    item_delta: HashMap<ItemKey, i64>,  // 尚未套用的物品增減
+    current_map: Option<String>,        // 尚未套用的傳送目的地
+    checkpoint: Checkpoint,
+    report: BatchReport,
+}
+
+impl EventBatch {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// 規劃一個事件；失敗時回滾該事件的寫入與訊息，返回錯誤
+    pub fn run_event(&mut self, event_id: &str, compiled: &CompiledEvent, game_world: &mut GameWorld) -> Result<(), String> {
+        self.messages.push(compiled.header.clone());
+        self.checkpoint = Checkpoint { effects: self.effects.len(), messages: self.messages.len(), ..Default::default() };
+        match compiled.program.plan(game_world, self) {
+            Ok(()) => {
+                self.report.executed += 1;
+                Ok(())
+            }
+            Err(e) => {
+                self.rollback();
+                let error = format!("執行動作失敗: {e}");
+                self.report.failures.push((event_id.to_string(), error.clone()));
+                Err(error)
+            }
+        }
+    }
+
+    fn rollback(&mut self) {
+        let checkpoint = std::mem::take(&mut self.checkpoint);
+        self.effects.truncate(checkpoint.effects);
+        self.messages.truncate(checkpoint.messages);
+        for (key, old) in checkpoint.undo.into_iter().rev() {
+            self.item_delta.insert(key, old);
+        }
+        if let Some(current_map) = checkpoint.current_map {
+            self.current_map = current_map;
+        }
+    }
+
+    pub(crate) fn print(&mut self, message: String) {
+        self.messages.push(message);
+    }
+
+    pub(crate) fn push(&mut self, effect: Effect) {
+        if let Effect::AddItem { map, x, y, item } | Effect::RemoveItem { map, x, y, item } = &effect {
+            let key = (map.clone(), *x, *y, item.clone());
+            let delta = self.item_delta.entry(key.clone()).or_insert(0);
+            self.checkpoint.undo.push((key, *delta));
+            *delta += if matches!(effect, Effect::AddItem { .. }) { 1 } else { -1 };
+        }
+        if let Effect::Teleport { map, .. } = &effect {
+            if self.checkpoint.current_map.is_none() {
+                self.checkpoint.current_map = Some(self.current_map.clone());
+            }
+            self.current_map = Some(map.clone());
+        }
+        self.effects.push(effect);
+    }
+
+    /// 規劃中的目前地圖（含本批次尚未套用的傳送）
+    pub(crate) fn current_map<'a>(&'a self, game_world: &'a GameWorld) -> &'a str {
+        self.current_map.as_deref().unwrap_or(&game_world.current_map_name)
+    }
+
+    /// 某點上的物品數量（含本批次尚未套用的增減）
+    pub(crate) fn item_count(&self, game_world: &GameWorld, map: &str, x: usize, y: usize, item: &str) -> i64 {
+        let stored = game_world.maps.get(map)
+            .and_then(|m| m.get_point(x, y))
+            .and_then(|point| point.objects.get(item))
+            .map_or(0, |&count| count as i64);
+        let key = (map.to_string(), x, y, item.to_string());
+        stored + self.item_delta.get(&key).copied().unwrap_or(0)
+    }
+
+    /// 套用所有已提交的寫入，返回合併的輸出訊息與執行結果
+    pub fn apply(self, game_world: &mut GameWorld) -> (Vec<String>, BatchReport) {
+        // 依地圖分組（保持各地圖內的寫入順序），傳送只保留最後一次，NPC 生成與離開保持原順序
+        let mut groups: Vec<(String, Vec<Effect>)> = Vec::new();
+        let mut teleport = None;
+        let mut npc_effects = Vec::new();
+        for effect in self.effects {
+            let Some(target) = effect.map() else {
+                match effect {
+                    Effect::Teleport { .. } => teleport = Some(effect),
+                    _ => npc_effects.push(effect),
+                }
+                continue;
+            };
+            match groups.iter_mut().find(|(map, _)| map == target) {
+                Some((_, effects)) => effects.push(effect),
+                None => groups.push((target.to_string(), vec![effect])),
+            }
+        }
+
+        let mut changes = Vec::new();
+        for (map_name, effects) in groups {
+            let Some(map) = game_world.maps.get_mut(&map_name) else {
+                continue;
+            };
+            for effect in effects {
+                match effect {
+                    Effect::AddItem { x, y, item, .. } => {
+                        if let Some(point) = map.items_mut(x, y) {
+                            point.add_object(item);
+                        }
+                    }
+                    Effect::RemoveItem { x, y, item, .. } => {
+                        if let Some(point) = map.items_mut(x, y) {
+                            point.remove_object(&item);
+                        }
+                    }
+                    Effect::SetProperty { property, value, .. } => {
+                        let old = map.properties.set(property, value);
+                        if old != Some(value) {
+                            changes.push(PropertyChange { map: map_name.clone(), property, old, new: value });
+                        }
+                    }
+                    Effect::SetUntypedProperty { name, value, .. } => map.properties.set_str(&name, &value),
+                    Effect::Teleport { .. } | Effect::SpawnNpc { .. } | Effect::DespawnNpc { .. } => {}
+                }
+            }
+        }
+        game_world.notify_property_changes(changes);
+
+        if let Some(Effect::Teleport { map, x, y }) = teleport {
+            game_world.change_map(&map);
+            let controlled_id = game_world.current_controlled_id.clone();
+            if let Some(me) = game_world.npc_manager.get_npc_mut(&controlled_id) {
+                me.move_to(x, y);
+            }
+        }
+
+        for effect in npc_effects {
+            match effect {
+                Effect::SpawnNpc { npc, map, x, y } => {
+                    // plan 已拒絕常駐 NPC，這裡不會失敗
+                    let spawned = game_world.spawn_npc(&npc, &map, x, y);
+                    debug_assert!(spawned, "事件生成的 NPC {npc} 與常駐 NPC 衝突");
+                }
+                Effect::DespawnNpc { npc } => {
+                    game_world.despawn_npc(&npc);
+                }
+                _ => {}
+            }
+        }
+        (self.messages, self.report)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::event::{EventAction, Position};
+    use crate::event_vm::EventProgram;
+    use crate::map::Map;
+    use crate::person::Person;
+    use std::sync::Arc;
+    use crate::rng::WorldRng;
+
+    #[test]
+    fn test_batch_rolls_back_failed_event() {
+        let mut game_world = GameWorld::new_with_dir("unused");
+        game_world.add_map(Map::new("beginMap".to_string(), 5, 5, &WorldRng::new(1)));
+        let event = |name: &str, actions: &[EventAction]| CompiledEvent {
+            header: name.to_string(),
+            program: EventProgram::compile(actions, &game_world.property_schema),
+        };
+        let add = EventAction::AddItem { item: "蘋果".to_string(), position: Position::Fixed([1, 1]) };
+        let remove = EventAction::RemoveItem { item: "蘋果".to_string(), position: Position::Fixed([1, 1]) };
+        let add_event = event("A", &[add]);
+        // 第一次移除看得到 A 尚未套用的物品，第二次失敗，整個事件回滾
+        let remove_event = event("B", &[remove.clone(), remove]);
+
+        let mut batch = EventBatch::new();
+        assert!(batch.run_event("a", &add_event, &mut game_world).is_ok());
+        assert!(batch.run_event("b", &remove_event, &mut game_world).is_err());
+        let (messages, report) = batch.apply(&mut game_world);
+
+        assert_eq!(messages, vec!["A".to_string(), "🎁 蘋果 出現在 (1, 1)".to_string(), "B".to_string()]);
+        assert_eq!(report.executed, 1);
+        assert_eq!(report.failures.len(), 1);
+        let point = game_world.get_current_map().unwrap().get_point(1, 1).unwrap();
+        assert_eq!(point.objects.get("蘋果"), Some(&1));
+    }
+
+    #[test]
+    fn test_spawn_rejects_resident_npc() {
+        let mut game_world = GameWorld::new_with_dir("unused");
+        game_world.add_map(Map::new("beginMap".to_string(), 5, 5, &WorldRng::new(1)));
+        let me = Person::new("玩家".to_string(), String::new());
+        game_world.npc_manager.add_npc("me".to_string(), me, Vec::new());
+        let schema = Arc::clone(&game_world.property_schema);
+        let spawn = |npc_id: &str| CompiledEvent {
+            header: npc_id.to_string(),
+            program: EventProgram::compile(&[EventAction::SpawnNpc {
+                npc_id: npc_id.to_string(),
+                position: Position::Fixed([2, 3]),
+                dialogue: None,
+            }], &schema),
+        };
+
+        // 常駐的 me 不能被事件搬走，事件回滾；事件生成的 NPC 照常出現
+        let mut batch = EventBatch::new();
+        assert!(batch.run_event("me", &spawn("me"), &mut game_world).is_err());
+        assert!(batch.run_event("ghost", &spawn("ghost"), &mut game_world).is_ok());
+        let (_, report) = batch.apply(&mut game_world);
+
+        assert_eq!((report.executed, report.failures.len()), (1, 1));
+        assert!(game_world.npc_manager.is_transient("ghost"));
+        let me = game_world.npc_manager.get_npc("me").unwrap();
+        assert_ne!((me.x, me.y), (2, 3));
+    }
+}
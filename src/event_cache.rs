@@ -0,0 +1,228 @@
+// 事件定義快取
+// 事件腳本解析後存入世界資料夾的 .cache/events.bin，下次啟動時：
+// - 檔案大小與修改時間都相同 → 直接使用快取內容，不讀取原始檔
+// - 修改時間不同但內容雜湊相同（例如 git checkout）→ 使用快取內容並更新時間戳
+// - 其餘情況重新解析；未命中的檔案以多個執行緒平行讀取與解析
+//
+// 檔案格式（小端序）:
+//   "RMEC" | 版本 u32 | 項目數 u32
+//   每個項目: 路徑長度 u32 | 路徑 | 修改時間 u64（ns）| 大小 u64 | FNV-1a 雜湊 u64 | 內容長度 u32 | 內容
+// 內容為該檔案所有事件的緊湊 JSON 陣列：事件型別使用 serde 的內部標記列舉（"type" 欄位），
+// 需要自我描述的格式，因此以 JSON 編碼記錄、以二進位容器索引。
+//
+// 快取的是事件定義而不是編譯後的位元組碼：EventManager 仍需要完整的 GameEvent
+// （觸發條件、事件清單、快照），而位元組碼中的屬性編號取決於世界的 properties.json，
+// 宣告表可以獨立於事件檔案改變；編譯只走訪一次動作樹，成本遠低於讀檔與解析原始 JSON。
+
+use std::collections::HashMap;
+use std::fs;
+use std::path::{Path, PathBuf};
+use std::time::UNIX_EPOCH;
+
+use crate::event::GameEvent;
+
+const MAGIC: &[u8; 4] = b"RMEC";
+/// GameEvent 結構變更時遞增，舊快取會整個失效
+const VERSION: u32 = 1;
+
+/// 一個事件檔案的快取項目
+#[derive(Debug, Clone, PartialEq)]
+pub struct CacheEntry {
+    pub mtime: u64,
+    pub size: u64,
+    pub hash: u64,
+    pub payload: Vec<u8>,  // 緊湊 JSON: Vec<GameEvent>
+}
+
+/// 檔案的修改時間（ns）與大小
+pub fn file_stamp(metadata: &fs::Metadata) -> std::io::Result<(u64, u64)> {
+    let mtime = metadata.modified()?
+        .duration_since(UNIX_EPOCH)
+        .map(|d| d.as_nanos() as u64)
+        .unwrap_or(0);
+    Ok((mtime, metadata.len()))
+}
+
+/// FNV-1a 64 位元雜湊（跨版本穩定，適合寫入檔案）
+pub fn fnv1a(bytes: &[u8]) -> u64 {
+    let mut hash: u64 = 0xcbf2_9ce4_8422_2325;
+    for &b in bytes {
+        hash ^= b as u64;
+        hash = hash.wrapping_mul(0x0000_0100_0000_01b3);
+    }
+    hash
+}
+
+/// 讀取快取；檔案不存在、版本不符或內容損毀時返回空表
+pub fn read_cache(path: &Path) -> HashMap<PathBuf, CacheEntry> {
+    fs::read(path).ok().and_then(|bytes| decode(&bytes)).unwrap_or_default()
+}
+
+/// 寫入快取（先寫暫存檔再改名，中斷時不會留下半個檔案）
+pub fn write_cache(path: &Path, entries: &[(PathBuf, CacheEntry)]) -> std::io::Result<()> {
+    if let Some(parent) = path.parent() {
+        fs::create_dir_all(parent)?;
+    }
+    let tmp = path.with_extension("bin.tmp");
+    fs::write(&tmp, encode(entries))?;
+    fs::rename(tmp, path)
+}
+
+fn encode(entries: &[(PathBuf, CacheEntry)]) -> Vec<u8> {
+    let size: usize = entries.iter().map(|(p, e)| p.as_os_str().len() + e.payload.len() + 32).sum();
+    let mut out = Vec::with_capacity(12 + size);
+    out.extend_from_slice(MAGIC);
+    out.extend_from_slice(&VERSION.to_le_bytes());
+    out.extend_from_slice(&(entries.len() as u32).to_le_bytes());
+    for (path, entry) in entries {
+        let path = path.to_string_lossy();
+        out.extend_from_slice(&(path.len() as u32).to_le_bytes());
+        out.extend_from_slice(path.as_bytes());
+        out.extend_from_slice(&entry.mtime.to_le_bytes());
+        out.extend_from_slice(&entry.size.to_le_bytes());
+        out.extend_from_slice(&entry.hash.to_le_bytes());
+        out.extend_from_slice(&(entry.payload.len() as u32).to_le_bytes());
+        out.extend_from_slice(&entry.payload);
+    }
+    out
+}
+
+fn decode(bytes: &[u8]) -> Option<HashMap<PathBuf, CacheEntry>> {
+    let mut reader = Reader { bytes, pos: 0 };
+    if reader.take(4)? != MAGIC || reader.u32()? != VERSION {
+        return None;
+    }
+    let count = reader.u32()? as usize;
+    let mut entries = HashMap::with_capacity(count);
+    for _ in 0..count {
+        let path_len = reader.u32()? as usize;
+        let path = PathBuf::from(std::str::from_utf8(reader.take(path_len)?).ok()?);
+        let mtime = reader.u64()?;
+        let size = reader.u64()?;
+        let hash = reader.u64()?;
+        let payload_len = reader.u32()? as usize;
+        let payload = reader.take(payload_len)?.to_vec();
+        entries.insert(path, CacheEntry { mtime, size, hash, payload });
+    }
+    Some(entries)
+}
+
+struct Reader<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn take(&mut self, n: usize) -> Option<&'a [u8]> {
+        let slice = self.bytes.get(self.pos..self.pos.checked_add(n)?)?;
+        self.pos += n;
+        Some(slice)
+    }
+
+    fn u32(&mut self) -> Option<u32> {
+        Some(u32::from_le_bytes(self.take(4)?.try_into().ok()?))
+    }
+
+    fn u64(&mut self) -> Option<u64> {
+        Some(u64::from_le_bytes(self.take(8)?.try_into().ok()?))
+    }
+}
+
+/// 載入單一檔案的結果
+pub struct Loaded {
+    pub events: Vec<GameEvent>,
+    pub entry: CacheEntry,
+    pub parsed: bool,  // 是否重新解析了原始檔（快取需要更新）
+}
+
+/// 依快取載入一個事件檔案；stamp 為目錄掃描時取得的 (修改時間, 大小)
+pub fn load_file(path: &Path, stamp: (u64, u64), cached: Option<&CacheEntry>) -> Result<Loaded, Box<dyn std::error::Error + Send + Sync>> {
+    let (mtime, size) = stamp;
+    if let Some(entry) = cached.filter(|e| e.mtime == mtime && e.size == size) {
+        let events = serde_json::from_slice(&entry.payload)?;
+        return Ok(Loaded { events, entry: entry.clone(), parsed: false });
+    }
+
+    let content = fs::read(path)?;
+    let hash = fnv1a(&content);
+    if let Some(entry) = cached.filter(|e| e.hash == hash && e.size == content.len() as u64) {
+        let events = serde_json::from_slice(&entry.payload)?;
+        return Ok(Loaded { events, entry: CacheEntry { mtime, ..entry.clone() }, parsed: true });
+    }
+
+    let events = parse_events(&content)?;
+    let payload = serde_json::to_vec(&events)?;
+    Ok(Loaded { events, entry: CacheEntry { mtime, size: content.len() as u64, hash, payload }, parsed: true })
+}
+
+/// 解析事件檔案（支援單個事件或事件陣列）
+pub fn parse_events(content: &[u8]) -> Result<Vec<GameEvent>, serde_json::Error> {
+    // 先嘗試載入為陣列，失敗時嘗試載入為單個事件
+    serde_json::from_slice::<Vec<GameEvent>>(content)
+        .or_else(|_| serde_json::from_slice::<GameEvent>(content).map(|event| vec![event]))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_cache_roundtrip() {
+        let entries = vec![
+            (PathBuf::from("events/a.json"), CacheEntry { mtime: 1, size: 2, hash: fnv1a(b"a"), payload: b"[]".to_vec() }),
+            (PathBuf::from("events/子目錄/b.json"), CacheEntry { mtime: 3, size: 4, hash: 5, payload: Vec::new() }),
+        ];
+        let bytes = encode(&entries);
+        let decoded = decode(&bytes).unwrap();
+        assert_eq!(decoded.len(), 2);
+        assert_eq!(decoded[Path::new("events/子目錄/b.json")], entries[1].1);
+
+        // 截斷或版本不符的快取視為不存在
+        assert!(decode(&bytes[..bytes.len() - 1]).is_none());
+        let mut stale = bytes.clone();
+        stale[4] ^= 0xFF;
+        assert!(decode(&stale).is_none());
+    }
+
+    #[test]
+    fn test_cache_invalidation() {
+        let dir = std::env::temp_dir().join(format!("ratamud_event_cache_{}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        let path = dir.join("a.json");
+        let event = |id: &str| format!(
+            r#"{{"id":"{id}","name":"n","description":"d","trigger":{{"type":"manual"}},"actions":[]}}"#
+        );
+        fs::write(&path, event("first")).unwrap();
+        let stamp = file_stamp(&fs::metadata(&path).unwrap()).unwrap();
+
+        let first = load_file(&path, stamp, None).unwrap();
+        assert!(first.parsed);
+        assert_eq!(first.events[0].id, "first");
+
+        // 快取內容換成空陣列：命中時返回的是快取內容，而不是重新解析原始檔
+        let cached = CacheEntry { payload: b"[]".to_vec(), ..first.entry.clone() };
+
+        // 時間戳相同：直接使用快取
+        let hit = load_file(&path, stamp, Some(&cached)).unwrap();
+        assert!(!hit.parsed && hit.events.is_empty());
+
+        // 時間戳不同、內容雜湊相同：使用快取並更新時間戳
+        let touched = (stamp.0 + 1, stamp.1);
+        let rehashed = load_file(&path, touched, Some(&cached)).unwrap();
+        assert!(rehashed.parsed && rehashed.events.is_empty());
+        assert_eq!(rehashed.entry.mtime, touched.0);
+
+        // 內容改變：重新解析
+        fs::write(&path, event("second")).unwrap();
+        let stamp = file_stamp(&fs::metadata(&path).unwrap()).unwrap();
+        let changed = load_file(&path, stamp, Some(&cached)).unwrap();
+        assert!(changed.parsed);
+        assert_eq!(changed.events[0].id, "second");
+
+        // 檔案刪除：時間戳已不相符，讀取失敗（不會返回舊的快取內容）
+        fs::remove_file(&path).unwrap();
+        assert!(load_file(&path, (0, 0), Some(&changed.entry)).is_err());
+
+        fs::remove_dir_all(&dir).unwrap();
+    }
+}
@@ -1,6 +1,13 @@
 use crate::event::{EventManager, GameEvent};
+use crate::event_cache;
+use std::collections::HashMap;
 use std::fs;
-use std::path::Path;
+use std::path::{Path, PathBuf};
+
+/// 每個執行緒至少分到的檔案數（檔案少時不值得開執行緒）
+const FILES_PER_THREAD: usize = 64;
+
+type LoadResult = Result<event_cache::Loaded, Box<dyn std::error::Error + Send + Sync>>;
 
 /// 事件加載器
 pub struct EventLoader;
@@ -18,58 +25,82 @@ impl EventLoader {
             return Ok((0, loaded_events));
         }
         
-        // 遞迴讀取目錄
-        Self::load_recursive(event_manager, dir_path, &mut loaded_events)?;
+        // 收集所有事件檔案（排序後載入，事件覆蓋順序固定）
+        let mut files = Vec::new();
+        Self::collect_files(Path::new(dir_path), &mut files)?;
+        files.sort();
+        
+        let cache_path = Self::cache_path(dir_path);
+        let cache = event_cache::read_cache(&cache_path);
+        let results = Self::load_files(&files, &cache);
+        
+        let mut entries = Vec::with_capacity(files.len());
+        let mut dirty = false;
+        for ((path, _), result) in files.into_iter().zip(results) {
+            match result {
+                Ok(loaded) => {
+                    dirty |= loaded.parsed;
+                    for event in loaded.events {
+                        loaded_events.push(format!("{} ({})", event.name, event.id));
+                        event_manager.add_event(event);
+                    }
+                    entries.push((path, loaded.entry));
+                }
+                Err(e) => {
+                    eprintln!("載入事件檔案 {path:?} 失敗: {e}");
+                }
+            }
+        }
+        
+        // 有檔案重新解析、新增或刪除時更新快取
+        if dirty || entries.len() != cache.len() {
+            if let Err(e) = event_cache::write_cache(&cache_path, &entries) {
+                eprintln!("寫入事件快取 {cache_path:?} 失敗: {e}");
+            }
+        }
         
         let count = loaded_events.len();
         Ok((count, loaded_events))
     }
     
-    fn load_recursive(
-        event_manager: &mut EventManager,
-        dir_path: &str,
-        loaded_events: &mut Vec<String>,
-    ) -> Result<(), Box<dyn std::error::Error>> {
-        
-        for entry in fs::read_dir(dir_path)? {
-            let entry = entry?;
-            let path = entry.path();
-            
-            if path.is_dir() {
-                // 遞迴處理子目錄
-                Self::load_recursive(event_manager, path.to_str().unwrap(), loaded_events)?;
+    /// 事件快取位置: 世界資料夾/.cache/events.bin
+    fn cache_path(dir_path: &str) -> PathBuf {
+        Path::new(dir_path).parent().unwrap_or(Path::new(".")).join(".cache").join("events.bin")
+    }
+    
+    /// 遞迴收集目錄下的 JSON 檔案與其 (修改時間, 大小)
+    /// 使用 fs::metadata 跟隨符號連結：連結的子目錄照常載入，連結的檔案以目標檔案的時間戳判斷快取
+    fn collect_files(dir: &Path, files: &mut Vec<(PathBuf, (u64, u64))>) -> std::io::Result<()> {
+        for entry in fs::read_dir(dir)? {
+            let path = entry?.path();
+            let metadata = fs::metadata(&path)?;
+            if metadata.is_dir() {
+                Self::collect_files(&path, files)?;
             } else if path.extension().and_then(|s| s.to_str()) == Some("json") {
-                // 加載 JSON 事件檔案
-                match Self::load_event_file(&path) {
-                    Ok(events) => {
-                        for event in events {
-                            let event_info = format!("{} ({})", event.name, event.id);
-                            loaded_events.push(event_info);
-                            event_manager.add_event(event);
-                        }
-                    }
-                    Err(e) => {
-                        eprintln!("載入事件檔案 {path:?} 失敗: {e}");
-                    }
-                }
+                files.push((path, event_cache::file_stamp(&metadata)?));
             }
         }
-        
         Ok(())
     }
     
-    /// 從文件加載事件（支援單個事件或事件陣列）
-    fn load_event_file(path: &Path) -> Result<Vec<GameEvent>, Box<dyn std::error::Error>> {
-        let content = fs::read_to_string(path)?;
-        
-        // 先嘗試載入為陣列
-        if let Ok(events) = serde_json::from_str::<Vec<GameEvent>>(&content) {
-            return Ok(events);
+    /// 載入所有檔案；檔案多時分給多個執行緒（結果順序與 files 相同）
+    fn load_files(files: &[(PathBuf, (u64, u64))], cache: &HashMap<PathBuf, event_cache::CacheEntry>) -> Vec<LoadResult> {
+        let load = |(path, stamp): &(PathBuf, (u64, u64))| event_cache::load_file(path, *stamp, cache.get(path));
+        let threads = std::thread::available_parallelism()
+            .map_or(1, |n| n.get())
+            .min(files.len() / FILES_PER_THREAD);
+        if threads <= 1 {
+            return files.iter().map(load).collect();
         }
-        
-        // 如果失敗，嘗試載入為單個事件
-        let event: GameEvent = serde_json::from_str(&content)?;
-        Ok(vec![event])
+        let chunk_size = files.len().div_ceil(threads);
+        std::thread::scope(|scope| {
+            let handles: Vec<_> = files.chunks(chunk_size)
+                .map(|chunk| scope.spawn(move || chunk.iter().map(load).collect::<Vec<_>>()))
+                .collect();
+            handles.into_iter()
+                .flat_map(|handle| handle.join().unwrap_or_else(|e| std::panic::resume_unwind(e)))
+                .collect()
+        })
     }
     
     /// 保存事件到文件
@@ -205,3 +236,38 @@ impl EventLoader {
         Ok(())
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_reload_follows_symlinks_and_drops_deleted_files() {
+        let root = std::env::temp_dir().join(format!("ratamud_event_loader_{}", std::process::id()));
+        let events_dir = root.join("events");
+        let shared = root.join("shared");
+        fs::create_dir_all(&events_dir).unwrap();
+        fs::create_dir_all(&shared).unwrap();
+        let event = |id: &str| format!(
+            r#"{{"id":"{id}","name":"n","description":"d","trigger":{{"type":"manual"}},"actions":[]}}"#
+        );
+        fs::write(events_dir.join("a.json"), event("a")).unwrap();
+        fs::write(shared.join("b.json"), event("b")).unwrap();
+        #[cfg(unix)]
+        std::os::unix::fs::symlink(&shared, events_dir.join("linked")).unwrap();
+
+        let dir = events_dir.to_string_lossy().to_string();
+        let expected = if cfg!(unix) { 2 } else { 1 };
+        let (count, _) = EventLoader::load_from_directory(&mut EventManager::new(), &dir).unwrap();
+        assert_eq!(count, expected);
+        assert_eq!(event_cache::read_cache(&EventLoader::cache_path(&dir)).len(), expected);
+
+        // 刪除的檔案不再載入，也從快取中移除
+        fs::remove_file(events_dir.join("a.json")).unwrap();
+        let (count, _) = EventLoader::load_from_directory(&mut EventManager::new(), &dir).unwrap();
+        assert_eq!(count, expected - 1);
+        assert_eq!(event_cache::read_cache(&EventLoader::cache_path(&dir)).len(), expected - 1);
+
+        fs::remove_dir_all(&root).unwrap();
+    }
+}
@@ -1,7 +1,7 @@
 use crate::event::{EventManager, GameEvent, TriggerType};
 use crate::world::GameWorld;
 use crate::person::Person;
-use rand::Rng;
+use crate::rng::RngStream;
 
 /// Crontab 解析器
 pub struct CronParser;
@@ -153,8 +153,7 @@ impl EventScheduler {
                 
                 // 檢查隨機機率
                 if let Some(chance) = random_chance {
-                    let mut rng = rand::thread_rng();
-                    if rng.gen::<f32>() > *chance {
+                    if game_world.rng.stream(RngStream::Scheduler).next_f32() > *chance {
                         return false;
                     }
                 }
@@ -162,8 +161,7 @@ impl EventScheduler {
                 true
             }
             TriggerType::Random { chance, .. } => {
-                let mut rng = rand::thread_rng();
-                rng.gen::<f32>() <= *chance
+                game_world.rng.stream(RngStream::Scheduler).next_f32() <= *chance
             }
             TriggerType::Location { positions } => {
                 // 需要在移動時檢查，這裡返回 false
@@ -0,0 +1,381 @@
+// 事件動作位元組碼
+// 事件載入時把 EventAction 樹編譯成扁平的指令序列：
+// - 不含執行期資料的訊息（廣播、對話、地圖屬性變化）在編譯時就格式化完成
+// - NPC/地圖/物品/屬性名稱放進字串池，指令只存索引
+// - 已宣告的地圖屬性在編譯時解析為 (PropertyId, PropertyValue)，執行時只寫入槽位
+// - RandomAction 編譯成 Walker 別名表（O(1) 抽樣），權重檢查也在編譯時完成
+// 執行時由 EventProgram::plan 以小型迴圈直譯，不需遞迴也不需重新加總權重；
+// 直譯只驗證並把寫入記錄到 EventBatch，由批次統一套用（見 event_batch）。
+
+use crate::event::{EventAction, Position, WeightedAction};
+use crate::event_batch::{Effect, EventBatch};
+use crate::map_property::{PropertyId, PropertySchema, PropertyValue};
+use crate::rng::{Rng, RngStream};
+use crate::world::GameWorld;
+
+/// 編譯後的位置
+#[derive(Debug, Clone, Copy, PartialEq)]
+enum Pos {
+    Fixed(usize, usize),
+    Random,  // 地圖上隨機的可行走點
+}
+
+impl Pos {
+    fn compile(position: &Position) -> Self {
+        match position {
+            Position::Fixed([x, y]) => Pos::Fixed(*x, *y),
+            Position::Random(_) => Pos::Random,
+        }
+    }
+
+    fn resolve(self, map: &crate::map::Map, rng: &Rng) -> Option<(usize, usize)> {
+        match self {
+            Pos::Fixed(x, y) => Some((x, y)),
+            Pos::Random => map.random_walkable_point(rng),
+        }
+    }
+}
+
+/// 指令（字串欄位皆為字串池索引）
+#[derive(Debug, Clone, PartialEq)]
+enum Op {
+    /// 輸出常數訊息
+    Print(u32),
+    /// NPC 出現：從物件池生成到世界，dialogue 為已格式化的對話訊息
+    SpawnNpc { npc: u32, pos: Pos, dialogue: Option<u32> },
+    /// NPC 離開：回收事件生成的 NPC，message 為已格式化的離開訊息
+    RemoveNpc { npc: u32, message: u32 },
+    AddItem { item: u32, pos: Pos },
+    RemoveItem { item: u32, pos: Pos },
+    Teleport { map: u32, pos: Pos },
+    /// message 為已格式化的「地圖現在屬性是值」訊息
+    SetMapProperty { map: u32, typed: Option<(PropertyId, PropertyValue)>, property: u32, value: u32, message: u32 },
+    /// 依別名表選一個分支，跳到該分支的起點
+    Choose { table: u32 },
+    Jump(u32),
+    /// 編譯時已知會失敗的動作（例如權重全為 0 的隨機動作）
+    Fail(u32),
+}
+
+/// Walker 別名表：n 個選項各一個門檻與別名，抽樣只需一次亂數
+#[derive(Debug, Clone, PartialEq)]
+struct AliasTable {
+    threshold: Vec<f32>,
+    alias: Vec<u32>,
+    targets: Vec<u32>,  // 各選項分支起點的指令位置
+}
+
+impl AliasTable {
+    /// 以 Vose 演算法建立；weights 必須至少有一個正值
+    fn new(weights: &[f32]) -> Self {
+        let n = weights.len();
+        let total: f32 = weights.iter().map(|w| w.max(0.0)).sum();
+        let mut scaled: Vec<f32> = weights.iter().map(|w| w.max(0.0) * n as f32 / total).collect();
+        let mut threshold = vec![1.0; n];
+        let mut alias: Vec<u32> = (0..n as u32).collect();
+
+        let (mut small, mut large): (Vec<usize>, Vec<usize>) = (0..n).partition(|&i| scaled[i] < 1.0);
+        while let (Some(s), Some(&l)) = (small.pop(), large.last()) {
+            threshold[s] = scaled[s];
+            alias[s] = l as u32;
+            scaled[l] -= 1.0 - scaled[s];
+            if scaled[l] < 1.0 {
+                large.pop();
+                small.push(l);
+            }
+        }
+        AliasTable { threshold, alias, targets: Vec::with_capacity(n) }
+    }
+
+    /// 抽一個選項：高 32 位元選欄位，低 32 位元與門檻比較
+    fn sample(&self, rng: &Rng) -> usize {
+        let r = rng.next_u64();
+        let column = (((r >> 32) * self.threshold.len() as u64) >> 32) as usize;
+        let coin = (r & 0xFFFF_FFFF) as f32 * (1.0 / 4_294_967_296.0);
+        if coin < self.threshold[column] {
+            column
+        } else {
+            self.alias[column] as usize
+        }
+    }
+}
+
+/// 編譯後的動作序列
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct EventProgram {
+    ops: Vec<Op>,
+    strings: Vec<String>,
+    tables: Vec<AliasTable>,
+}
+
+/// 編譯後的事件（EventManager 在載入事件時建立）
+#[derive(Debug, Clone, PartialEq)]
+pub struct CompiledEvent {
+    pub header: String,  // 「🎭 事件觸發: 名稱」
+    pub program: EventProgram,
+}
+
+impl CompiledEvent {
+    pub fn compile(event: &crate::event::GameEvent, schema: &PropertySchema) -> Self {
+        CompiledEvent {
+            header: format!("🎭 事件觸發: {}", event.name),
+            program: EventProgram::compile(&event.actions, schema),
+        }
+    }
+}
+
+impl EventProgram {
+    pub fn compile(actions: &[EventAction], schema: &PropertySchema) -> Self {
+        let mut program = EventProgram::default();
+        for action in actions {
+            program.compile_action(action, schema);
+        }
+        program.ops.shrink_to_fit();
+        program.strings.shrink_to_fit();
+        program
+    }
+
+    /// 加入字串池（相同內容共用同一個索引）
+    fn intern(&mut self, s: &str) -> u32 {
+        if let Some(index) = self.strings.iter().position(|existing| existing == s) {
+            return index as u32;
+        }
+        self.strings.push(s.to_string());
+        (self.strings.len() - 1) as u32
+    }
+
+    fn compile_action(&mut self, action: &EventAction, schema: &PropertySchema) {
+        let op = match action {
+            EventAction::SpawnNpc { npc_id, position, dialogue } => {
+                let dialogue = dialogue.as_ref().map(|text| self.intern(&format!("💬 {npc_id}: \"{text}\"")));
+                Op::SpawnNpc { npc: self.intern(npc_id), pos: Pos::compile(position), dialogue }
+            }
+            EventAction::RemoveNpc { npc_id } => Op::RemoveNpc {
+                npc: self.intern(npc_id),
+                message: self.intern(&format!("👤 NPC {npc_id} 離開了")),
+            },
+            EventAction::Message { text } => Op::Print(self.intern(&format!("📢 {text}"))),
+            EventAction::Dialogue { npc_id, text } => Op::Print(self.intern(&format!("💬 {npc_id}: \"{text}\""))),
+            EventAction::AddItem { item, position } => Op::AddItem { item: self.intern(item), pos: Pos::compile(position) },
+            EventAction::RemoveItem { item, position } => Op::RemoveItem { item: self.intern(item), pos: Pos::compile(position) },
+            EventAction::Teleport { map, position } => Op::Teleport { map: self.intern(map), pos: Pos::compile(position) },
+            EventAction::SetMapProperty { map, property, value } => Op::SetMapProperty {
+                map: self.intern(map),
+                typed: schema.resolve(property, value),
+                property: self.intern(property),
+                value: self.intern(value),
+                message: self.intern(&format!("🗺️  {map}現在{property}是{value}")),
+            },
+            EventAction::RandomAction { actions } => return self.compile_random(actions, schema),
+        };
+        self.ops.push(op);
+    }
+
+    /// Choose 之後依序放各分支，每個分支結尾跳到整段之後
+    fn compile_random(&mut self, actions: &[WeightedAction], schema: &PropertySchema) {
+        if actions.is_empty() {
+            let message = self.intern("沒有可執行的隨機動作");
+            self.ops.push(Op::Fail(message));
+            return;
+        }
+        let weights: Vec<f32> = actions.iter().map(|a| a.weight).collect();
+        if weights.iter().map(|w| w.max(0.0)).sum::<f32>() <= 0.0 {
+            let message = self.intern("總權重必須大於0");
+            self.ops.push(Op::Fail(message));
+            return;
+        }
+
+        let table_index = self.tables.len();
+        self.tables.push(AliasTable::new(&weights));
+        self.ops.push(Op::Choose { table: table_index as u32 });
+
+        let mut jumps = Vec::with_capacity(actions.len());
+        for weighted in actions {
+            let start = self.ops.len() as u32;
+            self.tables[table_index].targets.push(start);
+            self.compile_action(&weighted.action, schema);
+            jumps.push(self.ops.len());
+            self.ops.push(Op::Jump(0));
+        }
+        let end = self.ops.len() as u32;
+        for jump in jumps {
+            self.ops[jump] = Op::Jump(end);
+        }
+    }
+
+    /// 規劃執行：驗證每個動作並把寫入與訊息記錄到批次，不修改世界（只會載入尚未載入的地圖）
+    /// 遇到第一個失敗的動作即停止並返回錯誤，由批次回滾本事件
+    pub fn plan(&self, game_world: &mut GameWorld, batch: &mut EventBatch) -> Result<(), String> {
+        let mut pc = 0;
+        while let Some(op) = self.ops.get(pc) {
+            pc += 1;
+            match *op {
+                Op::Print(message) => batch.print(self.str(message).to_string()),
+                Op::SpawnNpc { npc, pos, dialogue } => {
+                    let npc = self.str(npc);
+                    // 常駐 NPC（包括玩家 me）不能由事件生成或搬移
+                    if game_world.npc_manager.contains(npc) && !game_world.npc_manager.is_transient(npc) {
+                        return Err(format!("NPC {npc} 已存在且不是事件生成的"));
+                    }
+                    let (map, x, y) = Self::resolve_current(game_world, batch, pos)?;
+                    if game_world.maps.get(&map).and_then(|m| m.get_point(x, y)).is_none() {
+                        return Err(format!("無法在位置 ({x}, {y}) 生成 NPC {npc}"));
+                    }
+                    batch.push(Effect::SpawnNpc { npc: npc.to_string(), map, x, y });
+                    batch.print(format!("👤 NPC {npc} 出現在 ({x}, {y})"));
+                    if let Some(dialogue) = dialogue {
+                        batch.print(self.str(dialogue).to_string());
+                    }
+                }
+                Op::RemoveNpc { npc, message } => {
+                    batch.push(Effect::DespawnNpc { npc: self.str(npc).to_string() });
+                    batch.print(self.str(message).to_string());
+                }
+                Op::AddItem { item, pos } => {
+                    let item = self.str(item);
+                    let (map, x, y) = Self::resolve_current(game_world, batch, pos)?;
+                    if game_world.maps.get(&map).and_then(|m| m.get_point(x, y)).is_none() {
+                        return Err(format!("無法在位置 ({x}, {y}) 添加物品"));
+                    }
+                    batch.push(Effect::AddItem { map, x, y, item: item.to_string() });
+                    batch.print(format!("🎁 {item} 出現在 ({x}, {y})"));
+                }
+                Op::RemoveItem { item, pos } => {
+                    let item = self.str(item);
+                    let (map, x, y) = Self::resolve_current(game_world, batch, pos)?;
+                    if batch.item_count(game_world, &map, x, y, item) <= 0 {
+                        return Err(format!("無法在位置 ({x}, {y}) 移除物品 {item}"));
+                    }
+                    batch.push(Effect::RemoveItem { map, x, y, item: item.to_string() });
+                    batch.print(format!("🗑️  {item} 從 ({x}, {y}) 消失了"));
+                }
+                Op::Teleport { map, pos } => {
+                    let map = self.str(map);
+                    if !game_world.ensure_map_loaded(map) {
+                        return Err(format!("地圖 {map} 不存在"));
+                    }
+                    let (x, y) = game_world.maps.get(map)
+                        .and_then(|m| pos.resolve(m, game_world.rng.stream(RngStream::Events)))
+                        .ok_or("無法解析目標位置")?;
+                    if game_world.npc_manager.get_npc(&game_world.current_controlled_id).is_none() {
+                        return Err("無法獲取當前角色".to_string());
+                    }
+                    batch.push(Effect::Teleport { map: map.to_string(), x, y });
+                    batch.print(format!("✨ 你被傳送到 {map} ({x}, {y})"));
+                }
+                Op::SetMapProperty { map, typed, property, value, message } => {
+                    let map = self.str(map);
+                    if !game_world.ensure_map_loaded(map) {
+                        return Err(format!("地圖 {map} 不存在"));
+                    }
+                    // 未宣告的屬性（或不在列舉內的值）以字串保存，不發送變化通知
+                    batch.push(match typed {
+                        Some((property, value)) => Effect::SetProperty { map: map.to_string(), property, value },
+                        None => Effect::SetUntypedProperty {
+                            map: map.to_string(),
+                            name: self.str(property).to_string(),
+                            value: self.str(value).to_string(),
+                        },
+                    });
+                    batch.print(self.str(message).to_string());
+                }
+                Op::Choose { table } => {
+                    let table = &self.tables[table as usize];
+                    let choice = table.sample(game_world.rng.stream(RngStream::Events));
+                    pc = table.targets[choice] as usize;
+                }
+                Op::Jump(target) => pc = target as usize,
+                Op::Fail(message) => return Err(self.str(message).to_string()),
+            }
+        }
+        Ok(())
+    }
+
+    fn str(&self, index: u32) -> &str {
+        &self.strings[index as usize]
+    }
+
+    /// 在規劃中的目前地圖（含本批次尚未套用的傳送）上解析位置
+    fn resolve_current(game_world: &GameWorld, batch: &EventBatch, pos: Pos) -> Result<(String, usize, usize), String> {
+        let map_name = batch.current_map(game_world);
+        let map = game_world.maps.get(map_name).ok_or("無法獲取當前地圖")?;
+        let (x, y) = pos.resolve(map, game_world.rng.stream(RngStream::Events)).ok_or("無法解析位置")?;
+        Ok((map_name.to_string(), x, y))
+    }
+
+    /// 指令數（除錯與測試用）
+    #[allow(dead_code)]
+    pub fn len(&self) -> usize {
+        self.ops.len()
+    }
+
+    #[allow(dead_code)]
+    pub fn is_empty(&self) -> bool {
+        self.ops.is_empty()
+    }
+}
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for EventProgram {
+    fn heap_size(&self) -> usize {
+        self.ops.capacity() * std::mem::size_of::<Op>()
+            + self.strings.heap_size()
+            + self.tables.iter()
+                .map(|t| t.threshold.heap_size() + t.alias.heap_size() + t.targets.heap_size() + std::mem::size_of::<AliasTable>())
+                .sum::<usize>()
+    }
+}
+
+impl HeapSize for CompiledEvent {
+    fn heap_size(&self) -> usize {
+        self.header.heap_size() + self.program.heap_size()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_compile_random_action() {
+        let weather = |value: &str, weight: f32| WeightedAction {
+            weight,
+            action: Box::new(EventAction::SetMapProperty {
+                map: "forest".to_string(),
+                property: "天氣".to_string(),
+                value: value.to_string(),
+            }),
+        };
+        let schema = PropertySchema::builtin();
+        let program = EventProgram::compile(&[
+            EventAction::Message { text: "起風了".to_string() },
+            EventAction::RandomAction { actions: vec![weather("晴天", 3.0), weather("雨天", 1.0), weather("霧天", 0.0)] },
+        ], &schema);
+        // Print + Choose + 3 × (SetMapProperty + Jump)
+        assert_eq!(program.len(), 8);
+        assert_eq!(program.ops[0], Op::Print(program.intern_index("📢 起風了")));
+        assert_eq!(program.strings.iter().filter(|s| *s == "forest").count(), 1);
+        let rainy = schema.resolve("天氣", "雨天");
+        assert!(program.ops.iter().any(|op| matches!(op, Op::SetMapProperty { typed, .. } if *typed == rainy)));
+
+        // 別名表抽樣比例接近權重，權重 0 的選項不會被選到
+        let table = &program.tables[0];
+        let rng = Rng::seed_from_u64(3);
+        let mut counts = [0usize; 3];
+        for _ in 0..40_000 {
+            counts[table.sample(&rng)] += 1;
+        }
+        assert_eq!(counts[2], 0);
+        assert!((counts[0] as f64 / counts[1] as f64 - 3.0).abs() < 0.2);
+
+        let empty = EventProgram::compile(&[EventAction::RandomAction { actions: Vec::new() }], &schema);
+        assert!(matches!(empty.ops[0], Op::Fail(_)));
+    }
+
+    impl EventProgram {
+        fn intern_index(&self, s: &str) -> u32 {
+            self.strings.iter().position(|existing| existing == s).unwrap() as u32
+        }
+    }
+}
@@ -1,16 +1,38 @@
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
-use std::ffi::{CStr, CString};
+use std::ffi::{c_void, CStr, CString};
 use std::os::raw::{c_char, c_int};
-use std::sync::Mutex;
+use std::sync::{Arc, Mutex};
 use once_cell::sync::Lazy;
 
+use crate::bulk_query;
+use crate::command_queue::{CommandQueue, Submission};
+use crate::command_registry::{self, NativeCommandFn};
 use crate::core_output;
+use crate::host_alloc::{self, FreeFn, MallocFn, ReallocFn};
+use crate::map_edit::Rect;
+use crate::native_ai::{self, AiDecideFn};
+use crate::npc_ai::NpcAiController;
+use crate::pump::Pump;
+use crate::snapshot;
 use crate::world::GameWorld;
 
 /// 全局遊戲世界實例（FFI 和其他非 UI 模式共用）
 static GAME_WORLD: Lazy<Mutex<Option<GameWorld>>> = Lazy::new(|| Mutex::new(None));
 
+/// 非同步提交的命令與完成記錄（ratamud_submit）
+static COMMAND_QUEUE: Lazy<CommandQueue> = Lazy::new(CommandQueue::new);
+
+/// 內建策略與所屬世界的編號
+type BuiltinAi = (u32, Arc<NpcAiController>);
+
+/// 未設定原生 AI 外掛時使用的內建策略
+/// （每個世界第一次 AI tick 時以該世界的亂數流建立，世界被取代後重新建立）
+static BUILTIN_AI: Lazy<Mutex<Option<BuiltinAi>>> = Lazy::new(|| Mutex::new(None));
+
+/// ratamud_pump 跨呼叫保留的待執行工作
+static PUMP: Lazy<Mutex<Pump>> = Lazy::new(|| Mutex::new(Pump::new()));
+
 /// 輸出回調函數類型 (C FFI)
 /// 參數: msg_type (類型標記: MAIN/LOG/STATUS/SIDE), content (內容)
 pub type OutputCallback = extern "C" fn(*const c_char, *const c_char);
@@ -39,21 +61,24 @@ pub extern "C" fn ratamud_clear_output_callback() {
 }
 
 /// 初始化遊戲世界（無 UI 模式）
+/// 只載入目前所在的地圖（其餘地圖第一次進入時載入），角色描述表在第一次使用時載入；
+/// 詳細啟動日誌（各地圖統計、每個角色位置）需在 settings.json 設定 verbose_startup
 /// 返回 0=成功, -1=失敗
 #[no_mangle]
 pub extern "C" fn ratamud_init_game() -> c_int {
     use crate::core_output::OutputZone;
     use crate::event_loader;
     
-    // 初始化 Person 描述資料
-    crate::person::init_person_descriptions();
+    let verbose = crate::settings::GameSettings::load().verbose_startup;
     
-    // 創建遊戲世界
+    // 創建遊戲世界（之後的載入計入此世界的配置計數）
     let mut game_world = GameWorld::new();
+    let _scope = game_world.alloc_scope.enter();
     
-    // 載入世界元數據和時間
+    // 載入世界元數據和時間，再啟動時鐘
     let _ = game_world.load_metadata();
     let _ = game_world.load_time();
+    game_world.start_clock();
     
     // 輸出當前時間
     core_output::trigger_output(OutputZone::Status, &game_world.format_time());
@@ -61,10 +86,12 @@ pub extern "C" fn ratamud_init_game() -> c_int {
     // 載入地圖
     match game_world.initialize_maps() {
         Ok((map_count, logs)) => {
-            for log in logs {
-                core_output::trigger_output(OutputZone::Log, &log);
+            if verbose {
+                for log in logs {
+                    core_output::trigger_output(OutputZone::Log, &log);
+                }
             }
-            core_output::trigger_output(OutputZone::Log, &format!("已加載 {} 個地圖", map_count));
+            core_output::trigger_output(OutputZone::Log, &format!("共 {} 個地圖", map_count));
         }
         Err(e) => {
             core_output::trigger_output(OutputZone::Log, &format!("⚠️  載入地圖失敗: {}", e));
@@ -76,9 +103,11 @@ pub extern "C" fn ratamud_init_game() -> c_int {
     let me = match game_world.npc_manager.initialize(&person_dir) {
         Ok((count, me)) => {
             core_output::trigger_output(OutputZone::Log, &format!("已載入 {} 個角色", count));
-            for npc in game_world.npc_manager.get_all_npcs() {
-                core_output::trigger_output(OutputZone::Log, 
-                    &format!("  - {} 在位置 ({}, {})", npc.name, npc.x, npc.y));
+            if verbose {
+                for npc in game_world.npc_manager.get_all_npcs() {
+                    core_output::trigger_output(OutputZone::Log, 
+                        &format!("  - {} 在位置 ({}, {})", npc.name, npc.x, npc.y));
+                }
             }
             me
         }
@@ -88,8 +117,9 @@ pub extern "C" fn ratamud_init_game() -> c_int {
         }
     };
     
-    // 設定 original_player
+    // 設定 original_player，並載入角色所在的其他地圖
     game_world.original_player = Some(me.clone());
+    game_world.load_resident_maps();
     
     // 載入任務
     let quest_dir = format!("{}/quests", game_world.world_dir);
@@ -152,6 +182,17 @@ pub extern "C" fn ratamud_input_command(command: *const c_char) -> c_int {
             return -1;
         }
     };
+
+    run_command(game_world, cmd)
+}
+
+/// 執行一個命令，返回 1=繼續, 0=退出, -2=記憶體超過預算（未執行）
+fn run_command(game_world: &mut GameWorld, cmd: &str) -> c_int {
+    if host_alloc::over_budget(game_world.alloc_scope.id()) {
+        use crate::core_output::OutputZone;
+        core_output::trigger_output(OutputZone::Status, "⚠️  記憶體已超過預算，命令未執行");
+        return -2;
+    }
     
     // 執行命令
     let should_continue = game_world.execute_command(cmd);
@@ -163,6 +204,605 @@ pub extern "C" fn ratamud_input_command(command: *const c_char) -> c_int {
     }
 }
 
+/// 非同步提交命令（任何執行緒皆可呼叫，不等待世界鎖）
+/// cmd 為 len 個位元組的 UTF-8（不需 NUL 結尾）；session 與 tag 原樣出現在完成記錄中
+/// 命令在下一次 ratamud_run_submitted 時執行，輸出收進完成記錄而不經過輸出回調
+/// 返回 0=已排入, -1=cmd 為 NULL 或不是 UTF-8
+#[no_mangle]
+pub extern "C" fn ratamud_submit(world: u32, session: u64, cmd: *const c_char, len: usize, tag: u64) -> c_int {
+    if cmd.is_null() {
+        return -1;
+    }
+    let bytes = unsafe { std::slice::from_raw_parts(cmd as *const u8, len) };
+    let Ok(command) = std::str::from_utf8(bytes) else {
+        return -1;
+    };
+    COMMAND_QUEUE.submit(Submission { world, session, tag, command: command.to_string() });
+    0
+}
+
+/// 依提交順序執行最多 max 個已提交的命令（0=目前佇列中的全部），結果排入完成佇列
+/// 編號與目前世界不符或遊戲尚未初始化時，命令的完成狀態為 -1
+/// 返回執行的命令數，-1=鎖定失敗
+#[no_mangle]
+pub extern "C" fn ratamud_run_submitted(max: usize) -> c_int {
+    let Ok(mut guard) = GAME_WORLD.lock() else {
+        return -1;
+    };
+    let ran = COMMAND_QUEUE.run(max, |submission| {
+        match guard.as_mut().filter(|world| world.alloc_scope.id() == submission.world) {
+            Some(world) => run_command(world, &submission.command),
+            None => -1,
+        }
+    });
+    ran as c_int
+}
+
+/// 一個提交命令的完成記錄 (C FFI)
+#[repr(C)]
+pub struct RataCompletion {
+    pub session: u64,
+    pub tag: u64,
+    pub status: c_int,    // 同 ratamud_input_command：1=繼續, 0=退出, -1=錯誤, -2=超過預算
+    pub output_len: u32,  // 輸出的位元組數
+}
+
+/// 取出最早的完成記錄；輸出以連續的 "區域\0內容\0" 寫入 buf（區域為 MAIN/LOG/STATUS/SIDE）
+/// buf_len 小於 output_len 時只填入 out（含 output_len），記錄留在佇列中，可配置足夠的緩衝區後再取
+/// 返回 1=取得, 0=佇列為空, -1=out 為 NULL, -2=緩衝區不足
+#[no_mangle]
+pub extern "C" fn ratamud_poll_completion(out: *mut RataCompletion, buf: *mut c_char, buf_len: usize) -> c_int {
+    let Some(out) = (unsafe { out.as_mut() }) else {
+        return -1;
+    };
+    let mut seen = false;
+    let accept = |completion: &crate::command_queue::Completion| {
+        seen = true;
+        let output_len = completion.output_len();
+        *out = RataCompletion {
+            session: completion.session,
+            tag: completion.tag,
+            status: completion.status,
+            output_len: output_len as u32,
+        };
+        output_len == 0 || (!buf.is_null() && output_len <= buf_len)
+    };
+    match COMMAND_QUEUE.poll_if(accept) {
+        Some(completion) => {
+            if !buf.is_null() {
+                let buf = unsafe { std::slice::from_raw_parts_mut(buf as *mut u8, buf_len) };
+                completion.encode_output(buf);
+            }
+            1
+        }
+        None if seen => -2,
+        None => 0,
+    }
+}
+
+/// 等待完成記錄，最多 timeout_ms 毫秒；返回 1=有完成記錄, 0=逾時
+#[no_mangle]
+pub extern "C" fn ratamud_wait_completion(timeout_ms: u32) -> c_int {
+    COMMAND_QUEUE.wait(std::time::Duration::from_millis(timeout_ms as u64)) as c_int
+}
+
+/// 完成佇列的 eventfd（非空時可讀，可加入宿主的 epoll；取空佇列後自動歸零，宿主不需讀取）
+/// 返回檔案描述符，-1=此平台不支援
+#[no_mangle]
+pub extern "C" fn ratamud_completion_fd() -> c_int {
+    COMMAND_QUEUE.notify_fd()
+}
+
+/// 記憶體使用報告（JSON，各子系統位元組數；啟用 count-alloc 時含分配器統計）
+/// 以 snprintf 語意寫入 buf（含結尾 NUL，超出時截斷）
+/// 返回完整報告長度（不含 NUL），-1=遊戲尚未初始化
+#[no_mangle]
+pub extern "C" fn ratamud_memory_report(buf: *mut c_char, buf_len: usize) -> c_int {
+    let report = match GAME_WORLD.lock() {
+        Ok(guard) => match guard.as_ref() {
+            Some(world) => world.memory_report().to_json(),
+            None => return -1,
+        },
+        Err(_) => return -1,
+    };
+    write_c_str(&report, buf, buf_len)
+}
+
+/// 設定宿主分配器（需以 host-alloc feature 建置；應在 ratamud_init_game 之前呼叫）
+/// realloc_fn 可為 NULL（以 malloc + 複製 + free 代替）；malloc_fn 回傳的位址不需特別對齊（例如只有 8 位元組對齊的配置器也可以）
+/// 返回 0=成功, -1=未支援或參數為 NULL, -2=已經設定過
+#[no_mangle]
+pub extern "C" fn ratamud_set_allocator(
+    malloc_fn: Option<MallocFn>,
+    free_fn: Option<FreeFn>,
+    realloc_fn: Option<ReallocFn>,
+    user: *mut c_void,
+) -> c_int {
+    let (true, Some(malloc_fn), Some(free_fn)) = (host_alloc::INSTALLED, malloc_fn, free_fn) else {
+        return -1;
+    };
+    if host_alloc::set_hooks(malloc_fn, free_fn, realloc_fn, user) { 0 } else { -2 }
+}
+
+/// 一個世界的配置統計 (C FFI)
+#[repr(C)]
+pub struct RataAllocStats {
+    pub live_bytes: u64,
+    pub peak_bytes: u64,
+    pub alloc_count: u64,
+    pub budget: u64,
+}
+
+/// 目前遊戲世界的配置計數編號，0=尚未初始化
+#[no_mangle]
+pub extern "C" fn ratamud_world_id() -> u32 {
+    GAME_WORLD.lock().ok()
+        .and_then(|guard| guard.as_ref().map(|world| world.alloc_scope.id()))
+        .unwrap_or(0)
+}
+
+/// 讀取世界的配置統計
+/// 返回 0=成功, -1=未以 host-alloc 建置、編號無效或 out 為 NULL
+#[no_mangle]
+pub extern "C" fn ratamud_world_alloc_stats(world: u32, out: *mut RataAllocStats) -> c_int {
+    let (true, Some(stats), false) = (host_alloc::INSTALLED, host_alloc::world_stats(world), out.is_null()) else {
+        return -1;
+    };
+    unsafe {
+        *out = RataAllocStats {
+            live_bytes: stats.live_bytes as u64,
+            peak_bytes: stats.peak_bytes as u64,
+            alloc_count: stats.alloc_count as u64,
+            budget: stats.budget as u64,
+        };
+    }
+    0
+}
+
+/// 設定世界的記憶體預算（位元組，0=不限制）；超過時 ratamud_input_command 不執行命令並返回 -2
+/// 返回 0=成功, -1=編號無效
+#[no_mangle]
+pub extern "C" fn ratamud_set_world_budget(world: u32, bytes: u64) -> c_int {
+    if host_alloc::set_world_budget(world, bytes as usize) { 0 } else { -1 }
+}
+
+/// 以 snprintf 語意把字串寫入 buf，返回完整長度（不含 NUL）
+fn write_c_str(s: &str, buf: *mut c_char, buf_len: usize) -> c_int {
+    if !buf.is_null() && buf_len > 0 {
+        let n = s.len().min(buf_len - 1);
+        unsafe {
+            std::ptr::copy_nonoverlapping(s.as_ptr(), buf as *mut u8, n);
+            *buf.add(n) = 0;
+        }
+    }
+    s.len() as c_int
+}
+
+/// 矩形範圍 (C FFI)：左上角與寬高
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct RataRect {
+    pub x: u32,
+    pub y: u32,
+    pub w: u32,
+    pub h: u32,
+}
+
+impl RataRect {
+    /// 轉成含邊界的矩形（寬或高為 0 時為 None）；右下角以飽和運算計算，32 位元平台上不溢位
+    fn to_rect(self) -> Option<Rect> {
+        if self.w == 0 || self.h == 0 {
+            return None;
+        }
+        let (x, y) = (self.x as usize, self.y as usize);
+        Some(Rect::new(x, y, x.saturating_add(self.w as usize - 1), y.saturating_add(self.h as usize - 1)))
+    }
+}
+
+/// 角色查詢結果的欄位陣列 (C FFI)，由呼叫者配置，每個陣列至少 cap 個元素；NULL 的欄位不寫入
+#[repr(C)]
+pub struct RataEntitySoA {
+    pub ids: *mut u32,
+    pub x: *mut u32,
+    pub y: *mut u32,
+    pub hp: *mut i32,
+    pub max_hp: *mut i32,
+    pub flags: *mut u32,
+}
+
+/// 取得地圖名稱參數（NULL 表示目前地圖）
+fn map_name_arg(world: &GameWorld, map: *const c_char) -> Option<String> {
+    if map.is_null() {
+        return Some(world.current_map_name.clone());
+    }
+    unsafe { CStr::from_ptr(map) }.to_str().ok().map(str::to_string)
+}
+
+/// 批次查詢地圖上矩形範圍內的角色，寫入呼叫者提供的欄位陣列（最多 cap 筆，引擎不配置記憶體）
+/// world 為 ratamud_world_id() 的編號：代號只在同一個世界內有效，換了世界（讀入快照）後的查詢會失敗
+/// 返回符合的角色總數（可能大於 cap），-1=編號不符、錯誤或遊戲尚未初始化
+#[no_mangle]
+pub extern "C" fn ratamud_query_entities(world: u32, map: *const c_char, rect: RataRect, out: *mut RataEntitySoA, cap: usize) -> c_int {
+    let Ok(guard) = GAME_WORLD.lock() else {
+        return -1;
+    };
+    let Some(world) = guard.as_ref().filter(|w| w.alloc_scope.id() == world) else {
+        return -1;
+    };
+    let Some(map_name) = map_name_arg(world, map) else {
+        return -1;
+    };
+    let Some(rect) = rect.to_rect() else {
+        return 0;
+    };
+    let out = if cap > 0 { unsafe { out.as_ref() } } else { None };
+
+    let mut total = 0;
+    for record in bulk_query::entities_in(world, &map_name, rect) {
+        if let Some(out) = out.filter(|_| total < cap) {
+            unsafe {
+                let put = |column: *mut u32, value: u32| if !column.is_null() { *column.add(total) = value };
+                put(out.ids, record.handle);
+                put(out.x, record.x as u32);
+                put(out.y, record.y as u32);
+                put(out.flags, record.flags);
+                if !out.hp.is_null() {
+                    *out.hp.add(total) = record.hp;
+                }
+                if !out.max_hp.is_null() {
+                    *out.max_hp.add(total) = record.max_hp;
+                }
+            }
+        }
+        total += 1;
+    }
+    total as c_int
+}
+
+/// 把地圖上矩形範圍的格子狀態寫入呼叫者的緩衝區（NULL 的圖層略過）。
+/// 矩形先裁切到地圖範圍內（{0, 0, UINT32_MAX, UINT32_MAX} 即整張地圖），w、h 指裁切後的寬高：
+/// walk: 可行走位元，每列 (w + 7) / 8 個位元組，x 由小到大對應位元由低到高
+/// glyphs: 每格一個 Unicode 碼位，列優先
+/// 返回 0=成功（矩形完全在地圖外時不寫入），-1=世界編號不符、地圖未載入、緩衝區不足或遊戲尚未初始化
+#[no_mangle]
+pub extern "C" fn ratamud_query_tiles(
+    world: u32,
+    map: *const c_char,
+    rect: RataRect,
+    walk: *mut u8,
+    walk_len: usize,
+    glyphs: *mut u32,
+    glyphs_len: usize,
+) -> c_int {
+    let Ok(guard) = GAME_WORLD.lock() else {
+        return -1;
+    };
+    let Some(world) = guard.as_ref().filter(|w| w.alloc_scope.id() == world) else {
+        return -1;
+    };
+    let Some(map) = map_name_arg(world, map).and_then(|name| world.maps.get(&name)) else {
+        return -1;
+    };
+    let Some(rect) = rect.to_rect().and_then(|rect| rect.clamp(map)) else {
+        return 0;
+    };
+    if !walk.is_null() {
+        let walk = unsafe { std::slice::from_raw_parts_mut(walk, walk_len) };
+        if !bulk_query::write_walk_bits(map, rect, walk) {
+            return -1;
+        }
+    }
+    if !glyphs.is_null() {
+        let glyphs = unsafe { std::slice::from_raw_parts_mut(glyphs, glyphs_len) };
+        if !bulk_query::write_glyphs(map, rect, glyphs) {
+            return -1;
+        }
+    }
+    0
+}
+
+/// 取得地圖（NULL 表示目前地圖，需已載入）的寬高，讓呼叫者依地圖大小配置 ratamud_query_tiles 的緩衝區
+/// 返回 0=成功，-1=世界編號不符、地圖未載入或遊戲尚未初始化（NULL 的輸出略過）
+#[no_mangle]
+pub extern "C" fn ratamud_map_size(world: u32, map: *const c_char, width: *mut u32, height: *mut u32) -> c_int {
+    let Ok(guard) = GAME_WORLD.lock() else {
+        return -1;
+    };
+    let Some(world) = guard.as_ref().filter(|w| w.alloc_scope.id() == world) else {
+        return -1;
+    };
+    let Some(map) = map_name_arg(world, map).and_then(|name| world.maps.get(&name)) else {
+        return -1;
+    };
+    unsafe {
+        if !width.is_null() {
+            *width = map.width as u32;
+        }
+        if !height.is_null() {
+            *height = map.height as u32;
+        }
+    }
+    0
+}
+
+/// 世界的物品統計 (C FFI)
+#[repr(C)]
+pub struct RataCensus {
+    pub maps_loaded: u32,
+    pub npcs: u32,
+    pub items_on_maps: u64,
+    pub items_carried: u64,
+}
+
+/// 統計世界中的角色與物品（壓力測試檢查物品守恆用）
+/// 返回 0=成功, -1=編號不符、out 為 NULL 或尚未初始化
+#[no_mangle]
+pub extern "C" fn ratamud_world_census(world: u32, out: *mut RataCensus) -> c_int {
+    if out.is_null() {
+        return -1;
+    }
+    let Ok(guard) = GAME_WORLD.lock() else {
+        return -1;
+    };
+    let Some(game_world) = guard.as_ref().filter(|w| w.alloc_scope.id() == world) else {
+        return -1;
+    };
+    let (maps_loaded, items_on_maps, items_carried) = game_world.item_census();
+    let npcs = game_world.npc_manager.iter().count() as u32;
+    unsafe { *out = RataCensus { maps_loaded: maps_loaded as u32, npcs, items_on_maps, items_carried } };
+    0
+}
+
+/// 以數字代號（同一個世界的 ratamud_query_entities 結果）取得角色 ID（snprintf 語意寫入 buf）
+/// 返回 ID 長度（不含 NUL），-1=世界編號不符、代號不存在或遊戲尚未初始化
+#[no_mangle]
+pub extern "C" fn ratamud_entity_id(world: u32, handle: u32, buf: *mut c_char, buf_len: usize) -> c_int {
+    let Ok(guard) = GAME_WORLD.lock() else {
+        return -1;
+    };
+    let game_world = guard.as_ref().filter(|w| w.alloc_scope.id() == world);
+    match game_world.and_then(|world| world.npc_manager.id_for_handle(handle)) {
+        Some(id) => write_c_str(id, buf, buf_len),
+        None => -1,
+    }
+}
+
+/// 註冊擴充命令：輸入的第一個字為 name 時，以切分好的參數呼叫 command（優先於同名的內建命令）
+/// command 為 NULL 時移除該命令；command 在引擎執行緒上、持有世界鎖時被呼叫，
+/// 其中只可呼叫 ratamud_emit_output 送出輸出，不可呼叫其他 ratamud_* 函數
+/// 返回 0=成功, -1=name 為 NULL 或不是 UTF-8
+#[no_mangle]
+pub extern "C" fn ratamud_register_command(name: *const c_char, command: Option<NativeCommandFn>, user: *mut c_void) -> c_int {
+    if name.is_null() {
+        return -1;
+    }
+    let Ok(name) = unsafe { CStr::from_ptr(name) }.to_str() else {
+        return -1;
+    };
+    match command {
+        Some(command) => command_registry::register_native(name, command, user),
+        None => {
+            command_registry::unregister(name);
+        }
+    }
+    0
+}
+
+/// 送出輸出（zone: MAIN/LOG/STATUS/SIDE），供擴充命令使用；經提交佇列執行時收進該命令的完成記錄
+/// 返回 0=成功, -1=參數為 NULL、不是 UTF-8 或區域不存在
+#[no_mangle]
+pub extern "C" fn ratamud_emit_output(zone: *const c_char, text: *const c_char) -> c_int {
+    use crate::core_output::OutputZone;
+
+    if zone.is_null() || text.is_null() {
+        return -1;
+    }
+    let (zone, text) = unsafe { (CStr::from_ptr(zone), CStr::from_ptr(text)) };
+    let (Ok(zone), Ok(text)) = (zone.to_str(), text.to_str()) else {
+        return -1;
+    };
+    let zone = match zone {
+        "MAIN" => OutputZone::Main,
+        "LOG" => OutputZone::Log,
+        "STATUS" => OutputZone::Status,
+        "SIDE" => OutputZone::Side,
+        _ => return -1,
+    };
+    core_output::trigger_output(zone, text);
+    0
+}
+
+/// 設定原生 AI 外掛：每個 AI tick 以一批 NPC 視圖呼叫 decide 一次（NULL 表示改回內建策略）
+/// 外掛在引擎執行緒上、持有世界鎖時被呼叫，不可再呼叫 ratamud_* 函數
+#[no_mangle]
+pub extern "C" fn ratamud_set_ai_plugin(decide: Option<AiDecideFn>, user: *mut c_void) {
+    native_ai::set_plugin(decide, user);
+}
+
+/// 執行一次 NPC AI（原生外掛或內建策略），行為的訊息經輸出回調送出
+/// 返回產生的訊息數，-1=遊戲尚未初始化
+#[no_mangle]
+pub extern "C" fn ratamud_run_ai() -> c_int {
+    use crate::core_output::OutputZone;
+
+    let Ok(mut guard) = GAME_WORLD.lock() else {
+        return -1;
+    };
+    let Some(game_world) = guard.as_mut() else {
+        return -1;
+    };
+    let _scope = game_world.alloc_scope.enter();
+    let builtin = builtin_ai(game_world);
+    let messages = game_world.run_ai_tick(&builtin);
+    for message in &messages {
+        let zone = if message.is_log() { OutputZone::Log } else { OutputZone::Main };
+        core_output::trigger_output(zone, &message.to_display_text());
+    }
+    messages.len() as c_int
+}
+
+fn builtin_ai(game_world: &GameWorld) -> Arc<NpcAiController> {
+    use crate::rng::RngStream;
+    let mut builtin = BUILTIN_AI.lock().unwrap_or_else(|e| e.into_inner());
+    let world = game_world.alloc_scope.id();
+    match builtin.as_ref() {
+        Some((id, controller)) if *id == world => Arc::clone(controller),
+        _ => {
+            let controller = Arc::new(NpcAiController::with_rng(&game_world.rng.stream(RngStream::NpcAi).split()));
+            *builtin = Some((world, Arc::clone(&controller)));
+            controller
+        }
+    }
+}
+
+/// ratamud_pump 的結果 (C FFI)
+#[repr(C)]
+#[derive(Default)]
+pub struct RataPumpStats {
+    pub commands_run: u32,
+    pub events_run: u32,
+    pub ai_ticks: u32,
+    pub queued_commands: u32,  // 剩餘的已提交命令
+    pub pending_events: u32,   // 剩餘的到期事件
+    pub ai_pending: u32,       // 1=已到執行時間的 AI tick 尚未執行
+    pub elapsed_us: u64,
+}
+
+/// 在 budget_us 微秒內依優先順序推進世界：提交的命令、時鐘、到期事件、NPC AI（每 5 秒一次）
+/// 預算用完即返回，剩下的工作留到下一次呼叫；命令的輸出進入完成佇列，其餘經輸出回調送出
+/// out 可為 NULL；返回剩餘的工作數（0=已閒置），-1=編號不符或尚未初始化
+#[no_mangle]
+pub extern "C" fn ratamud_pump(world: u32, budget_us: u64, out: *mut RataPumpStats) -> c_int {
+    let Ok(mut guard) = GAME_WORLD.lock() else {
+        return -1;
+    };
+    let Some(game_world) = guard.as_mut().filter(|w| w.alloc_scope.id() == world) else {
+        return -1;
+    };
+    let Ok(mut pump) = PUMP.lock() else {
+        return -1;
+    };
+    let builtin = builtin_ai(game_world);
+    let mut output = core_output::CoreOutputManager::new();
+    let report = pump.run(game_world, std::time::Duration::from_micros(budget_us), &builtin, &mut output, |game_world| {
+        COMMAND_QUEUE.run(1, |submission| {
+            if submission.world == game_world.alloc_scope.id() {
+                run_command(game_world, &submission.command)
+            } else {
+                -1
+            }
+        }) == 1
+    });
+    let stats = RataPumpStats {
+        commands_run: report.commands as u32,
+        events_run: report.events as u32,
+        ai_ticks: report.ai_ticks as u32,
+        queued_commands: COMMAND_QUEUE.queued() as u32,
+        pending_events: report.pending_events as u32,
+        ai_pending: report.ai_pending as u32,
+        elapsed_us: report.elapsed.as_micros() as u64,
+    };
+    let backlog = stats.queued_commands + stats.pending_events + stats.ai_pending;
+    if !out.is_null() {
+        unsafe { *out = stats };
+    }
+    backlog as c_int
+}
+
+/// 快照寫入回調 (C FFI)：收到一段資料，返回 0=成功，非 0 中止寫入
+pub type SnapshotWriteFn = extern "C" fn(*mut c_void, *const u8, usize) -> c_int;
+/// 快照讀取回調 (C FFI)：最多填入 cap 個位元組，返回實際長度，0=資料結束
+pub type SnapshotReadFn = extern "C" fn(*mut c_void, *mut u8, usize) -> usize;
+
+/// 把資料交給宿主 writer 回調
+struct CallbackWriter {
+    writer: SnapshotWriteFn,
+    user: *mut c_void,
+}
+
+impl std::io::Write for CallbackWriter {
+    fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+        if (self.writer)(self.user, buf.as_ptr(), buf.len()) != 0 {
+            return Err(std::io::Error::other("宿主中止快照寫入"));
+        }
+        Ok(buf.len())
+    }
+
+    fn flush(&mut self) -> std::io::Result<()> {
+        Ok(())
+    }
+}
+
+/// 向宿主 reader 回調要資料
+struct CallbackReader {
+    reader: SnapshotReadFn,
+    user: *mut c_void,
+}
+
+impl std::io::Read for CallbackReader {
+    fn read(&mut self, buf: &mut [u8]) -> std::io::Result<usize> {
+        let n = (self.reader)(self.user, buf.as_mut_ptr(), buf.len());
+        if n > buf.len() {
+            return Err(std::io::Error::other("快照讀取回調返回的長度超過緩衝區"));
+        }
+        Ok(n)
+    }
+}
+
+/// 把世界寫成二進位快照，分段（每段最多 64 KiB）交給 writer 回調
+/// world 為 ratamud_world_id() 的編號；寫入期間持有世界鎖，回調中不可再呼叫 ratamud_* 函數
+/// 返回 0=成功, -1=編號不符、尚未初始化或 writer 為 NULL, -2=寫入失敗或被回調中止
+#[no_mangle]
+pub extern "C" fn ratamud_snapshot_write(world: u32, writer: Option<SnapshotWriteFn>, user: *mut c_void) -> c_int {
+    let Some(writer) = writer else {
+        return -1;
+    };
+    let Ok(guard) = GAME_WORLD.lock() else {
+        return -1;
+    };
+    let Some(game_world) = guard.as_ref().filter(|w| w.alloc_scope.id() == world) else {
+        return -1;
+    };
+    let _scope = game_world.alloc_scope.enter();
+    match snapshot::write(game_world, CallbackWriter { writer, user }) {
+        Ok(()) => 0,
+        Err(_) => -2,
+    }
+}
+
+/// 由 reader 回調讀取快照，還原後取代目前的遊戲世界（讀取失敗時原世界不變）
+/// 原世界的時鐘線程改為新世界的時間繼續使用；沒有原世界時啟動新的時鐘
+/// 新世界另有配置計數編號（以 ratamud_world_id 取得）
+/// 返回 0=成功, -1=reader 為 NULL 或鎖定失敗, -2=資料損壞或不完整
+#[no_mangle]
+pub extern "C" fn ratamud_snapshot_read(reader: Option<SnapshotReadFn>, user: *mut c_void) -> c_int {
+    let Some(reader) = reader else {
+        return -1;
+    };
+    let mut game_world = match snapshot::read(CallbackReader { reader, user }) {
+        Ok(world) => world,
+        Err(e) => {
+            use crate::core_output::OutputZone;
+            core_output::trigger_output(OutputZone::Log, &format!("⚠️  快照還原失敗: {}", e));
+            return -2;
+        }
+    };
+    match GAME_WORLD.lock() {
+        Ok(mut guard) => {
+            match guard.as_mut().and_then(|old| old.time_thread.take()) {
+                Some(clock) => {
+                    clock.set_time(game_world.time.clone());
+                    game_world.time_thread = Some(clock);
+                }
+                None => game_world.start_clock(),
+            }
+            *guard = Some(game_world);
+            0
+        }
+        Err(_) => -1,
+    }
+}
+
 /// 測試輸出回調功能（無 UI 模式）
 #[no_mangle]
 pub extern "C" fn ratamud_test_output_callback() {
@@ -202,13 +842,9 @@ pub mod terminal_ui_ffi {
         use crate::input::InputHandler;
         use crate::output::OutputManager;
         use crate::world::GameWorld;
-        use crate::person;
         use crate::settings::GameSettings;
         use crate::app;
         
-        // 初始化 Person 描述資料
-        person::init_person_descriptions();
-        
         // 初始化 InputHandler, OutputManager, GameWorld, Person
         let mut output_manager = OutputManager::new();
             
@@ -232,9 +868,10 @@ pub mod terminal_ui_ffi {
         // 初始化遊戲世界
         let mut game_world = GameWorld::new();
         
-        // 嘗試加載世界元數據和時間
+        // 嘗試加載世界元數據和時間，再啟動時鐘
         let _ = game_world.load_metadata();
         let _ = game_world.load_time();
+        game_world.start_clock();
         
         // 設置初始時間顯示
         output_manager.set_current_time(game_world.format_time());
@@ -242,10 +879,12 @@ pub mod terminal_ui_ffi {
         // 載入地圖   
         match game_world.initialize_maps() {
             Ok((map_count, logs)) => {
-                for log in logs {
-                    output_manager.log(log);
+                if game_settings.verbose_startup {
+                    for log in logs {
+                        output_manager.log(log);
+                    }
                 }
-                output_manager.log(format!("已加載 {map_count} 個地圖"));
+                output_manager.log(format!("共 {map_count} 個地圖"));
             }
             Err(e) => {
                 output_manager.log(format!("⚠️  載入地圖失敗: {e}"));
@@ -260,11 +899,14 @@ pub mod terminal_ui_ffi {
         match game_world.npc_manager.initialize(&person_dir) {
             Ok((count, me)) => {
                 output_manager.log(format!("已載入 {count} 個角色"));
-                for npc in game_world.npc_manager.get_all_npcs() {
-                    output_manager.log(format!("  - {} 在位置 ({}, {})", npc.name, npc.x, npc.y));
+                if game_settings.verbose_startup {
+                    for npc in game_world.npc_manager.get_all_npcs() {
+                        output_manager.log(format!("  - {} 在位置 ({}, {})", npc.name, npc.x, npc.y));
+                    }
                 }
-                // 設定 game_world.original_player
+                // 設定 game_world.original_player，並載入角色所在的其他地圖
                 game_world.original_player = Some(me);
+                game_world.load_resident_maps();
             }
             Err(e) => {
                 eprintln!("初始化角色系統失敗: {e}");
@@ -276,7 +918,7 @@ pub mod terminal_ui_ffi {
         load_quest_internal(&mut game_world, &mut output_manager);
 
         // 載入事件腳本
-        load_event_internal(&mut game_world, &mut output_manager);
+        load_event_internal(&mut game_world, &mut output_manager, game_settings.verbose_startup);
 
         // 顯示歡迎訊息
         show_welcome_message_internal(&mut output_manager, &game_world);
@@ -366,15 +1008,17 @@ pub mod terminal_ui_ffi {
     }
 
     /// 載入事件腳本
-    fn load_event_internal(game_world: &mut crate::world::GameWorld, output_manager: &mut crate::output::OutputManager) {
+    fn load_event_internal(game_world: &mut crate::world::GameWorld, output_manager: &mut crate::output::OutputManager, verbose: bool) {
         use crate::event_loader;
         let events_dir = format!("{}/events", game_world.world_dir);
         match event_loader::EventLoader::load_from_directory(&mut game_world.event_manager, &events_dir) {
             Ok((count, event_list)) => {
                 if count > 0 {
                     output_manager.log(game_world.event_manager.show_total_loaded_events());
-                    for event_name in event_list {
-                        output_manager.log(format!("  📌 {event_name}"));
+                    if verbose {
+                        for event_name in event_list {
+                            output_manager.log(format!("  📌 {event_name}"));
+                        }
                     }
                 }
             }
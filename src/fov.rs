@@ -0,0 +1,333 @@
+// 視野（FOV）與視線計算
+// 以遞迴陰影投射（recursive shadowcasting）在地圖的可行走格上計算視野：
+// 不可行走的格子（牆、岩石、樹叢）阻擋視線，但本身看得到；超出地圖視為牆。
+// 八個八分圓各自掃描，每格只檢查一次，結果存成以觀察者為中心的 (2r+1)² 位元集合。
+//
+// FovCache 以實體 ID 快取視野，只有在以下情況才重新計算：
+// - 實體移動、換地圖或視野半徑改變
+// - 視野範圍內的牆有變化（Map::set_walkable 記錄在地圖的 WallLog）
+// look 輸出、NPC 感知（NpcView.nearby_entities）與可見性查詢共用同一份結果。
+
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex};
+use crate::map::Map;
+
+/// 牆變化記錄超過此數量時整批丟棄（快取中較舊的項目全部失效）
+const MAX_WALL_EDITS: usize = 256;
+
+static NEXT_WALL_LOG_ID: AtomicU64 = AtomicU64::new(1);
+
+/// 地圖的牆變化記錄（不存檔）：每次可行走性改變遞增世代並記下位置
+#[derive(Debug)]
+pub struct WallLog {
+    id: u64,                     // 地圖實例編號（重新載入或複製的地圖不共用快取）
+    base: u64,                   // edits[0] 的世代
+    edits: Vec<(usize, usize, usize, usize)>,  // 改變的矩形 (x0, y0, x1, y1)，含邊界
+}
+
+impl Default for WallLog {
+    fn default() -> Self {
+        WallLog { id: NEXT_WALL_LOG_ID.fetch_add(1, Ordering::Relaxed), base: 0, edits: Vec::new() }
+    }
+}
+
+impl Clone for WallLog {
+    /// 複製的地圖之後可能各自改變，使用新的編號
+    fn clone(&self) -> Self {
+        WallLog { base: self.generation(), ..WallLog::default() }
+    }
+}
+
+impl WallLog {
+    /// 目前的世代
+    pub fn generation(&self) -> u64 {
+        self.base + self.edits.len() as u64
+    }
+
+    pub fn record(&mut self, x: usize, y: usize) {
+        self.record_region(x, y, x, y);
+    }
+
+    /// 記錄一整個矩形的改變（區域編輯只記一筆）
+    pub fn record_region(&mut self, x0: usize, y0: usize, x1: usize, y1: usize) {
+        if self.edits.len() >= MAX_WALL_EDITS {
+            self.base = self.generation();
+            self.edits.clear();
+        }
+        self.edits.push((x0, y0, x1, y1));
+    }
+
+    /// 自某世代以來，指定範圍內（含邊界）是否有牆改變；無法判斷時視為有
+    fn changed_near(&self, id: u64, since: u64, x0: usize, y0: usize, x1: usize, y1: usize) -> bool {
+        if id != self.id || since < self.base || since > self.generation() {
+            return true;
+        }
+        self.edits[(since - self.base) as usize..].iter()
+            .any(|&(ex0, ey0, ex1, ey1)| ex0 <= x1 && ex1 >= x0 && ey0 <= y1 && ey1 >= y0)
+    }
+}
+
+/// 以觀察者為中心的可見格集合
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct VisibleSet {
+    origin: (usize, usize),
+    radius: usize,
+    bits: Vec<u64>,  // (2r+1)² 位元，列優先，左上角為 (origin - r)
+}
+
+impl VisibleSet {
+    fn new(x: usize, y: usize, radius: usize) -> Self {
+        let side = 2 * radius + 1;
+        VisibleSet { origin: (x, y), radius, bits: vec![0; (side * side).div_ceil(64)] }
+    }
+
+    fn index(&self, x: i64, y: i64) -> Option<usize> {
+        let r = self.radius as i64;
+        let dx = x - self.origin.0 as i64 + r;
+        let dy = y - self.origin.1 as i64 + r;
+        let side = 2 * r + 1;
+        (dx >= 0 && dy >= 0 && dx < side && dy < side).then(|| (dy * side + dx) as usize)
+    }
+
+    fn insert(&mut self, x: i64, y: i64) {
+        if let Some(i) = self.index(x, y) {
+            self.bits[i / 64] |= 1 << (i % 64);
+        }
+    }
+
+    /// 該格是否可見
+    pub fn contains(&self, x: usize, y: usize) -> bool {
+        self.index(x as i64, y as i64).is_some_and(|i| self.bits[i / 64] & (1 << (i % 64)) != 0)
+    }
+
+    /// 所有可見格（由上而下、由左而右）
+    pub fn iter(&self) -> impl Iterator<Item = (usize, usize)> + '_ {
+        // 只有地圖內的格子會被標記，origin + 偏移必定不小於 radius
+        let side = 2 * self.radius + 1;
+        let (ox, oy, r) = (self.origin.0, self.origin.1, self.radius);
+        (0..side * side)
+            .filter(|&i| self.bits[i / 64] & (1 << (i % 64)) != 0)
+            .map(move |i| (ox + i % side - r, oy + i / side - r))
+    }
+
+    /// 可見格數量
+    #[allow(dead_code)]
+    pub fn len(&self) -> usize {
+        self.bits.iter().map(|b| b.count_ones() as usize).sum()
+    }
+
+    #[allow(dead_code)]
+    pub fn is_empty(&self) -> bool {
+        self.bits.iter().all(|&b| b == 0)
+    }
+
+    pub fn origin(&self) -> (usize, usize) {
+        self.origin
+    }
+
+    pub fn radius(&self) -> usize {
+        self.radius
+    }
+}
+
+/// 八分圓的座標轉換 (xx, xy, yx, yy)
+const OCTANTS: [(i64, i64, i64, i64); 8] = [
+    (1, 0, 0, 1), (0, 1, 1, 0), (0, -1, 1, 0), (-1, 0, 0, 1),
+    (-1, 0, 0, -1), (0, -1, -1, 0), (0, 1, -1, 0), (1, 0, 0, -1),
+];
+
+/// 計算 (x, y) 在半徑 radius（歐氏距離）內的視野
+pub fn compute(map: &Map, x: usize, y: usize, radius: usize) -> VisibleSet {
+    let mut visible = VisibleSet::new(x, y, radius);
+    if map.get_point(x, y).is_none() {
+        return visible;
+    }
+    visible.insert(x as i64, y as i64);
+    let mut caster = Caster { map, origin: (x as i64, y as i64), radius: radius as i64, visible: &mut visible };
+    for octant in OCTANTS {
+        caster.cast(1, 1.0, 0.0, octant);
+    }
+    visible
+}
+
+struct Caster<'a> {
+    map: &'a Map,
+    origin: (i64, i64),
+    radius: i64,
+    visible: &'a mut VisibleSet,
+}
+
+impl Caster<'_> {
+    fn opaque(&self, x: i64, y: i64) -> bool {
+        x < 0 || y < 0 || !self.map.is_walkable(x as usize, y as usize)
+    }
+
+    /// 掃描一個八分圓從第 row 列開始、斜率介於 start 與 end 之間的扇形
+    fn cast(&mut self, row: i64, mut start: f64, end: f64, (xx, xy, yx, yy): (i64, i64, i64, i64)) {
+        if start < end {
+            return;
+        }
+        let radius_sq = self.radius * self.radius;
+        let mut next_start = start;
+        for j in row..=self.radius {
+            let dy = -j;
+            let mut blocked = false;
+            for dx in -j..=0 {
+                let (mx, my) = (self.origin.0 + dx * xx + dy * xy, self.origin.1 + dx * yx + dy * yy);
+                let left = (dx as f64 - 0.5) / (dy as f64 + 0.5);
+                let right = (dx as f64 + 0.5) / (dy as f64 - 0.5);
+                if start < right {
+                    continue;
+                }
+                if end > left {
+                    break;
+                }
+                let in_bounds = mx >= 0 && my >= 0 && (mx as usize) < self.map.width && (my as usize) < self.map.height;
+                if in_bounds && dx * dx + dy * dy <= radius_sq {
+                    self.visible.insert(mx, my);
+                }
+                let opaque = self.opaque(mx, my);
+                if blocked {
+                    if opaque {
+                        next_start = right;
+                    } else {
+                        blocked = false;
+                        start = next_start;
+                    }
+                } else if opaque && j < self.radius {
+                    blocked = true;
+                    self.cast(j + 1, start, left, (xx, xy, yx, yy));
+                    next_start = right;
+                }
+            }
+            if blocked {
+                break;
+            }
+        }
+    }
+}
+
+/// 快取項目
+#[derive(Debug)]
+struct CachedFov {
+    map: String,
+    wall_log: u64,
+    generation: u64,
+    visible: Arc<VisibleSet>,
+}
+
+/// 以實體 ID 快取的視野（查詢只需 &self，可在建立 NpcView 時使用）
+#[derive(Debug, Default)]
+pub struct FovCache {
+    entries: Mutex<HashMap<String, CachedFov>>,
+    hits: AtomicU64,
+    misses: AtomicU64,
+}
+
+impl Clone for FovCache {
+    /// 複製的世界從空快取開始（地圖的 WallLog 也會換新編號）
+    fn clone(&self) -> Self {
+        FovCache::default()
+    }
+}
+
+impl FovCache {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// 實體在 (x, y) 的視野；位置、地圖、半徑不變且範圍內的牆沒有變化時直接返回快取
+    pub fn visible(&self, entity_id: &str, map: &Map, x: usize, y: usize, radius: usize) -> Arc<VisibleSet> {
+        let mut entries = self.entries.lock().unwrap_or_else(|e| e.into_inner());
+        let generation = map.walls.generation();
+        if let Some(entry) = entries.get_mut(entity_id) {
+            let fov = &entry.visible;
+            if entry.map == map.name && fov.origin() == (x, y) && fov.radius() == radius
+                && !map.walls.changed_near(entry.wall_log, entry.generation,
+                    x.saturating_sub(radius), y.saturating_sub(radius), x + radius, y + radius)
+            {
+                entry.generation = generation;
+                self.hits.fetch_add(1, Ordering::Relaxed);
+                return Arc::clone(&entry.visible);
+            }
+        }
+        self.misses.fetch_add(1, Ordering::Relaxed);
+        let visible = Arc::new(compute(map, x, y, radius));
+        let entry = CachedFov { map: map.name.clone(), wall_log: map.walls.id, generation, visible: Arc::clone(&visible) };
+        entries.insert(entity_id.to_string(), entry);
+        visible
+    }
+
+    /// 移除實體的快取（實體離開世界時）
+    pub fn forget(&self, entity_id: &str) {
+        self.entries.lock().unwrap_or_else(|e| e.into_inner()).remove(entity_id);
+    }
+
+    /// (命中, 重新計算) 次數
+    #[allow(dead_code)]
+    pub fn stats(&self) -> (u64, u64) {
+        (self.hits.load(Ordering::Relaxed), self.misses.load(Ordering::Relaxed))
+    }
+}
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for WallLog {
+    fn heap_size(&self) -> usize {
+        self.edits.capacity() * std::mem::size_of::<(usize, usize, usize, usize)>()
+    }
+}
+
+impl HeapSize for FovCache {
+    fn heap_size(&self) -> usize {
+        let entries = self.entries.lock().unwrap_or_else(|e| e.into_inner());
+        entries.capacity() * std::mem::size_of::<(String, CachedFov)>()
+            + entries.iter()
+                .map(|(id, e)| id.heap_size() + e.map.heap_size() + e.visible.bits.capacity() * 8)
+                .sum::<usize>()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::rng::WorldRng;
+
+    fn open_map(width: usize, height: usize) -> Map {
+        let mut map = Map::new("test".to_string(), width, height, &WorldRng::new(1));
+        for y in 0..height {
+            for x in 0..width {
+                map.set_walkable(x, y, true);
+            }
+        }
+        map
+    }
+
+    #[test]
+    fn test_shadowcasting_and_cache() {
+        let mut map = open_map(11, 11);
+        let fov = compute(&map, 5, 5, 4);
+        assert!(fov.contains(5, 5) && fov.contains(9, 5) && fov.contains(5, 1));
+        assert!(!fov.contains(9, 9));  // 超出歐氏半徑
+        assert_eq!(fov.iter().count(), fov.len());
+        assert!(fov.iter().all(|(x, y)| fov.contains(x, y)));
+
+        // 東側的牆擋住後方，但牆本身可見
+        map.set_walkable(7, 5, false);
+        let fov = compute(&map, 5, 5, 4);
+        assert!(fov.contains(7, 5));
+        assert!(!fov.contains(8, 5) && !fov.contains(9, 5));
+        assert!(fov.contains(8, 3));
+
+        // 快取：位置不變時命中；遠處的牆變化不影響，附近的牆變化重新計算
+        let cache = FovCache::new();
+        let first = cache.visible("npc", &map, 5, 5, 4);
+        map.set_walkable(0, 10, false);
+        assert!(Arc::ptr_eq(&first, &cache.visible("npc", &map, 5, 5, 4)));
+        map.set_walkable(7, 5, true);
+        let reopened = cache.visible("npc", &map, 5, 5, 4);
+        assert!(reopened.contains(9, 5));
+        assert_eq!(cache.stats(), (1, 2));
+    }
+}
@@ -0,0 +1,374 @@
+// 宿主提供的分配器（C API：ratamud_set_allocator）與每個世界的配置計數
+// 啟用 host-alloc feature 時 HostAllocator 安裝為全域分配器：宿主設定了 malloc/free/realloc 之後，
+// 引擎的所有配置都經由宿主（追蹤用 arena、每租戶上限）；未設定時使用系統分配器。
+//
+// 每個區塊前面加 16 位元組的標頭，記下原始區塊位址、來源（系統或宿主）與所屬世界：
+// - 引擎已經用系統分配器配置過之後才設定宿主分配器也安全：舊區塊仍由系統釋放
+// - 釋放時扣回配置當時所屬世界的計數；執行緒目前所屬的世界由 AllocScope::enter 設定
+//   （GameWorld::execute_command 與 C API 的進入點），背景執行緒的配置不屬於任何世界
+// 世界計數放在固定大小的表中，配置路徑上不會再配置記憶體。世界被丟棄時歸還表中的位置，
+// 編號的高 16 位是位置的世代：位置重新使用後，舊世界遺留區塊的釋放不會扣到新世界的計數。
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::cell::Cell;
+use std::ffi::c_void;
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicUsize, Ordering};
+use once_cell::sync::OnceCell;
+
+use crate::mem_stats::CountingAllocator;
+
+/// 宿主分配函數（C 端簽名：size, user → ptr；回傳的位址不需特別對齊，對齊由標頭前的預留空間處理）
+pub type MallocFn = unsafe extern "C" fn(usize, *mut c_void) -> *mut c_void;
+pub type FreeFn = unsafe extern "C" fn(*mut c_void, *mut c_void);
+pub type ReallocFn = unsafe extern "C" fn(*mut c_void, usize, *mut c_void) -> *mut c_void;
+
+struct Hooks {
+    malloc: MallocFn,
+    free: FreeFn,
+    realloc: Option<ReallocFn>,  // 未提供時以 malloc + 複製 + free 代替
+    user: usize,                 // 宿主的 user 指標（原樣傳回）
+}
+
+static HOOKS: OnceCell<Hooks> = OnceCell::new();
+
+/// 設定宿主分配器（每個程序只能設定一次，應在初始化遊戲之前呼叫）；返回是否設定成功
+pub fn set_hooks(malloc: MallocFn, free: FreeFn, realloc: Option<ReallocFn>, user: *mut c_void) -> bool {
+    HOOKS.set(Hooks { malloc, free, realloc, user: user as usize }).is_ok()
+}
+
+/// 是否安裝了 HostAllocator（否則世界計數不會更新）
+pub const INSTALLED: bool = cfg!(feature = "host-alloc");
+
+// ==================== 世界計數 ====================
+
+/// 可同時分別計數的世界數；位置 1..MAX_WORLDS，編號 0 表示不屬於任何世界
+pub const MAX_WORLDS: usize = 256;
+
+/// 編號中世代所在的位移（低 16 位是位置）
+const GENERATION_SHIFT: u32 = 16;
+
+struct WorldCounters {
+    live: AtomicUsize,
+    peak: AtomicUsize,
+    allocs: AtomicUsize,
+    budget: AtomicUsize,      // 0 = 不限制
+    generation: AtomicU32,    // 每次歸還位置時加一
+    in_use: AtomicBool,
+}
+
+#[allow(clippy::declare_interior_mutable_const)]
+const EMPTY_COUNTERS: WorldCounters = WorldCounters {
+    live: AtomicUsize::new(0),
+    peak: AtomicUsize::new(0),
+    allocs: AtomicUsize::new(0),
+    budget: AtomicUsize::new(0),
+    generation: AtomicU32::new(0),
+    in_use: AtomicBool::new(false),
+};
+
+static WORLDS: [WorldCounters; MAX_WORLDS] = [EMPTY_COUNTERS; MAX_WORLDS];
+
+/// 編號對應的計數（編號為 0、位置無效或世代已過時返回 None）
+fn counters(id: u32) -> Option<&'static WorldCounters> {
+    let slot = (id & ((1 << GENERATION_SHIFT) - 1)) as usize;
+    WORLDS.get(slot)
+        .filter(|counters| slot != 0 && counters.generation.load(Ordering::Relaxed) & 0xFFFF == id >> GENERATION_SHIFT)
+}
+
+thread_local! {
+    static CURRENT_WORLD: Cell<u32> = const { Cell::new(0) };
+}
+
+fn current_world() -> u32 {
+    CURRENT_WORLD.try_with(Cell::get).unwrap_or(0)
+}
+
+/// 世界的配置計數編號（同時存在超過 MAX_WORLDS - 1 個世界時，多出的世界不分別計數）
+#[derive(Debug)]
+pub struct AllocScope {
+    id: u32,
+}
+
+impl Default for AllocScope {
+    /// 取得第一個空出的位置，計數從零開始
+    fn default() -> Self {
+        for (slot, counters) in WORLDS.iter().enumerate().skip(1) {
+            if counters.in_use.compare_exchange(false, true, Ordering::Acquire, Ordering::Relaxed).is_ok() {
+                for counter in [&counters.live, &counters.peak, &counters.allocs, &counters.budget] {
+                    counter.store(0, Ordering::Relaxed);
+                }
+                let generation = counters.generation.load(Ordering::Relaxed) & 0xFFFF;
+                return AllocScope { id: generation << GENERATION_SHIFT | slot as u32 };
+            }
+        }
+        AllocScope { id: 0 }
+    }
+}
+
+impl Drop for AllocScope {
+    /// 歸還位置；先換世代，之後釋放的舊區塊不再計入
+    fn drop(&mut self) {
+        if let Some(counters) = counters(self.id) {
+            counters.generation.fetch_add(1, Ordering::Relaxed);
+            counters.in_use.store(false, Ordering::Release);
+        }
+    }
+}
+
+impl Clone for AllocScope {
+    /// 複製的世界另外計數
+    fn clone(&self) -> Self {
+        AllocScope::default()
+    }
+}
+
+impl AllocScope {
+    pub fn id(&self) -> u32 {
+        self.id
+    }
+
+    /// 之後本執行緒的配置計入此世界，直到返回的守衛被丟棄（可巢狀）
+    pub fn enter(&self) -> ScopeGuard {
+        ScopeGuard { previous: CURRENT_WORLD.with(|current| current.replace(self.id)) }
+    }
+}
+
+pub struct ScopeGuard {
+    previous: u32,
+}
+
+impl Drop for ScopeGuard {
+    fn drop(&mut self) {
+        let _ = CURRENT_WORLD.try_with(|current| current.set(self.previous));
+    }
+}
+
+/// 一個世界的配置統計
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct WorldAllocStats {
+    pub live_bytes: usize,
+    pub peak_bytes: usize,
+    pub alloc_count: usize,
+    pub budget: usize,
+}
+
+/// 讀取世界的配置統計（編號無效或世界已丟棄時返回 None）
+pub fn world_stats(id: u32) -> Option<WorldAllocStats> {
+    let counters = counters(id)?;
+    Some(WorldAllocStats {
+        live_bytes: counters.live.load(Ordering::Relaxed),
+        peak_bytes: counters.peak.load(Ordering::Relaxed),
+        alloc_count: counters.allocs.load(Ordering::Relaxed),
+        budget: counters.budget.load(Ordering::Relaxed),
+    })
+}
+
+/// 設定世界的記憶體預算（0 = 不限制）；返回編號是否有效
+pub fn set_world_budget(id: u32, bytes: usize) -> bool {
+    match counters(id) {
+        Some(counters) => {
+            counters.budget.store(bytes, Ordering::Relaxed);
+            true
+        }
+        None => false,
+    }
+}
+
+/// 世界目前的配置是否已超過預算
+pub fn over_budget(id: u32) -> bool {
+    world_stats(id).is_some_and(|stats| stats.budget != 0 && stats.live_bytes > stats.budget)
+}
+
+fn record_alloc(world: u32, size: usize) {
+    CountingAllocator::record_alloc(size);
+    if let Some(counters) = counters(world) {
+        counters.allocs.fetch_add(1, Ordering::Relaxed);
+        let live = counters.live.fetch_add(size, Ordering::Relaxed) + size;
+        counters.peak.fetch_max(live, Ordering::Relaxed);
+    }
+}
+
+fn record_dealloc(world: u32, size: usize) {
+    CountingAllocator::record_dealloc(size);
+    if let Some(counters) = counters(world) {
+        counters.live.fetch_sub(size, Ordering::Relaxed);
+    }
+}
+
+// ==================== 分配器 ====================
+
+/// 標頭大小（也是使用者區塊的最小對齊）
+const HEADER: usize = 16;
+
+/// 緊接在使用者區塊之前的標頭
+#[repr(C)]
+struct Header {
+    raw: *mut u8,    // 原始區塊位址
+    world: u32,      // 所屬世界
+    from_host: u32,  // 1 = 由宿主配置
+}
+
+/// 經由宿主函數（未設定時為系統分配器）配置，並記錄全域與每個世界的計數
+#[cfg_attr(not(feature = "host-alloc"), allow(dead_code))]
+pub struct HostAllocator;
+
+impl HostAllocator {
+    /// 原始區塊大小：標頭 + 資料 + 對齊用的預留空間（宿主的 malloc 可能只有 8 位元組對齊）
+    fn raw_size(layout: Layout) -> usize {
+        layout.size() + HEADER + layout.align().max(HEADER) - 1
+    }
+
+    /// 使用者區塊在原始區塊中的位移：標頭之後第一個對齊的位址
+    fn data_offset(raw: *mut u8, align: usize) -> usize {
+        (raw as usize + HEADER).next_multiple_of(align.max(HEADER)) - raw as usize
+    }
+
+    unsafe fn raw_alloc(size: usize) -> (*mut u8, bool) {
+        match HOOKS.get() {
+            Some(hooks) => ((hooks.malloc)(size, hooks.user as *mut c_void) as *mut u8, true),
+            None => (System.alloc(Layout::from_size_align_unchecked(size, HEADER)), false),
+        }
+    }
+
+    unsafe fn raw_free(raw: *mut u8, size: usize, from_host: bool) {
+        match HOOKS.get() {
+            Some(hooks) if from_host => (hooks.free)(raw as *mut c_void, hooks.user as *mut c_void),
+            _ => System.dealloc(raw, Layout::from_size_align_unchecked(size, HEADER)),
+        }
+    }
+
+    unsafe fn header<'a>(ptr: *mut u8) -> &'a mut Header {
+        &mut *(ptr.sub(HEADER) as *mut Header)
+    }
+}
+
+unsafe impl GlobalAlloc for HostAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let (raw, from_host) = Self::raw_alloc(Self::raw_size(layout));
+        if raw.is_null() {
+            return raw;
+        }
+        let ptr = raw.add(Self::data_offset(raw, layout.align()));
+        let world = current_world();
+        (ptr.sub(HEADER) as *mut Header).write(Header { raw, world, from_host: from_host as u32 });
+        record_alloc(world, layout.size());
+        ptr
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        let header = Self::header(ptr);
+        record_dealloc(header.world, layout.size());
+        Self::raw_free(header.raw, Self::raw_size(layout), header.from_host != 0);
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        let header = Self::header(ptr);
+        let (world, from_host) = (header.world, header.from_host != 0);
+        let hooks = HOOKS.get();
+        let host_realloc = hooks.and_then(|hooks| hooks.realloc);
+        // 原地擴縮：資料隨原始區塊一起搬移，新位址的對齊不同時在區塊內移到對齊的位置
+        if layout.align() <= HEADER && (!from_host || host_realloc.is_some()) {
+            let offset = ptr as usize - header.raw as usize;
+            let new_raw_size = Self::raw_size(Layout::from_size_align_unchecked(new_size, layout.align()));
+            let raw = match (from_host, hooks, host_realloc) {
+                (true, Some(hooks), Some(realloc)) => {
+                    realloc(header.raw as *mut c_void, new_raw_size, hooks.user as *mut c_void) as *mut u8
+                }
+                _ => System.realloc(header.raw, Layout::from_size_align_unchecked(Self::raw_size(layout), HEADER), new_raw_size),
+            };
+            if raw.is_null() {
+                return raw;
+            }
+            let new_offset = Self::data_offset(raw, layout.align());
+            if new_offset != offset {
+                std::ptr::copy(raw.add(offset), raw.add(new_offset), layout.size().min(new_size));
+            }
+            let ptr = raw.add(new_offset);
+            (ptr.sub(HEADER) as *mut Header).write(Header { raw, world, from_host: from_host as u32 });
+            record_dealloc(world, layout.size());
+            record_alloc(world, new_size);
+            return ptr;
+        }
+        let new_ptr = self.alloc(Layout::from_size_align_unchecked(new_size, layout.align()));
+        if !new_ptr.is_null() {
+            std::ptr::copy_nonoverlapping(ptr, new_ptr, layout.size().min(new_size));
+            self.dealloc(ptr, layout);
+        }
+        new_ptr
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    static HOST_CALLS: AtomicUsize = AtomicUsize::new(0);
+
+    extern "C" {
+        fn malloc(size: usize) -> *mut c_void;
+        fn realloc(ptr: *mut c_void, size: usize) -> *mut c_void;
+        fn free(ptr: *mut c_void);
+    }
+
+    // 模擬只有 8 位元組對齊的宿主：回傳的位址都是 16 的倍數再加 8
+    unsafe extern "C" fn host_malloc(size: usize, _user: *mut c_void) -> *mut c_void {
+        HOST_CALLS.fetch_add(1, Ordering::Relaxed);
+        (malloc(size + 8) as *mut u8).add(8) as *mut c_void
+    }
+
+    unsafe extern "C" fn host_realloc(ptr: *mut c_void, size: usize, _user: *mut c_void) -> *mut c_void {
+        HOST_CALLS.fetch_add(1, Ordering::Relaxed);
+        (realloc((ptr as *mut u8).sub(8) as *mut c_void, size + 8) as *mut u8).add(8) as *mut c_void
+    }
+
+    unsafe extern "C" fn host_free(ptr: *mut c_void, _user: *mut c_void) {
+        free((ptr as *mut u8).sub(8) as *mut c_void)
+    }
+
+    #[test]
+    fn test_host_allocator_counts_per_world() {
+        let allocator = HostAllocator;
+        let scope = AllocScope::default();
+        let layout = Layout::from_size_align(100, 8).unwrap();
+        unsafe {
+            // 設定宿主之前配置的區塊，之後仍由系統釋放
+            let early = {
+                let _guard = scope.enter();
+                allocator.alloc(layout)
+            };
+            assert!(set_hooks(host_malloc, host_free, Some(host_realloc), std::ptr::null_mut()));
+            let _guard = scope.enter();
+            let ptr = allocator.alloc(layout);
+            ptr.write_bytes(7, 100);
+            let ptr = allocator.realloc(ptr, layout, 300);
+            assert_eq!((ptr as usize % HEADER, *ptr.add(99)), (0, 7));
+            let wide = Layout::from_size_align(40, 64).unwrap();
+            let aligned = allocator.alloc(wide);
+            assert_eq!(aligned as usize % 64, 0);
+            assert_eq!(world_stats(scope.id()).unwrap().live_bytes, 100 + 300 + 40);
+
+            allocator.dealloc(early, layout);
+            allocator.dealloc(ptr, Layout::from_size_align(300, 8).unwrap());
+            allocator.dealloc(aligned, wide);
+        }
+        let stats = world_stats(scope.id()).unwrap();
+        assert_eq!((stats.live_bytes, stats.peak_bytes), (0, 100 + 300 + 40));
+        assert!(HOST_CALLS.load(Ordering::Relaxed) >= 3);
+
+        assert!(set_world_budget(scope.id(), 1));
+        assert!(!over_budget(scope.id()));
+        assert!(!set_world_budget(0, 1));
+
+        // 丟棄的世界歸還位置：新世界重新使用時編號不同，舊世界遺留區塊的釋放不計入新世界
+        let (old_id, leftover) = {
+            let _guard = scope.enter();
+            (scope.id(), unsafe { allocator.alloc(layout) })
+        };
+        drop(scope);
+        assert!(world_stats(old_id).is_none());
+        let reused = (0..MAX_WORLDS).map(|_| AllocScope::default()).find(|s| s.id() & 0xFFFF == old_id & 0xFFFF).unwrap();
+        assert_ne!(reused.id(), old_id);
+        unsafe { allocator.dealloc(leftover, layout) };
+        assert_eq!(world_stats(reused.id()).unwrap().live_bytes, 0);
+    }
+}
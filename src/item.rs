@@ -1,5 +1,5 @@
 use serde::{Serialize, Deserialize};
-use rand::Rng;
+use crate::rng::Rng;
 use std::sync::Mutex;
 use once_cell::sync::Lazy;
 
@@ -133,9 +133,7 @@ impl Item {
 
     // 生成隨機物品
     #[allow(dead_code)]
-    pub fn generate_random() -> Self {
-        let mut rng = rand::thread_rng();
-        
+    pub fn generate_random(rng: &Rng) -> Self {
         let items = vec![
             // 雜物 (name, english_name, type, description, value)
             ("舊布料", "cloth", ItemType::Miscellaneous, "一塊破舊的布料", 5),
@@ -181,7 +179,7 @@ impl Item {
             ("變醜果", "ugly_fruit", ItemType::Fruit, "傳說吃了會變醜的神奇果實", 180),
         ];
         
-        let idx = rng.gen_range(0..items.len());
+        let idx = rng.below(items.len());
         let (name, english_name, item_type, description, value) = items[idx];
         Item::new(name.to_string(), english_name.to_string(), item_type, description.to_string(), value)
     }
@@ -203,3 +201,9 @@ impl TimeUpdatable for ItemInstance {
         self.age += 1;
     }
 }
+
+impl crate::mem_stats::HeapSize for ItemInstance {
+    fn heap_size(&self) -> usize {
+        self.name.heap_size() + self.stories.heap_size()
+    }
+}
@@ -10,14 +10,36 @@ pub mod quest;
 pub mod world;
 pub mod event;
 pub mod event_loader;
+pub mod event_cache;
 pub mod event_executor;
+pub mod event_vm;
+pub mod event_batch;
 pub mod event_scheduler;
 pub mod time_updatable;
 pub mod time_thread;
 pub mod settings;
 pub mod command_handler;  // Command parsing (shared by terminal-ui and FFI)
 pub mod command_executor; // Command execution (shared by all modes)
+pub mod command_registry; // Hashed dispatch table for extension commands (Rust and C)
 pub mod ffi;
+pub mod mem_stats;       // Memory accounting (heap_size, counting allocator)
+pub mod host_alloc;      // Host-supplied allocator hooks and per-world allocation counters
+pub mod rng;             // Seeded per-world RNG streams
+pub mod map_property;    // Typed map properties and change notifications
+pub mod weather;         // Regional weather grid simulation
+pub mod spawn_pool;      // Pooled templates for event-spawned NPCs
+pub mod fov;             // Shadowcasting field of view with per-entity cache
+pub mod map_edit;        // Builder region edits with undo
+pub mod overworld;       // Procedural chunked overworld with background prefetch
+pub mod walk_bits;       // Packed per-map walkability bitset
+pub mod bulk_query;      // Allocation-free entity/tile queries for the C API
+pub mod snapshot;        // Streamed binary world snapshots for the C API
+pub mod asset_pack;      // Memory-mapped read-only asset pack shared across processes
+pub mod shared_assets;   // Immutable assets shared by every world in the process
+pub mod command_queue;   // Async command submission and tagged completion queue
+pub mod native_ai;       // Batched NPC views for host-provided AI plugins
+pub mod pump;            // Time-budgeted engine stepping for host frame loops
+pub mod worldgen;        // Synthetic world generator (tools/benchmarks)
 
 // New architecture modules
 pub mod npc_view;
@@ -37,3 +59,13 @@ pub mod app;
 
 // Core output interface (always available)
 pub mod core_output;
+
+// 計數分配器（僅在啟用 count-alloc feature 時安裝，供基準測試與記憶體報告使用）
+#[cfg(all(feature = "count-alloc", not(feature = "host-alloc")))]
+#[global_allocator]
+static GLOBAL_ALLOCATOR: mem_stats::CountingAllocator = mem_stats::CountingAllocator;
+
+// 宿主分配器（啟用 host-alloc feature 時安裝，由 ratamud_set_allocator 設定；同時提供計數）
+#[cfg(feature = "host-alloc")]
+#[global_allocator]
+static GLOBAL_ALLOCATOR: host_alloc::HostAllocator = host_alloc::HostAllocator;
@@ -14,11 +14,32 @@ mod settings;
 mod event;
 mod event_scheduler;
 mod event_executor;
+mod event_vm;
+mod event_batch;
 mod event_loader;
+mod event_cache;
 mod command_handler;  // Command parsing (shared by terminal-ui and FFI)
 mod command_executor; // Command execution (shared by all modes)
+mod command_registry; // Hashed dispatch table for extension commands (Rust and C)
 mod ffi;
 mod core_output;
+mod mem_stats;
+mod host_alloc;
+mod rng;
+mod map_property;
+mod weather;
+mod spawn_pool;
+mod fov;
+mod map_edit;
+mod overworld;
+mod walk_bits;
+mod bulk_query;
+mod snapshot;
+mod asset_pack;
+mod shared_assets;
+mod command_queue;
+mod native_ai;
+mod pump;
 
 // New architecture modules
 mod npc_view;
@@ -36,6 +57,16 @@ mod ui;
 #[cfg(feature = "terminal-ui")]
 mod app;
 
+// 計數分配器（僅在啟用 count-alloc feature 時安裝）
+#[cfg(all(feature = "count-alloc", not(feature = "host-alloc")))]
+#[global_allocator]
+static GLOBAL_ALLOCATOR: mem_stats::CountingAllocator = mem_stats::CountingAllocator;
+
+// 宿主分配器（啟用 host-alloc feature 時安裝，由 ratamud_set_allocator 設定；同時提供計數）
+#[cfg(feature = "host-alloc")]
+#[global_allocator]
+static GLOBAL_ALLOCATOR: host_alloc::HostAllocator = host_alloc::HostAllocator;
+
 #[cfg(feature = "terminal-ui")]
 fn main() -> Result<(), Box<dyn std::error::Error>> {
     let result = ffi::terminal_ui_ffi::ratamud_start_game();
@@ -1,6 +1,12 @@
-use rand::Rng;
 use serde::{Serialize, Deserialize};
-use std::collections::HashMap;
+use std::collections::{BTreeMap, HashMap};
+use std::sync::Arc;
+use once_cell::sync::Lazy;
+use crate::rng::{Rng, RngStream, WorldRng};
+use crate::map_property::MapProperties;
+use crate::fov::WallLog;
+use crate::walk_bits::WalkBits;
+use crate::shared_assets::SharedStr;
 
 // 地圖類型
 #[derive(Clone, Debug, Serialize, Deserialize, PartialEq, Eq, Hash)]
@@ -13,7 +19,7 @@ pub enum MapType {
 }
 
 // 地形類型（Point 的特殊屬性）
-#[derive(Clone, Debug, Serialize, Deserialize, PartialEq, Eq)]
+#[derive(Clone, Copy, Debug, Serialize, Deserialize, PartialEq, Eq, Hash)]
 pub enum TerrainType {
     Normal,      // 普通地形
     Farmland,    // 農地
@@ -23,6 +29,21 @@ pub enum TerrainType {
     Water,       // 水域
 }
 
+impl TerrainType {
+    /// 由名稱解析（英文或中文，建造者指令使用）
+    pub fn from_name(name: &str) -> Option<Self> {
+        match name.to_lowercase().as_str() {
+            "normal" | "普通" => Some(TerrainType::Normal),
+            "farmland" | "農地" => Some(TerrainType::Farmland),
+            "road" | "道路" => Some(TerrainType::Road),
+            "shop" | "商店" => Some(TerrainType::Shop),
+            "house" | "房屋" => Some(TerrainType::House),
+            "water" | "水域" => Some(TerrainType::Water),
+            _ => None,
+        }
+    }
+}
+
 impl MapType {
     pub fn walkable_chance(&self) -> f64 {
         match self {
@@ -37,7 +58,7 @@ impl MapType {
 
 // 描述資料庫
 pub struct DescriptionDb {
-    descriptions: HashMap<MapType, Vec<String>>,
+    descriptions: HashMap<MapType, Vec<&'static str>>,  // 常數字串，生成的地點直接借用
 }
 
 impl Default for DescriptionDb {
@@ -55,6 +76,12 @@ impl DescriptionDb {
         db
     }
 
+    /// 全域共用的描述資料庫（第一次生成地圖時才建立）
+    pub fn shared() -> &'static DescriptionDb {
+        static SHARED: Lazy<DescriptionDb> = Lazy::new(DescriptionDb::new);
+        &SHARED
+    }
+
     fn init_default_descriptions(&mut self) {
         // 預設描述 - 普通地圖
         self.descriptions.insert(
@@ -65,10 +92,7 @@ impl DescriptionDb {
                 "盛開的彩色花田", "黃色沙漠風景", "白雪皚皚的地面", "懸崖的邊緣，可以俯瞰遠景",
                 "神秘的洞穴入口", "古老的廢墟遺跡", "熱鬧的小村落", "宏偉的石砌城堡",
                 "連接兩岸的古老橋樑", "清涼的泉水湧出", "寂靜的墓地", "聳立的懸崖", "深綠色的古老森林",
-            ]
-            .iter()
-            .map(|s| s.to_string())
-            .collect(),
+            ],
         );
         
         // 森林地圖
@@ -81,10 +105,7 @@ impl DescriptionDb {
                 "蕨類植物生長茂盛", "松樹林香氣撲鼻", "橡樹叢聚集成林",
                 "野生花卉遍佈", "林間寬闊露地", "深不見底的老林", "倒下的樹樁",
                 "稀有的臺灣檜木", "山毛櫸樹下", "森林中的大石頭", "腐爛的枯木",
-            ]
-            .iter()
-            .map(|s| s.to_string())
-            .collect(),
+            ],
         );
 
         // 洞穴地圖
@@ -97,10 +118,7 @@ impl DescriptionDb {
                 "洞穴入口外透進微光", "如同地下宮殿般的空間", "岩壁上的裂縫",
                 "陡峭的滑坡", "蝙蝠棲息地傳來尖叫聲", "熔岩冷卻成的黑石",
                 "地震遺留的痕跡", "隱藏的秘密房間", "寶藏可能埋藏的地點", "複雜的地下迷宮",
-            ]
-            .iter()
-            .map(|s| s.to_string())
-            .collect(),
+            ],
         );
 
         // 沙漠地圖
@@ -113,10 +131,7 @@ impl DescriptionDb {
                 "地表的流沙危險", "沙漠中的沙棗樹", "鹽湖結晶而成", "陶土色的沙堆",
                 "被沙埋沒的建築", "開放的沙漠花卉", "岩石構成的平台", "深色的沙層",
                 "被風化的古老石頭",
-            ]
-            .iter()
-            .map(|s| s.to_string())
-            .collect(),
+            ],
         );
 
         // 山脈地圖
@@ -129,22 +144,19 @@ impl DescriptionDb {
                 "山脈的脊線清晰", "碎石坡滑落危險", "高山湖水清澈冰冷",
                 "雲霧繚繞視線不清", "松樹林密集生長", "石頭砌成的平台",
                 "冰凍的溪流結冰", "山頂視野遼闊", "吊橋晃動不穩", "彎曲的山路",
-            ]
-            .iter()
-            .map(|s| s.to_string())
-            .collect(),
+            ],
         );
     }
 
-    pub fn get_description(&self, map_type: &MapType) -> Option<String> {
-        if let Some(descs) = self.descriptions.get(map_type) {
-            if !descs.is_empty() {
-                let mut rng = rand::thread_rng();
-                let idx = rng.gen_range(0..descs.len());
-                return Some(descs[idx].clone());
-            }
-        }
-        None
+    pub fn get_description(&self, map_type: &MapType, rng: &Rng) -> Option<&'static str> {
+        self.descriptions.get(map_type)
+            .and_then(|descs| rng.pick(descs))
+            .copied()
+    }
+
+    /// 某類型的所有描述（沒有時為空）
+    pub fn descriptions(&self, map_type: &MapType) -> &[&'static str] {
+        self.descriptions.get(map_type).map(Vec::as_slice).unwrap_or(&[])
     }
 
     #[allow(dead_code)]
@@ -154,13 +166,13 @@ impl DescriptionDb {
     }
 }
 
-// Point 代表地圖上的一個點
+// Point 代表地圖上的一個點（地圖檔中的完整內容；載入後拆成共用的基底與各世界的物品）
 #[derive(Clone, Debug, Serialize, Deserialize)]
 pub struct Point {
     pub x: usize,
     pub y: usize,
     pub walkable: bool,           // 是否可移動
-    pub description: String,      // 描述
+    pub description: SharedStr,   // 描述（跨世界共用：借用資源包、描述庫或共用字串表）
     #[serde(default)]
     pub name: String,             // 地點名稱（可選）
     #[serde(default = "default_objects")]
@@ -178,12 +190,12 @@ fn default_objects() -> HashMap<String, u32> {
 
 impl Point {
     #[allow(dead_code)]
-    pub fn new(x: usize, y: usize, walkable: bool, description: String) -> Self {
+    pub fn new(x: usize, y: usize, walkable: bool, description: impl Into<SharedStr>) -> Self {
         Point {
             x,
             y,
             walkable,
-            description,
+            description: description.into(),
             name: String::new(),
             objects: HashMap::new(),
             object_ages: HashMap::new(),
@@ -192,32 +204,49 @@ impl Point {
     }
 
     // 隨機生成Point - 使用指定的地圖類型
-    pub fn random_for_type(x: usize, y: usize, map_type: &MapType) -> Self {
-        let mut rng = rand::thread_rng();
-        
-        let db = DescriptionDb::new();
-        let walkable_chance = map_type.walkable_chance();
-        
-        let walkable = rng.gen_bool(walkable_chance);
-        let description = db.get_description(map_type)
-            .unwrap_or_else(|| "未知地點".to_string());
-        
-        Point {
-            x,
-            y,
-            walkable,
-            description,
-            name: String::new(),
-            objects: HashMap::new(),
-            object_ages: HashMap::new(),
-            terrain_type: TerrainType::Normal,
-        }
+    // 描述資料庫由呼叫者建立一次後共用，可行走判定與描述各用一個亂數流
+    pub fn random_for_type(x: usize, y: usize, map_type: &MapType, db: &DescriptionDb, rng: &WorldRng) -> Self {
+        let walkable = rng.stream(RngStream::MapGen).chance(map_type.walkable_chance());
+        let description = db.get_description(map_type, rng.stream(RngStream::Description))
+            .unwrap_or("未知地點");
+        Point::new(x, y, walkable, description)
     }
 
     // 隨機生成Point - 舊方法保留相容性
     #[allow(dead_code)]
-    pub fn random(x: usize, y: usize) -> Self {
-        Self::random_for_type(x, y, &MapType::Normal)
+    pub fn random(x: usize, y: usize, rng: &WorldRng) -> Self {
+        Self::random_for_type(x, y, &MapType::Normal, DescriptionDb::shared(), rng)
+    }
+
+    /// 拆成基底與物品
+    pub fn into_parts(self) -> (Cell, PointItems) {
+        let cell = Cell { walkable: self.walkable, terrain_type: self.terrain_type, description: self.description, name: self.name };
+        (cell, PointItems { objects: self.objects, object_ages: self.object_ages })
+    }
+}
+
+/// 一格的不可變基底（同一張地圖的所有世界共用，見 shared_assets）
+#[derive(Clone, Debug, Default, PartialEq, Eq, Hash)]
+pub struct Cell {
+    pub walkable: bool,
+    pub terrain_type: TerrainType,
+    pub description: SharedStr,
+    pub name: String,
+}
+
+/// 一格上的物品（每個世界各自一份，只有放過物品的格子才有）
+#[derive(Clone, Debug, Default, PartialEq)]
+pub struct PointItems {
+    pub objects: HashMap<String, u32>,           // 物件名稱 -> 數量
+    pub object_ages: HashMap<String, Vec<u64>>,  // 物品名稱 -> 各個實例的年齡
+}
+
+/// 沒有物品的格子共用的空表
+static NO_ITEMS: Lazy<PointItems> = Lazy::new(PointItems::default);
+
+impl PointItems {
+    pub fn is_empty(&self) -> bool {
+        self.objects.is_empty() && self.object_ages.is_empty()
     }
 
     // 添加物件（預設數量1）
@@ -226,13 +255,20 @@ impl Point {
     }
     
     // 添加指定數量的物件
+    // 已有同名物件時只增加數量，不複製名稱（事件反覆生成物品時不配置記憶體）
     pub fn add_objects(&mut self, obj: String, quantity: u32) {
-        *self.objects.entry(obj.clone()).or_insert(0) += quantity;
         // 添加對應數量的年齡記錄（初始為0）
-        let ages = self.object_ages.entry(obj).or_default();
-        for _ in 0..quantity {
-            ages.push(0);
+        if let Some(count) = self.objects.get_mut(&obj) {
+            *count += quantity;
+            if let Some(ages) = self.object_ages.get_mut(&obj) {
+                ages.resize(ages.len() + quantity as usize, 0);
+                return;
+            }
+        } else {
+            self.objects.insert(obj.clone(), quantity);
         }
+        let ages = self.object_ages.entry(obj).or_default();
+        ages.resize(ages.len() + quantity as usize, 0);
     }
 
     // 移除物件（預設數量1）
@@ -251,11 +287,8 @@ impl Point {
             
             // 移除對應數量的年齡記錄（從最舊的開始移除）
             if let Some(ages) = self.object_ages.get_mut(obj_name) {
-                for _ in 0..removed {
-                    if !ages.is_empty() {
-                        ages.remove(0);  // 移除最舊的
-                    }
-                }
+                let n = (removed as usize).min(ages.len());
+                ages.drain(..n);  // 移除最舊的
                 if ages.is_empty() {
                     self.object_ages.remove(obj_name);
                 }
@@ -272,37 +305,158 @@ impl Point {
     }
 }
 
+/// 地圖上一格的唯讀檢視（基底加上這個世界的物品；序列化的格式與 Point 相同）
+#[derive(Clone, Copy, Debug, Serialize)]
+pub struct PointRef<'a> {
+    pub x: usize,
+    pub y: usize,
+    pub walkable: bool,
+    pub description: &'a str,
+    pub name: &'a str,
+    pub objects: &'a HashMap<String, u32>,
+    pub object_ages: &'a HashMap<String, Vec<u64>>,
+    pub terrain_type: TerrainType,
+}
+
+impl PointRef<'_> {
+    // 獲取物件數量
+    #[allow(dead_code)]
+    pub fn get_object_count(&self, obj_name: &str) -> u32 {
+        *self.objects.get(obj_name).unwrap_or(&0)
+    }
+}
+
+/// 地圖上可隨機放置的物品中文名稱（與 item_registry 一致）
+pub const SPAWNABLE_ITEMS: &[&str] = &[
+    "舊布料", "石子", "樹皮", "羽毛",
+    "蘋果", "麵包", "乾肉", "漿果",
+    "木劍", "鐵劍", "弓", "匕首",
+    "皮衣", "頭盔", "盾牌",
+    "治療藥水", "魔力藥水", "毒藥",
+    "火把", "繩索", "鎬", "鑰匙",
+];
+
 // Map 代表整個遊戲地圖
-#[derive(Clone, Serialize, Deserialize)]
+// 格子分成兩層：不可變的基底（可行走性、地形、描述、名稱）以 Arc 共用，同一張地圖載入到多個世界時
+// 只保存一份，修改時才複製（cell_mut）；物品與年齡每個 tick 都會變動，放在每個世界各自的稀疏表中，
+// 只有放過物品的格子佔記憶體。地圖檔的格式不變（points 仍是完整的點陣）。
+#[derive(Clone, Deserialize)]
+#[serde(try_from = "MapFile")]
 pub struct Map {
     pub name: String,
     pub width: usize,
     pub height: usize,
     pub map_type: MapType,           // 地圖類型
-    pub points: Vec<Vec<Point>>,
-    #[serde(default)]
+    cells: Arc<Vec<Cell>>,           // 基底（列優先）
+    items: BTreeMap<usize, PointItems>,  // 列優先索引 -> 該格的物品
     pub description: String,         // 地圖描述
+    pub properties: MapProperties,  // 地圖自定義屬性（例如：天氣），加入世界時綁定宣告表
+    pub walls: WallLog,             // 可行走性變化記錄（視野快取失效判斷）
+    walk_bits: WalkBits,            // 可行走性位元集合（統計、選點與視線查詢）
+}
+
+/// 地圖檔的內容
+#[derive(Deserialize)]
+struct MapFile {
+    name: String,
+    width: usize,
+    height: usize,
+    map_type: MapType,
+    points: Vec<Vec<Point>>,
+    #[serde(default)]
+    description: String,
     #[serde(default)]
-    pub properties: HashMap<String, String>,  // 地圖自定義屬性（例如：天氣）
+    properties: MapProperties,
+}
+
+impl TryFrom<MapFile> for Map {
+    type Error = String;
+
+    fn try_from(file: MapFile) -> Result<Self, String> {
+        if file.points.len() != file.height || file.points.iter().any(|row| row.len() != file.width) {
+            return Err(format!("地圖 {} 的點陣大小與寬高不符", file.name));
+        }
+        let mut map = Map::from_points(file.name, file.map_type, file.points);
+        map.description = file.description;
+        map.properties = file.properties;
+        Ok(map)
+    }
+}
+
+impl Serialize for Map {
+    fn serialize<S: serde::Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        use serde::ser::SerializeStruct;
+
+        /// 一列的檢視
+        struct Row<'a>(&'a Map, usize);
+
+        impl Serialize for Row<'_> {
+            fn serialize<S: serde::Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+                serializer.collect_seq((0..self.0.width).filter_map(|x| self.0.get_point(x, self.1)))
+            }
+        }
+
+        /// 整個點陣的檢視
+        struct Rows<'a>(&'a Map);
+
+        impl Serialize for Rows<'_> {
+            fn serialize<S: serde::Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+                serializer.collect_seq((0..self.0.height).map(|y| Row(self.0, y)))
+            }
+        }
+
+        let mut state = serializer.serialize_struct("Map", 7)?;
+        state.serialize_field("name", &self.name)?;
+        state.serialize_field("width", &self.width)?;
+        state.serialize_field("height", &self.height)?;
+        state.serialize_field("map_type", &self.map_type)?;
+        state.serialize_field("points", &Rows(self))?;
+        state.serialize_field("description", &self.description)?;
+        state.serialize_field("properties", &self.properties)?;
+        state.end()
+    }
 }
 
 impl Map {
     #[allow(dead_code)]
-    pub fn new(name: String, width: usize, height: usize) -> Self {
-        Self::new_with_type(name, width, height, MapType::Normal)
+    pub fn new(name: String, width: usize, height: usize, rng: &WorldRng) -> Self {
+        Self::new_with_type(name, width, height, MapType::Normal, rng)
     }
 
-    // 根據類型建立地圖
-    pub fn new_with_type(name: String, width: usize, height: usize, map_type: MapType) -> Self {
-        let mut points = Vec::new();
+    // 根據類型建立地圖（同一 seed 的 WorldRng 產生相同的地圖）
+    pub fn new_with_type(name: String, width: usize, height: usize, map_type: MapType, rng: &WorldRng) -> Self {
+        let db = DescriptionDb::shared();
+        let mut cells = Vec::with_capacity(width * height);
         
         for y in 0..height {
-            let mut row = Vec::new();
             for x in 0..width {
-                row.push(Point::random_for_type(x, y, &map_type));
+                cells.push(Point::random_for_type(x, y, &map_type, db, rng).into_parts().0);
+            }
+        }
+
+        Self::from_cells(name, map_type, width, cells)
+    }
+
+    /// 由已生成的點建立地圖（寬高取自 points）
+    pub fn from_points(name: String, map_type: MapType, points: Vec<Vec<Point>>) -> Self {
+        let width = points.first().map_or(0, Vec::len);
+        let mut cells = Vec::with_capacity(width * points.len());
+        let mut items = BTreeMap::new();
+        for point in points.into_iter().flatten() {
+            let (cell, stock) = point.into_parts();
+            if !stock.is_empty() {
+                items.insert(cells.len(), stock);
             }
-            points.push(row);
+            cells.push(cell);
         }
+        let mut map = Self::from_cells(name, map_type, width, cells);
+        map.items = items;
+        map
+    }
+
+    /// 由列優先的基底建立地圖（沒有物品）；內容相同的基底已有世界使用時共用那一份
+    pub fn from_cells(name: String, map_type: MapType, width: usize, cells: Vec<Cell>) -> Self {
+        let height = if width == 0 { 0 } else { cells.len() / width };
 
         // 根據地圖類型設定描述
         let description = match map_type {
@@ -318,48 +472,169 @@ impl Map {
             width,
             height,
             map_type,
-            points,
+            walk_bits: WalkBits::from_cells(&cells, width),
+            cells: crate::shared_assets::share_cells(cells),
+            items: BTreeMap::new(),
             description,
-            properties: HashMap::new(),
+            properties: MapProperties::default(),
+            walls: WallLog::default(),
         }
     }
 
-    // 獲取所有可移動的點
+    // 獲取所有可移動的點（列優先）
     pub fn get_walkable_points(&self) -> Vec<(usize, usize)> {
-        let mut walkable_points = Vec::new();
-        for y in 0..self.height {
-            for x in 0..self.width {
-                if let Some(point) = self.get_point(x, y) {
-                    if point.walkable {
-                        walkable_points.push((x, y));
-                    }
-                }
-            }
-        }
+        let mut walkable_points = Vec::with_capacity(self.walk_bits.count());
+        walkable_points.extend(self.walk_bits.iter());
         walkable_points
     }
 
-    // 獲取指定位置的Point
-    pub fn get_point(&self, x: usize, y: usize) -> Option<&Point> {
-        if x < self.width && y < self.height {
-            Some(&self.points[y][x])
+    /// 隨機選一個可行走的點（均勻分布，只取一個亂數）
+    pub fn random_walkable_point(&self, rng: &Rng) -> Option<(usize, usize)> {
+        match self.walk_bits.count() {
+            0 => None,
+            count => self.walk_bits.nth(rng.below(count)),
+        }
+    }
+
+    /// 指定位置是否可行走（超出地圖為否）
+    #[inline]
+    pub fn is_walkable(&self, x: usize, y: usize) -> bool {
+        self.walk_bits.get(x, y)
+    }
+
+    /// 不可行走格的顯示字元（依地圖類型）
+    pub fn wall_glyph(&self) -> char {
+        match self.map_type {
+            MapType::Forest => '🌲',
+            MapType::Cave => '▓',
+            MapType::Desert => '≈',
+            MapType::Mountain => '△',
+            _ => 'x',
+        }
+    }
+
+    /// 格子的顯示字元：物品 I、水 ~、牆依地圖類型、可行走為 ·
+    pub fn glyph(&self, point: &PointRef) -> char {
+        if !point.objects.is_empty() {
+            'I'
+        } else if point.terrain_type == TerrainType::Water {
+            '~'
+        } else if point.walkable {
+            '·'
         } else {
-            None
+            self.wall_glyph()
         }
     }
 
-    // 可變地獲取指定位置的Point
-    pub fn get_point_mut(&mut self, x: usize, y: usize) -> Option<&mut Point> {
-        if x < self.width && y < self.height {
-            Some(&mut self.points[y][x])
+    /// 可行走性位元集合（列掃描、矩形計數等查詢）
+    #[allow(dead_code)]
+    pub fn walkable_bits(&self) -> &WalkBits {
+        &self.walk_bits
+    }
+
+    /// 以 cell_mut 修改了矩形（含邊界）內格子的可行走性之後呼叫：同步位元集合並記錄牆的變化
+    pub fn walls_changed(&mut self, x0: usize, y0: usize, x1: usize, y1: usize) {
+        self.walk_bits.sync_rect(&self.cells, x0, y0, x1, y1);
+        self.walls.record_region(x0, y0, x1, y1);
+    }
+
+    /// 列優先的基底
+    pub fn cells(&self) -> &[Cell] {
+        &self.cells
+    }
+
+    /// 基底是否與 other 共用同一份
+    #[allow(dead_code)]
+    pub fn shares_cells_with(&self, other: &Map) -> bool {
+        Arc::ptr_eq(&self.cells, &other.cells)
+    }
+
+    #[inline]
+    fn index(&self, x: usize, y: usize) -> Option<usize> {
+        (x < self.width && y < self.height).then_some(y * self.width + x)
+    }
+
+    // 獲取指定位置的Point
+    pub fn get_point(&self, x: usize, y: usize) -> Option<PointRef<'_>> {
+        let index = self.index(x, y)?;
+        let cell = &self.cells[index];
+        let items = self.items.get(&index).unwrap_or(&NO_ITEMS);
+        Some(PointRef {
+            x,
+            y,
+            walkable: cell.walkable,
+            description: &cell.description,
+            name: &cell.name,
+            objects: &items.objects,
+            object_ages: &items.object_ages,
+            terrain_type: cell.terrain_type,
+        })
+    }
+
+    /// 指定位置的基底
+    pub fn cell(&self, x: usize, y: usize) -> Option<&Cell> {
+        self.index(x, y).map(|index| &self.cells[index])
+    }
+
+    /// 指定位置的物品（沒有放過物品的格子為 None）
+    pub fn items(&self, x: usize, y: usize) -> Option<&PointItems> {
+        self.index(x, y).and_then(|index| self.items.get(&index))
+    }
+
+    /// 所有的點（列優先）
+    pub fn points(&self) -> impl Iterator<Item = PointRef<'_>> {
+        (0..self.height).flat_map(move |y| (0..self.width).filter_map(move |x| self.get_point(x, y)))
+    }
+
+    /// 有物品的格子（列優先）
+    pub fn points_with_items(&self) -> impl Iterator<Item = ((usize, usize), &PointItems)> {
+        self.items.iter()
+            .filter(|(_, items)| !items.is_empty())
+            .map(|(&index, items)| ((index % self.width, index / self.width), items))
+    }
+
+    // 設定指定位置是否可行走，返回是否有改變（改變會使附近的視野快取失效）
+    pub fn set_walkable(&mut self, x: usize, y: usize, walkable: bool) -> bool {
+        if self.walk_bits.get(x, y) == walkable || self.index(x, y).is_none() {
+            return false;
+        }
+        if let Some(cell) = self.cell_mut(x, y) {
+            cell.walkable = walkable;
+        }
+        self.walk_bits.set(x, y, walkable);
+        self.walls.record(x, y);
+        true
+    }
+
+    /// 可變地獲取指定位置的基底（與其他世界共用時先複製整個基底）；
+    /// 改了可行走性要呼叫 walls_changed 或改用 set_walkable
+    pub fn cell_mut(&mut self, x: usize, y: usize) -> Option<&mut Cell> {
+        let index = self.index(x, y)?;
+        Some(&mut Arc::make_mut(&mut self.cells)[index])
+    }
+
+    // 可變地獲取指定位置的物品（不影響共用的基底）
+    pub fn items_mut(&mut self, x: usize, y: usize) -> Option<&mut PointItems> {
+        let index = self.index(x, y)?;
+        Some(self.items.entry(index).or_default())
+    }
+
+    /// 取代指定位置的物品，返回位置是否在地圖內
+    pub fn set_items(&mut self, x: usize, y: usize, items: PointItems) -> bool {
+        let Some(index) = self.index(x, y) else {
+            return false;
+        };
+        if items.is_empty() {
+            self.items.remove(&index);
         } else {
-            None
+            self.items.insert(index, items);
         }
+        true
     }
 
     // 獲取周圍的Point（3x3範圍，包括中心點）
     #[allow(dead_code)]
-    pub fn get_surrounding_points(&self, x: usize, y: usize, radius: usize) -> Vec<&Point> {
+    pub fn get_surrounding_points(&self, x: usize, y: usize, radius: usize) -> Vec<PointRef<'_>> {
         let mut surrounding = Vec::new();
         
         let x_start = x.saturating_sub(radius);
@@ -380,54 +655,33 @@ impl Map {
 
     // 統計可移動和不可移動的Point
     pub fn get_stats(&self) -> (usize, usize) {
-        let mut walkable = 0;
-        let mut unwalkable = 0;
-
-        for row in &self.points {
-            for point in row {
-                if point.walkable {
-                    walkable += 1;
-                } else {
-                    unwalkable += 1;
-                }
-            }
-        }
-
-        (walkable, unwalkable)
+        let walkable = self.walk_bits.count();
+        (walkable, self.walk_bits.len() - walkable)
     }
 
     // 初始化隨機 item 散落在地圖上，大概占一半的可移動地點
-    pub fn initialize_items(&mut self) {
-        let mut rng = rand::thread_rng();
-        let walkable_points = self.get_walkable_points();
+    pub fn initialize_items(&mut self, rng: &Rng) {
+        let walkable_count = self.walk_bits.count();
         
-        if walkable_points.is_empty() {
+        if walkable_count == 0 {
             return;
         }
 
-        // 可用的物品中文名稱（與 item_registry 一致）
-        let available_items = vec![
-            "舊布料", "石子", "樹皮", "羽毛",
-            "蘋果", "麵包", "乾肉", "漿果",
-            "木劍", "鐵劍", "弓", "匕首",
-            "皮衣", "頭盔", "盾牌",
-            "治療藥水", "魔力藥水", "毒藥",
-            "火把", "繩索", "鎬", "鑰匙",
-        ];
+        let available_items = SPAWNABLE_ITEMS;
 
         // 計算要放置的 item 數量（可移動地點的 10%）
-        let item_count = (walkable_points.len() / 10).max(5);
+        let item_count = (walkable_count / 10).max(5);
         
         // 隨機選擇位置並放置 item
         for _ in 0..item_count {
-            let random_idx = rng.gen_range(0..walkable_points.len());
-            let (x, y) = walkable_points[random_idx];
+            let Some((x, y)) = self.walk_bits.nth(rng.below(walkable_count)) else {
+                continue;
+            };
             
-            if let Some(point) = self.get_point_mut(x, y) {
-                let item_idx = rng.gen_range(0..available_items.len());
-                let item_name = available_items[item_idx];
-                let quantity = rng.gen_range(1..=3);  // 隨機 1-3 個
-                point.add_objects(item_name.to_string(), quantity);
+            if let Some(items) = self.items_mut(x, y) {
+                let item_name = available_items[rng.below(available_items.len())];
+                let quantity = 1 + rng.below(3) as u32;  // 隨機 1-3 個
+                items.add_objects(item_name.to_string(), quantity);
             }
         }
     }
@@ -445,25 +699,26 @@ impl Map {
         Ok(())
     }
 
-    // 從檔案加載地圖
+    // 從檔案加載地圖（資源包中有最新的版本時直接由映射的資源包解碼）
     pub fn load(filename: &str) -> std::io::Result<Self> {
         use std::fs;
 
+        if let Some(map) = crate::asset_pack::load_map(filename) {
+            return Ok(map);
+        }
         let content = fs::read_to_string(filename)?;
-        let map: Map = serde_json::from_str(&content)
-            .map_err(std::io::Error::other)?;
-        Ok(map)
+        serde_json::from_str(&content).map_err(std::io::Error::other)
     }
 
     // 設定地圖屬性
     pub fn set_property(&mut self, key: String, value: String) {
-        self.properties.insert(key, value);
+        self.properties.set_str(&key, &value);
     }
 
     // 獲取地圖屬性
     #[allow(dead_code)]
-    pub fn get_property(&self, key: &str) -> Option<&String> {
-        self.properties.get(key)
+    pub fn get_property(&self, key: &str) -> Option<String> {
+        self.properties.get_str(key)
     }
 }
 
@@ -472,15 +727,37 @@ use crate::time_updatable::{TimeUpdatable, TimeInfo};
 
 impl TimeUpdatable for Map {
     fn on_time_update(&mut self, _current_time: &TimeInfo) {
-        // 更新所有地點上的物品年齡
-        for row in &mut self.points {
-            for point in row {
-                for ages in point.object_ages.values_mut() {
-                    for age in ages {
-                        *age += 1;
-                    }
+        // 更新有物品的格子上的物品年齡（物品已被拿光的格子順便移除）
+        self.items.retain(|_, items| {
+            for ages in items.object_ages.values_mut() {
+                for age in ages {
+                    *age += 1;
                 }
             }
-        }
+            !items.is_empty()
+        });
+    }
+}
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for Cell {
+    fn heap_size(&self) -> usize {
+        self.description.heap_size() + self.name.heap_size()
+    }
+}
+
+impl HeapSize for PointItems {
+    fn heap_size(&self) -> usize {
+        self.objects.heap_size() + self.object_ages.heap_size()
+    }
+}
+
+impl HeapSize for Map {
+    /// 共用的基底由共用的世界平均分攤，物品只計有物品的格子
+    fn heap_size(&self) -> usize {
+        self.name.heap_size() + crate::shared_assets::split_heap_size(&self.cells) + self.items.heap_size()
+            + self.description.heap_size() + self.properties.heap_size() + self.walls.heap_size()
+            + self.walk_bits.heap_size()
     }
 }
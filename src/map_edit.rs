@@ -0,0 +1,351 @@
+// 地圖區域編輯（建造者指令）
+// conquer / namehere / destroy / create item 每次只改一格並重寫整個地圖檔。
+// region 指令一次修改一個矩形：逐格掃描一次，同一次掃描中把修改前的格子存成一筆復原紀錄，
+// 整個操作結束後只寫一次地圖檔（由 GameWorld::edit_region 負責）。
+// 基底有改變的格子才寫回（與其他世界共用的基底在第一次改變時複製），只放物品不動到基底。
+//
+// region fill <x1> <y1> <x2> <y2> <walk|block|地形>   填滿可行走性或地形
+// region paint <x1> <y1> <x2> <y2> <描述>            設定描述
+// region scatter <x1> <y1> <x2> <y2> <物品> [數量]   在隨機位置放置物品
+// region copy <x1> <y1> <x2> <y2>                    複製到剪貼簿
+// region paste <x> <y>                               以 (x, y) 為左上角貼上
+// region undo                                        復原上一個區域編輯
+
+use crate::map::{Cell, Map, PointItems, TerrainType};
+use crate::shared_assets::SharedStr;
+use crate::rng::Rng;
+
+/// 最多保留的復原紀錄數
+const MAX_UNDO: usize = 32;
+
+pub const USAGE: &str = "Usage: region <fill|paint|scatter> <x1> <y1> <x2> <y2> <值> | copy <x1> <y1> <x2> <y2> | paste <x> <y> | undo";
+
+/// 矩形範圍（含邊界，x0 <= x1、y0 <= y1）
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Rect {
+    pub x0: usize,
+    pub y0: usize,
+    pub x1: usize,
+    pub y1: usize,
+}
+
+impl Rect {
+    /// 任意兩角建立
+    pub fn new(ax: usize, ay: usize, bx: usize, by: usize) -> Self {
+        Rect { x0: ax.min(bx), y0: ay.min(by), x1: ax.max(bx), y1: ay.max(by) }
+    }
+
+    /// 裁切到地圖範圍內；完全在地圖外時返回 None
+    pub fn clamp(self, map: &Map) -> Option<Rect> {
+        if self.x0 >= map.width || self.y0 >= map.height {
+            return None;
+        }
+        Some(Rect { x1: self.x1.min(map.width - 1), y1: self.y1.min(map.height - 1), ..self })
+    }
+
+    pub fn width(&self) -> usize {
+        self.x1 - self.x0 + 1
+    }
+
+    pub fn height(&self) -> usize {
+        self.y1 - self.y0 + 1
+    }
+
+    pub fn area(&self) -> usize {
+        self.width() * self.height()
+    }
+}
+
+/// fill 的內容
+#[derive(Debug, Clone, PartialEq)]
+pub enum Fill {
+    Walkable(bool),
+    Terrain(TerrainType),
+}
+
+/// 區域編輯指令
+#[derive(Debug, Clone, PartialEq)]
+pub enum RegionCommand {
+    Fill { rect: Rect, fill: Fill },
+    Paint { rect: Rect, description: String },
+    Scatter { rect: Rect, item: String, count: u32 },
+    Copy { rect: Rect },
+    Paste { x: usize, y: usize },
+    Undo,
+}
+
+impl RegionCommand {
+    /// 解析 region 之後的參數
+    pub fn parse(args: &[&str]) -> Result<Self, String> {
+        let coord = |i: usize| args.get(i).and_then(|s| s.parse::<usize>().ok()).ok_or_else(|| USAGE.to_string());
+        let rect = || Ok::<_, String>(Rect::new(coord(1)?, coord(2)?, coord(3)?, coord(4)?));
+        let rest = || (args.len() > 5).then(|| args[5..].join(" ")).ok_or_else(|| USAGE.to_string());
+        match args.first().copied() {
+            Some("fill") => {
+                let value = rest()?;
+                let fill = match value.as_str() {
+                    "walk" | "walkable" | "可行走" => Fill::Walkable(true),
+                    "block" | "wall" | "障礙" => Fill::Walkable(false),
+                    name => Fill::Terrain(TerrainType::from_name(name).ok_or(format!("未知的地形: {name}"))?),
+                };
+                Ok(RegionCommand::Fill { rect: rect()?, fill })
+            }
+            Some("paint") => Ok(RegionCommand::Paint { rect: rect()?, description: rest()? }),
+            Some("scatter") => {
+                let item = args.get(5).ok_or_else(|| USAGE.to_string())?;
+                let count = args.get(6).and_then(|s| s.parse().ok()).unwrap_or(1);
+                Ok(RegionCommand::Scatter { rect: rect()?, item: crate::item_registry::resolve_item_name(item), count })
+            }
+            Some("copy") => Ok(RegionCommand::Copy { rect: rect()? }),
+            Some("paste") => Ok(RegionCommand::Paste { x: coord(1)?, y: coord(2)? }),
+            Some("undo") => Ok(RegionCommand::Undo),
+            _ => Err(USAGE.to_string()),
+        }
+    }
+}
+
+/// 一個矩形的格子（列優先）
+#[derive(Debug, Clone)]
+struct Region {
+    rect: Rect,
+    points: Vec<(Cell, PointItems)>,
+}
+
+/// 一筆復原紀錄：編輯前的矩形內容
+#[derive(Debug, Clone)]
+struct Snapshot {
+    map: String,
+    region: Region,
+    walls_changed: bool,
+}
+
+/// 編輯結果
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct EditOutcome {
+    pub map: String,       // 被修改的地圖
+    pub modified: bool,    // 是否需要存檔（copy 不修改地圖）
+    pub message: String,
+}
+
+/// 建造者的剪貼簿與復原堆疊
+#[derive(Debug, Clone, Default)]
+pub struct MapEditor {
+    clipboard: Option<Region>,
+    undo: Vec<Snapshot>,
+}
+
+impl MapEditor {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// 對地圖執行一個區域編輯（Undo 由 undo_target / undo 處理）
+    pub fn apply(&mut self, map: &mut Map, command: RegionCommand, rng: &Rng) -> Result<EditOutcome, String> {
+        let outcome = |map: &Map, modified, message| EditOutcome { map: map.name.clone(), modified, message };
+        match command {
+            RegionCommand::Fill { rect, fill } => {
+                let rect = rect.clamp(map).ok_or("範圍超出地圖")?;
+                let walls = matches!(fill, Fill::Walkable(_));
+                let changed = self.edit(map, rect, walls, |cell, _| match &fill {
+                    Fill::Walkable(walkable) => cell.walkable = *walkable,
+                    Fill::Terrain(terrain) => cell.terrain_type = *terrain,
+                });
+                Ok(outcome(map, true, format!("已填滿 {} 格（{} 格有改變）", rect.area(), changed)))
+            }
+            RegionCommand::Paint { rect, description } => {
+                let rect = rect.clamp(map).ok_or("範圍超出地圖")?;
+                let description = SharedStr::from(description);
+                self.edit(map, rect, false, |cell, _| cell.description = description.clone());
+                Ok(outcome(map, true, format!("已設定 {} 格的描述", rect.area())))
+            }
+            RegionCommand::Scatter { rect, item, count } => {
+                let rect = rect.clamp(map).ok_or("範圍超出地圖")?;
+                // 數量不超過範圍的格數；先抽好位置（列優先索引），掃描時依序放置
+                let count = (count as usize).min(rect.area());
+                let mut spots: Vec<usize> = (0..count).map(|_| rng.below(rect.area())).collect();
+                spots.sort_unstable();
+                let mut next = spots.iter().peekable();
+                let mut index = 0;
+                self.edit(map, rect, false, |_, items| {
+                    let mut quantity = 0;
+                    while next.next_if_eq(&&index).is_some() {
+                        quantity += 1;
+                    }
+                    if quantity > 0 {
+                        items.add_objects(item.clone(), quantity);
+                    }
+                    index += 1;
+                });
+                Ok(outcome(map, true, format!("已在範圍內放置 {count} 個 {item}")))
+            }
+            RegionCommand::Copy { rect } => {
+                let rect = rect.clamp(map).ok_or("範圍超出地圖")?;
+                self.clipboard = Some(Region { rect, points: read_region(map, rect) });
+                Ok(outcome(map, false, format!("已複製 {}×{} 的區域", rect.width(), rect.height())))
+            }
+            RegionCommand::Paste { x, y } => {
+                let clipboard = self.clipboard.take().ok_or("剪貼簿是空的")?;
+                let source = clipboard.rect;
+                // 右下角以飽和運算計算（超大座標不溢位），起點在地圖外時拒絕
+                let target = Rect {
+                    x0: x,
+                    y0: y,
+                    x1: x.saturating_add(source.width() - 1),
+                    y1: y.saturating_add(source.height() - 1),
+                };
+                let result = target.clamp(map).ok_or("範圍超出地圖".to_string()).map(|rect| {
+                    let width = source.width();
+                    let (mut col, mut row) = (0, 0);
+                    self.edit(map, rect, true, |cell, items| {
+                        let (source_cell, source_items) = &clipboard.points[row * width + col];
+                        cell.clone_from(source_cell);
+                        items.clone_from(source_items);
+                        col += 1;
+                        if col == rect.width() {
+                            (col, row) = (0, row + 1);
+                        }
+                    });
+                    outcome(map, true, format!("已貼上 {}×{} 的區域到 ({x}, {y})", rect.width(), rect.height()))
+                });
+                self.clipboard = Some(clipboard);
+                result
+            }
+            RegionCommand::Undo => Err("undo 需要由 undo() 處理".to_string()),
+        }
+    }
+
+    /// 下一個復原紀錄所屬的地圖
+    pub fn undo_target(&self) -> Option<&str> {
+        self.undo.last().map(|s| s.map.as_str())
+    }
+
+    /// 還原最近一筆紀錄（map 必須是 undo_target 指出的地圖）
+    pub fn undo(&mut self, map: &mut Map) -> Result<EditOutcome, String> {
+        let snapshot = self.undo.pop().ok_or("沒有可以復原的區域編輯")?;
+        let rect = snapshot.region.rect;
+        let mut saved = snapshot.region.points.into_iter();
+        for y in rect.y0..=rect.y1 {
+            for (x, (cell, items)) in (rect.x0..=rect.x1).zip(&mut saved) {
+                write_point(map, x, y, cell, items);
+            }
+        }
+        if snapshot.walls_changed {
+            map.walls_changed(rect.x0, rect.y0, rect.x1, rect.y1);
+        }
+        Ok(EditOutcome { map: map.name.clone(), modified: true, message: format!("已復原 {} 格", rect.area()) })
+    }
+
+    /// 單次掃描：逐格先保存原值再修改；返回可行走性改變的格數
+    fn edit(&mut self, map: &mut Map, rect: Rect, walls: bool, mut apply: impl FnMut(&mut Cell, &mut PointItems)) -> usize {
+        let before = read_region(map, rect);
+        let mut walls_changed = 0;
+        for (i, (old_cell, old_items)) in before.iter().enumerate() {
+            let (x, y) = (rect.x0 + i % rect.width(), rect.y0 + i / rect.width());
+            let (mut cell, mut items) = (old_cell.clone(), old_items.clone());
+            apply(&mut cell, &mut items);
+            walls_changed += usize::from(cell.walkable != old_cell.walkable);
+            write_point(map, x, y, cell, items);
+        }
+        if walls && walls_changed > 0 {
+            map.walls_changed(rect.x0, rect.y0, rect.x1, rect.y1);
+        }
+        if self.undo.len() >= MAX_UNDO {
+            self.undo.remove(0);
+        }
+        self.undo.push(Snapshot { map: map.name.clone(), region: Region { rect, points: before }, walls_changed: walls_changed > 0 });
+        walls_changed
+    }
+}
+
+/// 讀出矩形內的格子（列優先）
+fn read_region(map: &Map, rect: Rect) -> Vec<(Cell, PointItems)> {
+    let mut points = Vec::with_capacity(rect.area());
+    for y in rect.y0..=rect.y1 {
+        for x in rect.x0..=rect.x1 {
+            let cell = map.cell(x, y).cloned().unwrap_or_default();
+            points.push((cell, map.items(x, y).cloned().unwrap_or_default()));
+        }
+    }
+    points
+}
+
+/// 寫回一格：基底有改變時才寫（避免複製共用的基底）
+fn write_point(map: &mut Map, x: usize, y: usize, cell: Cell, items: PointItems) {
+    if map.cell(x, y) != Some(&cell) {
+        if let Some(target) = map.cell_mut(x, y) {
+            *target = cell;
+        }
+    }
+    map.set_items(x, y, items);
+}
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for Region {
+    fn heap_size(&self) -> usize {
+        self.points.heap_size()
+    }
+}
+
+impl HeapSize for MapEditor {
+    fn heap_size(&self) -> usize {
+        self.clipboard.heap_size()
+            + self.undo.capacity() * std::mem::size_of::<Snapshot>()
+            + self.undo.iter().map(|s| s.map.heap_size() + s.region.heap_size()).sum::<usize>()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::rng::WorldRng;
+
+    #[test]
+    fn test_region_edit_and_undo() {
+        let rng = Rng::seed_from_u64(3);
+        let mut map = Map::new("test".to_string(), 8, 6, &WorldRng::new(1));
+        let original: Vec<bool> = map.points().map(|p| p.walkable).collect();
+        let count_apples = |map: &Map| map.points().map(|p| p.get_object_count("蘋果")).sum::<u32>();
+        let apples = count_apples(&map);
+        let mut editor = MapEditor::new();
+
+        // 另一個世界的同一張地圖：只放物品時仍共用基底，改基底時才複製，另一個世界不受影響
+        let mut other = map.clone();
+        let scatter = RegionCommand::Scatter { rect: Rect::new(0, 0, 7, 5), item: "石子".to_string(), count: 3 };
+        MapEditor::new().apply(&mut other, scatter, &rng).unwrap();
+        assert!(other.shares_cells_with(&map));
+
+        let fill = RegionCommand::parse(&["fill", "6", "4", "1", "1", "block"]).unwrap();
+        assert_eq!(fill, RegionCommand::Fill { rect: Rect::new(1, 1, 6, 4), fill: Fill::Walkable(false) });
+        editor.apply(&mut map, fill, &rng).unwrap();
+        assert!((1..=4).all(|y| (1..=6).all(|x| !map.is_walkable(x, y) && !map.get_point(x, y).unwrap().walkable)));
+        assert!(!other.shares_cells_with(&map));
+        assert!(other.points().map(|p| p.walkable).eq(original.iter().copied()));
+
+        editor.apply(&mut map, RegionCommand::Scatter { rect: Rect::new(0, 0, 7, 5), item: "蘋果".to_string(), count: 5 }, &rng).unwrap();
+        assert_eq!(count_apples(&map), apples + 5);
+
+        // 數量超過格數時只放置格數那麼多（隨即復原，不影響後面的檢查）
+        editor.apply(&mut map, RegionCommand::Scatter { rect: Rect::new(0, 0, 1, 0), item: "蘋果".to_string(), count: u32::MAX }, &rng).unwrap();
+        assert_eq!(count_apples(&map), apples + 7);
+        editor.undo(&mut map).unwrap();
+
+        // 複製左上角貼到右下角（超出部分裁切）
+        editor.apply(&mut map, RegionCommand::Copy { rect: Rect::new(0, 0, 2, 2) }, &rng).unwrap();
+        editor.apply(&mut map, RegionCommand::Paste { x: 6, y: 4 }, &rng).unwrap();
+        assert_eq!(map.cell(7, 5), map.cell(1, 1));
+        assert_eq!(map.is_walkable(7, 5), map.is_walkable(1, 1));
+        assert!(editor.apply(&mut map, RegionCommand::Paste { x: usize::MAX, y: 0 }, &rng).is_err());
+        assert!(editor.apply(&mut map, RegionCommand::Paste { x: 8, y: 0 }, &rng).is_err());
+
+        // 依序復原三次編輯（copy 不產生紀錄）
+        for _ in 0..3 {
+            assert_eq!(editor.undo_target(), Some("test"));
+            editor.undo(&mut map).unwrap();
+        }
+        assert!(editor.undo(&mut map).is_err());
+        let restored: Vec<bool> = map.points().map(|p| p.walkable).collect();
+        assert_eq!(restored, original);
+        assert_eq!(count_apples(&map), apples);
+    }
+}
@@ -0,0 +1,274 @@
+// 地圖屬性（天氣、溫度等環境狀態）
+// 屬性在世界層級宣告型別（列舉或數值），每張地圖以固定槽位陣列儲存：
+// 讀寫以 PropertyId 索引，值是 Copy 的小型列舉，不需比較字串。
+// 宣告來自內建預設與世界資料夾的 properties.json；未宣告的屬性仍以字串保存（相容舊資料）。
+// 值改變時 GameWorld 會送出 PropertyChange 給訂閱者（NPC AI、描述系統等），不需輪詢。
+//
+// properties.json 格式:
+// [
+//   { "name": "天氣", "type": "enum", "values": ["晴天", "雨天"] },
+//   { "name": "氣溫", "type": "number", "min": -30, "max": 50 }
+// ]
+
+use serde::{Deserialize, Deserializer, Serialize, Serializer};
+use std::collections::HashMap;
+use std::sync::Arc;
+
+/// 屬性在世界中的編號（即地圖槽位索引）
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct PropertyId(pub u16);
+
+/// 屬性值：列舉的變體索引或數值
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum PropertyValue {
+    Enum(u16),
+    Number(i32),
+}
+
+/// 屬性型別
+#[derive(Debug, Clone, Serialize, Deserialize, PartialEq)]
+#[serde(tag = "type")]
+pub enum PropertyKind {
+    #[serde(rename = "enum")]
+    Enum { values: Vec<String> },
+    #[serde(rename = "number")]
+    Number { min: i32, max: i32 },
+}
+
+/// 屬性宣告
+#[derive(Debug, Clone, Serialize, Deserialize, PartialEq)]
+pub struct PropertyDecl {
+    pub name: String,
+    #[serde(flatten)]
+    pub kind: PropertyKind,
+}
+
+/// 世界的屬性宣告表
+#[derive(Debug, Clone, Default)]
+pub struct PropertySchema {
+    decls: Vec<PropertyDecl>,
+    by_name: HashMap<String, PropertyId>,
+}
+
+impl PropertySchema {
+    /// 內建宣告（beginWorld 事件使用的天氣與溫度）
+    pub fn builtin() -> Self {
+        let mut schema = PropertySchema::default();
+        let values = |list: &[&str]| list.iter().map(|s| s.to_string()).collect();
+        schema.declare(PropertyDecl {
+            name: "天氣".to_string(),
+            kind: PropertyKind::Enum { values: values(&["晴天", "陰天", "雨天", "多雲", "霧天", "雪天", "暴風雨"]) },
+        });
+        schema.declare(PropertyDecl {
+            name: "溫度".to_string(),
+            kind: PropertyKind::Enum { values: values(&["寒冷", "涼爽", "溫暖", "炎熱"]) },
+        });
+        schema
+    }
+
+    /// 內建宣告加上 world_dir/properties.json（同名時以檔案為準）
+    pub fn load(world_dir: &str) -> Result<Self, Box<dyn std::error::Error>> {
+        let mut schema = Self::builtin();
+        let path = format!("{world_dir}/properties.json");
+        if std::path::Path::new(&path).exists() {
+            let decls: Vec<PropertyDecl> = serde_json::from_str(&std::fs::read_to_string(path)?)?;
+            for decl in decls {
+                schema.declare(decl);
+            }
+        }
+        Ok(schema)
+    }
+
+    /// 宣告屬性；已存在時取代其型別並沿用編號
+    pub fn declare(&mut self, decl: PropertyDecl) -> PropertyId {
+        if let Some(&id) = self.by_name.get(&decl.name) {
+            self.decls[id.0 as usize] = decl;
+            return id;
+        }
+        let id = PropertyId(self.decls.len() as u16);
+        self.by_name.insert(decl.name.clone(), id);
+        self.decls.push(decl);
+        id
+    }
+
+    pub fn id(&self, name: &str) -> Option<PropertyId> {
+        self.by_name.get(name).copied()
+    }
+
+    pub fn decl(&self, id: PropertyId) -> &PropertyDecl {
+        &self.decls[id.0 as usize]
+    }
+
+    pub fn len(&self) -> usize {
+        self.decls.len()
+    }
+
+    /// 所有宣告（依編號排列）
+    pub fn decls(&self) -> &[PropertyDecl] {
+        &self.decls
+    }
+
+    #[allow(dead_code)]
+    pub fn is_empty(&self) -> bool {
+        self.decls.is_empty()
+    }
+
+    /// 將字串解析為該屬性的值；不在列舉中或超出數值範圍時返回 None
+    pub fn parse(&self, id: PropertyId, text: &str) -> Option<PropertyValue> {
+        match &self.decl(id).kind {
+            PropertyKind::Enum { values } => {
+                values.iter().position(|v| v == text).map(|i| PropertyValue::Enum(i as u16))
+            }
+            PropertyKind::Number { min, max } => {
+                text.trim().parse::<i32>().ok()
+                    .filter(|n| (*min..=*max).contains(n))
+                    .map(PropertyValue::Number)
+            }
+        }
+    }
+
+    /// 以名稱解析（編譯事件時使用）
+    pub fn resolve(&self, name: &str, text: &str) -> Option<(PropertyId, PropertyValue)> {
+        let id = self.id(name)?;
+        Some((id, self.parse(id, text)?))
+    }
+
+    pub fn format(&self, id: PropertyId, value: PropertyValue) -> String {
+        match (&self.decl(id).kind, value) {
+            (PropertyKind::Enum { values }, PropertyValue::Enum(i)) => {
+                values.get(i as usize).cloned().unwrap_or_default()
+            }
+            (_, PropertyValue::Number(n)) => n.to_string(),
+            (_, PropertyValue::Enum(i)) => i.to_string(),
+        }
+    }
+}
+
+/// 屬性變化通知
+#[derive(Debug, Clone, PartialEq)]
+pub struct PropertyChange {
+    pub map: String,
+    pub property: PropertyId,
+    pub old: Option<PropertyValue>,
+    pub new: PropertyValue,
+}
+
+/// 單張地圖的屬性：已宣告的屬性放在固定槽位，其餘以字串保存
+/// 序列化格式維持 {"名稱": "值"}，與舊版地圖檔相容
+#[derive(Debug, Clone, Default)]
+pub struct MapProperties {
+    schema: Arc<PropertySchema>,
+    slots: Vec<Option<PropertyValue>>,
+    untyped: HashMap<String, String>,
+}
+
+impl MapProperties {
+    /// 綁定世界的宣告表：可解析的字串值移入槽位（地圖加入世界時呼叫）
+    pub fn bind(&mut self, schema: &Arc<PropertySchema>) {
+        let mut entries: Vec<(String, String)> = self.iter_strings().collect();
+        entries.extend(self.untyped.drain());
+        entries.sort();
+        entries.dedup_by(|a, b| a.0 == b.0);
+        self.schema = Arc::clone(schema);
+        self.slots = vec![None; schema.len()];
+        for (name, value) in entries {
+            self.set_str(&name, &value);
+        }
+    }
+
+    pub fn get(&self, id: PropertyId) -> Option<PropertyValue> {
+        self.slots.get(id.0 as usize).copied().flatten()
+    }
+
+    /// 設定槽位值，返回舊值；id 不屬於目前的宣告表時不做任何事
+    pub fn set(&mut self, id: PropertyId, value: PropertyValue) -> Option<PropertyValue> {
+        self.slots.get_mut(id.0 as usize).and_then(|slot| slot.replace(value))
+    }
+
+    /// 以字串讀取（顯示與序列化用）
+    pub fn get_str(&self, name: &str) -> Option<String> {
+        match self.schema.id(name) {
+            Some(id) => self.get(id).map(|v| self.schema.format(id, v))
+                .or_else(|| self.untyped.get(name).cloned()),
+            None => self.untyped.get(name).cloned(),
+        }
+    }
+
+    /// 以字串設定：已宣告且值合法時寫入槽位，否則以字串保存
+    pub fn set_str(&mut self, name: &str, value: &str) {
+        if let Some((id, parsed)) = self.schema.resolve(name, value) {
+            if (id.0 as usize) < self.slots.len() {
+                self.set(id, parsed);
+                self.untyped.remove(name);
+                return;
+            }
+        }
+        self.untyped.insert(name.to_string(), value.to_string());
+    }
+
+    /// 所有已設定屬性的 (名稱, 值) 字串
+    pub fn iter_strings(&self) -> impl Iterator<Item = (String, String)> + '_ {
+        let typed = self.slots.iter().enumerate().filter_map(move |(i, slot)| {
+            let id = PropertyId(i as u16);
+            slot.map(|v| (self.schema.decl(id).name.clone(), self.schema.format(id, v)))
+        });
+        typed.chain(self.untyped.iter().map(|(k, v)| (k.clone(), v.clone())))
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.slots.iter().all(Option::is_none) && self.untyped.is_empty()
+    }
+}
+
+impl Serialize for MapProperties {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.collect_map(self.iter_strings())
+    }
+}
+
+impl<'de> Deserialize<'de> for MapProperties {
+    /// 反序列化時尚無宣告表，全部先以字串保存，待 bind() 時轉為槽位
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        let untyped = HashMap::<String, String>::deserialize(deserializer)?;
+        Ok(MapProperties { untyped, ..Default::default() })
+    }
+}
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for MapProperties {
+    /// 宣告表由整個世界共用，不計入
+    fn heap_size(&self) -> usize {
+        self.slots.capacity() * std::mem::size_of::<Option<PropertyValue>>() + self.untyped.heap_size()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_typed_properties() {
+        let mut schema = PropertySchema::builtin();
+        let temperature = schema.declare(PropertyDecl {
+            name: "氣溫".to_string(),
+            kind: PropertyKind::Number { min: -30, max: 50 },
+        });
+        let schema = Arc::new(schema);
+        let weather = schema.id("天氣").unwrap();
+
+        // 舊版地圖檔的字串屬性在 bind 後進入槽位
+        let mut props: MapProperties = serde_json::from_str(r#"{"天氣": "雨天", "傳說": "龍"}"#).unwrap();
+        props.bind(&schema);
+        assert_eq!(props.get(weather), schema.parse(weather, "雨天"));
+        assert_eq!(props.get_str("傳說").as_deref(), Some("龍"));
+
+        props.set_str("氣溫", "25");
+        assert_eq!(props.get(temperature), Some(PropertyValue::Number(25)));
+        props.set_str("氣溫", "99");  // 超出範圍，以字串保存
+        assert_eq!(props.get_str("氣溫").as_deref(), Some("25"));
+
+        let json: HashMap<String, String> = serde_json::from_str(&serde_json::to_string(&props).unwrap()).unwrap();
+        assert_eq!(json.get("天氣").map(String::as_str), Some("雨天"));
+    }
+}
@@ -0,0 +1,247 @@
+// 記憶體統計
+// HeapSize：各主要結構的堆積記憶體估算（容量 × 元素大小 + 子元素的堆積）
+// CountingAllocator：可選的計數全域分配器（啟用 count-alloc feature 時安裝）
+// MemoryReport：各子系統的記憶體分解，供 `mem` 指令與 ratamud_memory_report() 使用
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::collections::HashMap;
+use std::mem::size_of;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+
+/// 堆積記憶體估算（不含結構本身的 size_of，只計算其擁有的堆積配置）
+pub trait HeapSize {
+    fn heap_size(&self) -> usize;
+}
+
+/// 不擁有堆積記憶體的型別
+macro_rules! impl_heap_size_zero {
+    ($($t:ty),*) => {
+        $(impl HeapSize for $t {
+            fn heap_size(&self) -> usize { 0 }
+        })*
+    };
+}
+
+impl_heap_size_zero!(bool, u8, u16, u32, u64, usize, i8, i16, i32, i64, isize, f32, f64, char);
+
+impl HeapSize for String {
+    fn heap_size(&self) -> usize {
+        self.capacity()
+    }
+}
+
+impl HeapSize for std::borrow::Cow<'static, str> {
+    /// 借用的字串（例如資源包的映射頁面）不佔行程的堆積
+    fn heap_size(&self) -> usize {
+        match self {
+            std::borrow::Cow::Borrowed(_) => 0,
+            std::borrow::Cow::Owned(s) => s.capacity(),
+        }
+    }
+}
+
+impl<T: HeapSize> HeapSize for Vec<T> {
+    fn heap_size(&self) -> usize {
+        self.capacity() * size_of::<T>() + self.iter().map(HeapSize::heap_size).sum::<usize>()
+    }
+}
+
+impl<T: HeapSize> HeapSize for Option<T> {
+    fn heap_size(&self) -> usize {
+        self.as_ref().map_or(0, HeapSize::heap_size)
+    }
+}
+
+impl<T: HeapSize> HeapSize for Box<T> {
+    fn heap_size(&self) -> usize {
+        size_of::<T>() + (**self).heap_size()
+    }
+}
+
+impl<T: HeapSize> HeapSize for std::sync::Arc<T> {
+    /// 視為獨佔擁有：計入強/弱計數與內容（多處共用的 Arc 會被重複計算）
+    fn heap_size(&self) -> usize {
+        2 * size_of::<usize>() + size_of::<T>() + (**self).heap_size()
+    }
+}
+
+impl<K: HeapSize, V: HeapSize, S> HeapSize for HashMap<K, V, S> {
+    /// hashbrown 每個槽位額外一個控制位元組
+    fn heap_size(&self) -> usize {
+        self.capacity() * (size_of::<(K, V)>() + 1)
+            + self.iter().map(|(k, v)| k.heap_size() + v.heap_size()).sum::<usize>()
+    }
+}
+
+impl<K: HeapSize, V: HeapSize> HeapSize for std::collections::BTreeMap<K, V> {
+    /// B 樹節點的額外空間不計，只計元素與子元素的堆積
+    fn heap_size(&self) -> usize {
+        self.len() * size_of::<(K, V)>()
+            + self.iter().map(|(k, v)| k.heap_size() + v.heap_size()).sum::<usize>()
+    }
+}
+
+impl<A: HeapSize, B: HeapSize> HeapSize for (A, B) {
+    fn heap_size(&self) -> usize {
+        self.0.heap_size() + self.1.heap_size()
+    }
+}
+
+impl<T: HeapSize, const N: usize> HeapSize for [T; N] {
+    fn heap_size(&self) -> usize {
+        self.iter().map(HeapSize::heap_size).sum()
+    }
+}
+
+// ==================== 計數分配器 ====================
+
+static ALLOC_ACTIVE: AtomicBool = AtomicBool::new(false);
+static ALLOC_LIVE_BYTES: AtomicUsize = AtomicUsize::new(0);
+static ALLOC_PEAK_BYTES: AtomicUsize = AtomicUsize::new(0);
+static ALLOC_COUNT: AtomicUsize = AtomicUsize::new(0);
+
+/// 包裝系統分配器，記錄目前/峰值配置位元組與配置次數
+#[cfg_attr(not(feature = "count-alloc"), allow(dead_code))]
+pub struct CountingAllocator;
+
+impl CountingAllocator {
+    pub(crate) fn record_alloc(size: usize) {
+        ALLOC_ACTIVE.store(true, Ordering::Relaxed);
+        ALLOC_COUNT.fetch_add(1, Ordering::Relaxed);
+        let live = ALLOC_LIVE_BYTES.fetch_add(size, Ordering::Relaxed) + size;
+        ALLOC_PEAK_BYTES.fetch_max(live, Ordering::Relaxed);
+    }
+
+    pub(crate) fn record_dealloc(size: usize) {
+        ALLOC_LIVE_BYTES.fetch_sub(size, Ordering::Relaxed);
+    }
+}
+
+unsafe impl GlobalAlloc for CountingAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let ptr = System.alloc(layout);
+        if !ptr.is_null() {
+            Self::record_alloc(layout.size());
+        }
+        ptr
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        let ptr = System.alloc_zeroed(layout);
+        if !ptr.is_null() {
+            Self::record_alloc(layout.size());
+        }
+        ptr
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout);
+        Self::record_dealloc(layout.size());
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        let new_ptr = System.realloc(ptr, layout, new_size);
+        if !new_ptr.is_null() {
+            Self::record_dealloc(layout.size());
+            Self::record_alloc(new_size);
+        }
+        new_ptr
+    }
+}
+
+/// 計數分配器的快照
+#[derive(Debug, Clone, Copy)]
+pub struct AllocStats {
+    pub live_bytes: usize,
+    pub peak_bytes: usize,
+    pub alloc_count: usize,
+}
+
+/// 讀取計數分配器統計；未安裝 CountingAllocator 時返回 None
+pub fn alloc_stats() -> Option<AllocStats> {
+    if !ALLOC_ACTIVE.load(Ordering::Relaxed) {
+        return None;
+    }
+    Some(AllocStats {
+        live_bytes: ALLOC_LIVE_BYTES.load(Ordering::Relaxed),
+        peak_bytes: ALLOC_PEAK_BYTES.load(Ordering::Relaxed),
+        alloc_count: ALLOC_COUNT.load(Ordering::Relaxed),
+    })
+}
+
+// ==================== 記憶體報告 ====================
+
+/// 各子系統的記憶體分解（位元組）
+#[derive(Debug, Clone, Default)]
+pub struct MemoryReport {
+    pub entries: Vec<(&'static str, usize)>,
+}
+
+impl MemoryReport {
+    pub fn add(&mut self, subsystem: &'static str, bytes: usize) {
+        self.entries.push((subsystem, bytes));
+    }
+
+    pub fn total(&self) -> usize {
+        self.entries.iter().map(|(_, bytes)| bytes).sum()
+    }
+
+    /// 可讀格式（`mem` 指令使用）
+    pub fn to_lines(&self) -> Vec<String> {
+        let mut lines = vec!["=== 記憶體使用（估算） ===".to_string()];
+        for (subsystem, bytes) in &self.entries {
+            lines.push(format!("  {subsystem:<10} {:>10}", format_bytes(*bytes)));
+        }
+        lines.push(format!("  {:<10} {:>10}", "total", format_bytes(self.total())));
+        if let Some(stats) = alloc_stats() {
+            lines.push(format!("  分配器: 目前 {}，峰值 {}，配置次數 {}",
+                format_bytes(stats.live_bytes), format_bytes(stats.peak_bytes), stats.alloc_count));
+        }
+        lines
+    }
+
+    /// JSON 格式（C API 與 CI 基準測試使用）
+    pub fn to_json(&self) -> String {
+        let mut json = serde_json::Map::new();
+        for (subsystem, bytes) in &self.entries {
+            json.insert(subsystem.to_string(), (*bytes).into());
+        }
+        json.insert("total".to_string(), self.total().into());
+        if let Some(stats) = alloc_stats() {
+            json.insert("alloc_live".to_string(), stats.live_bytes.into());
+            json.insert("alloc_peak".to_string(), stats.peak_bytes.into());
+            json.insert("alloc_count".to_string(), stats.alloc_count.into());
+        }
+        serde_json::Value::Object(json).to_string()
+    }
+}
+
+/// 將位元組數格式化為 B/KB/MB
+pub fn format_bytes(bytes: usize) -> String {
+    if bytes >= 1024 * 1024 {
+        format!("{:.1} MB", bytes as f64 / (1024.0 * 1024.0))
+    } else if bytes >= 1024 {
+        format!("{:.1} KB", bytes as f64 / 1024.0)
+    } else {
+        format!("{bytes} B")
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_heap_size_collections() {
+        let s = String::with_capacity(16);
+        assert_eq!(s.heap_size(), 16);
+
+        let v: Vec<String> = vec![String::with_capacity(8), String::with_capacity(4)];
+        assert_eq!(v.heap_size(), v.capacity() * size_of::<String>() + 12);
+
+        let mut m: HashMap<String, u32> = HashMap::new();
+        assert_eq!(m.heap_size(), 0);
+        m.insert("石子".to_string(), 3);
+        assert!(m.heap_size() >= size_of::<(String, u32)>() + "石子".len());
+    }
+}
@@ -0,0 +1,368 @@
+// 原生 AI 外掛（C API：宿主以 C/C++ 撰寫 NPC 決策，在同一個行程中執行）
+// 每個 AI tick 把所有 NPC 的視圖打包成固定佈局的唯讀陣列，整批呼叫一次外掛函數，
+// 外掛把行為記錄寫回引擎提供的陣列；每批只跨越 FFI 一次，而不是每個 NPC 一次。
+// - 視圖、附近實體、物品各是一個 #[repr(C)] 陣列，視圖以 (start, len) 指向後兩者的區段
+// - 所有字串（ID、名稱、地圖、地形描述、物品名稱）放進去重的字串表：
+//   一塊以 NUL 分隔的 UTF-8，加上每個字串起點的偏移陣列
+// 未設定外掛時仍由內建的 NpcAiStrategyComposer 逐一決定。
+
+use std::collections::HashMap;
+use std::ffi::{c_void, CStr};
+use std::os::raw::c_char;
+use std::sync::Mutex;
+
+use crate::npc_action::{Direction, NpcAction};
+use crate::npc_ai::NpcAiController;
+use crate::npc_view::{EntityType, NpcView};
+
+pub const VIEW_INTERACTING: u32 = 1 << 0;  // 交易、對話中
+pub const VIEW_IN_PARTY: u32 = 1 << 1;     // 已組隊
+pub const VIEW_IN_COMBAT: u32 = 1 << 2;    // 戰鬥中
+pub const VIEW_WALKABLE: u32 = 1 << 3;     // 所在格可行走
+pub const VIEW_HAS_WEATHER: u32 = 1 << 4;  // 天氣欄位有效
+
+pub const ENTITY_KIND_PLAYER: u32 = 0;
+pub const ENTITY_KIND_NPC: u32 = 1;
+pub const ENTITY_KIND_ITEM: u32 = 2;
+
+pub const ACTION_IDLE: u32 = 0;
+pub const ACTION_SAY: u32 = 1;        // text: 說的話
+pub const ACTION_MOVE: u32 = 2;       // direction: 0 上, 1 下, 2 左, 3 右
+pub const ACTION_PICKUP: u32 = 3;     // text: 物品名稱, quantity
+pub const ACTION_USE_ITEM: u32 = 4;   // text: 物品名稱
+pub const ACTION_DROP: u32 = 5;       // text: 物品名稱, quantity
+pub const ACTION_TRADE: u32 = 6;      // target
+pub const ACTION_ATTACK: u32 = 7;     // target
+pub const ACTION_USE_SKILL: u32 = 8;  // text: 技能名稱, target
+
+/// 每個 NPC 最多可寫回的行為數（行為陣列容量 = NPC 數 × 此值）
+pub const ACTIONS_PER_NPC: usize = 4;
+
+/// 一個 NPC 的視圖（字串欄位皆為字串表編號）
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct RataNpcView {
+    pub id: u32,
+    pub map: u32,
+    pub x: u32,
+    pub y: u32,
+    pub hp: i32,
+    pub max_hp: i32,
+    pub mp: i32,
+    pub flags: u32,
+    pub day: u32,
+    pub hour: u8,
+    pub minute: u8,
+    pub second: u8,
+    pub _reserved: u8,
+    pub terrain: u32,         // 所在格的描述
+    pub temperature: f32,     // 以下三項在 VIEW_HAS_WEATHER 時有效
+    pub rain: f32,
+    pub visibility: f32,
+    pub entities_start: u32,  // 附近實體在 entities 陣列中的區段
+    pub entities_len: u32,
+    pub items_start: u32,     // 所在格的物品在 items 陣列中的區段
+    pub items_len: u32,
+    pub inventory_start: u32, // 背包物品在 items 陣列中的區段
+    pub inventory_len: u32,
+}
+
+/// 附近的實體
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct RataAiEntity {
+    pub id: u32,
+    pub name: u32,
+    pub kind: u32,
+    pub x: u32,
+    pub y: u32,
+}
+
+/// 物品（背包物品的座標為 NPC 所在位置）
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct RataAiItem {
+    pub name: u32,
+    pub count: u32,
+    pub x: u32,
+    pub y: u32,
+}
+
+/// 一批視圖（只在外掛呼叫期間有效）
+#[repr(C)]
+pub struct RataAiBatch {
+    pub views: *const RataNpcView,
+    pub view_count: u32,
+    pub entities: *const RataAiEntity,
+    pub entity_count: u32,
+    pub items: *const RataAiItem,
+    pub item_count: u32,
+    pub strings: *const c_char,      // 以 NUL 分隔的 UTF-8
+    pub string_offsets: *const u32,  // 第 i 個字串從 strings + string_offsets[i] 開始
+    pub string_count: u32,
+}
+
+/// 外掛寫回的一個行為
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct RataAiAction {
+    pub view: u32,           // 行動的 NPC（views 陣列索引）
+    pub kind: u32,
+    pub direction: u32,
+    pub quantity: u32,
+    pub target: u32,         // 目標的 ID（字串表編號）
+    pub text: *const c_char, // NUL 結尾 UTF-8，由外掛持有，引擎在呼叫返回後立即複製
+}
+
+/// 外掛函數：讀取 batch，把最多 cap 個行為寫入 out，返回寫入的數量
+pub type AiDecideFn = unsafe extern "C" fn(*mut c_void, *const RataAiBatch, *mut RataAiAction, u32) -> u32;
+
+#[derive(Clone, Copy)]
+struct Plugin {
+    decide: AiDecideFn,
+    user: usize,
+}
+
+static PLUGIN: Mutex<Option<Plugin>> = Mutex::new(None);
+
+/// 設定原生 AI 外掛（None 表示改回內建策略）
+pub fn set_plugin(decide: Option<AiDecideFn>, user: *mut c_void) {
+    if let Ok(mut plugin) = PLUGIN.lock() {
+        *plugin = decide.map(|decide| Plugin { decide, user: user as usize });
+    }
+}
+
+fn plugin() -> Option<Plugin> {
+    PLUGIN.lock().ok().and_then(|plugin| *plugin)
+}
+
+/// 打包好的一批視圖
+#[derive(Default)]
+pub struct AiBatch {
+    ids: Vec<String>,  // 視圖索引 -> NPC ID
+    views: Vec<RataNpcView>,
+    entities: Vec<RataAiEntity>,
+    items: Vec<RataAiItem>,
+    strings: Vec<u8>,
+    offsets: Vec<u32>,
+    lookup: HashMap<String, u32>,
+}
+
+impl AiBatch {
+    pub fn build(views: &HashMap<String, NpcView>) -> Self {
+        let mut batch = AiBatch::default();
+        for (id, view) in views {
+            batch.push(id, view);
+        }
+        batch
+    }
+
+    fn intern(&mut self, s: &str) -> u32 {
+        if let Some(&id) = self.lookup.get(s) {
+            return id;
+        }
+        let id = self.offsets.len() as u32;
+        self.offsets.push(self.strings.len() as u32);
+        self.strings.extend_from_slice(s.as_bytes());
+        self.strings.push(0);
+        self.lookup.insert(s.to_string(), id);
+        id
+    }
+
+    /// 字串表中的字串
+    pub fn string(&self, id: u32) -> Option<&str> {
+        let start = *self.offsets.get(id as usize)? as usize;
+        let len = self.strings[start..].iter().position(|&b| b == 0)?;
+        std::str::from_utf8(&self.strings[start..start + len]).ok()
+    }
+
+    fn push(&mut self, id: &str, view: &NpcView) {
+        let entities_start = self.entities.len() as u32;
+        for entity in &view.nearby_entities {
+            let kind = match entity.entity_type {
+                EntityType::Player => ENTITY_KIND_PLAYER,
+                EntityType::Npc => ENTITY_KIND_NPC,
+                EntityType::Item => ENTITY_KIND_ITEM,
+            };
+            let (id, name) = (self.intern(&entity.id), self.intern(&entity.name));
+            self.entities.push(RataAiEntity { id, name, kind, x: entity.pos.x as u32, y: entity.pos.y as u32 });
+        }
+        let items_start = self.items.len() as u32;
+        for item in &view.visible_items {
+            let name = self.intern(&item.item_name);
+            self.items.push(RataAiItem { name, count: item.count, x: item.pos.x as u32, y: item.pos.y as u32 });
+        }
+        let inventory_start = self.items.len() as u32;
+        for (item_name, count) in &view.self_items {
+            let name = self.intern(item_name);
+            self.items.push(RataAiItem { name, count: *count, x: view.self_pos.x as u32, y: view.self_pos.y as u32 });
+        }
+
+        let flags = [
+            (view.is_interacting, VIEW_INTERACTING),
+            (view.in_party, VIEW_IN_PARTY),
+            (view.in_combat, VIEW_IN_COMBAT),
+            (view.terrain.walkable, VIEW_WALKABLE),
+            (view.terrain.weather.is_some(), VIEW_HAS_WEATHER),
+        ].iter().filter(|(set, _)| *set).fold(0, |flags, (_, bit)| flags | bit);
+        let (temperature, rain, visibility) = view.terrain.weather
+            .map_or((0.0, 0.0, 0.0), |w| (w.temperature, w.rain, w.visibility));
+        let record = RataNpcView {
+            id: self.intern(id),
+            map: self.intern(&view.current_map),
+            x: view.self_pos.x as u32,
+            y: view.self_pos.y as u32,
+            hp: view.self_hp,
+            max_hp: view.self_max_hp,
+            mp: view.self_mp,
+            flags,
+            day: view.time.day,
+            hour: view.time.hour,
+            minute: view.time.minute,
+            second: view.time.second,
+            _reserved: 0,
+            terrain: self.intern(&view.terrain.description),
+            temperature,
+            rain,
+            visibility,
+            entities_start,
+            entities_len: self.entities.len() as u32 - entities_start,
+            items_start,
+            items_len: inventory_start - items_start,
+            inventory_start,
+            inventory_len: self.items.len() as u32 - inventory_start,
+        };
+        self.ids.push(id.to_string());
+        self.views.push(record);
+    }
+
+    fn raw(&self) -> RataAiBatch {
+        RataAiBatch {
+            views: self.views.as_ptr(),
+            view_count: self.views.len() as u32,
+            entities: self.entities.as_ptr(),
+            entity_count: self.entities.len() as u32,
+            items: self.items.as_ptr(),
+            item_count: self.items.len() as u32,
+            strings: self.strings.as_ptr() as *const c_char,
+            string_offsets: self.offsets.as_ptr(),
+            string_count: self.offsets.len() as u32,
+        }
+    }
+
+    /// 把外掛寫回的行為記錄轉成 (NPC ID, 行為)；NPC 索引、種類或目標無效的記錄略過
+    fn actions(&self, records: &[RataAiAction]) -> Vec<(String, NpcAction)> {
+        let text = |record: &RataAiAction| -> Option<String> {
+            if record.text.is_null() {
+                return None;
+            }
+            Some(unsafe { CStr::from_ptr(record.text) }.to_string_lossy().into_owned())
+        };
+        let target = |record: &RataAiAction| self.string(record.target).map(str::to_string);
+        records.iter().filter_map(|record| {
+            let npc_id = self.ids.get(record.view as usize)?;
+            let action = match record.kind {
+                ACTION_IDLE => NpcAction::Idle,
+                ACTION_SAY => NpcAction::Say(text(record)?),
+                ACTION_MOVE => NpcAction::Move(match record.direction {
+                    0 => Direction::Up,
+                    1 => Direction::Down,
+                    2 => Direction::Left,
+                    3 => Direction::Right,
+                    _ => return None,
+                }),
+                ACTION_PICKUP => NpcAction::PickupItem { item_name: text(record)?, quantity: record.quantity },
+                ACTION_USE_ITEM => NpcAction::UseItem(text(record)?),
+                ACTION_DROP => NpcAction::DropItem { item_name: text(record)?, quantity: record.quantity },
+                ACTION_TRADE => NpcAction::Trade { target_id: target(record)? },
+                ACTION_ATTACK => NpcAction::Attack { target_id: target(record)? },
+                ACTION_USE_SKILL => NpcAction::UseCombatSkill { skill_name: text(record)?, target_id: target(record)? },
+                _ => return None,
+            };
+            Some((npc_id.clone(), action))
+        }).collect()
+    }
+
+    /// 整批交給外掛決定
+    fn decide_with(&self, plugin: Plugin) -> Vec<(String, NpcAction)> {
+        if self.views.is_empty() {
+            return Vec::new();
+        }
+        let raw = self.raw();
+        let cap = self.views.len() * ACTIONS_PER_NPC;
+        let mut out: Vec<RataAiAction> = Vec::with_capacity(cap);
+        let written = unsafe { (plugin.decide)(plugin.user as *mut c_void, &raw, out.as_mut_ptr(), cap as u32) };
+        unsafe { out.set_len((written as usize).min(cap)) };
+        self.actions(&out)
+    }
+}
+
+/// 一次 AI tick 的所有決策：設定了外掛時整批交給外掛，否則由內建策略逐一決定
+pub fn decide_all(views: &HashMap<String, NpcView>, builtin: &NpcAiController) -> Vec<(String, NpcAction)> {
+    match plugin() {
+        Some(plugin) => AiBatch::build(views).decide_with(plugin),
+        None => views.iter()
+            .filter_map(|(id, view)| builtin.decide_action(view).map(|action| (id.clone(), action)))
+            .collect(),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::npc_view::{EntityInfo, Position};
+
+    /// 每個 NPC 往右走；看到玩家的 NPC 攻擊玩家
+    unsafe extern "C" fn test_plugin(_user: *mut c_void, batch: *const RataAiBatch, out: *mut RataAiAction, cap: u32) -> u32 {
+        let batch = &*batch;
+        let views = std::slice::from_raw_parts(batch.views, batch.view_count as usize);
+        let entities = std::slice::from_raw_parts(batch.entities, batch.entity_count as usize);
+        let mut written = 0;
+        for (i, view) in views.iter().enumerate() {
+            let nearby = &entities[view.entities_start as usize..(view.entities_start + view.entities_len) as usize];
+            let action = match nearby.iter().find(|e| e.kind == ENTITY_KIND_PLAYER) {
+                Some(player) => RataAiAction { view: i as u32, kind: ACTION_ATTACK, direction: 0, quantity: 0, target: player.id, text: std::ptr::null() },
+                None => RataAiAction { view: i as u32, kind: ACTION_MOVE, direction: 3, quantity: 0, target: 0, text: std::ptr::null() },
+            };
+            if written < cap {
+                *out.add(written as usize) = action;
+                written += 1;
+            }
+        }
+        written
+    }
+
+    #[test]
+    fn test_plugin_decides_whole_batch() {
+        let mut views = HashMap::new();
+        let mut guard = NpcView::empty("guard".to_string());
+        guard.current_map = "town".to_string();
+        guard.nearby_entities.push(EntityInfo {
+            entity_type: EntityType::Player,
+            id: "player".to_string(),
+            pos: Position { x: 1, y: 0 },
+            name: "旅人".to_string(),
+        });
+        guard.self_items.push(("蘋果".to_string(), 3));
+        let mut farmer = NpcView::empty("farmer".to_string());
+        farmer.current_map = "town".to_string();
+        views.insert("guard".to_string(), guard);
+        views.insert("farmer".to_string(), farmer);
+
+        let batch = AiBatch::build(&views);
+        assert_eq!(batch.views.len(), 2);
+        // 地圖名稱與地形描述在兩個視圖間共用同一個字串
+        let map_ids: Vec<u32> = batch.views.iter().map(|v| v.map).collect();
+        assert_eq!(map_ids[0], map_ids[1]);
+        assert_eq!(batch.string(map_ids[0]), Some("town"));
+        let guard_view = batch.views.iter().find(|v| batch.string(v.id) == Some("guard")).unwrap();
+        assert_eq!((guard_view.entities_len, guard_view.inventory_len), (1, 1));
+
+        set_plugin(Some(test_plugin), std::ptr::null_mut());
+        let mut actions = decide_all(&views, &NpcAiController::new());
+        set_plugin(None, std::ptr::null_mut());
+        actions.sort_by(|a, b| a.0.cmp(&b.0));
+        assert!(matches!(&actions[0], (id, NpcAction::Move(Direction::Right)) if id == "farmer"));
+        assert!(matches!(&actions[1], (id, NpcAction::Attack { target_id }) if id == "guard" && target_id == "player"));
+    }
+}
@@ -1,5 +1,6 @@
 use serde::{Deserialize, Serialize};
 use crate::npc_view::NpcView;
+use crate::rng::Rng;
 
 /// 方向
 #[derive(Clone, Debug, Serialize, Deserialize, PartialEq, Eq)]
@@ -132,7 +133,9 @@ impl NpcAiStrategy for InteractingStrategy {
 }
 
 /// 戰鬥策略
-pub struct CombatStrategy;
+pub struct CombatStrategy {
+    rng: Rng,
+}
 
 impl NpcAiStrategy for CombatStrategy {
     fn decide_action(&self, npc_view: &NpcView) -> Option<NpcAction> {
@@ -140,10 +143,8 @@ impl NpcAiStrategy for CombatStrategy {
             return None;
         }
         
-        use rand::Rng;
-        let mut rng = rand::thread_rng();
         let skills = ["punch", "kick"];
-        let skill_name = skills[rng.gen_range(0..skills.len())];
+        let skill_name = skills[self.rng.below(skills.len())];
         
         Some(NpcAction::UseCombatSkill {
             skill_name: skill_name.to_string(),
@@ -199,14 +200,13 @@ impl NpcAiStrategy for HealingStrategy {
 }
 
 /// 隨機行為策略
-pub struct RandomBehaviorStrategy;
+pub struct RandomBehaviorStrategy {
+    rng: Rng,
+}
 
 impl NpcAiStrategy for RandomBehaviorStrategy {
     fn decide_action(&self, _npc_view: &NpcView) -> Option<NpcAction> {
-        use rand::Rng;
-        
-        let mut rng = rand::thread_rng();
-        let roll = rng.gen_range(0..100);
+        let roll = self.rng.below(100);
         
         if roll < 20 && !_npc_view.visible_items.is_empty() {
             let item = &_npc_view.visible_items[0];
@@ -214,9 +214,10 @@ impl NpcAiStrategy for RandomBehaviorStrategy {
                 item_name: item.item_name.clone(),
                 quantity: 1,
             })
-        } else if roll < 30 {
+        } else if roll < 30 && !_npc_view.terrain.weather.is_some_and(|w| w.is_raining()) {
+            // 下雨時留在原地躲雨
             let directions = [Direction::Up, Direction::Down, Direction::Left, Direction::Right];
-            let direction = directions[rng.gen_range(0..directions.len())].clone();
+            let direction = directions[self.rng.below(directions.len())].clone();
             Some(NpcAction::Move(direction))
         } else {
             Some(NpcAction::Idle)
@@ -256,13 +257,20 @@ impl NpcAiStrategyComposer {
     }
 }
 
-impl Default for NpcAiStrategyComposer {
-    fn default() -> Self {
+impl NpcAiStrategyComposer {
+    /// 預設策略組合，隨機策略從指定的亂數來源分流（同一 seed 得到相同的 NPC 行為）
+    pub fn with_rng(rng: &Rng) -> Self {
         Self::new()
             .add_strategy(Box::new(InteractingStrategy))
-            .add_strategy(Box::new(CombatStrategy))
+            .add_strategy(Box::new(CombatStrategy { rng: rng.split() }))
             .add_strategy(Box::new(PartyStrategy))
             .add_strategy(Box::new(HealingStrategy))
-            .add_strategy(Box::new(RandomBehaviorStrategy))
+            .add_strategy(Box::new(RandomBehaviorStrategy { rng: rng.split() }))
+    }
+}
+
+impl Default for NpcAiStrategyComposer {
+    fn default() -> Self {
+        Self::with_rng(&Rng::from_entropy())
     }
 }
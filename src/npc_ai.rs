@@ -12,6 +12,13 @@ impl NpcAiController {
             strategy_composer: NpcAiStrategyComposer::default(),
         }
     }
+
+    /// 使用指定的亂數來源創建（世界 seed 固定時 NPC 行為可重現）
+    pub fn with_rng(rng: &crate::rng::Rng) -> Self {
+        Self {
+            strategy_composer: NpcAiStrategyComposer::with_rng(rng),
+        }
+    }
     
     /// 根據 NpcView 決定 NPC 的行為（使用 Strategy 模式）
     /// 這個方法只返回意圖，不修改任何狀態
@@ -1,5 +1,5 @@
 use crate::person::Person;
-use std::collections::HashMap;
+use std::collections::{HashMap, HashSet};
 
 /// NPC 管理器，負責管理遊戲中的所有 NPC
 #[derive(Clone)]
@@ -7,6 +7,9 @@ pub struct NpcManager {
     npcs: HashMap<String, Person>,  // NPC ID -> Person
     npc_aliases: HashMap<String, String>,  // 別名 -> NPC ID
     previous_distances: HashMap<String, usize>,  // 用於追蹤 NPC 與 me 的前一次距離（for 靠近/離開檢測）
+    transient: HashSet<String>,  // 事件生成的暫時 NPC（不存檔，離開時回收到物件池）
+    handles: HashMap<String, u32>,  // NPC ID -> 數字代號（C API 使用；第一次加入時配發，之後不變也不重用）
+    handle_ids: Vec<String>,        // 數字代號 - 1 -> NPC ID
 }
 
 impl Default for NpcManager {
@@ -21,9 +24,47 @@ impl NpcManager {
             npcs: HashMap::new(),
             npc_aliases: HashMap::new(),
             previous_distances: HashMap::new(),
+            transient: HashSet::new(),
+            handles: HashMap::new(),
+            handle_ids: Vec::new(),
         }
     }
 
+    /// 配發數字代號（已有代號時不變）
+    fn assign_handle(&mut self, id: &str) {
+        if !self.handles.contains_key(id) {
+            self.handle_ids.push(id.to_string());
+            self.handles.insert(id.to_string(), self.handle_ids.len() as u32);
+        }
+    }
+
+    /// NPC 的數字代號（從 1 開始；同一個 ID 移除後再加入仍是同一個代號）
+    pub fn handle(&self, id: &str) -> Option<u32> {
+        self.handles.get(id).copied()
+    }
+
+    /// 由數字代號取得 NPC ID
+    pub fn id_for_handle(&self, handle: u32) -> Option<&str> {
+        let index = (handle as usize).checked_sub(1)?;
+        self.handle_ids.get(index).map(String::as_str)
+    }
+
+    /// 依數字代號排列的 NPC ID（含已移除的 ID，快照使用）
+    pub fn handle_ids(&self) -> &[String] {
+        &self.handle_ids
+    }
+
+    /// 還原代號表（快照還原時在加入 NPC 之前呼叫，之後加入的 NPC 沿用原代號）
+    pub fn restore_handles(&mut self, ids: Vec<String>) {
+        self.handles = ids.iter().enumerate().map(|(i, id)| (id.clone(), i as u32 + 1)).collect();
+        self.handle_ids = ids;
+    }
+
+    /// 所有別名 -> NPC ID（含 ID 本身的小寫）
+    pub fn aliases(&self) -> impl Iterator<Item = (&String, &String)> {
+        self.npc_aliases.iter()
+    }
+
     /// 添加 NPC
     pub fn add_npc(&mut self, id: String, mut npc: Person, aliases: Vec<String>) {
         // 確保 NPC 有預設的 10000 金幣（如果沒有或為0）
@@ -34,6 +75,12 @@ impl NpcManager {
         // 根據 NPC 屬性更新描述
         npc.update_description();
         
+        self.insert_npc(id, npc, aliases);
+    }
+
+    /// 原樣加入 NPC（快照還原使用：不補金幣、不重寫描述）
+    pub fn insert_npc(&mut self, id: String, npc: Person, aliases: Vec<String>) {
+        self.assign_handle(&id);
         self.npcs.insert(id.clone(), npc);
         
         // 添加別名映射
@@ -88,6 +135,11 @@ impl NpcManager {
         self.npcs.keys().cloned().collect()
     }
 
+    /// 逐一走訪 (ID, NPC)，不複製 ID
+    pub fn iter(&self) -> impl Iterator<Item = (&String, &Person)> {
+        self.npcs.iter()
+    }
+
     /// 獲取指定位置的 NPC（不過濾地圖，保留供特殊用途）
     #[allow(dead_code)]
     pub fn get_npcs_at(&self, x: usize, y: usize) -> Vec<&Person> {
@@ -124,9 +176,46 @@ impl NpcManager {
     /// 移除 NPC
     #[allow(dead_code)]
     pub fn remove_npc(&mut self, id: &str) -> Option<Person> {
+        self.transient.remove(id);
+        self.npcs.remove(id)
+    }
+
+    /// 加入事件生成的暫時 NPC（角色已由物件池初始化，不補金幣也不重算描述）
+    pub fn insert_transient(&mut self, id: &str, npc: Person) {
+        self.npc_aliases.insert(id.to_lowercase(), id.to_string());
+        self.transient.insert(id.to_string());
+        self.assign_handle(id);
+        self.npcs.insert(id.to_string(), npc);
+    }
+
+    /// 移除暫時 NPC（連同別名），非暫時 NPC 不受影響
+    pub fn remove_transient(&mut self, id: &str) -> Option<Person> {
+        if !self.transient.remove(id) {
+            return None;
+        }
+        self.npc_aliases.remove(&id.to_lowercase());
+        self.previous_distances.remove(id);
         self.npcs.remove(id)
     }
 
+    /// 取得暫時 NPC（以 ID 直接查找）
+    pub fn get_transient_mut(&mut self, id: &str) -> Option<&mut Person> {
+        if !self.transient.contains(id) {
+            return None;
+        }
+        self.npcs.get_mut(id)
+    }
+
+    /// 是否有此 ID 的 NPC（只比對 ID，不查別名與名稱）
+    pub fn contains(&self, id: &str) -> bool {
+        self.npcs.contains_key(id)
+    }
+
+    /// 是否為事件生成的暫時 NPC
+    pub fn is_transient(&self, id: &str) -> bool {
+        self.transient.contains(id)
+    }
+
     /// 通過名稱或別名和位置移除 NPC
     pub fn remove_npc_at(&mut self, name_or_id: &str, x: usize, y: usize) -> Option<(String, Person)> {
         let key = name_or_id.to_lowercase();
@@ -158,7 +247,7 @@ impl NpcManager {
 
     /// 保存所有 NPC
     pub fn save_all(&self, person_dir: &str) -> Result<(), Box<dyn std::error::Error>> {
-        for (id, npc) in &self.npcs {
+        for (id, npc) in self.npcs.iter().filter(|(id, _)| !self.transient.contains(*id)) {
             npc.save(person_dir, id)?;
         }
         Ok(())
@@ -352,3 +441,18 @@ impl NpcManager {
         notifications
     }
 }
+
+impl crate::mem_stats::HeapSize for NpcManager {
+    fn heap_size(&self) -> usize {
+        self.npcs.heap_size() + self.npc_aliases.heap_size() + self.previous_distances.heap_size()
+            + self.transient.iter().map(|id| id.heap_size()).sum::<usize>()
+            + self.handles.heap_size() + self.handle_ids.heap_size()
+    }
+}
+
+impl NpcManager {
+    /// 所有角色對話表的堆積記憶體總和
+    pub fn dialogue_heap_size(&self) -> usize {
+        self.npcs.values().map(Person::dialogue_heap_size).sum()
+    }
+}
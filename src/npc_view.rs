@@ -46,6 +46,8 @@ pub struct ItemInfo {
 pub struct TerrainInfo {
     pub walkable: bool,
     pub description: String,
+    #[serde(default)]
+    pub weather: Option<crate::weather::RegionWeather>,  // 所在區域的天氣
 }
 
 /// NPC 可見的世界快照（不可變）
@@ -118,6 +120,7 @@ impl NpcView {
             terrain: TerrainInfo {
                 walkable: true,
                 description: "未知區域".to_string(),
+                weather: None,
             },
             is_interacting: false,
             in_party: false,
@@ -554,13 +554,7 @@ impl OutputManager {
                             line_spans.push(Span::styled(" ", Style::default().fg(Color::White)));
                         } else {
                             // 根據地圖類型顯示不同字符
-                            let char_display = match map.map_type {
-                                crate::map::MapType::Forest => "🌲",
-                                crate::map::MapType::Cave => "▓",
-                                crate::map::MapType::Desert => "≈",
-                                crate::map::MapType::Mountain => "△",
-                                _ => "x",
-                            };
+                            let char_display = map.wall_glyph().to_string();
                             line_spans.push(Span::styled(char_display, Style::default().fg(Color::White)));
                         }
                     } else {
@@ -579,3 +573,17 @@ impl OutputManager {
             .style(Style::default().bg(Color::Black).fg(Color::White))
     }
 }
+
+impl crate::mem_stats::HeapSize for OutputManager {
+    /// 訊息緩衝區、日誌與小地圖行（小地圖每格一個 Span）
+    fn heap_size(&self) -> usize {
+        let minimap = self.minimap_lines.capacity() * std::mem::size_of::<Line>()
+            + self.minimap_lines.iter()
+                .map(|line| line.spans.capacity() * std::mem::size_of::<Span>()
+                    + line.spans.iter().map(|span| span.content.len()).sum::<usize>())
+                .sum::<usize>();
+        self.messages.heap_size() + self.status.heap_size() + self.side_messages.heap_size()
+            + self.side_content.heap_size() + self.current_time.heap_size()
+            + self.log_messages.heap_size() + minimap
+    }
+}
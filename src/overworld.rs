@@ -0,0 +1,297 @@
+// 無限大地圖（程序生成的區塊）
+// 大地圖切成 CHUNK_SIZE×CHUNK_SIZE 的區塊，每個區塊是一張名為 overworld_{cx}_{cy} 的一般地圖，
+// 第一次進入時才生成，之後留在記憶體中；只有被修改（建造者指令、撿放物品等會呼叫 save_map 的操作）
+// 的區塊才會寫入 maps 資料夾，未修改的區塊每次都由種子重新生成，內容完全相同。
+//
+// 生成：以種子化的值噪聲（value noise，多層 fBm）計算海拔與濕度決定生態區，
+// 再以高頻細節噪聲決定可行走性，相鄰格與相鄰區塊連續（不再是每格獨立隨機）。
+// 生成只依賴 (種子, 區塊座標)，可在背景執行緒中預先生成玩家前方的區塊。
+
+use std::collections::{HashMap, HashSet};
+use std::sync::mpsc;
+use std::thread;
+
+use crate::map::{Cell, DescriptionDb, Map, MapType, TerrainType};
+use crate::rng::mix64;
+
+/// 區塊邊長（地圖點數）
+pub const CHUNK_SIZE: usize = 32;
+/// 區塊地圖名稱的前綴
+const PREFIX: &str = "overworld_";
+
+/// 區塊座標
+pub type ChunkPos = (i32, i32);
+
+/// 區塊的地圖名稱
+pub fn chunk_map_name((cx, cy): ChunkPos) -> String {
+    format!("{PREFIX}{cx}_{cy}")
+}
+
+/// 由地圖名稱解析區塊座標（不是大地圖區塊時返回 None）
+pub fn parse_chunk_name(name: &str) -> Option<ChunkPos> {
+    let (cx, cy) = name.strip_prefix(PREFIX)?.split_once('_')?;
+    Some((cx.parse().ok()?, cy.parse().ok()?))
+}
+
+/// 種子化的二維值噪聲：整數格點上的雜湊值以平滑插值連接，輸出 [0, 1)
+#[derive(Debug, Clone, Copy)]
+pub struct ValueNoise {
+    seed: u64,
+}
+
+impl ValueNoise {
+    pub fn new(seed: u64) -> Self {
+        ValueNoise { seed }
+    }
+
+    fn lattice(&self, x: i64, y: i64) -> f32 {
+        let h = mix64(self.seed ^ mix64((x as u64).wrapping_mul(0x9E37_79B9_7F4A_7C15) ^ (y as u64)));
+        (h >> 40) as f32 / (1u64 << 24) as f32
+    }
+
+    pub fn sample(&self, x: f64, y: f64) -> f32 {
+        let (x0, y0) = (x.floor(), y.floor());
+        let smooth = |t: f64| (t * t * (3.0 - 2.0 * t)) as f32;
+        let (tx, ty) = (smooth(x - x0), smooth(y - y0));
+        let (ix, iy) = (x0 as i64, y0 as i64);
+        let top = self.lattice(ix, iy) + (self.lattice(ix + 1, iy) - self.lattice(ix, iy)) * tx;
+        let bottom = self.lattice(ix, iy + 1) + (self.lattice(ix + 1, iy + 1) - self.lattice(ix, iy + 1)) * tx;
+        top + (bottom - top) * ty
+    }
+
+    /// 多層疊加（fractal Brownian motion），輸出仍在 [0, 1)
+    pub fn fbm(&self, x: f64, y: f64, octaves: u32) -> f32 {
+        let (mut sum, mut amplitude, mut frequency, mut total) = (0.0, 1.0, 1.0, 0.0);
+        for octave in 0..octaves {
+            // 每層錯開原點，避免各層在 (0, 0) 對齊
+            let offset = octave as f64 * 17.31;
+            sum += amplitude * self.sample(x * frequency + offset, y * frequency - offset);
+            total += amplitude;
+            amplitude *= 0.5;
+            frequency *= 2.0;
+        }
+        sum / total
+    }
+}
+
+/// 大地圖生成器（只含種子，可複製到背景執行緒）
+#[derive(Debug, Clone, Copy)]
+pub struct OverworldGen {
+    elevation: ValueNoise,
+    moisture: ValueNoise,
+    detail: ValueNoise,
+}
+
+/// 一格的生態區
+struct Tile {
+    biome: MapType,
+    walkable: bool,
+    terrain: TerrainType,
+}
+
+impl OverworldGen {
+    pub fn new(seed: u64) -> Self {
+        OverworldGen {
+            elevation: ValueNoise::new(mix64(seed ^ 1)),
+            moisture: ValueNoise::new(mix64(seed ^ 2)),
+            detail: ValueNoise::new(mix64(seed ^ 3)),
+        }
+    }
+
+    fn tile(&self, wx: i64, wy: i64) -> Tile {
+        let (x, y) = (wx as f64, wy as f64);
+        let elevation = self.elevation.fbm(x / 96.0, y / 96.0, 4);
+        let moisture = self.moisture.fbm(x / 128.0, y / 128.0, 3);
+        let detail = self.detail.sample(x / 5.0, y / 5.0);
+        // (生態區, 細節噪聲高於此值才可行走)
+        let (biome, threshold) = match (elevation, moisture) {
+            (e, _) if e < 0.3 => return Tile { biome: MapType::Normal, walkable: false, terrain: TerrainType::Water },
+            (e, _) if e > 0.68 => (MapType::Mountain, 0.55),
+            (_, m) if m < 0.38 => (MapType::Desert, 0.15),
+            (_, m) if m > 0.58 => (MapType::Forest, 0.35),
+            _ => (MapType::Normal, 0.25),
+        };
+        Tile { biome, walkable: detail > threshold, terrain: TerrainType::Normal }
+    }
+
+    /// 生成一個區塊（同一種子與座標永遠得到相同的地圖）
+    pub fn generate(&self, pos: ChunkPos) -> Map {
+        let db = DescriptionDb::shared();
+        let (ox, oy) = (pos.0 as i64 * CHUNK_SIZE as i64, pos.1 as i64 * CHUNK_SIZE as i64);
+        let center = self.tile(ox + CHUNK_SIZE as i64 / 2, oy + CHUNK_SIZE as i64 / 2).biome;
+        let mut cells = Vec::with_capacity(CHUNK_SIZE * CHUNK_SIZE);
+        for y in 0..CHUNK_SIZE {
+            for x in 0..CHUNK_SIZE {
+                let (wx, wy) = (ox + x as i64, oy + y as i64);
+                let tile = self.tile(wx, wy);
+                let descriptions = db.descriptions(&tile.biome);
+                let pick = mix64((wx as u64) << 32 ^ wy as u64 ^ self.detail.seed) as usize;
+                let description = descriptions.get(pick % descriptions.len().max(1))
+                    .copied()
+                    .unwrap_or("未知地點");
+                cells.push(Cell {
+                    walkable: tile.walkable,
+                    terrain_type: tile.terrain,
+                    description: description.into(),
+                    name: String::new(),
+                });
+            }
+        }
+        Map::from_cells(chunk_map_name(pos), center, CHUNK_SIZE, cells)
+    }
+}
+
+/// 大地圖區塊的生成與預取
+/// 背景執行緒依請求生成區塊，主執行緒取用時若尚未完成則直接同步生成
+pub struct Overworld {
+    generator: OverworldGen,
+    worker: Option<(mpsc::Sender<ChunkPos>, mpsc::Receiver<Map>)>,
+    pending: HashSet<ChunkPos>,
+    ready: HashMap<ChunkPos, Map>,
+}
+
+impl Clone for Overworld {
+    /// 複製的世界不共用背景執行緒，預取的結果也不複製
+    fn clone(&self) -> Self {
+        Overworld::new_with_gen(self.generator)
+    }
+}
+
+impl Overworld {
+    pub fn new(seed: u64) -> Self {
+        Self::new_with_gen(OverworldGen::new(seed))
+    }
+
+    fn new_with_gen(generator: OverworldGen) -> Self {
+        Overworld { generator, worker: None, pending: HashSet::new(), ready: HashMap::new() }
+    }
+
+    /// 請求背景生成 center 周圍 radius 個區塊內、known 判定為尚未存在的區塊
+    pub fn prefetch(&mut self, center: ChunkPos, radius: i32, known: impl Fn(ChunkPos) -> bool) {
+        self.drain();
+        for dy in -radius..=radius {
+            for dx in -radius..=radius {
+                let pos = (center.0 + dx, center.1 + dy);
+                if self.pending.contains(&pos) || self.ready.contains_key(&pos) || known(pos) {
+                    continue;
+                }
+                if self.request(pos) {
+                    self.pending.insert(pos);
+                }
+            }
+        }
+    }
+
+    fn request(&mut self, pos: ChunkPos) -> bool {
+        if self.worker.is_none() {
+            let (request_tx, request_rx) = mpsc::channel::<ChunkPos>();
+            let (result_tx, result_rx) = mpsc::channel();
+            let generator = self.generator;
+            let spawned = thread::Builder::new()
+                .name("overworld-gen".to_string())
+                .spawn(move || {
+                    // 世界被丟棄（請求端關閉）時結束
+                    for pos in request_rx {
+                        if result_tx.send(generator.generate(pos)).is_err() {
+                            break;
+                        }
+                    }
+                });
+            if spawned.is_err() {
+                return false;
+            }
+            self.worker = Some((request_tx, result_rx));
+        }
+        self.worker.as_ref().is_some_and(|(tx, _)| tx.send(pos).is_ok())
+    }
+
+    /// 收下背景執行緒已完成的區塊
+    fn drain(&mut self) {
+        let Some((_, results)) = &self.worker else {
+            return;
+        };
+        for map in results.try_iter() {
+            if let Some(pos) = parse_chunk_name(&map.name) {
+                // 已被同步生成取走的區塊不再保留
+                if self.pending.remove(&pos) {
+                    self.ready.insert(pos, map);
+                }
+            }
+        }
+    }
+
+    /// 取得區塊：優先使用預取的結果，否則同步生成
+    pub fn take(&mut self, pos: ChunkPos) -> Map {
+        self.drain();
+        if let Some(map) = self.ready.remove(&pos) {
+            return map;
+        }
+        self.pending.remove(&pos);
+        self.generator.generate(pos)
+    }
+
+    /// 預取完成、尚未取用的區塊數
+    #[allow(dead_code)]
+    pub fn ready_count(&mut self) -> usize {
+        self.drain();
+        self.ready.len()
+    }
+}
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for Overworld {
+    fn heap_size(&self) -> usize {
+        self.ready.heap_size() + self.pending.capacity() * std::mem::size_of::<ChunkPos>()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_chunks_are_deterministic_and_continuous() {
+        assert_eq!(parse_chunk_name(&chunk_map_name((-3, 7))), Some((-3, 7)));
+        assert_eq!(parse_chunk_name("beginMap"), None);
+
+        let generator = OverworldGen::new(42);
+        let a = generator.generate((-1, 0));
+        let b = OverworldGen::new(42).generate((-1, 0));
+        let walkable = |map: &Map| map.cells().iter().map(|cell| cell.walkable).collect::<Vec<_>>();
+        assert_eq!(walkable(&a), walkable(&b));
+        assert_ne!(walkable(&a), walkable(&OverworldGen::new(43).generate((-1, 0))));
+
+        // 噪聲連續：相鄰取樣點的差異很小
+        let noise = ValueNoise::new(7);
+        for i in 0..100 {
+            let x = i as f64 * 0.37;
+            assert!((noise.sample(x, 1.5) - noise.sample(x + 0.01, 1.5)).abs() < 0.05);
+        }
+
+        // 背景預取的結果與同步生成相同
+        let mut overworld = Overworld::new(42);
+        overworld.prefetch((0, 0), 1, |pos| pos == (0, 0));
+        let prefetched = overworld.take((1, 1));
+        assert_eq!(walkable(&prefetched), walkable(&generator.generate((1, 1))));
+        assert_eq!(prefetched.name, "overworld_1_1");
+    }
+
+    #[test]
+    fn test_saved_chunks_stay_out_of_map_list() {
+        let world_dir = std::env::temp_dir().join(format!("ratamud_overworld_{}", std::process::id()));
+        let mut world = crate::world::GameWorld::new_with_dir(&world_dir.to_string_lossy());
+        world.metadata.overworld_seed = Some(42);
+        let name = chunk_map_name((2, -1));
+
+        // 生成的區塊被修改後存檔，再次進入時載入存檔，兩次都不列入地圖清單
+        assert!(world.change_map(&name));
+        world.maps.get_mut(&name).unwrap().cell_mut(1, 1).unwrap().name = "營地".to_string();
+        world.save_map(&world.maps[&name]).unwrap();
+        world.maps.remove(&name);
+        assert!(world.change_map(&name));
+        assert_eq!(world.maps[&name].cell(1, 1).unwrap().name, "營地");
+        assert!(!world.metadata.maps.contains(&name));
+        let _ = std::fs::remove_dir_all(&world_dir);
+    }
+}
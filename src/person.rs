@@ -1,25 +1,30 @@
 use crate::time_updatable::{TimeUpdatable, TimeInfo};
 use crate::item_registry;
 use serde::{Deserialize, Serialize};
+use std::borrow::Cow;
 use std::fs;
 use std::path::Path;
 use std::collections::HashMap;
-use rand::Rng;
+use crate::rng::Rng;
+use crate::shared_assets::Dialogues;
 use std::sync::OnceLock;
 
 // 全域靜態描述資料
 static PERSON_DESCRIPTIONS: OnceLock<PersonDescriptions> = OnceLock::new();
 
-// 描述資料結構
-#[derive(Debug, Deserialize)]
+// 描述資料結構（字串借用來源資料：資源包映射的頁面，或讀檔後保留的 JSON）
+// 顏值表的鍵與值直接借用（&str，不能含跳脫字元）；區間描述為 Cow，含跳脫字元時才配置
+#[derive(Debug, Deserialize, Default)]
 pub struct PersonDescriptions {
-    pub appearance: HashMap<String, String>,
+    #[serde(borrow)]
+    pub appearance: HashMap<&'static str, &'static str>,
     pub strength: AttributeRanges,
     pub build: AttributeRanges,
     pub health_status: HealthStatusRanges,
 }
 
-#[derive(Debug, Deserialize)]
+#[derive(Debug, Deserialize, Default)]
+#[serde(bound(deserialize = "'de: 'static"))]
 pub struct AttributeRanges {
     pub ranges: Vec<AttributeRange>,
 }
@@ -28,10 +33,12 @@ pub struct AttributeRanges {
 pub struct AttributeRange {
     pub min: i32,
     pub max: i32,
-    pub description: String,
+    #[serde(borrow)]
+    pub description: Cow<'static, str>,
 }
 
-#[derive(Debug, Deserialize)]
+#[derive(Debug, Deserialize, Default)]
+#[serde(bound(deserialize = "'de: 'static"))]
 pub struct HealthStatusRanges {
     pub ranges: Vec<HealthStatusRange>,
 }
@@ -39,29 +46,34 @@ pub struct HealthStatusRanges {
 #[derive(Debug, Deserialize)]
 pub struct HealthStatusRange {
     pub hp_ratio: f32,
-    pub description: String,
+    #[serde(borrow)]
+    pub description: Cow<'static, str>,
 }
 
 impl PersonDescriptions {
+    /// 優先使用資源包中的描述表，否則讀檔（只載入一次，JSON 保留到行程結束）
     pub fn load() -> Result<Self, Box<dyn std::error::Error>> {
         let json_path = "worlds/person_descriptions.json";
-        let json_str = fs::read_to_string(json_path)?;
-        let descriptions: PersonDescriptions = serde_json::from_str(&json_str)?;
+        let json_str: &'static str = match crate::asset_pack::asset(crate::asset_pack::KIND_PERSON_DESCRIPTIONS, json_path) {
+            Some(bytes) => std::str::from_utf8(bytes)?,
+            None => Box::leak(fs::read_to_string(json_path)?.into_boxed_str()),
+        };
+        let descriptions: PersonDescriptions = serde_json::from_str(json_str)?;
         Ok(descriptions)
     }
 
     pub fn get_appearance_description(&self, appearance: i32) -> String {
         let clamped = appearance.clamp(1, 100);
         self.appearance
-            .get(&clamped.to_string())
-            .cloned()
+            .get(clamped.to_string().as_str())
+            .map(|s| s.to_string())
             .unwrap_or_else(|| "普通的".to_string())
     }
 
     pub fn get_strength_description(&self, strength: i32) -> String {
         for range in &self.strength.ranges {
             if strength >= range.min && strength <= range.max {
-                return range.description.clone();
+                return range.description.to_string();
             }
         }
         "普通的".to_string()
@@ -70,7 +82,7 @@ impl PersonDescriptions {
     pub fn get_build_description(&self, build: i32) -> String {
         for range in &self.build.ranges {
             if build >= range.min && build <= range.max {
-                return range.description.clone();
+                return range.description.to_string();
             }
         }
         "普通".to_string()
@@ -85,7 +97,7 @@ impl PersonDescriptions {
         
         for range in &self.health_status.ranges {
             if hp_ratio <= range.hp_ratio {
-                return range.description.clone();
+                return range.description.to_string();
             }
         }
         
@@ -93,18 +105,15 @@ impl PersonDescriptions {
     }
 }
 
-/// 初始化描述資料（應在程式啟動時調用）
+/// 預先載入描述資料（可選；未呼叫時在第一次使用描述時才載入）
+#[allow(dead_code)]
 pub fn init_person_descriptions() {
-    PERSON_DESCRIPTIONS.get_or_init(|| {
-        PersonDescriptions::load().expect("Failed to load person descriptions")
-    });
+    get_descriptions();
 }
 
-/// 獲取全域描述資料
+/// 獲取全域描述資料（第一次呼叫時讀取 JSON；檔案不存在時使用預設描述）
 fn get_descriptions() -> &'static PersonDescriptions {
-    PERSON_DESCRIPTIONS.get_or_init(|| {
-        PersonDescriptions::load().expect("Failed to load person descriptions")
-    })
+    PERSON_DESCRIPTIONS.get_or_init(|| PersonDescriptions::load().unwrap_or_default())
 }
 
 // 對話條件
@@ -258,7 +267,7 @@ pub struct Person {
     #[serde(default)]
     pub is_interacting: bool,        // 是否正在互動中（交易、對話等）
     #[serde(default)]
-    pub dialogues: HashMap<String, Vec<DialogueOption>>,  // 話題 -> 對話選項列表
+    pub dialogues: Dialogues,        // 話題 -> 對話選項列表（內容相同的角色跨世界共用）
     #[serde(default = "default_talk_eagerness")]
     pub talk_eagerness: u8,          // 說話積極度 (0-100)
     #[serde(default)]
@@ -325,7 +334,7 @@ impl Person {
             is_sleeping: false,
             last_mp_restore_minute: 0,
             is_interacting: false,    // 初始化為 false
-            dialogues: HashMap::new(),
+            dialogues: Dialogues::default(),
             talk_eagerness: 100,
             relationship: 0,
             dialogue_state: "初見".to_string(),
@@ -434,15 +443,10 @@ impl Person {
     }
     
     /// 獲取技能台詞（從一般對話系統，隨機選擇）
-    pub fn get_skill_dialogue(&self, skill_name: &str) -> String {
+    pub fn get_skill_dialogue(&self, skill_name: &str, rng: &Rng) -> String {
         // 從對話系統中獲取技能台詞（隨機選擇一個）
-        if let Some(dialogue_options) = self.dialogues.get(skill_name) {
-            if !dialogue_options.is_empty() {
-                use rand::Rng;
-                let mut rng = rand::thread_rng();
-                let index = rng.gen_range(0..dialogue_options.len());
-                return dialogue_options[index].text.clone();
-            }
+        if let Some(option) = self.dialogues.get(skill_name).and_then(|options| rng.pick(options)) {
+            return option.text.clone();
         }
         // 預設台詞
         "攻擊！".to_string()
@@ -513,13 +517,13 @@ impl Person {
 
     /// 設置台詞（新版：支援多個選項）
     pub fn add_dialogue_option(&mut self, topic: String, option: DialogueOption) {
-        self.dialogues.entry(topic).or_default().push(option);
+        self.dialogues.make_mut().entry(topic).or_default().push(option);
     }
 
     /// 設置台詞（簡單版：無條件）
     pub fn set_dialogue(&mut self, topic: String, text: String) {
         let option = DialogueOption::new(text);
-        self.dialogues.entry(topic).or_default().push(option);
+        self.dialogues.make_mut().entry(topic).or_default().push(option);
     }
 
     /// 設置說話積極度 (0-100)
@@ -581,7 +585,7 @@ impl Person {
         if !self.dialogues.is_empty() {
             info.push_str("├─────────────────────────\n");
             info.push_str(&format!("│ 對話 (積極度: {}%)\n", self.talk_eagerness));
-            for (topic, options) in &self.dialogues {
+            for (topic, options) in self.dialogues.iter() {
                 info.push_str(&format!("│  [{topic}] {} 個選項\n", options.len()));
                 for (i, opt) in options.iter().enumerate() {
                     let cond_str = if opt.conditions.is_empty() {
@@ -611,7 +615,7 @@ impl Person {
 
     /// 根據權重選擇對話（新版）
     /// target_person: 用來評估條件的 Person（通常是玩家）
-    pub fn get_weighted_dialogue(&self, topic: &str, target_person: &Person) -> Option<String> {
+    pub fn get_weighted_dialogue(&self, topic: &str, target_person: &Person, rng: &Rng) -> Option<String> {
         let options = self.dialogues.get(topic)?;
         if options.is_empty() {
             return None;
@@ -630,8 +634,7 @@ impl Person {
         }
         
         // 加權隨機選擇
-        let mut rng = rand::thread_rng();
-        let mut roll = rng.gen::<f32>() * total_weight;
+        let mut roll = rng.next_f32() * total_weight;
         
         for (i, &weight) in weights.iter().enumerate() {
             roll -= weight;
@@ -650,12 +653,11 @@ impl Person {
 
     /// 嘗試說話（根據積極度和權重）
     /// target_person: 用來評估條件的 Person（通常是玩家）
-    pub fn try_talk(&self, topic: &str, target_person: &Person) -> Option<String> {
+    pub fn try_talk(&self, topic: &str, target_person: &Person, rng: &Rng) -> Option<String> {
         // 根據積極度決定是否說話
-        let mut rng = rand::thread_rng();
-        let roll: u8 = rng.gen_range(0..100);                
+        let roll = rng.below(100) as u8;
         if roll < self.talk_eagerness {
-            self.get_weighted_dialogue(topic, target_person)
+            self.get_weighted_dialogue(topic, target_person, rng)
         } else {
             None
         }
@@ -664,7 +666,7 @@ impl Person {
     /// 根據好感度和狀態動態選擇對話（僅測試使用）
     #[cfg(test)]
     pub fn get_context_dialogue(&self, scene: &str) -> Option<String> {
-        self.get_weighted_dialogue(scene, self)
+        self.get_weighted_dialogue(scene, self, &Rng::from_entropy())
     }
     
     /// 改變好感度
@@ -962,6 +964,73 @@ impl TimeUpdatable for Person {
     }
 }
 
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for DialogueCondition {
+    fn heap_size(&self) -> usize {
+        self.attribute.heap_size() + self.operator.heap_size() + self.value.heap_size()
+    }
+}
+
+impl HeapSize for DialogueOption {
+    fn heap_size(&self) -> usize {
+        self.text.heap_size() + self.conditions.heap_size()
+    }
+}
+
+impl HeapSize for CombatSkill {
+    fn heap_size(&self) -> usize {
+        self.name.heap_size()
+    }
+}
+
+impl Person {
+    /// 對話表佔用的堆積記憶體（記憶體報告中與角色本體分開列出）
+    pub fn dialogue_heap_size(&self) -> usize {
+        self.dialogues.heap_size()
+    }
+
+    /// 以自己（原型）覆寫 slot 的所有欄位，重用 slot 已配置的字串、Vec 與 HashMap 容量（物件池使用）
+    /// 完整解構而不使用 `..`：新增欄位時會編譯失敗，避免回收的角色殘留舊資料
+    pub fn clone_into_slot(&self, slot: &mut Person) {
+        let Person {
+            name, description, abilities, items, item_instances, status, x, y, map,
+            hp, mp, max_hp, max_mp, strength, knowledge, sociality, age, last_hunger_hour,
+            is_sleeping, last_mp_restore_minute, is_interacting, dialogues, talk_eagerness,
+            relationship, dialogue_state, met_player, interaction_count, gender, appearance,
+            build, party_leader, combat_skills, combat_exp,
+        } = slot;
+        name.clone_from(&self.name);
+        description.clone_from(&self.description);
+        abilities.clone_from(&self.abilities);
+        items.clone_from(&self.items);
+        item_instances.clone_from(&self.item_instances);
+        status.clone_from(&self.status);
+        map.clone_from(&self.map);
+        dialogues.clone_from(&self.dialogues);
+        dialogue_state.clone_from(&self.dialogue_state);
+        gender.clone_from(&self.gender);
+        party_leader.clone_from(&self.party_leader);
+        combat_skills.clone_from(&self.combat_skills);
+        (*x, *y) = (self.x, self.y);
+        (*hp, *mp, *max_hp, *max_mp) = (self.hp, self.mp, self.max_hp, self.max_mp);
+        (*strength, *knowledge, *sociality) = (self.strength, self.knowledge, self.sociality);
+        (*age, *last_hunger_hour, *last_mp_restore_minute) = (self.age, self.last_hunger_hour, self.last_mp_restore_minute);
+        (*is_sleeping, *is_interacting, *met_player) = (self.is_sleeping, self.is_interacting, self.met_player);
+        (*talk_eagerness, *relationship, *interaction_count) = (self.talk_eagerness, self.relationship, self.interaction_count);
+        (*appearance, *build, *combat_exp) = (self.appearance, self.build, self.combat_exp);
+    }
+}
+
+impl HeapSize for Person {
+    fn heap_size(&self) -> usize {
+        self.name.heap_size() + self.description.heap_size() + self.abilities.heap_size()
+            + self.items.heap_size() + self.item_instances.heap_size() + self.status.heap_size()
+            + self.map.heap_size() + self.dialogue_heap_size() + self.dialogue_state.heap_size()
+            + self.gender.heap_size() + self.party_leader.heap_size() + self.combat_skills.heap_size()
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -1031,6 +1100,16 @@ mod tests {
         assert_eq!(person.get_context_dialogue("告別"), None);
     }
     
+    #[test]
+    fn test_descriptions_borrow_source() {
+        // 顏值表的字串直接指向來源 JSON，不另外配置
+        let json: &'static str = include_str!("../worlds/person_descriptions.json");
+        let descriptions: PersonDescriptions = serde_json::from_str(json).unwrap();
+        let word = descriptions.appearance["50"];
+        assert!(json.as_bytes().as_ptr_range().contains(&word.as_ptr()));
+        assert_eq!(descriptions.get_appearance_description(50), word);
+    }
+
     #[test]
     fn test_relationship_description() {
         let mut person = Person::new("NPC".to_string(), "測試".to_string());
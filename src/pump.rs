@@ -0,0 +1,177 @@
+// 時間預算內推進引擎（C API：宿主在自己的畫面迴圈中每幀呼叫，做完預算內的工作就返回）
+// 每次依優先順序處理：提交的命令 → 時鐘與天氣 → 到期事件 → NPC AI；
+// 每完成一個工作單位就檢查一次預算，用完即停止，剩下的工作留到下一次呼叫。
+// 到期事件先收進待執行佇列，每次取最多 EVENT_BATCH 個以 execute_batch 執行（與終端相同的交易語意與日誌），
+// 因此一大批同時到期的事件也能分散到多幀；批次內的事件依序規劃，分批執行的結果與一次執行相同。
+// NPC AI 與終端的 AI 執行緒相同，每 AI_INTERVAL 執行一次，不是每幀執行。
+// 單一工作單位（一個命令、一批事件、一次 AI tick）不會被中途打斷。
+
+use std::collections::VecDeque;
+use std::time::{Duration, Instant};
+
+use crate::core_output::CoreOutputManager;
+use crate::event_executor::EventExecutor;
+use crate::npc_ai::NpcAiController;
+use crate::world::GameWorld;
+
+/// 每批執行的事件數上限
+const EVENT_BATCH: usize = 16;
+/// NPC AI 的執行間隔（與終端模式的 AI 執行緒相同）
+pub const AI_INTERVAL: Duration = Duration::from_secs(5);
+
+/// 一次 pump 的結果
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct PumpReport {
+    pub commands: usize,        // 執行的命令數
+    pub events: usize,          // 執行的事件數
+    pub ai_ticks: usize,        // 執行的 AI tick 數（0 或 1）
+    pub pending_events: usize,  // 已到期、尚未執行的事件數
+    pub ai_pending: bool,       // 已到執行時間的 AI tick 尚未執行
+    pub elapsed: Duration,
+}
+
+/// 跨呼叫保留的待執行工作
+#[derive(Default)]
+pub struct Pump {
+    world: u32,
+    events: VecDeque<String>,
+    ai_pending: bool,
+    last_ai: Option<Instant>,  // 上次執行 AI tick 的時間
+}
+
+impl Pump {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// 在 budget 內推進世界
+    /// next_command 執行一個已提交的命令，佇列為空時返回 false
+    pub fn run(
+        &mut self,
+        world: &mut GameWorld,
+        budget: Duration,
+        builtin: &NpcAiController,
+        output: &mut CoreOutputManager,
+        mut next_command: impl FnMut(&mut GameWorld) -> bool,
+    ) -> PumpReport {
+        let start = Instant::now();
+        let in_budget = || start.elapsed() < budget;
+        let mut report = PumpReport::default();
+
+        // 換了世界（例如讀入快照）時，舊世界的待執行工作作廢
+        if self.world != world.alloc_scope.id() {
+            self.world = world.alloc_scope.id();
+            self.events.clear();
+        }
+        if self.last_ai.is_none_or(|last| last.elapsed() >= AI_INTERVAL) {
+            self.ai_pending = true;
+        }
+
+        // 1. 命令：玩家的輸入最優先
+        while in_budget() && next_command(world) {
+            report.commands += 1;
+        }
+
+        let _scope = world.alloc_scope.enter();
+
+        // 2. 時鐘：同步遊戲時間與天氣，收集本分鐘到期的事件
+        if in_budget() {
+            world.update_time();
+            use crate::time_updatable::TimeUpdatable;
+            let time_info = world.get_time_info();
+            if let Some(me) = world.npc_manager.get_npc_mut("me") {
+                me.on_time_update(&time_info);
+            }
+            output.add_messages(world.take_weather_narration());
+            self.events.extend(world.collect_due_events());
+        }
+
+        // 3. 事件：每次一批，日誌與終端的主循環相同
+        while in_budget() && !self.events.is_empty() {
+            let due: Vec<String> = self.events.drain(..self.events.len().min(EVENT_BATCH)).collect();
+            let mut logs: Vec<String> = due.iter().filter_map(|event_id| world.event_log_line(event_id)).collect();
+            let batch = EventExecutor::execute_batch(&due, world, output);
+            logs.extend(batch.failures.into_iter().map(|(_, e)| format!("⚠️  事件執行錯誤: {e}")));
+            output.add_log(logs.join("\n"));
+            report.events += due.len();
+        }
+
+        // 4. NPC AI
+        if self.ai_pending && in_budget() {
+            for message in world.run_ai_tick(builtin) {
+                let text = message.to_display_text();
+                if message.is_log() {
+                    output.add_log(text);
+                } else {
+                    output.add_message(text);
+                }
+            }
+            self.ai_pending = false;
+            self.last_ai = Some(Instant::now());
+            report.ai_ticks = 1;
+        }
+
+        report.pending_events = self.events.len();
+        report.ai_pending = self.ai_pending;
+        report.elapsed = start.elapsed();
+        report
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::map::Map;
+    use crate::rng::WorldRng;
+
+    #[test]
+    fn test_pump_stops_at_budget() {
+        let mut world = GameWorld::new_with_dir("unused");
+        let builtin = NpcAiController::new();
+        let mut output = CoreOutputManager::new();
+        let mut pump = Pump::new();
+
+        // 預算為零：什麼都不做，AI tick 留待下一次
+        let mut queued = 100;
+        let mut next = |_: &mut GameWorld| if queued > 0 { queued -= 1; true } else { false };
+        let report = pump.run(&mut world, Duration::ZERO, &builtin, &mut output, &mut next);
+        assert_eq!((report.commands, report.ai_ticks, report.ai_pending), (0, 0, true));
+
+        // 每個命令耗時 1 毫秒：5 毫秒的預算只夠執行一部分，其餘留在佇列中
+        let report = pump.run(&mut world, Duration::from_millis(5), &builtin, &mut output, |_| {
+            std::thread::sleep(Duration::from_millis(1));
+            true
+        });
+        assert!(report.commands >= 1 && report.commands < 100);
+        assert!(report.ai_pending);
+
+        // 預算足夠：命令全部執行，AI 也跑完
+        let report = pump.run(&mut world, Duration::from_secs(10), &builtin, &mut output, &mut next);
+        assert_eq!((report.commands, report.ai_ticks, report.ai_pending), (100, 1, false));
+
+        // AI 每 AI_INTERVAL 才執行一次，不是每幀執行
+        let report = pump.run(&mut world, Duration::from_secs(10), &builtin, &mut output, &mut next);
+        assert_eq!((report.ai_ticks, report.ai_pending), (0, false));
+    }
+
+    #[test]
+    fn test_pump_narrates_weather_changes() {
+        let mut world = GameWorld::new_with_dir("unused");
+        world.add_map(Map::new("beginMap".to_string(), 5, 5, &WorldRng::new(1)));
+        world.add_map(Map::new("field".to_string(), 5, 5, &WorldRng::new(2)));
+        let (weather, sunny) = world.property_schema.resolve("天氣", "晴天").unwrap();
+        let (_, rainy) = world.property_schema.resolve("天氣", "雨天").unwrap();
+
+        // 初次設定與其他地圖的變化不描述，目前地圖的變化由 pump 輸出
+        world.set_map_property("beginMap", weather, sunny).unwrap();
+        world.set_map_property("field", weather, sunny).unwrap();
+        world.set_map_property("field", weather, rainy).unwrap();
+        world.set_map_property("beginMap", weather, rainy).unwrap();
+        let mut output = CoreOutputManager::new();
+        Pump::new().run(&mut world, Duration::from_secs(10), &NpcAiController::new(), &mut output, |_| false);
+
+        let rain = "📢 🌧️ 開始下起雨來，雨滴打在地上發出滴答聲。";
+        assert_eq!(output.get_messages().iter().filter(|m| m.as_str() == rain).count(), 1);
+        assert!(world.take_weather_narration().is_empty());
+    }
+}
@@ -465,6 +465,49 @@ impl QuestManager {
     }
 }
 
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for QuestCondition {
+    fn heap_size(&self) -> usize {
+        match self {
+            QuestCondition::TalkToNpc { npc_id, .. } => npc_id.heap_size(),
+            QuestCondition::HasItem { item, .. } => item.heap_size(),
+            QuestCondition::KillEnemy { enemy, .. } => enemy.heap_size(),
+            QuestCondition::ReachLocation { map, .. } => map.heap_size(),
+            QuestCondition::PlayerStat { stat, .. } => stat.heap_size(),
+            QuestCondition::NpcRelationship { npc_id, .. } => npc_id.heap_size(),
+        }
+    }
+}
+
+impl HeapSize for QuestReward {
+    fn heap_size(&self) -> usize {
+        match self {
+            QuestReward::Item { item, .. } => item.heap_size(),
+            QuestReward::Experience { .. } => 0,
+            QuestReward::Relationship { npc_id, .. } => npc_id.heap_size(),
+            QuestReward::UnlockDialogue { npc_id, scene, text } => {
+                npc_id.heap_size() + scene.heap_size() + text.heap_size()
+            }
+            QuestReward::StatBoost { stat, .. } => stat.heap_size(),
+        }
+    }
+}
+
+impl HeapSize for Quest {
+    fn heap_size(&self) -> usize {
+        self.id.heap_size() + self.name.heap_size() + self.description.heap_size()
+            + self.prerequisites.heap_size() + self.conditions.heap_size()
+            + self.rewards.heap_size() + self.giver.heap_size()
+    }
+}
+
+impl HeapSize for QuestManager {
+    fn heap_size(&self) -> usize {
+        self.quests.heap_size() + self.completed_quests.heap_size()
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
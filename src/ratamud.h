@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,11 +34,268 @@ void ratamud_register_event_callback(EventCallback callback);
 
 // ============= 遊戲引擎 API（推薦使用）=============
 
-/// 處理命令（返回 1=繼續, 0=退出, -1=錯誤）
+/// 處理命令（返回 1=繼續, 0=退出, -1=錯誤, -2=超過記憶體預算）
 int ratamud_input_command(const char* command);
 
 void ratamud_start_game(void);
 
+/// 記憶體使用報告（JSON: maps/npcs/dialogues/events/quests/total 位元組數）
+/// 以 snprintf 語意寫入 buf，返回完整長度（不含 NUL），-1=尚未初始化
+/// 可先以 (NULL, 0) 查詢所需長度
+int ratamud_memory_report(char* buf, size_t buf_len);
+
+// ============= 宿主分配器與每個世界的配置計數（需以 host-alloc feature 建置）=============
+
+typedef void* (*RataMallocFn)(size_t size, void* user);
+typedef void (*RataFreeFn)(void* ptr, void* user);
+typedef void* (*RataReallocFn)(void* ptr, size_t size, void* user);
+
+/// 設定宿主分配器，應在 ratamud_init_game 之前呼叫（每個程序一次）
+/// realloc_fn 可為 NULL；malloc_fn 回傳的位址不需特別對齊（例如只有 8 位元組對齊的配置器也可以）
+/// 返回 0=成功, -1=未支援或參數為 NULL, -2=已經設定過
+int ratamud_set_allocator(RataMallocFn malloc_fn, RataFreeFn free_fn, RataReallocFn realloc_fn, void* user);
+
+typedef struct RataAllocStats {
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+    uint64_t alloc_count;
+    uint64_t budget;      /* 0 = 不限制 */
+} RataAllocStats;
+
+/// 目前遊戲世界的配置計數編號，0=尚未初始化
+uint32_t ratamud_world_id(void);
+
+/// 讀取世界的配置統計，返回 0=成功, -1=未支援或編號無效
+int ratamud_world_alloc_stats(uint32_t world, RataAllocStats* out);
+
+/// 設定世界的記憶體預算（0=不限制）；超過時 ratamud_input_command 返回 -2 且不執行命令
+int ratamud_set_world_budget(uint32_t world, uint64_t bytes);
+
+// ============= 批次查詢（渲染器、遙測用；引擎不配置記憶體）=============
+
+/// 矩形範圍：左上角 (x, y) 與寬高；{0, 0, UINT32_MAX, UINT32_MAX} 表示整張地圖
+typedef struct RataRect {
+    uint32_t x, y, w, h;
+} RataRect;
+
+/// 角色旗標
+#define RATA_ENTITY_PLAYER      (1u << 0)  /* 玩家本人（me） */
+#define RATA_ENTITY_CONTROLLED  (1u << 1)  /* 目前操控中的角色 */
+#define RATA_ENTITY_TRANSIENT   (1u << 2)  /* 事件生成的暫時 NPC */
+#define RATA_ENTITY_IN_PARTY    (1u << 3)  /* 已組隊 */
+#define RATA_ENTITY_SLEEPING    (1u << 4)  /* 睡眠中 */
+#define RATA_ENTITY_INTERACTING (1u << 5)  /* 交易、對話中 */
+
+/// 角色查詢結果的欄位陣列，由呼叫者配置，每個陣列至少 cap 個元素；NULL 的欄位不寫入
+typedef struct RataEntitySoA {
+    uint32_t* ids;     /* 數字代號（以 ratamud_entity_id 取得字串 ID） */
+    uint32_t* x;
+    uint32_t* y;
+    int32_t* hp;
+    int32_t* max_hp;
+    uint32_t* flags;   /* RATA_ENTITY_* */
+} RataEntitySoA;
+
+/// 查詢世界（ratamud_world_id 的編號）中地圖（NULL=目前地圖）上矩形範圍內的角色，最多寫入 cap 筆
+/// 代號只在同一個世界內有效：換了世界（讀入快照）後以舊編號查詢會失敗
+/// 返回符合的角色總數（可能大於 cap），-1=編號不符、錯誤或尚未初始化
+int ratamud_query_entities(uint32_t world, const char* map, RataRect rect, RataEntitySoA* out, size_t cap);
+
+/// 查詢地圖（NULL=目前地圖，需已載入）上矩形範圍的格子，NULL 的圖層略過
+/// 矩形先裁切到地圖範圍內，以下的 w、h 指裁切後的寬高（整張地圖時即 ratamud_map_size 的結果）
+/// walk: 可行走位元，每列 (w + 7) / 8 個位元組，x 由小到大對應位元由低到高
+/// glyphs: 每格一個 Unicode 碼位（w * h 個，列優先）
+/// 返回 0=成功（矩形完全在地圖外時不寫入），-1=世界編號不符、地圖未載入、緩衝區不足或尚未初始化
+int ratamud_query_tiles(uint32_t world, const char* map, RataRect rect, uint8_t* walk, size_t walk_len,
+                        uint32_t* glyphs, size_t glyphs_len);
+
+/// 取得地圖（NULL=目前地圖，需已載入）的寬高，NULL 的輸出略過
+/// 返回 0=成功，-1=世界編號不符、地圖未載入或尚未初始化
+int ratamud_map_size(uint32_t world, const char* map, uint32_t* width, uint32_t* height);
+
+/// 世界的物品統計
+typedef struct RataCensus {
+    uint32_t maps_loaded;
+    uint32_t npcs;
+    uint64_t items_on_maps;
+    uint64_t items_carried;
+} RataCensus;
+
+/// 統計世界中的角色與物品（壓力測試檢查物品守恆用）
+/// 返回 0=成功, -1=編號不符、out 為 NULL 或尚未初始化
+int ratamud_world_census(uint32_t world, RataCensus* out);
+
+/// 以數字代號（同一個世界的查詢結果）取得角色 ID（snprintf 語意），返回長度，-1=世界編號不符或代號不存在
+int ratamud_entity_id(uint32_t world, uint32_t handle, char* buf, size_t buf_len);
+
+// ============= 非同步命令（多執行緒提交，輸出依請求歸屬）=============
+
+/// 提交命令（任何執行緒皆可呼叫，不等待世界鎖）；cmd 為 len 個位元組的 UTF-8，不需 NUL 結尾
+/// session 與 tag 原樣出現在完成記錄中；命令在下一次 ratamud_run_submitted 時執行
+/// 返回 0=已排入, -1=cmd 為 NULL 或不是 UTF-8
+int ratamud_submit(uint32_t world, uint64_t session, const char* cmd, size_t len, uint64_t tag);
+
+/// 在引擎執行緒依提交順序執行最多 max 個命令（0=目前佇列中的全部），返回執行的數量
+/// 執行期間的輸出收進各自的完成記錄，不經過輸出回調；world 編號不符時完成狀態為 -1
+int ratamud_run_submitted(size_t max);
+
+/// 一個提交命令的完成記錄
+typedef struct RataCompletion {
+    uint64_t session;
+    uint64_t tag;
+    int status;           /* 同 ratamud_input_command：1=繼續, 0=退出, -1=錯誤, -2=超過預算 */
+    uint32_t output_len;  /* 輸出的位元組數 */
+} RataCompletion;
+
+/// 取出最早的完成記錄；輸出以連續的 "區域\0內容\0" 寫入 buf（區域為 MAIN/LOG/STATUS/SIDE）
+/// buf_len < output_len 時只填入 out，記錄留在佇列中
+/// 返回 1=取得, 0=佇列為空, -1=out 為 NULL, -2=緩衝區不足
+int ratamud_poll_completion(RataCompletion* out, char* buf, size_t buf_len);
+
+/// 等待完成記錄最多 timeout_ms 毫秒，返回 1=有完成記錄, 0=逾時
+int ratamud_wait_completion(uint32_t timeout_ms);
+
+/// 完成佇列的 eventfd（非空時可讀，可加入 epoll；取空後自動歸零），-1=此平台不支援
+int ratamud_completion_fd(void);
+
+// ============= 擴充命令（宿主以 C/C++ 實作命令）=============
+
+/// 擴充命令函數：argv[0] 為命令名稱，argv 為切分好的 NUL 結尾 UTF-8（只在呼叫期間有效）
+/// world 為目前世界的編號；返回 1=繼續, 0=退出, 負數=錯誤（顯示在狀態列）
+typedef int (*RataCommandFn)(void* user, uint32_t world, const char* const* argv, uint32_t argc);
+
+/// 註冊擴充命令：輸入的第一個字為 name 時呼叫 command（以雜湊表查找，優先於同名的內建命令）
+/// command 為 NULL 時移除該命令；command 在引擎執行緒上、持有世界鎖時被呼叫，
+/// 其中只可呼叫 ratamud_emit_output，不可呼叫其他 ratamud_* 函數
+/// 返回 0=成功, -1=name 為 NULL 或不是 UTF-8
+int ratamud_register_command(const char* name, RataCommandFn command, void* user);
+
+/// 送出輸出（zone: "MAIN"/"LOG"/"STATUS"/"SIDE"），供擴充命令使用；
+/// 經 ratamud_submit 執行時收進該命令的完成記錄
+/// 返回 0=成功, -1=參數為 NULL、不是 UTF-8 或區域不存在
+int ratamud_emit_output(const char* zone, const char* text);
+
+// ============= 原生 AI 外掛（宿主以 C/C++ 決定 NPC 行為）=============
+
+#define RATA_VIEW_INTERACTING  (1u << 0)  /* 交易、對話中 */
+#define RATA_VIEW_IN_PARTY     (1u << 1)  /* 已組隊 */
+#define RATA_VIEW_IN_COMBAT    (1u << 2)  /* 戰鬥中 */
+#define RATA_VIEW_WALKABLE     (1u << 3)  /* 所在格可行走 */
+#define RATA_VIEW_HAS_WEATHER  (1u << 4)  /* 天氣欄位有效 */
+
+#define RATA_AI_ENTITY_PLAYER 0
+#define RATA_AI_ENTITY_NPC    1
+#define RATA_AI_ENTITY_ITEM   2
+
+#define RATA_AI_IDLE       0
+#define RATA_AI_SAY        1  /* text: 說的話 */
+#define RATA_AI_MOVE       2  /* direction: 0 上, 1 下, 2 左, 3 右 */
+#define RATA_AI_PICKUP     3  /* text: 物品名稱, quantity */
+#define RATA_AI_USE_ITEM   4  /* text: 物品名稱 */
+#define RATA_AI_DROP       5  /* text: 物品名稱, quantity */
+#define RATA_AI_TRADE      6  /* target */
+#define RATA_AI_ATTACK     7  /* target */
+#define RATA_AI_USE_SKILL  8  /* text: 技能名稱, target */
+
+/// 每個 NPC 最多可寫回的行為數（cap = view_count * RATA_AI_ACTIONS_PER_NPC）
+#define RATA_AI_ACTIONS_PER_NPC 4
+
+/// 一個 NPC 的視圖；id、map、terrain 與實體/物品的名稱皆為字串表編號
+typedef struct RataNpcView {
+    uint32_t id;
+    uint32_t map;
+    uint32_t x, y;
+    int32_t hp, max_hp, mp;
+    uint32_t flags;            /* RATA_VIEW_* */
+    uint32_t day;
+    uint8_t hour, minute, second, reserved;
+    uint32_t terrain;          /* 所在格的描述 */
+    float temperature, rain, visibility;  /* RATA_VIEW_HAS_WEATHER 時有效 */
+    uint32_t entities_start, entities_len;    /* 附近實體在 entities 中的區段 */
+    uint32_t items_start, items_len;          /* 所在格的物品在 items 中的區段 */
+    uint32_t inventory_start, inventory_len;  /* 背包物品在 items 中的區段 */
+} RataNpcView;
+
+typedef struct RataAiEntity {
+    uint32_t id, name, kind;   /* kind: RATA_AI_ENTITY_* */
+    uint32_t x, y;
+} RataAiEntity;
+
+typedef struct RataAiItem {
+    uint32_t name, count;
+    uint32_t x, y;             /* 背包物品為 NPC 所在位置 */
+} RataAiItem;
+
+/// 一批視圖（只在 decide 呼叫期間有效）
+typedef struct RataAiBatch {
+    const RataNpcView* views;
+    uint32_t view_count;
+    const RataAiEntity* entities;
+    uint32_t entity_count;
+    const RataAiItem* items;
+    uint32_t item_count;
+    const char* strings;              /* 以 NUL 分隔的 UTF-8 */
+    const uint32_t* string_offsets;   /* 第 i 個字串從 strings + string_offsets[i] 開始 */
+    uint32_t string_count;
+} RataAiBatch;
+
+/// 外掛寫回的一個行為；無效的記錄（索引、種類或目標錯誤）會被略過
+typedef struct RataAiAction {
+    uint32_t view;             /* 行動的 NPC（views 陣列索引） */
+    uint32_t kind;             /* RATA_AI_* */
+    uint32_t direction;
+    uint32_t quantity;
+    uint32_t target;           /* 目標 ID 的字串表編號 */
+    const char* text;          /* NUL 結尾 UTF-8，由外掛持有，引擎在 decide 返回後立即複製 */
+} RataAiAction;
+
+/// 外掛函數：讀取 batch，把最多 cap 個行為寫入 out，返回寫入的數量
+typedef uint32_t (*RataAiDecideFn)(void* user, const RataAiBatch* batch, RataAiAction* out, uint32_t cap);
+
+/// 設定原生 AI 外掛：每個 AI tick 以整批視圖呼叫 decide 一次（NULL 表示改回內建策略）
+/// 外掛在引擎執行緒上、持有世界鎖時被呼叫，不可再呼叫 ratamud_* 函數
+void ratamud_set_ai_plugin(RataAiDecideFn decide, void* user);
+
+/// 執行一次 NPC AI（外掛或內建策略），行為產生的訊息經輸出回調送出
+/// 返回產生的訊息數，-1=尚未初始化
+int ratamud_run_ai(void);
+
+// ============= 時間預算推進（嵌入宿主的畫面迴圈）=============
+
+/// ratamud_pump 的結果
+typedef struct RataPumpStats {
+    uint32_t commands_run;
+    uint32_t events_run;
+    uint32_t ai_ticks;
+    uint32_t queued_commands;  /* 剩餘的已提交命令 */
+    uint32_t pending_events;   /* 剩餘的到期事件 */
+    uint32_t ai_pending;       /* 1=已到執行時間的 AI tick 尚未執行 */
+    uint64_t elapsed_us;
+} RataPumpStats;
+
+/// 在 budget_us 微秒內依優先順序推進世界：提交的命令、時鐘、到期事件（每批最多 16 個）、NPC AI（每 5 秒一次）
+/// 每完成一個工作單位檢查一次預算，用完即返回，剩下的工作留到下一次呼叫
+/// 命令的輸出進入完成佇列，其餘經輸出回調送出；out 可為 NULL
+/// 返回剩餘的工作數（0=已閒置），-1=編號不符或尚未初始化
+int ratamud_pump(uint32_t world, uint64_t budget_us, RataPumpStats* out);
+
+// ============= 世界快照（宿主自行保存、複製或搬移執行中的世界）=============
+
+/// 快照寫入回調：收到一段資料（最多 64 KiB），返回 0=成功，非 0 中止寫入
+typedef int (*RataSnapshotWriteFn)(void* user, const uint8_t* data, size_t len);
+
+/// 快照讀取回調：最多填入 cap 個位元組，返回實際長度，0=資料結束
+typedef size_t (*RataSnapshotReadFn)(void* user, uint8_t* buf, size_t cap);
+
+/// 把世界（ratamud_world_id 的編號）寫成二進位快照，分段交給 writer
+/// 寫入期間持有世界鎖，回調中不可再呼叫 ratamud_* 函數
+/// 返回 0=成功, -1=編號不符或尚未初始化, -2=寫入失敗或被回調中止
+int ratamud_snapshot_write(uint32_t world, RataSnapshotWriteFn writer, void* user);
+
+/// 由 reader 讀取快照，還原後取代目前的世界（失敗時原世界不變）；新世界的編號以 ratamud_world_id 取得
+/// 返回 0=成功, -1=reader 為 NULL, -2=資料損壞或不完整
+int ratamud_snapshot_read(RataSnapshotReadFn reader, void* user);
+
 /// 測試輸出回調功能（會生成各種類型的測試輸出）
 void ratamud_test_output_callback(void);
 
@@ -0,0 +1,210 @@
+// 可注入的亂數產生器
+// 每個世界持有一個 WorldRng，依子系統切分為獨立的亂數流（地圖、事件、NPC AI、戰鬥、對話…），
+// 同一 seed 產生完全相同的結果，供基準測試、重播與分片執行使用。
+// 演算法為 SplitMix64：非密碼學用途，狀態只有 8 位元組，每次取值只需數個乘法與位移。
+
+use std::collections::hash_map::RandomState;
+use std::hash::{BuildHasher, Hasher};
+use std::sync::atomic::{AtomicU64, Ordering};
+
+/// SplitMix64 的黃金比例增量
+const GOLDEN_GAMMA: u64 = 0x9E37_79B9_7F4A_7C15;
+
+/// SplitMix64 輸出混合函數
+pub(crate) fn mix64(mut z: u64) -> u64 {
+    z = (z ^ (z >> 30)).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+    z = (z ^ (z >> 27)).wrapping_mul(0x94D0_49BB_1331_11EB);
+    z ^ (z >> 31)
+}
+
+/// 單一亂數流（SplitMix64）
+/// 狀態以 Relaxed 的 load/store 存取（不是原子讀改寫，沒有鎖定成本），
+/// 讓持有 `&GameWorld` 的唯讀路徑（事件觸發判斷、對話選擇）也能取值，並可放進需要 Sync 的 AI 策略中。
+/// 每個亂數流應只由一個執行緒使用；需要跨執行緒時以 split() 分出新的流。
+#[derive(Debug)]
+pub struct Rng {
+    state: AtomicU64,
+}
+
+impl Clone for Rng {
+    fn clone(&self) -> Self {
+        Rng::seed_from_u64(self.state.load(Ordering::Relaxed))
+    }
+}
+
+impl Rng {
+    pub fn seed_from_u64(seed: u64) -> Self {
+        Rng { state: AtomicU64::new(seed) }
+    }
+
+    /// 以程序層級的隨機來源（雜湊種子 + 時間）建立，用於未指定 seed 的情況
+    pub fn from_entropy() -> Self {
+        Rng::seed_from_u64(entropy_seed())
+    }
+
+    pub fn next_u64(&self) -> u64 {
+        let state = self.state.load(Ordering::Relaxed).wrapping_add(GOLDEN_GAMMA);
+        self.state.store(state, Ordering::Relaxed);
+        mix64(state)
+    }
+
+    /// [0, n) 的均勻整數（乘法取高位，無除法）；n 為 0 時返回 0
+    pub fn below(&self, n: usize) -> usize {
+        ((self.next_u64() as u128 * n as u128) >> 64) as usize
+    }
+
+    /// [low, high) 的均勻整數；範圍為空時返回 low
+    pub fn range(&self, low: i64, high: i64) -> i64 {
+        if high <= low {
+            return low;
+        }
+        let span = high.wrapping_sub(low) as u64;
+        low.wrapping_add(((self.next_u64() as u128 * span as u128) >> 64) as i64)
+    }
+
+    /// [0, 1) 的浮點數
+    pub fn next_f32(&self) -> f32 {
+        (self.next_u64() >> 40) as f32 * (1.0 / (1u64 << 24) as f32)
+    }
+
+    /// [0, 1) 的浮點數
+    pub fn next_f64(&self) -> f64 {
+        (self.next_u64() >> 11) as f64 * (1.0 / (1u64 << 53) as f64)
+    }
+
+    /// 以機率 p 返回 true
+    pub fn chance(&self, p: f64) -> bool {
+        self.next_f64() < p
+    }
+
+    /// 從切片中隨機選一個元素
+    pub fn pick<'a, T>(&self, items: &'a [T]) -> Option<&'a T> {
+        if items.is_empty() {
+            None
+        } else {
+            Some(&items[self.below(items.len())])
+        }
+    }
+
+    /// 分出一個獨立的子亂數流（推進本流一次）
+    pub fn split(&self) -> Rng {
+        Rng::seed_from_u64(mix64(self.next_u64() ^ GOLDEN_GAMMA))
+    }
+}
+
+/// 程序層級的隨機種子：RandomState 每次建立都會帶入 OS 提供的隨機鍵
+fn entropy_seed() -> u64 {
+    let mut hasher = RandomState::new().build_hasher();
+    if let Ok(elapsed) = std::time::SystemTime::now().duration_since(std::time::UNIX_EPOCH) {
+        hasher.write_u128(elapsed.as_nanos());
+    }
+    hasher.finish()
+}
+
+/// 各子系統的亂數流，互不干擾：新增一個子系統的取值不會改變其他子系統的序列
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RngStream {
+    MapGen,       // 地圖生成
+    Description,  // 地點描述
+    Items,        // 物品生成
+    Events,       // 事件動作（隨機位置、隨機動作）
+    Scheduler,    // 事件觸發機率
+    NpcAi,        // NPC AI 行為
+    Combat,       // 戰鬥
+    Dialogue,     // 對話選擇
+    Weather,      // 區域天氣模擬
+}
+
+impl RngStream {
+    pub const ALL: [RngStream; 9] = [
+        RngStream::MapGen,
+        RngStream::Description,
+        RngStream::Items,
+        RngStream::Events,
+        RngStream::Scheduler,
+        RngStream::NpcAi,
+        RngStream::Combat,
+        RngStream::Dialogue,
+        RngStream::Weather,
+    ];
+}
+
+/// 每個世界一份的亂數來源，依子系統提供獨立的亂數流
+#[derive(Debug, Clone)]
+pub struct WorldRng {
+    seed: u64,
+    streams: [Rng; RngStream::ALL.len()],
+}
+
+impl WorldRng {
+    pub fn new(seed: u64) -> Self {
+        WorldRng {
+            seed,
+            streams: RngStream::ALL.map(|stream| {
+                Rng::seed_from_u64(mix64(seed ^ mix64((stream as u64 + 1).wrapping_mul(GOLDEN_GAMMA))))
+            }),
+        }
+    }
+
+    pub fn from_entropy() -> Self {
+        WorldRng::new(entropy_seed())
+    }
+
+    /// 建立時使用的 seed（可寫入 world.json 以重現）
+    pub fn seed(&self) -> u64 {
+        self.seed
+    }
+
+    pub fn stream(&self, stream: RngStream) -> &Rng {
+        &self.streams[stream as usize]
+    }
+
+    /// 各亂數流目前的狀態（快照保存，以 restore 接續同一序列）
+    pub fn states(&self) -> Vec<u64> {
+        self.streams.iter().map(|rng| rng.state.load(Ordering::Relaxed)).collect()
+    }
+
+    /// 由 seed 與 states 的結果還原；亂數流數量不符時返回 None
+    pub fn restore(seed: u64, states: &[u64]) -> Option<Self> {
+        let states: [u64; RngStream::ALL.len()] = states.try_into().ok()?;
+        Some(WorldRng { seed, streams: states.map(Rng::seed_from_u64) })
+    }
+
+    /// 由某個亂數流派生出一整組新的 WorldRng（例如交給 NPC AI 執行緒或分片工作者）
+    pub fn split(&self, stream: RngStream) -> WorldRng {
+        WorldRng::new(self.stream(stream).next_u64())
+    }
+}
+
+impl Default for WorldRng {
+    fn default() -> Self {
+        WorldRng::from_entropy()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_world_rng_deterministic_streams() {
+        let a = WorldRng::new(42);
+        let b = WorldRng::new(42);
+        let seq = |rng: &WorldRng, s| (0..8).map(|_| rng.stream(s).next_u64()).collect::<Vec<_>>();
+        assert_eq!(seq(&a, RngStream::Combat), seq(&b, RngStream::Combat));
+
+        // 其他亂數流的取值不影響本流
+        let c = WorldRng::new(42);
+        c.stream(RngStream::MapGen).next_u64();
+        assert_eq!(seq(&c, RngStream::Dialogue), seq(&b, RngStream::Dialogue));
+        assert_ne!(seq(&a, RngStream::Events), seq(&a, RngStream::NpcAi));
+
+        let rng = Rng::seed_from_u64(7);
+        for _ in 0..1000 {
+            assert!(rng.below(10) < 10);
+            assert!((-5..5).contains(&rng.range(-5, 5)));
+            assert!((0.0..1.0).contains(&rng.next_f32()));
+        }
+        assert_eq!(rng.below(0), 0);
+    }
+}
@@ -9,6 +9,9 @@ pub struct GameSettings {
     pub show_minimap: bool,
     // 是否顯示日誌視窗
     pub show_log: bool,
+    // 啟動時是否輸出詳細日誌（各地圖統計、每個角色位置）
+    #[serde(default)]
+    pub verbose_startup: bool,
 }
 
 impl Default for GameSettings {
@@ -16,6 +19,7 @@ impl Default for GameSettings {
         GameSettings {
             show_minimap: false,
             show_log: true,  // 日誌視窗預設開啟
+            verbose_startup: false,
         }
     }
 }
@@ -0,0 +1,334 @@
+// 跨世界共用的不可變資源層：同一行程中的多個世界共用一份資源，世界本身只保存可變的部分
+// - 地圖基底：每格的可行走性、地形、描述與名稱以 Arc 共用，同一張地圖載入到多個世界
+//   （或由快照還原）時只保存一份；某個世界修改基底時才複製出自己的一份（Arc::make_mut）。
+//   物品與年齡每個 tick 都會變動，放在每個世界各自的稀疏表中（見 Map）
+// - 地點描述：從地圖檔、快照與區域編輯來的描述放進共用字串表，內容相同的格子共用同一份字串；
+//   生成的地點借用描述庫的常數字串，由資源包載入的地點借用映射的頁面
+// - 角色對話表：以 Arc 共用，內容相同的對話表（同一個角色檔載入到多個世界、事件 NPC 原型與其複本）
+//   只保存一份；某個角色修改對話時才複製出自己的一份（Arc::make_mut）
+// 物品表、角色描述表與地點描述庫本來就是行程層級的常數或全域資料，不屬於任何世界。
+//
+// 三個共用表都只保存 Weak，沒有任何世界使用時內容即釋放。失效的 Weak 仍佔著 Arc 的配置，
+// 所以表中的項目數每成長一倍就整表清除一次，表的大小維持在使用中項目數的常數倍以內
+// （宿主不斷匯入不同的快照或編輯地圖也不會累積）。
+
+use std::collections::{BTreeMap, HashMap};
+use std::fmt;
+use std::hash::{Hash, Hasher};
+use std::ops::Deref;
+use std::sync::{Arc, Mutex, Weak};
+use once_cell::sync::Lazy;
+use serde::de::{self, Visitor};
+use serde::{Deserialize, Deserializer, Serialize, Serializer};
+
+use crate::map::Cell;
+use crate::person::DialogueOption;
+
+/// 內容雜湊 -> 使用中的共用值（只保存 Weak）
+struct WeakTable<T: ?Sized> {
+    buckets: HashMap<u64, Vec<Weak<T>>>,
+    entries: usize,   // 表中的 Weak 數（含已失效的）
+    sweep_at: usize,  // 達到此數量時整表清除失效的項目
+}
+
+/// 整表清除的最低門檻
+const MIN_SWEEP: usize = 64;
+
+impl<T: ?Sized> WeakTable<T> {
+    fn new() -> Self {
+        WeakTable { buckets: HashMap::new(), entries: 0, sweep_at: MIN_SWEEP }
+    }
+
+    /// 使用中且內容相同（same 為真）的值
+    fn find(&mut self, hash: u64, same: impl Fn(&T) -> bool) -> Option<Arc<T>> {
+        let bucket = self.buckets.get_mut(&hash)?;
+        let before = bucket.len();
+        bucket.retain(|weak| weak.strong_count() > 0);
+        self.entries -= before - bucket.len();
+        bucket.iter().filter_map(Weak::upgrade).find(|value| same(value))
+    }
+
+    /// 登記新的共用值
+    fn insert(&mut self, hash: u64, shared: &Arc<T>) {
+        self.buckets.entry(hash).or_default().push(Arc::downgrade(shared));
+        self.entries += 1;
+        if self.entries >= self.sweep_at {
+            self.sweep();
+        }
+    }
+
+    /// 清除所有失效的項目（只在同一雜湊再次出現時清除的話，不再出現的內容會一直佔著配置）
+    fn sweep(&mut self) {
+        self.buckets.retain(|_, bucket| {
+            bucket.retain(|weak| weak.strong_count() > 0);
+            !bucket.is_empty()
+        });
+        self.entries = self.buckets.values().map(Vec::len).sum();
+        self.sweep_at = (self.entries * 2).max(MIN_SWEEP);
+    }
+}
+
+fn hash_of(value: &impl Hash) -> u64 {
+    let mut hasher = std::collections::hash_map::DefaultHasher::new();
+    value.hash(&mut hasher);
+    hasher.finish()
+}
+
+/// 共用的字串：借用常數或映射的頁面，或是共用字串表中的一份
+#[derive(Clone)]
+pub enum SharedStr {
+    Static(&'static str),
+    Shared(Arc<str>),
+}
+
+static STRINGS: Lazy<Mutex<WeakTable<str>>> = Lazy::new(|| Mutex::new(WeakTable::new()));
+
+/// 取得共用字串（內容相同的字串在使用中時返回同一份，否則複製一份登記）
+pub fn intern(s: &str) -> SharedStr {
+    if s.is_empty() {
+        return SharedStr::default();
+    }
+    let hash = hash_of(&s);
+    let mut strings = STRINGS.lock().unwrap_or_else(|e| e.into_inner());
+    let shared = strings.find(hash, |shared| shared == s).unwrap_or_else(|| {
+        let shared = Arc::from(s);
+        strings.insert(hash, &shared);
+        shared
+    });
+    SharedStr::Shared(shared)
+}
+
+impl Default for SharedStr {
+    fn default() -> Self {
+        SharedStr::Static("")
+    }
+}
+
+impl Deref for SharedStr {
+    type Target = str;
+
+    fn deref(&self) -> &str {
+        match self {
+            SharedStr::Static(s) => s,
+            SharedStr::Shared(s) => s,
+        }
+    }
+}
+
+impl From<&'static str> for SharedStr {
+    fn from(s: &'static str) -> Self {
+        SharedStr::Static(s)
+    }
+}
+
+impl From<String> for SharedStr {
+    fn from(s: String) -> Self {
+        intern(&s)
+    }
+}
+
+impl PartialEq for SharedStr {
+    fn eq(&self, other: &Self) -> bool {
+        **self == **other
+    }
+}
+
+impl Eq for SharedStr {}
+
+impl Hash for SharedStr {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        (**self).hash(state)
+    }
+}
+
+impl fmt::Debug for SharedStr {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        fmt::Debug::fmt(&**self, f)
+    }
+}
+
+impl fmt::Display for SharedStr {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.write_str(self)
+    }
+}
+
+impl Serialize for SharedStr {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.serialize_str(self)
+    }
+}
+
+impl<'de> Deserialize<'de> for SharedStr {
+    /// 反序列化時直接放進共用字串表，不另外配置 String
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        struct InternVisitor;
+
+        impl Visitor<'_> for InternVisitor {
+            type Value = SharedStr;
+
+            fn expecting(&self, f: &mut fmt::Formatter) -> fmt::Result {
+                f.write_str("字串")
+            }
+
+            fn visit_str<E: de::Error>(self, v: &str) -> Result<Self::Value, E> {
+                Ok(intern(v))
+            }
+        }
+
+        deserializer.deserialize_str(InternVisitor)
+    }
+}
+
+/// 地圖基底（列優先的格子）
+pub type Cells = Vec<Cell>;
+
+static CELLS: Lazy<Mutex<WeakTable<Cells>>> = Lazy::new(|| Mutex::new(WeakTable::new()));
+
+/// 已有世界使用內容相同的地圖基底時共用那一份，否則登記這一份
+pub fn share_cells(cells: Cells) -> Arc<Cells> {
+    if cells.is_empty() {
+        return Arc::new(cells);
+    }
+    let hash = hash_of(&cells);
+    let mut table = CELLS.lock().unwrap_or_else(|e| e.into_inner());
+    if let Some(shared) = table.find(hash, |shared| *shared == cells) {
+        return shared;
+    }
+    let shared = Arc::new(cells);
+    table.insert(hash, &shared);
+    shared
+}
+
+/// 話題 -> 對話選項列表
+pub type DialogueTable = HashMap<String, Vec<DialogueOption>>;
+
+/// 角色的對話表（內容相同的角色共用一份，修改時才複製）
+#[derive(Clone, Default, Debug)]
+pub struct Dialogues(Arc<DialogueTable>);
+
+impl Dialogues {
+    /// 可修改的對話表（與其他角色共用時先複製一份）
+    pub fn make_mut(&mut self) -> &mut DialogueTable {
+        Arc::make_mut(&mut self.0)
+    }
+
+    /// 是否與 other 共用同一份
+    #[allow(dead_code)]
+    pub fn ptr_eq(&self, other: &Dialogues) -> bool {
+        Arc::ptr_eq(&self.0, &other.0)
+    }
+}
+
+impl Deref for Dialogues {
+    type Target = DialogueTable;
+
+    fn deref(&self) -> &DialogueTable {
+        &self.0
+    }
+}
+
+impl Serialize for Dialogues {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        self.0.serialize(serializer)
+    }
+}
+
+impl<'de> Deserialize<'de> for Dialogues {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        Ok(share_dialogues(DialogueTable::deserialize(deserializer)?))
+    }
+}
+
+static DIALOGUES: Lazy<Mutex<WeakTable<DialogueTable>>> = Lazy::new(|| Mutex::new(WeakTable::new()));
+
+/// 對話表的內容鍵：話題排序後的 JSON（HashMap 的走訪順序不固定）
+fn content_key(table: &DialogueTable) -> Option<String> {
+    serde_json::to_string(&table.iter().collect::<BTreeMap<_, _>>()).ok()
+}
+
+/// 已有角色使用內容相同的對話表時共用那一份，否則登記這一份
+pub fn share_dialogues(table: DialogueTable) -> Dialogues {
+    if table.is_empty() {
+        return Dialogues::default();
+    }
+    let Some(key) = content_key(&table) else {
+        return Dialogues(Arc::new(table));
+    };
+    let hash = hash_of(&key);
+    let mut cache = DIALOGUES.lock().unwrap_or_else(|e| e.into_inner());
+    if let Some(shared) = cache.find(hash, |t| content_key(t).as_ref() == Some(&key)) {
+        return Dialogues(shared);
+    }
+    let shared = Arc::new(table);
+    cache.insert(hash, &shared);
+    Dialogues(shared)
+}
+
+use crate::mem_stats::HeapSize;
+
+/// 共用的值由共用者平均分攤（十個世界共用時，每個世界只計入十分之一）
+pub fn split_heap_size<T: HeapSize>(shared: &Arc<T>) -> usize {
+    let total = 2 * std::mem::size_of::<usize>() + std::mem::size_of::<T>() + shared.heap_size();
+    total / Arc::strong_count(shared)
+}
+
+impl HeapSize for Dialogues {
+    fn heap_size(&self) -> usize {
+        split_heap_size(&self.0)
+    }
+}
+
+impl HeapSize for SharedStr {
+    /// 借用的字串不佔行程的堆積；共用字串表中的字串由共用的格子平均分攤
+    fn heap_size(&self) -> usize {
+        match self {
+            SharedStr::Static(_) => 0,
+            SharedStr::Shared(s) => (2 * std::mem::size_of::<usize>() + s.len()) / Arc::strong_count(s),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::map::Point;
+    use crate::person::Person;
+
+    #[test]
+    fn test_worlds_share_assets() {
+        let mut npc = Person::new("守衛".to_string(), "城門的守衛".to_string());
+        npc.set_dialogue("問候".to_string(), "站住！".to_string());
+        let json = serde_json::to_string(&npc).unwrap();
+
+        // 兩個世界各自載入同一個角色檔：對話表只有一份
+        let mut first: Person = serde_json::from_str(&json).unwrap();
+        let second: Person = serde_json::from_str(&json).unwrap();
+        assert!(first.dialogues.ptr_eq(&second.dialogues));
+
+        // 修改時複製，不影響另一個世界
+        first.set_dialogue("問候".to_string(), "通行證呢？".to_string());
+        assert!(!first.dialogues.ptr_eq(&second.dialogues));
+        assert_eq!((first.dialogues["問候"].len(), second.dialogues["問候"].len()), (2, 1));
+
+        // 地點描述共用同一份字串
+        let point = serde_json::to_string(&Point::new(0, 0, true, "寂靜的墓地".to_string())).unwrap();
+        let a: Point = serde_json::from_str(&point).unwrap();
+        let b: Point = serde_json::from_str(&point).unwrap();
+        assert!(matches!((&a.description, &b.description), (SharedStr::Shared(x), SharedStr::Shared(y)) if Arc::ptr_eq(x, y)));
+    }
+
+    #[test]
+    fn test_unused_strings_are_released() {
+        // 不再使用的字串被釋放，表的大小不隨匯入過的字串總數成長
+        let SharedStr::Shared(first) = intern("只用一次的描述 0") else { panic!() };
+        let released = Arc::downgrade(&first);
+        drop(first);
+        assert!(released.upgrade().is_none());
+        for i in 1..2000 {
+            intern(&format!("只用一次的描述 {i}"));
+        }
+        let strings = STRINGS.lock().unwrap_or_else(|e| e.into_inner());
+        assert!(strings.entries < 1000, "{} 個項目", strings.entries);
+    }
+}
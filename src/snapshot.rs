@@ -0,0 +1,480 @@
+// 世界快照（C API：由宿主保存、複製執行中的世界，或把世界搬到另一個行程）
+// 快照是一串記錄，不必先把整個世界組成一個大緩衝區：
+// 寫入時記錄累積在 CHUNK_SIZE 的緩衝區中，滿了才交給輸出端（宿主的 writer 回調）；
+// 讀取時每次只解碼一筆記錄。
+//
+// 格式：魔數 "RMSNAP" 與版本 (u16 LE)，之後每筆記錄為 標籤 (u8) + 長度 (u32 LE) + 內容，以 END 結尾
+// - 世界、角色、任務、事件等小型結構以 JSON 編碼，沿用存檔的 serde 定義
+// - 地圖點陣佔了大部分資料量，改以二進位編碼：描述與地點名稱放進共用字串表，
+//   每格只寫兩個字串編號（變長整數）與一個旗標位元組；有物品的格子另寫一筆記錄
+// 快照包含世界清單中的所有地圖：尚未載入的地圖由世界資料夾讀出後寫入（不加入原世界），
+// 另外保存各亂數流的狀態與天氣網格，還原後的世界接續原世界的序列
+
+use std::collections::HashMap;
+use std::error::Error;
+use std::io::{BufReader, BufWriter, Read, Write};
+
+use serde::{Deserialize, Serialize};
+
+use crate::event::{EventRuntimeState, GameEvent};
+use crate::map::{Cell, Map, MapType, PointItems, TerrainType};
+use crate::shared_assets::SharedStr;
+use crate::map_property::{MapProperties, PropertyDecl, PropertySchema};
+use crate::person::Person;
+use crate::quest::Quest;
+use crate::rng::WorldRng;
+use crate::weather::WeatherGrid;
+use crate::world::{GameWorld, WorldMetadata, WorldTime};
+
+/// 每次交給輸出端的資料量
+pub const CHUNK_SIZE: usize = 64 * 1024;
+
+const MAGIC: &[u8; 6] = b"RMSNAP";
+const VERSION: u16 = 2;
+/// 單筆記錄的長度上限（防止損壞的資料要求配置過大的緩衝區）
+const MAX_RECORD: usize = 256 * 1024 * 1024;
+
+const TAG_WORLD: u8 = b'W';    // 世界設定（JSON）
+const TAG_STRING: u8 = b'S';   // 字串表新增一個字串（UTF-8），編號依出現順序（0 固定為空字串）
+const TAG_MAP: u8 = b'M';      // 地圖開始（JSON），之後是 height 筆 ROW 與零或多筆 OBJECTS
+const TAG_ROW: u8 = b'R';      // 地圖的一列
+const TAG_OBJECTS: u8 = b'O';  // 一格上的物品（JSON）
+const TAG_PERSON: u8 = b'P';   // 角色（JSON）
+const TAG_QUEST: u8 = b'Q';    // 任務（JSON）
+const TAG_EVENT: u8 = b'E';    // 事件與運行狀態（JSON）
+const TAG_WEATHER: u8 = b'C';  // 一張地圖的天氣網格（JSON）
+const TAG_END: u8 = b'.';
+
+/// 世界層級的狀態
+#[derive(Serialize, Deserialize)]
+struct WorldRecord {
+    world_dir: String,
+    current_map: String,
+    controlled_id: String,
+    metadata: WorldMetadata,
+    time: WorldTime,
+    item_counter: u64,
+    rng_seed: u64,
+    rng_streams: Vec<u64>,
+    properties: Vec<PropertyDecl>,
+    handles: Vec<String>,
+    completed_quests: Vec<String>,
+    original_player: Option<Person>,
+}
+
+/// 地圖的非點陣部分（資源包沿用同一個定義）
+#[derive(Serialize, Deserialize)]
+pub(crate) struct MapRecord {
+    pub(crate) name: String,
+    pub(crate) width: usize,
+    pub(crate) height: usize,
+    pub(crate) map_type: MapType,
+    pub(crate) description: String,
+    pub(crate) properties: MapProperties,
+}
+
+impl MapRecord {
+    pub(crate) fn of(map: &Map) -> Self {
+        MapRecord {
+            name: map.name.clone(),
+            width: map.width,
+            height: map.height,
+            map_type: map.map_type.clone(),
+            description: map.description.clone(),
+            properties: map.properties.clone(),
+        }
+    }
+}
+
+/// 一格的旗標位元組：最低位為可行走，其上為地形編號
+pub(crate) fn cell_flags(cell: &Cell) -> u8 {
+    let terrain = match cell.terrain_type {
+        TerrainType::Normal => 0,
+        TerrainType::Farmland => 1,
+        TerrainType::Road => 2,
+        TerrainType::Shop => 3,
+        TerrainType::House => 4,
+        TerrainType::Water => 5,
+    };
+    terrain << 1 | cell.walkable as u8
+}
+
+pub(crate) fn terrain_from_flags(flags: u8) -> Result<TerrainType, Box<dyn Error>> {
+    Ok(match flags >> 1 {
+        0 => TerrainType::Normal,
+        1 => TerrainType::Farmland,
+        2 => TerrainType::Road,
+        3 => TerrainType::Shop,
+        4 => TerrainType::House,
+        5 => TerrainType::Water,
+        code => return Err(format!("地形編號 {code} 無效").into()),
+    })
+}
+
+fn put_varint(out: &mut Vec<u8>, mut value: u32) {
+    while value >= 0x80 {
+        out.push(value as u8 | 0x80);
+        value >>= 7;
+    }
+    out.push(value as u8);
+}
+
+fn take_varint(data: &mut &[u8]) -> Result<u32, Box<dyn Error>> {
+    let mut value = 0u32;
+    for shift in (0..35).step_by(7) {
+        let (&byte, rest) = data.split_first().ok_or("快照中的地圖列不完整")?;
+        *data = rest;
+        value |= ((byte & 0x7F) as u32) << shift;
+        if byte < 0x80 {
+            return Ok(value);
+        }
+    }
+    Err("快照中的變長整數過長".into())
+}
+
+/// 記錄寫入端
+struct RecordWriter<W: Write> {
+    out: BufWriter<W>,
+    record: Vec<u8>,                  // 正在編碼的記錄內容（重複使用）
+    strings: HashMap<String, u32>,    // 已寫出的字串 -> 編號
+}
+
+impl<W: Write> RecordWriter<W> {
+    fn emit(&mut self, tag: u8, payload: &[u8]) -> Result<(), Box<dyn Error>> {
+        self.out.write_all(&[tag])?;
+        self.out.write_all(&(payload.len() as u32).to_le_bytes())?;
+        self.out.write_all(payload)?;
+        Ok(())
+    }
+
+    fn json<T: Serialize + ?Sized>(&mut self, tag: u8, value: &T) -> Result<(), Box<dyn Error>> {
+        let mut record = std::mem::take(&mut self.record);
+        record.clear();
+        serde_json::to_writer(&mut record, value)?;
+        let result = self.emit(tag, &record);
+        self.record = record;
+        result
+    }
+
+    /// 字串的編號（第一次出現時先寫出 STRING 記錄；大部分格子沒有地點名稱，空字串不查表）
+    fn string_id(&mut self, s: &str) -> Result<u32, Box<dyn Error>> {
+        if s.is_empty() {
+            return Ok(0);
+        }
+        if let Some(&id) = self.strings.get(s) {
+            return Ok(id);
+        }
+        let id = self.strings.len() as u32 + 1;
+        self.emit(TAG_STRING, s.as_bytes())?;
+        self.strings.insert(s.to_string(), id);
+        Ok(id)
+    }
+
+    fn map(&mut self, map: &Map) -> Result<(), Box<dyn Error>> {
+        self.json(TAG_MAP, &MapRecord::of(map))?;
+        let mut row_bytes = Vec::with_capacity(map.width * 3);
+        for row in map.cells().chunks(map.width.max(1)) {
+            row_bytes.clear();
+            for cell in row {
+                let description = self.string_id(&cell.description)?;
+                let name = self.string_id(&cell.name)?;
+                put_varint(&mut row_bytes, description);
+                put_varint(&mut row_bytes, name);
+                row_bytes.push(cell_flags(cell));
+            }
+            self.emit(TAG_ROW, &row_bytes)?;
+        }
+        for ((x, y), items) in map.points_with_items() {
+            self.json(TAG_OBJECTS, &(x, y, &items.objects, &items.object_ages))?;
+        }
+        Ok(())
+    }
+}
+
+/// 把世界寫成快照，每累積 CHUNK_SIZE 位元組交給 out 一次
+pub fn write<W: Write>(world: &GameWorld, out: W) -> Result<(), Box<dyn Error>> {
+    let mut writer = RecordWriter {
+        out: BufWriter::with_capacity(CHUNK_SIZE, out),
+        record: Vec::new(),
+        strings: HashMap::new(),
+    };
+    writer.out.write_all(MAGIC)?;
+    writer.out.write_all(&VERSION.to_le_bytes())?;
+
+    let npcs = &world.npc_manager;
+    writer.json(TAG_WORLD, &WorldRecord {
+        world_dir: world.world_dir.clone(),
+        current_map: world.current_map_name.clone(),
+        controlled_id: world.current_controlled_id.clone(),
+        metadata: world.metadata.clone(),
+        time: world.time.clone(),
+        item_counter: crate::item::get_item_id_counter(),
+        rng_seed: world.rng.seed(),
+        rng_streams: world.rng.states(),
+        properties: world.property_schema.decls().to_vec(),
+        handles: npcs.handle_ids().to_vec(),
+        completed_quests: world.quest_manager.completed_quests.clone(),
+        original_player: world.original_player.clone(),
+    })?;
+
+    for map in world.maps.values() {
+        writer.map(map)?;
+    }
+    for name in world.metadata.maps.iter().filter(|name| !world.maps.contains_key(*name)) {
+        let path = format!("{}/{name}.json", world.get_maps_dir());
+        if std::path::Path::new(&path).exists() {
+            writer.map(&Map::load(&path)?)?;
+        }
+    }
+    for (name, grid) in &world.weather {
+        writer.json(TAG_WEATHER, &(name, grid))?;
+    }
+
+    // 別名依角色分組（角色 ID 本身由 insert_npc 重新加入）
+    let mut aliases: HashMap<&str, Vec<&str>> = HashMap::new();
+    for (alias, id) in npcs.aliases() {
+        if *alias != id.to_lowercase() {
+            aliases.entry(id).or_default().push(alias);
+        }
+    }
+    for (id, person) in npcs.iter() {
+        let person_aliases = aliases.get(id.as_str()).map_or(&[][..], Vec::as_slice);
+        writer.json(TAG_PERSON, &(id, npcs.is_transient(id), person_aliases, person))?;
+    }
+
+    for quest in world.quest_manager.quests.values() {
+        writer.json(TAG_QUEST, quest)?;
+    }
+    for event in world.event_manager.list_events() {
+        writer.json(TAG_EVENT, &(event, world.event_manager.get_runtime_state(&event.id)))?;
+    }
+
+    writer.emit(TAG_END, &[])?;
+    writer.out.flush()?;
+    Ok(())
+}
+
+/// 記錄讀取端
+struct RecordReader<R: Read> {
+    input: BufReader<R>,
+    record: Vec<u8>,
+}
+
+impl<R: Read> RecordReader<R> {
+    fn next(&mut self) -> Result<u8, Box<dyn Error>> {
+        let mut header = [0u8; 5];
+        self.input.read_exact(&mut header).map_err(|_| "快照不完整")?;
+        let len = u32::from_le_bytes([header[1], header[2], header[3], header[4]]) as usize;
+        if len > MAX_RECORD {
+            return Err(format!("快照記錄過大（{len} 位元組）").into());
+        }
+        self.record.resize(len, 0);
+        self.input.read_exact(&mut self.record).map_err(|_| "快照不完整")?;
+        Ok(header[0])
+    }
+
+    fn json<T: for<'de> Deserialize<'de>>(&self) -> Result<T, Box<dyn Error>> {
+        Ok(serde_json::from_slice(&self.record)?)
+    }
+}
+
+/// 讀取中的地圖
+struct PendingMap {
+    header: MapRecord,
+    cells: Vec<Cell>,
+    items: Vec<(usize, usize, PointItems)>,
+}
+
+impl PendingMap {
+    fn row(&mut self, mut data: &[u8], strings: &[SharedStr]) -> Result<(), Box<dyn Error>> {
+        if self.cells.len() >= self.header.width.saturating_mul(self.header.height) {
+            return Err(format!("地圖 {} 的列數超過高度", self.header.name).into());
+        }
+        let string = |id: u32| strings.get(id as usize).ok_or("快照中的字串編號無效");
+        for _ in 0..self.header.width {
+            let description = string(take_varint(&mut data)?)?.clone();
+            let name = string(take_varint(&mut data)?)?.to_string();
+            let (&flags, rest) = data.split_first().ok_or("快照中的地圖列不完整")?;
+            data = rest;
+            let terrain_type = terrain_from_flags(flags)?;
+            self.cells.push(Cell { walkable: flags & 1 != 0, terrain_type, description, name });
+        }
+        Ok(())
+    }
+
+    fn finish(self, world: &mut GameWorld) -> Result<(), Box<dyn Error>> {
+        let MapRecord { name, width, height, map_type, description, mut properties } = self.header;
+        if width.checked_mul(height) != Some(self.cells.len()) {
+            return Err(format!("地圖 {name} 的列數不足").into());
+        }
+        let mut map = Map::from_cells(name, map_type, width, self.cells);
+        for (x, y, items) in self.items {
+            if !map.set_items(x, y, items) {
+                return Err("快照中的物品位置超出地圖".into());
+            }
+        }
+        map.description = description;
+        properties.bind(&world.property_schema);
+        map.properties = properties;
+        world.maps.insert(map.name.clone(), map);
+        Ok(())
+    }
+}
+
+/// 由快照還原世界（不啟動時鐘線程）；還原期間的配置計入新世界
+pub fn read<R: Read>(input: R) -> Result<GameWorld, Box<dyn Error>> {
+    let mut reader = RecordReader { input: BufReader::with_capacity(CHUNK_SIZE, input), record: Vec::new() };
+    let mut header = [0u8; 8];
+    reader.input.read_exact(&mut header).map_err(|_| "快照不完整")?;
+    if &header[..6] != MAGIC {
+        return Err("不是 ratamud 快照".into());
+    }
+    let version = u16::from_le_bytes([header[6], header[7]]);
+    if version != VERSION {
+        return Err(format!("不支援的快照版本 {version}").into());
+    }
+
+    if reader.next()? != TAG_WORLD {
+        return Err("快照缺少世界記錄".into());
+    }
+    let record: WorldRecord = reader.json()?;
+    let mut world = GameWorld::new_with_dir(&record.world_dir);
+    let _scope = world.alloc_scope.enter();
+    world.metadata = record.metadata;
+    world.current_map_name = record.current_map;
+    world.current_controlled_id = record.controlled_id;
+    world.time = record.time;
+    world.time.resync();
+    world.rng = WorldRng::restore(record.rng_seed, &record.rng_streams).ok_or("快照中的亂數流數量不符")?;
+    let mut schema = PropertySchema::builtin();
+    for decl in record.properties {
+        schema.declare(decl);
+    }
+    world.set_property_schema(schema);
+    world.npc_manager.restore_handles(record.handles);
+    world.quest_manager.completed_quests = record.completed_quests;
+    world.original_player = record.original_player;
+
+    let mut strings = vec![SharedStr::default()];
+    let mut pending: Option<PendingMap> = None;
+    loop {
+        let tag = reader.next()?;
+        if !matches!(tag, TAG_ROW | TAG_OBJECTS | TAG_STRING) {
+            if let Some(map) = pending.take() {
+                map.finish(&mut world)?;
+            }
+        }
+        match tag {
+            TAG_STRING => strings.push(crate::shared_assets::intern(std::str::from_utf8(&reader.record)?)),
+            TAG_MAP => {
+                let header: MapRecord = reader.json()?;
+                pending = Some(PendingMap { cells: Vec::new(), items: Vec::new(), header });
+            }
+            TAG_ROW => pending.as_mut().ok_or("快照中的地圖列不屬於任何地圖")?.row(&reader.record, &strings)?,
+            TAG_OBJECTS => {
+                let (x, y, objects, object_ages): (usize, usize, _, _) = reader.json()?;
+                let map = pending.as_mut().ok_or("快照中的物品不屬於任何地圖")?;
+                map.items.push((x, y, PointItems { objects, object_ages }));
+            }
+            TAG_PERSON => {
+                let (id, transient, aliases, person): (String, bool, Vec<String>, Person) = reader.json()?;
+                if transient {
+                    world.npc_manager.insert_transient(&id, person);
+                } else {
+                    world.npc_manager.insert_npc(id, person, aliases);
+                }
+            }
+            TAG_WEATHER => {
+                let (name, grid): (String, WeatherGrid) = reader.json()?;
+                if !grid.is_valid() {
+                    return Err(format!("地圖 {name} 的天氣網格大小不符").into());
+                }
+                world.weather.insert(name, grid);
+            }
+            TAG_QUEST => world.quest_manager.add_quest(reader.json::<Quest>()?),
+            TAG_EVENT => {
+                let (event, state): (GameEvent, Option<EventRuntimeState>) = reader.json()?;
+                let id = event.id.clone();
+                world.event_manager.add_event(event);
+                if let (Some(state), Some(slot)) = (state, world.event_manager.get_runtime_state_mut(&id)) {
+                    *slot = state;
+                }
+            }
+            TAG_END => break,
+            tag => return Err(format!("快照中有未知的記錄類型 {tag}").into()),
+        }
+    }
+    // 物品編號計數器是行程層級的狀態，整個快照解碼成功後才套用
+    crate::item::set_item_id_counter(record.item_counter);
+    Ok(world)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::rng::RngStream;
+
+    #[test]
+    fn test_snapshot_round_trip() {
+        let world_dir = std::env::temp_dir().join(format!("ratamud_snapshot_{}", std::process::id()));
+        let mut world = GameWorld::new_with_dir(&world_dir.to_string_lossy());
+        world.set_seed(5);
+        world.metadata.seed = Some(5);
+        let mut map = Map::new("field".to_string(), 12, 6, &WorldRng::new(1));
+        map.items_mut(3, 2).unwrap().add_objects("蘋果".to_string(), 2);
+        map.cell_mut(3, 2).unwrap().name = "水井".to_string();
+        map.cell_mut(7, 4).unwrap().terrain_type = TerrainType::Water;
+        world.add_map(map);
+        world.current_map_name = "field".to_string();
+        let mut guard = Person::new("守衛".to_string(), String::new());
+        guard.map = "field".to_string();
+        world.npc_manager.add_npc("guard".to_string(), guard, vec!["Sentry".to_string()]);
+        world.npc_manager.insert_transient("crow", Person::new("烏鴉".to_string(), String::new()));
+        // 沒有金幣、描述自訂的角色原樣還原
+        let mut me = Person::new("勇者".to_string(), String::new());
+        me.description = "自訂的描述".to_string();
+        me.map = "field".to_string();
+        world.npc_manager.insert_npc("me".to_string(), me, Vec::new());
+        world.time.advance_secs(3_725);
+        world.update_weather();
+        // 世界清單中尚未載入的地圖也寫入快照
+        world.save_map(&Map::new("cave".to_string(), 5, 5, &WorldRng::new(2))).unwrap();
+        world.metadata.maps = vec!["field".to_string(), "cave".to_string()];
+        world.rng.stream(RngStream::Combat).next_u64();
+
+        let mut image = Vec::new();
+        write(&world, &mut image).unwrap();
+        let restored = read(image.as_slice()).unwrap();
+
+        let (a, b) = (&world.maps["field"], &restored.maps["field"]);
+        for (p, q) in a.points().zip(b.points()) {
+            assert_eq!((p.walkable, p.description, p.name, p.terrain_type), (q.walkable, q.description, q.name, q.terrain_type));
+            assert_eq!(p.objects, q.objects);
+        }
+        assert_eq!(a.get_stats(), b.get_stats());
+        // 由同一份快照還原的多個世界共用地圖基底
+        let again = read(image.as_slice()).unwrap();
+        assert!(again.maps["field"].shares_cells_with(b));
+        assert_eq!(restored.current_map_name, "field");
+        assert_eq!(restored.time.format_time(), world.time.format_time());
+        assert_eq!(restored.npc_manager.get_npc("sentry").map(|p| p.name.as_str()), Some("守衛"));
+        assert_eq!(restored.npc_manager.handle("guard"), world.npc_manager.handle("guard"));
+        assert!(restored.npc_manager.is_transient("crow"));
+        assert_eq!(restored.metadata.seed, Some(5));
+        let me = restored.npc_manager.get_npc("me").unwrap();
+        assert_eq!((me.items.get("金幣"), me.description.as_str()), (None, "自訂的描述"));
+        assert!(restored.maps.contains_key("cave") && !world.maps.contains_key("cave"));
+        assert_eq!(restored.weather_at("field", 3, 2), world.weather_at("field", 3, 2));
+        for stream in RngStream::ALL {
+            assert_eq!(restored.rng.stream(stream).next_u64(), world.rng.stream(stream).next_u64());
+        }
+
+        // 截斷的快照不能還原，也不改動物品編號計數器
+        let counter = crate::item::get_item_id_counter();
+        crate::item::set_item_id_counter(counter + 1000);
+        assert!(read(&image[..image.len() - 1]).is_err());
+        assert!(crate::item::get_item_id_counter() >= counter + 1000);
+        assert!(read(&b"not a snapshot"[..]).is_err());
+        let _ = std::fs::remove_dir_all(&world_dir);
+    }
+}
@@ -0,0 +1,124 @@
+// 事件生成 NPC 的物件池
+// 天氣、環境事件會頻繁地讓 NPC 出現又離開。每種 NPC 有一個預先建立好的原型（模板），
+// 生成時從池中取出回收的角色，以 Person::clone_into_slot 複製原型
+// （重用字串、Vec、HashMap 已配置的容量），離開時把角色放回池中，不釋放記憶體。
+//
+// 模板來源（依序）：register_template 註冊的原型 → {world_dir}/templates/{id}.json → Person::new(id)
+
+use std::collections::HashMap;
+use crate::person::Person;
+
+/// 池中最多保留的空閒角色數
+const MAX_FREE: usize = 64;
+
+/// 物件池統計
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct SpawnStats {
+    pub spawned: usize,    // 生成次數
+    pub reused: usize,     // 其中重用空閒角色的次數
+    pub despawned: usize,  // 回收次數
+}
+
+/// NPC 原型與空閒角色池
+#[derive(Clone, Default)]
+pub struct SpawnPool {
+    templates: HashMap<String, Person>,
+    free: Vec<Person>,
+    stats: SpawnStats,
+}
+
+impl SpawnPool {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// 註冊（或取代）某個 NPC ID 的原型
+    #[allow(dead_code)]
+    pub fn register_template(&mut self, npc_id: &str, template: Person) {
+        self.templates.insert(npc_id.to_string(), template);
+    }
+
+    #[allow(dead_code)]
+    pub fn has_template(&self, npc_id: &str) -> bool {
+        self.templates.contains_key(npc_id)
+    }
+
+    /// 取得原型，尚未註冊時從 templates 資料夾載入，沒有檔案則以預設角色建立（每個 ID 只建立一次）
+    fn template(&mut self, npc_id: &str, world_dir: &str) -> &Person {
+        if !self.templates.contains_key(npc_id) {
+            let template = Person::load(&format!("{world_dir}/templates"), npc_id)
+                .unwrap_or_else(|_| Person::new(npc_id.to_string(), format!("因事件而出現的{npc_id}")));
+            self.templates.insert(npc_id.to_string(), template);
+        }
+        &self.templates[npc_id]
+    }
+
+    /// 取出一個以原型初始化的角色（優先重用空閒角色）
+    pub fn acquire(&mut self, npc_id: &str, world_dir: &str) -> Person {
+        let slot = self.free.pop();
+        self.stats.spawned += 1;
+        let template = self.template(npc_id, world_dir);
+        match slot {
+            Some(mut person) => {
+                template.clone_into_slot(&mut person);
+                self.stats.reused += 1;
+                person
+            }
+            None => template.clone(),
+        }
+    }
+
+    /// 歸還角色（池滿時直接丟棄）
+    pub fn release(&mut self, person: Person) {
+        self.stats.despawned += 1;
+        if self.free.len() < MAX_FREE {
+            self.free.push(person);
+        }
+    }
+
+    #[allow(dead_code)]
+    pub fn stats(&self) -> SpawnStats {
+        self.stats
+    }
+
+    /// 目前的空閒角色數
+    #[allow(dead_code)]
+    pub fn free_count(&self) -> usize {
+        self.free.len()
+    }
+}
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for SpawnPool {
+    fn heap_size(&self) -> usize {
+        self.templates.heap_size() + self.free.heap_size()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_pool_reuses_slots() {
+        let mut pool = SpawnPool::new();
+        let mut template = Person::new("旅人".to_string(), "路過的旅人".to_string());
+        template.abilities.push("問路".to_string());
+        pool.register_template("traveler", template);
+
+        let mut first = pool.acquire("traveler", "unused");
+        first.hp = 1;
+        first.abilities.clear();
+        pool.release(first);
+
+        // 回收的角色會被原型完整覆寫
+        let second = pool.acquire("traveler", "unused");
+        assert_eq!(second.hp, second.max_hp);
+        assert_eq!(second.abilities, vec!["問路".to_string()]);
+        assert_eq!(pool.stats(), SpawnStats { spawned: 2, reused: 1, despawned: 1 });
+
+        // 沒有模板時以預設角色建立
+        assert_eq!(pool.acquire("crow", "unused").name, "crow");
+    }
+}
@@ -14,7 +14,8 @@ impl TimeThread {
         let time_clone = Arc::clone(&time);
         
         let _ = thread::spawn(move || {
-            loop {               
+            // 所有 TimeThread（連同複製的世界）都被丟棄後結束
+            while Arc::strong_count(&time_clone) > 1 {
                 // 更新時間
                 {
                     let mut time = time_clone.lock().unwrap();
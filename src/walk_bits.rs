@@ -0,0 +1,216 @@
+// 地圖可行走性的位元集合
+// 每格一個位元，每列打包成 u64 字組（列尾補零，列與列不共用字組）。
+// 統計、列掃描、矩形計數與隨機選點都以整個字組處理（count_ones / trailing_zeros
+// 編譯為 popcnt / tzcnt 指令），不必逐格讀取 Cell 中的 walkable 欄位。
+// Map 建立或載入時由基底建立，之後隨 set_walkable 與區域編輯同步更新。
+
+use crate::map::Cell;
+
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct WalkBits {
+    width: usize,
+    height: usize,
+    stride: usize,     // 每列的字組數
+    words: Vec<u64>,
+    count: usize,      // 可行走格數
+}
+
+impl WalkBits {
+    /// 由列優先的地圖基底建立（width 為每列的格數）
+    pub fn from_cells(cells: &[Cell], width: usize) -> Self {
+        let height = if width == 0 { 0 } else { cells.len() / width };
+        let stride = width.div_ceil(64);
+        let mut bits = WalkBits { width, height, stride, words: vec![0; stride * height], count: 0 };
+        if width > 0 && height > 0 {
+            bits.sync_rect(cells, 0, 0, width - 1, height - 1);
+        }
+        bits
+    }
+
+    /// 以基底重新讀取矩形（含邊界）內的可行走性
+    pub fn sync_rect(&mut self, cells: &[Cell], x0: usize, y0: usize, x1: usize, y1: usize) {
+        if self.width == 0 {
+            return;
+        }
+        for (y, row) in cells.chunks(self.width).enumerate().take(y1.min(self.height.saturating_sub(1)) + 1).skip(y0) {
+            for (x, cell) in row.iter().enumerate().take(x1.min(self.width - 1) + 1).skip(x0) {
+                let (i, mask) = self.index(x, y);
+                if cell.walkable {
+                    self.words[i] |= mask;
+                } else {
+                    self.words[i] &= !mask;
+                }
+            }
+        }
+        self.count = self.words.iter().map(|w| w.count_ones() as usize).sum();
+    }
+
+    #[inline]
+    fn index(&self, x: usize, y: usize) -> (usize, u64) {
+        (y * self.stride + x / 64, 1 << (x % 64))
+    }
+
+    #[inline]
+    pub fn get(&self, x: usize, y: usize) -> bool {
+        if x >= self.width || y >= self.height {
+            return false;
+        }
+        let (i, mask) = self.index(x, y);
+        self.words[i] & mask != 0
+    }
+
+    /// 設定一格，返回是否改變
+    pub fn set(&mut self, x: usize, y: usize, walkable: bool) -> bool {
+        if x >= self.width || y >= self.height || self.get(x, y) == walkable {
+            return false;
+        }
+        let (i, mask) = self.index(x, y);
+        self.words[i] ^= mask;
+        if walkable {
+            self.count += 1;
+        } else {
+            self.count -= 1;
+        }
+        true
+    }
+
+    /// 可行走格數
+    pub fn count(&self) -> usize {
+        self.count
+    }
+
+    /// 總格數
+    pub fn len(&self) -> usize {
+        self.width * self.height
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    fn row_words(&self, y: usize) -> &[u64] {
+        &self.words[y * self.stride..(y + 1) * self.stride]
+    }
+
+    /// 矩形（含邊界，超出地圖的部分裁掉）內的可行走格數
+    #[allow(dead_code)]
+    pub fn count_rect(&self, x0: usize, y0: usize, x1: usize, y1: usize) -> usize {
+        if x0 >= self.width || y0 >= self.height || x0 > x1 || y0 > y1 {
+            return 0;
+        }
+        let (x1, y1) = (x1.min(self.width - 1), y1.min(self.height - 1));
+        let (w0, w1) = (x0 / 64, x1 / 64);
+        let (low, high) = (u64::MAX << (x0 % 64), u64::MAX >> (63 - x1 % 64));
+        (y0..=y1).map(|y| {
+            let row = self.row_words(y);
+            if w0 == w1 {
+                return (row[w0] & low & high).count_ones() as usize;
+            }
+            let inner: u32 = row[w0 + 1..w1].iter().map(|w| w.count_ones()).sum();
+            (inner + (row[w0] & low).count_ones() + (row[w1] & high).count_ones()) as usize
+        }).sum()
+    }
+
+    /// 某列可行走格的 x 座標（由小到大）
+    pub fn row(&self, y: usize) -> impl Iterator<Item = usize> + '_ {
+        let words = if y < self.height { self.row_words(y) } else { &[] };
+        words.iter().enumerate().flat_map(|(i, &word)| SetBits(word).map(move |bit| i * 64 + bit))
+    }
+
+    /// 把第 y 列 [x0, x0 + len) 的位元複製到 out（每個位元組由低位元到高位元；地圖外為 0）
+    pub fn copy_row(&self, y: usize, x0: usize, len: usize, out: &mut [u8]) {
+        let words = if y < self.height { self.row_words(y) } else { &[] };
+        for (i, byte) in out.iter_mut().enumerate().take(len.div_ceil(8)) {
+            let (word, shift) = ((x0 + i * 8) / 64, (x0 + i * 8) % 64);
+            let mut value = words.get(word).map_or(0, |w| w >> shift);
+            if shift > 56 {
+                value |= words.get(word + 1).map_or(0, |w| w << (64 - shift));
+            }
+            let remaining = len - i * 8;
+            if remaining < 8 {
+                value &= (1 << remaining) - 1;
+            }
+            *byte = value as u8;
+        }
+    }
+
+    /// 所有可行走格（列優先）
+    pub fn iter(&self) -> impl Iterator<Item = (usize, usize)> + '_ {
+        (0..self.height).flat_map(move |y| self.row(y).map(move |x| (x, y)))
+    }
+
+    /// 列優先的第 n 個可行走格（n 取均勻亂數即為均勻隨機選點）
+    pub fn nth(&self, mut n: usize) -> Option<(usize, usize)> {
+        for (i, &word) in self.words.iter().enumerate() {
+            let ones = word.count_ones() as usize;
+            if n < ones {
+                let bit = SetBits(word).nth(n)?;
+                return Some(((i % self.stride) * 64 + bit, i / self.stride));
+            }
+            n -= ones;
+        }
+        None
+    }
+}
+
+/// 字組中為 1 的位元位置（由低到高）
+struct SetBits(u64);
+
+impl Iterator for SetBits {
+    type Item = usize;
+
+    fn next(&mut self) -> Option<usize> {
+        if self.0 == 0 {
+            return None;
+        }
+        let bit = self.0.trailing_zeros() as usize;
+        self.0 &= self.0 - 1;
+        Some(bit)
+    }
+}
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for WalkBits {
+    fn heap_size(&self) -> usize {
+        self.words.capacity() * std::mem::size_of::<u64>()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_bits_match_points() {
+        // 70 格寬：每列跨兩個字組
+        let (width, height) = (70, 5);
+        let cells: Vec<Cell> = (0..height)
+            .flat_map(|y| (0..width).map(move |x| Cell { walkable: (x * 7 + y * 3) % 5 != 0, ..Cell::default() }))
+            .collect();
+        let mut bits = WalkBits::from_cells(&cells, width);
+        let expected: Vec<(usize, usize)> = (0..height)
+            .flat_map(|y| (0..width).map(move |x| (x, y)))
+            .filter(|&(x, y)| cells[y * width + x].walkable)
+            .collect();
+        assert_eq!(bits.iter().collect::<Vec<_>>(), expected);
+        assert_eq!(bits.count(), expected.len());
+        for (n, &spot) in expected.iter().enumerate() {
+            assert_eq!(bits.nth(n), Some(spot));
+        }
+        assert_eq!(bits.nth(expected.len()), None);
+
+        let brute = |x0: usize, y0: usize, x1: usize, y1: usize| {
+            expected.iter().filter(|&&(x, y)| (x0..=x1).contains(&x) && (y0..=y1).contains(&y)).count()
+        };
+        for (x0, y0, x1, y1) in [(0, 0, 69, 4), (3, 1, 60, 3), (63, 0, 64, 4), (65, 2, 200, 9), (10, 2, 10, 2)] {
+            assert_eq!(bits.count_rect(x0, y0, x1, y1), brute(x0, y0, x1, y1));
+        }
+
+        assert!(bits.set(0, 0, true));
+        assert!(!bits.set(0, 0, true));
+        assert!(bits.get(0, 0));
+        assert_eq!(bits.count(), expected.len() + 1);
+        assert!(!bits.get(width, 0));
+    }
+}
@@ -0,0 +1,320 @@
+// 區域天氣模擬
+// 每張已載入的地圖有一個粗網格（每格 REGION_SIZE×REGION_SIZE 個地圖點），
+// 以溫度、雨量、能見度三個欄位（各自一個連續的 f32 陣列）表示各區域的環境狀態。
+// 每遊戲分鐘執行一次模板步驟：
+// 1. 五點擴散（逐列以切片 zip 計算，編譯器可自動向量化）
+// 2. 溫度向氣候基準（含日夜變化）回歸，雨量衰減，偶爾在隨機區域生成降雨
+// 3. 能見度由雨量與低溫霧氣逐格推導
+// 結果供移動判定（暴風雨無法通行）、NPC AI（雨中減少走動）與 look 描述使用，
+// 全圖平均寫入地圖屬性「天氣」「溫度」（取代原本隨機設定天氣的事件），
+// 目前地圖的值改變時以原事件的訊息（narration）告訴玩家。
+
+use serde::{Deserialize, Serialize};
+use crate::map::MapType;
+use crate::rng::Rng;
+
+/// 每個天氣區域涵蓋的地圖點邊長
+pub const REGION_SIZE: usize = 10;
+/// 擴散係數（每步與四個鄰格交換的比例，需小於 0.25）
+const DIFFUSION: f32 = 0.12;
+/// 溫度向基準回歸的速率（每步）
+const TEMP_RELAX: f32 = 0.05;
+/// 雨對溫度的冷卻（每步，雨量 1.0 時）
+const RAIN_COOLING: f32 = 0.3;
+/// 雨量每步的保留比例
+const RAIN_DECAY: f32 = 0.97;
+/// 生成降雨時加入的雨量
+const RAIN_BURST: f32 = 0.8;
+/// 雨量達到此值視為暴風雨，無法通行
+const STORM_RAIN: f32 = 0.9;
+/// 低於此溫度開始起霧
+const FOG_TEMP: f32 = 8.0;
+/// 一次追趕的最大步數（長時間未更新時不逐分鐘補算）
+const MAX_CATCHUP_STEPS: u64 = 30;
+
+/// 地圖類型的氣候參數
+#[derive(Debug, Clone, Copy, PartialEq, Serialize, Deserialize)]
+pub struct Climate {
+    pub base_temp: f32,      // 平均溫度（°C）
+    pub diurnal: f32,        // 日夜溫差的一半
+    pub rain_chance: f32,    // 每步在某區域生成降雨的機率
+    pub max_visibility: f32, // 能見度上限（洞穴較暗）
+}
+
+impl Climate {
+    pub fn for_map_type(map_type: &MapType) -> Self {
+        let (base_temp, diurnal, rain_chance, max_visibility) = match map_type {
+            MapType::Normal => (20.0, 6.0, 0.02, 1.0),
+            MapType::Forest => (17.0, 5.0, 0.03, 0.9),
+            MapType::Cave => (12.0, 1.0, 0.0, 0.5),
+            MapType::Desert => (30.0, 12.0, 0.005, 1.0),
+            MapType::Mountain => (8.0, 7.0, 0.04, 1.0),
+        };
+        Climate { base_temp, diurnal, rain_chance, max_visibility }
+    }
+
+    /// 某時刻（小時，可含小數）的基準溫度，15 時最高
+    fn temperature_at(&self, hour: f32) -> f32 {
+        self.base_temp + self.diurnal * ((hour - 15.0) / 24.0 * std::f32::consts::TAU).cos()
+    }
+}
+
+/// 單一區域的天氣
+#[derive(Debug, Clone, Copy, PartialEq, Serialize, Deserialize)]
+pub struct RegionWeather {
+    pub temperature: f32,  // °C
+    pub rain: f32,         // 0.0 - 1.0
+    pub visibility: f32,   // 0.0 - 1.0
+}
+
+impl RegionWeather {
+    /// 對應地圖屬性「天氣」的列舉值
+    pub fn condition(&self) -> &'static str {
+        if self.rain >= STORM_RAIN {
+            "暴風雨"
+        } else if self.rain >= 0.35 {
+            "雨天"
+        } else if self.visibility < 0.4 {
+            "霧天"
+        } else if self.rain >= 0.15 {
+            "陰天"
+        } else {
+            "晴天"
+        }
+    }
+
+    /// 對應地圖屬性「溫度」的列舉值
+    pub fn temperature_label(&self) -> &'static str {
+        match self.temperature {
+            t if t < 5.0 => "寒冷",
+            t if t < 15.0 => "涼爽",
+            t if t < 25.0 => "溫暖",
+            _ => "炎熱",
+        }
+    }
+
+    /// 暴風雨中無法移動進入此區域
+    pub fn blocks_movement(&self) -> bool {
+        self.rain >= STORM_RAIN
+    }
+
+    /// 正在下雨（NPC 會減少走動）
+    pub fn is_raining(&self) -> bool {
+        self.rain >= 0.35
+    }
+
+    /// look 使用的描述
+    pub fn describe(&self) -> String {
+        let visibility = match self.visibility {
+            v if v < 0.3 => "，能見度很低",
+            v if v < 0.6 => "，視線有些模糊",
+            _ => "",
+        };
+        format!("🌤️ 天氣: {}，{} ({:.0}°C){visibility}", self.condition(), self.temperature_label(), self.temperature)
+    }
+}
+
+/// 地圖屬性「天氣」「溫度」改變時對玩家的描述（沿用原本天氣事件的訊息，森林有自己的版本）
+/// 不是天氣或溫度的屬性、或沒有對應描述的值返回 None
+pub fn narration(property: &str, value: &str, map_type: &MapType) -> Option<&'static str> {
+    let forest = matches!(map_type, MapType::Forest);
+    let text = match (property, value) {
+        ("天氣", "晴天") if forest => "☀️ 陽光穿透樹葉間的縫隙灑下。",
+        ("天氣", "陰天") if forest => "☁️ 森林上方烏雲密布，光線變暗。",
+        ("天氣", "雨天") if forest => "🌧️ 雨滴從樹葉上滴落，林地變得濕滑。",
+        ("天氣", "霧天") if forest => "🌫️ 晨霧在樹林間瀰漫，能見度很低。",
+        ("天氣", "晴天") => "☀️ 天空放晴了，陽光灑滿大地。",
+        ("天氣", "陰天") => "☁️ 天空變得陰沉，烏雲密布。",
+        ("天氣", "雨天") => "🌧️ 開始下起雨來，雨滴打在地上發出滴答聲。",
+        ("天氣", "霧天") => "🌫️ 濃霧瀰漫，能見度變得很低。",
+        ("天氣", "多雲") => "⛅ 天空飄著幾朵白雲，時而遮住陽光。",
+        ("天氣", "暴風雨") => "⛈️ 狂風暴雨襲來，寸步難行。",
+        ("溫度", "炎熱") => "🔥 太陽高照，空氣變得炎熱。",
+        ("溫度", "溫暖") => "🌤️ 氣溫回升，感覺溫暖舒服。",
+        ("溫度", "舒適") => "😌 氣溫適中，非常舒適。",
+        ("溫度", "涼爽") => "🍃 微風吹拂，帶來些許涼意。",
+        ("溫度", "寒冷") => "❄️ 氣溫驟降，感覺有點寒冷。",
+        _ => return None,
+    };
+    Some(text)
+}
+
+/// 一張地圖的天氣網格（快照保存整個網格）
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct WeatherGrid {
+    cols: usize,
+    rows: usize,
+    climate: Climate,
+    temperature: Vec<f32>,
+    rain: Vec<f32>,
+    visibility: Vec<f32>,
+    #[serde(skip)]
+    scratch: Vec<f32>,  // 擴散的輸出緩衝區（與欄位交換，不重新配置；快照還原後第一步時配置）
+    minute: u64,        // 已模擬到的遊戲分鐘
+}
+
+impl WeatherGrid {
+    /// 依地圖大小建立，初始為指定時刻的晴朗天氣
+    pub fn new(map_width: usize, map_height: usize, map_type: &MapType, hour: f32, minute: u64) -> Self {
+        let cols = map_width.div_ceil(REGION_SIZE).max(1);
+        let rows = map_height.div_ceil(REGION_SIZE).max(1);
+        let climate = Climate::for_map_type(map_type);
+        let cells = cols * rows;
+        let mut grid = WeatherGrid {
+            cols,
+            rows,
+            climate,
+            temperature: vec![climate.temperature_at(hour); cells],
+            rain: vec![0.0; cells],
+            visibility: vec![climate.max_visibility; cells],
+            scratch: vec![0.0; cells],
+            minute,
+        };
+        grid.update_visibility();
+        grid
+    }
+
+    /// 推進到指定的遊戲分鐘（每分鐘一步，最多追趕 MAX_CATCHUP_STEPS 步）；返回執行的步數
+    pub fn advance_to(&mut self, minute: u64, hour: f32, rng: &Rng) -> u64 {
+        if minute <= self.minute {
+            // 時間被重設（例如載入存檔）時只同步時鐘
+            self.minute = minute;
+            return 0;
+        }
+        let steps = (minute - self.minute).min(MAX_CATCHUP_STEPS);
+        for _ in 0..steps {
+            self.step(hour, rng);
+        }
+        self.minute = minute;
+        steps
+    }
+
+    /// 執行一步模擬
+    pub fn step(&mut self, hour: f32, rng: &Rng) {
+        let (cols, rows) = (self.cols, self.rows);
+        self.scratch.resize(cols * rows, 0.0);
+        diffuse(&self.temperature, &mut self.scratch, cols, rows, DIFFUSION);
+        std::mem::swap(&mut self.temperature, &mut self.scratch);
+        diffuse(&self.rain, &mut self.scratch, cols, rows, DIFFUSION);
+        std::mem::swap(&mut self.rain, &mut self.scratch);
+
+        let target = self.climate.temperature_at(hour);
+        for (t, &r) in self.temperature.iter_mut().zip(&self.rain) {
+            *t += TEMP_RELAX * (target - *t) - RAIN_COOLING * r;
+        }
+        for r in &mut self.rain {
+            *r *= RAIN_DECAY;
+        }
+        if self.climate.rain_chance > 0.0 && rng.chance(self.climate.rain_chance as f64) {
+            let cell = rng.below(self.rain.len());
+            self.rain[cell] = (self.rain[cell] + RAIN_BURST).min(1.0);
+        }
+        self.update_visibility();
+    }
+
+    /// 能見度 = 上限 - 雨量影響 - 低溫霧氣
+    fn update_visibility(&mut self) {
+        let max_visibility = self.climate.max_visibility;
+        for ((v, &r), &t) in self.visibility.iter_mut().zip(&self.rain).zip(&self.temperature) {
+            let fog = ((FOG_TEMP - t) * 0.05).clamp(0.0, 0.5);
+            *v = (max_visibility - 0.75 * r - fog).clamp(0.05, 1.0);
+        }
+    }
+
+    /// 地圖座標所在區域的天氣
+    pub fn at(&self, x: usize, y: usize) -> RegionWeather {
+        let col = (x / REGION_SIZE).min(self.cols - 1);
+        let row = (y / REGION_SIZE).min(self.rows - 1);
+        let i = row * self.cols + col;
+        RegionWeather { temperature: self.temperature[i], rain: self.rain[i], visibility: self.visibility[i] }
+    }
+
+    /// 全圖平均（地圖層級的天氣摘要，決定地圖屬性「天氣」「溫度」）
+    pub fn average(&self) -> RegionWeather {
+        let n = self.temperature.len() as f32;
+        RegionWeather {
+            temperature: self.temperature.iter().sum::<f32>() / n,
+            rain: self.rain.iter().sum::<f32>() / n,
+            visibility: self.visibility.iter().sum::<f32>() / n,
+        }
+    }
+
+    /// 在指定區域降雨（事件或測試使用）
+    #[allow(dead_code)]
+    pub fn add_rain(&mut self, x: usize, y: usize, amount: f32) {
+        let col = (x / REGION_SIZE).min(self.cols - 1);
+        let row = (y / REGION_SIZE).min(self.rows - 1);
+        let cell = &mut self.rain[row * self.cols + col];
+        *cell = (*cell + amount).clamp(0.0, 1.0);
+    }
+
+    /// 欄位長度是否與網格大小一致（檢查由快照讀入的網格）
+    pub fn is_valid(&self) -> bool {
+        let cells = self.cols * self.rows;
+        cells > 0 && [&self.temperature, &self.rain, &self.visibility].iter().all(|field| field.len() == cells)
+    }
+
+    /// 網格大小 (欄, 列)
+    #[allow(dead_code)]
+    pub fn dimensions(&self) -> (usize, usize) {
+        (self.cols, self.rows)
+    }
+}
+
+/// 五點擴散模板：dst = src*(1-4k) + k*(上+下+左+右)，邊界外視為與邊界格相同
+/// 先以整列切片計算中心與上下鄰格，再處理左右鄰格，內層迴圈皆為無分支的 zip
+fn diffuse(src: &[f32], dst: &mut [f32], cols: usize, rows: usize, k: f32) {
+    let center = 1.0 - 4.0 * k;
+    for y in 0..rows {
+        let row = |r: usize| &src[r * cols..(r + 1) * cols];
+        let (up, mid, down) = (row(y.saturating_sub(1)), row(y), row((y + 1).min(rows - 1)));
+        let out = &mut dst[y * cols..(y + 1) * cols];
+        for (((o, &c), &u), &d) in out.iter_mut().zip(mid).zip(up).zip(down) {
+            *o = c * center + k * (u + d);
+        }
+        if cols == 1 {
+            out[0] += 2.0 * k * mid[0];
+            continue;
+        }
+        out[0] += k * (mid[0] + mid[1]);
+        for ((o, &l), &r) in out[1..cols - 1].iter_mut().zip(&mid[..cols - 2]).zip(&mid[2..]) {
+            *o += k * (l + r);
+        }
+        out[cols - 1] += k * (mid[cols - 2] + mid[cols - 1]);
+    }
+}
+
+use crate::mem_stats::HeapSize;
+
+impl HeapSize for WeatherGrid {
+    fn heap_size(&self) -> usize {
+        self.temperature.heap_size() + self.rain.heap_size() + self.visibility.heap_size() + self.scratch.heap_size()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_weather_grid_step() {
+        let rng = Rng::seed_from_u64(11);
+        let mut grid = WeatherGrid::new(100, 95, &MapType::Normal, 12.0, 0);
+        assert_eq!(grid.dimensions(), (10, 10));
+
+        // 擴散保持總量（邊界為反射），雨勢向鄰近區域擴散並逐漸減弱
+        grid.add_rain(55, 55, 1.0);
+        assert!(grid.at(55, 55).blocks_movement());
+        let mut diffused = vec![0.0; grid.rain.len()];
+        diffuse(&grid.rain, &mut diffused, 10, 10, DIFFUSION);
+        assert!((grid.rain.iter().sum::<f32>() - diffused.iter().sum::<f32>()).abs() < 1e-4);
+
+        assert_eq!(grid.advance_to(10, 12.0, &rng), 10);
+        assert!(grid.at(45, 55).rain > 0.0);
+        assert!(grid.at(55, 55).rain < 1.0);
+        assert!(grid.at(55, 55).visibility < grid.at(5, 5).visibility);
+
+        // 時間倒退時不模擬
+        assert_eq!(grid.advance_to(3, 12.0, &rng), 0);
+    }
+}
@@ -7,6 +7,15 @@ use crate::map::{Map, MapType};
 use crate::person::Person;
 use crate::time_updatable::{TimeInfo, TimeUpdatable};
 use crate::quest::QuestManager;
+use crate::rng::{RngStream, WorldRng};
+use crate::map_property::{PropertyChange, PropertyId, PropertySchema, PropertyValue};
+use std::sync::{mpsc, Arc};
+use crate::weather::{RegionWeather, WeatherGrid};
+use crate::spawn_pool::SpawnPool;
+use crate::fov::{FovCache, VisibleSet};
+use crate::map_edit::{MapEditor, RegionCommand};
+use crate::host_alloc::AllocScope;
+use crate::overworld::{chunk_map_name, parse_chunk_name, ChunkPos, Overworld, CHUNK_SIZE};
 
 /// NPC 互動狀態
 /// 用於追蹤玩家正在與哪個 NPC 進行什麼類型的互動
@@ -71,7 +80,21 @@ impl WorldTime {
         let elapsed_real_ms = now - self.last_update;
         // game_speed = 1.0 表示與真實世界同步
         let elapsed_game_secs = ((elapsed_real_ms as f32 / 1000.0) * game_speed) as u32;
-        
+        self.advance_secs(elapsed_game_secs);
+        self.last_update = now;
+    }
+
+    /// 以現在的真實時間為計時起點（載入或還原存檔後呼叫，避免時間跳躍）
+    pub fn resync(&mut self) {
+        self.last_update = SystemTime::now()
+            .duration_since(UNIX_EPOCH)
+            .unwrap()
+            .as_millis() as u64;
+    }
+
+    /// 直接推進指定的遊戲秒數（不依賴真實時間，供無時鐘線程的模擬使用）
+    #[allow(dead_code)]
+    pub fn advance_secs(&mut self, elapsed_game_secs: u32) {
         let total_secs = self.second as u32 + elapsed_game_secs;
         
         // 計算分鐘和秒
@@ -88,8 +111,6 @@ impl WorldTime {
         let total_hours = self.hour as u32 + hours;
         self.hour = (total_hours % 24) as u8;
         self.day += total_hours / 24;
-        
-        self.last_update = now;
     }
 
     pub fn format_time(&self) -> String {
@@ -105,6 +126,12 @@ pub struct WorldMetadata {
     pub maps: Vec<String>,
     #[serde(default)]
     pub current_map: String,
+    /// 世界亂數種子；指定時每次開啟世界都產生相同的亂數序列
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub seed: Option<u64>,
+    /// 大地圖的生成種子（第一次進入大地圖時決定；未修改的區塊都由它重新生成）
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub overworld_seed: Option<u64>,
 }
 
 impl WorldMetadata {
@@ -114,6 +141,8 @@ impl WorldMetadata {
             description,
             maps: Vec::new(),
             current_map: String::new(),
+            seed: None,
+            overworld_seed: None,
         }
     }
 
@@ -124,10 +153,29 @@ impl WorldMetadata {
     }
 }
 
+/// 角色視野半徑（晴朗時；NPC 感知與 look 共用）
+pub const VIEW_RADIUS: usize = 5;
+/// look 最多列出的視野內項目數
+const MAX_VISIBLE_LINES: usize = 10;
+/// 未被輸出端取走時保留的天氣描述筆數
+const MAX_WEATHER_NARRATION: usize = 4;
+
+/// 進入大地圖區塊時在背景預先生成周圍幾圈的區塊
+const OVERWORLD_PREFETCH_RADIUS: i32 = 1;
+
+/// 預設世界的地圖與類型（檔案不存在時以此生成）
+const DEFAULT_MAPS: [(&str, MapType); 5] = [
+    ("beginMap", MapType::Normal),
+    ("forest", MapType::Forest),
+    ("洞穴", MapType::Cave),
+    ("沙漠", MapType::Desert),
+    ("mountain", MapType::Mountain),
+];
+
 // 遊戲世界 - 管理多個地圖和時間
 #[derive(Clone)]
 pub struct GameWorld {
-    pub maps: HashMap<String, Map>,
+    pub maps: HashMap<String, Map>,  // 已載入的地圖（metadata.maps 中其餘的地圖在第一次存取時載入）
     pub current_map_name: String,
     pub metadata: WorldMetadata,
     pub world_dir: String,
@@ -142,6 +190,16 @@ pub struct GameWorld {
     pub original_player: Option<Person>,  // 原始玩家資料備份
     pub interaction_state: InteractionState,  // NPC 互動狀態
     pub combat_state: CombatState,       // 戰鬥狀態
+    pub rng: WorldRng,                   // 世界亂數來源（依子系統分流）
+    pub property_schema: Arc<PropertySchema>,  // 地圖屬性宣告（內建 + properties.json）
+    property_subscribers: Vec<mpsc::Sender<PropertyChange>>,  // 地圖屬性變化的訂閱者
+    weather_narration: Vec<String>,             // 目前地圖天氣、溫度改變的描述（由輸出端取走）
+    pub weather: HashMap<String, WeatherGrid>,  // 已載入地圖的區域天氣網格
+    pub spawn_pool: SpawnPool,                  // 事件生成 NPC 的原型與回收池
+    pub fov: FovCache,                          // 各角色的視野快取（look 與 NPC 感知共用）
+    pub map_editor: MapEditor,                  // 建造者區域編輯的剪貼簿與復原紀錄
+    pub overworld: Option<Overworld>,           // 大地圖區塊生成器（第一次進入大地圖時建立）
+    pub alloc_scope: AllocScope,                // 本世界的配置計數編號（host-alloc）
 }
 
 impl Default for GameWorld {
@@ -152,9 +210,14 @@ impl Default for GameWorld {
 
 impl GameWorld {
     pub fn new() -> Self {
-        // 建立世界資料夾
-        let world_dir = "worlds/beginWorld".to_string();
-        let _ = fs::create_dir_all(&world_dir);
+        Self::new_with_dir("worlds/beginWorld")
+    }
+
+    /// 以指定的世界資料夾建立遊戲世界（世界產生器與基準測試使用）
+    /// 只建立記憶體中的結構：不建立資料夾、不啟動時鐘線程、不載入地圖，
+    /// 由呼叫者依需要分階段執行 load_metadata / initialize_maps / start_clock
+    pub fn new_with_dir(world_dir: &str) -> Self {
+        let world_dir = world_dir.to_string();
 
         // 創建世界元數據
         let metadata = WorldMetadata::new(
@@ -166,7 +229,6 @@ impl GameWorld {
 
         let time = WorldTime::new();
         let game_speed = 1.0;  // 與真實世界同步：1實際秒 = 1遊戲秒
-        let time_thread = crate::time_thread::TimeThread::new(time.clone(), game_speed);
 
         GameWorld {
             maps: HashMap::new(),
@@ -177,26 +239,51 @@ impl GameWorld {
             _game_speed: game_speed,
             event_manager: crate::event::EventManager::new(),
             event_scheduler: crate::event_scheduler::EventScheduler::new(),
-            time_thread: Some(time_thread),
+            time_thread: None,
             npc_manager: crate::npc_manager::NpcManager::new(),
             quest_manager: QuestManager::new(),
             current_controlled_id: "me".to_string(),
             original_player: None,
             interaction_state: InteractionState::None,
             combat_state: CombatState::None,
+            rng: WorldRng::from_entropy(),
+            property_schema: Arc::new(PropertySchema::builtin()),
+            property_subscribers: Vec::new(),
+            weather_narration: Vec::new(),
+            weather: HashMap::new(),
+            spawn_pool: SpawnPool::new(),
+            fov: FovCache::new(),
+            map_editor: MapEditor::new(),
+            overworld: None,
+            alloc_scope: AllocScope::default(),
+        }
+    }
+
+    /// 啟動時鐘線程（以目前的世界時間為起點；已啟動時不做任何事）
+    /// 應在 load_time 之後呼叫；無頭模式可不啟動，改由呼叫者推進時間
+    pub fn start_clock(&mut self) {
+        if self.time_thread.is_none() {
+            self.time_thread = Some(crate::time_thread::TimeThread::new(self.time.clone(), self._game_speed));
         }
     }
 
-    // 添加地圖
-    pub fn add_map(&mut self, map: Map) {
+    /// 以指定種子重設世界亂數，之後的地圖生成、事件、AI、戰鬥與對話都可重現
+    #[allow(dead_code)]
+    pub fn set_seed(&mut self, seed: u64) {
+        self.rng = WorldRng::new(seed);
+    }
+
+    // 添加地圖（綁定世界的屬性宣告表）
+    pub fn add_map(&mut self, mut map: Map) {
+        map.properties.bind(&self.property_schema);
         let map_name = map.name.clone();
         self.maps.insert(map_name.clone(), map);
         self.metadata.add_map(map_name);
     }
 
-    // 切換地圖
+    // 切換地圖（尚未載入的地圖在此時載入）
     pub fn change_map(&mut self, map_name: &str) -> bool {
-        if self.maps.contains_key(map_name) {
+        if self.ensure_map_loaded(map_name) {
             self.current_map_name = map_name.to_string();
             true
         } else {
@@ -228,68 +315,204 @@ impl GameWorld {
         Ok(())
     }
 
+    /// 執行區域編輯（undo 作用在紀錄所屬的地圖，其餘作用在目前地圖），修改後只存檔一次
+    pub fn edit_region(&mut self, command: RegionCommand) -> Result<String, String> {
+        let map_name = match (&command, self.map_editor.undo_target()) {
+            (RegionCommand::Undo, Some(target)) => target.to_string(),
+            (RegionCommand::Undo, None) => return Err("沒有可以復原的區域編輯".to_string()),
+            _ => self.current_map_name.clone(),
+        };
+        self.ensure_map_loaded_or_err(&map_name).map_err(|e| e.to_string())?;
+        let map = self.maps.get_mut(&map_name).ok_or(format!("地圖 {map_name} 不存在"))?;
+        let outcome = match command {
+            RegionCommand::Undo => self.map_editor.undo(map)?,
+            command => self.map_editor.apply(map, command, self.rng.stream(RngStream::MapGen))?,
+        };
+        if outcome.modified {
+            if let Some(map) = self.maps.get(&outcome.map) {
+                self.save_map(map).map_err(|e| format!("保存地圖失敗: {e}"))?;
+            }
+        }
+        Ok(outcome.message)
+    }
+
     // 從檔案載入地圖
     #[allow(dead_code)]
     pub fn load_map(&mut self, map_name: &str) -> Result<(), Box<dyn std::error::Error>> {
         let maps_dir = self.get_maps_dir();
         let map_path = format!("{maps_dir}/{map_name}.json");
-        let map = Map::load(&map_path)?;
+        let mut map = Map::load(&map_path)?;
+        map.properties.bind(&self.property_schema);
         self.maps.insert(map_name.to_string(), map);
         Ok(())
     }
     
-    /// 初始化並載入所有地圖
+    /// 初始化地圖清單，只載入（或生成）目前所在的地圖，其餘地圖在第一次存取時才載入
     /// 返回 (總地圖數, 日誌訊息列表)
     pub fn initialize_maps(&mut self) -> Result<(usize, Vec<String>), Box<dyn std::error::Error>> {
-        // 初始化並載入所有地圖
-        let maps_config = vec![
-            ("beginMap", MapType::Normal),
-            ("forest", MapType::Forest),
-            ("洞穴", MapType::Cave),
-            ("沙漠", MapType::Desert),
-            ("mountain", MapType::Mountain),
-        ];
-        
         let mut logs = Vec::new();
         
         // 更新世界元數據
-        self.metadata.maps = maps_config.iter().map(|(name, _)| name.to_string()).collect();
+        self.metadata.maps = DEFAULT_MAPS.iter().map(|(name, _)| name.to_string()).collect();
         
         // 建立 maps 資料夾
         std::fs::create_dir_all(self.get_maps_dir())?;
         
-        // 生成並保存地圖
-        for (map_name, map_type) in maps_config {
-            let map_path = format!("{}/{}.json", self.get_maps_dir(), map_name);
-            
-            let map = if std::path::Path::new(&map_path).exists() {
-                // 如果檔案存在，則加載（不要重新初始化物品）
-                Map::load(&map_path)?
-            } else {
-                // 否則生成新地圖
-                let mut new_map = Map::new_with_type(map_name.to_string(), 100, 100, map_type);
-                // 只在新地圖時初始化物品
-                new_map.initialize_items();
-                // 保存新地圖
-                new_map.save(&map_path)?;
-                new_map
-            };
-            
+        let current_map_name = self.current_map_name.clone();
+        self.ensure_map_loaded_or_err(&current_map_name)?;
+        if let Some(map) = self.maps.get(&current_map_name) {
             logs.push(format!("地圖已加載: {}", map.name));
             let (walkable, unwalkable) = map.get_stats();
-            logs.push(format!("{map_name} - 可行走點: {walkable}, 不可行走點: {unwalkable}"));
-            
-            self.add_map(map);
+            logs.push(format!("{current_map_name} - 可行走點: {walkable}, 不可行走點: {unwalkable}"));
         }
         
         // 保存世界元數據
         self.save_metadata()?;
         
-        Ok((self.maps.len(), logs))
+        Ok((self.metadata.maps.len(), logs))
+    }
+
+    /// 確保地圖已在記憶體中：已載入則直接返回，否則從檔案載入；
+    /// 預設地圖的檔案不存在時生成並保存。返回地圖是否可用
+    pub fn ensure_map_loaded(&mut self, map_name: &str) -> bool {
+        self.ensure_map_loaded_or_err(map_name).is_ok()
+    }
+
+    /// 載入所有有角色所在的地圖（延遲載入只適用於沒有人的地圖：
+    /// 角色所在的地圖要能移動、撿東西、計算視野，物品年齡與天氣也要更新）
+    /// 返回新載入的地圖數量
+    pub fn load_resident_maps(&mut self) -> usize {
+        let mut missing: Vec<String> = self.npc_manager.iter()
+            .filter(|(_, npc)| !self.maps.contains_key(&npc.map))
+            .map(|(_, npc)| npc.map.clone())
+            .collect();
+        missing.sort();
+        missing.dedup();
+        missing.iter().filter(|map_name| self.ensure_map_loaded(map_name)).count()
+    }
+
+    fn ensure_map_loaded_or_err(&mut self, map_name: &str) -> Result<(), Box<dyn std::error::Error>> {
+        if self.maps.contains_key(map_name) {
+            return Ok(());
+        }
+        let map_path = format!("{}/{}.json", self.get_maps_dir(), map_name);
+        if let Some(pos) = parse_chunk_name(map_name) {
+            // 大地圖區塊：有存檔（曾被修改）時載入，否則由種子生成；兩者都不列入地圖清單
+            let mut chunk = if Path::new(&map_path).exists() {
+                Map::load(&map_path)?
+            } else {
+                self.take_chunk(pos)?
+            };
+            chunk.properties.bind(&self.property_schema);
+            self.maps.insert(chunk.name.clone(), chunk);
+            self.prefetch_chunks(pos);
+            return Ok(());
+        }
+        let map = if Path::new(&map_path).exists() {
+            // 如果檔案存在，則加載（不要重新初始化物品）
+            Map::load(&map_path)?
+        } else if let Some((_, map_type)) = DEFAULT_MAPS.iter().find(|(name, _)| *name == map_name) {
+            // 否則生成新地圖，只在新地圖時初始化物品
+            let mut new_map = Map::new_with_type(map_name.to_string(), 100, 100, map_type.clone(), &self.rng);
+            new_map.initialize_items(self.rng.stream(RngStream::Items));
+            self.save_map(&new_map)?;
+            new_map
+        } else {
+            return Err(format!("地圖 {map_name} 不存在").into());
+        };
+        self.add_map(map);
+        Ok(())
+    }
+
+    /// 取得大地圖區塊（背景已生成則直接使用）；第一次使用大地圖時決定並保存種子
+    fn take_chunk(&mut self, pos: ChunkPos) -> Result<Map, Box<dyn std::error::Error>> {
+        if self.overworld.is_none() {
+            let seed = match self.metadata.overworld_seed {
+                Some(seed) => seed,
+                None => {
+                    let seed = self.rng.seed();
+                    self.metadata.overworld_seed = Some(seed);
+                    self.save_metadata()?;
+                    seed
+                }
+            };
+            self.overworld = Some(Overworld::new(seed));
+        }
+        Ok(self.overworld.as_mut().map(|overworld| overworld.take(pos)).expect("overworld initialized"))
+    }
+
+    /// 請求背景生成周圍尚未載入、也沒有存檔的區塊
+    fn prefetch_chunks(&mut self, center: ChunkPos) {
+        let maps_dir = self.get_maps_dir();
+        let maps = &self.maps;
+        let Some(overworld) = self.overworld.as_mut() else {
+            return;
+        };
+        overworld.prefetch(center, OVERWORLD_PREFETCH_RADIUS, |pos| {
+            let name = chunk_map_name(pos);
+            maps.contains_key(&name) || Path::new(&format!("{maps_dir}/{name}.json")).exists()
+        });
+    }
+
+    /// 大地圖區塊之間的移動：角色在區塊邊緣往外走時移到相鄰區塊的對應位置
+    /// 目標不在大地圖或仍在同一區塊內時返回 None（由一般移動處理）；
+    /// 否則返回是否成功移動，操控中的角色會一併切換目前地圖
+    pub fn overworld_step(&mut self, entity_id: &str, dx: i32, dy: i32) -> Option<bool> {
+        let person = self.npc_manager.get_npc(entity_id)?;
+        let (cx, cy) = parse_chunk_name(&person.map)?;
+        let size = CHUNK_SIZE as i64;
+        let wx = cx as i64 * size + person.x as i64 + dx as i64;
+        let wy = cy as i64 * size + person.y as i64 + dy as i64;
+        let target = (wx.div_euclid(size) as i32, wy.div_euclid(size) as i32);
+        if target == (cx, cy) {
+            return None;
+        }
+        let (x, y) = (wx.rem_euclid(size) as usize, wy.rem_euclid(size) as usize);
+        let map_name = chunk_map_name(target);
+        if !self.ensure_map_loaded(&map_name) || !self.is_passable(&map_name, x, y) {
+            return Some(false);
+        }
+        let person = self.npc_manager.get_npc_mut(entity_id)?;
+        person.map = map_name.clone();
+        person.x = x;
+        person.y = y;
+        if entity_id == self.current_controlled_id {
+            self.current_map_name = map_name;
+        }
+        Some(true)
+    }
+
+    /// 以無 UI、無時鐘線程的方式開啟既有世界（基準測試與工具使用）
+    /// 載入 world.json、目前所在的地圖、角色與事件，不輸出任何日誌；其餘地圖在第一次存取時載入
+    #[allow(dead_code)]
+    pub fn open_headless(world_dir: &str) -> Result<Self, Box<dyn std::error::Error>> {
+        let mut game_world = Self::new_with_dir(world_dir);
+        game_world.load_metadata()?;
+        let current_map_name = game_world.current_map_name.clone();
+        game_world.ensure_map_loaded_or_err(&current_map_name)?;
+        let (_, me) = game_world.npc_manager.initialize(&format!("{world_dir}/persons"))?;
+        game_world.original_player = Some(me);
+        game_world.load_resident_maps();
+        crate::event_loader::EventLoader::load_from_directory(&mut game_world.event_manager, &format!("{world_dir}/events"))?;
+        Ok(game_world)
+    }
+
+    /// 依 world.json 的地圖清單載入所有尚未載入的地圖（不生成新地圖）
+    /// 返回已載入的地圖數量
+    #[allow(dead_code)]
+    pub fn load_all_maps(&mut self) -> Result<usize, Box<dyn std::error::Error>> {
+        let map_names = self.metadata.maps.clone();
+        for map_name in map_names {
+            if !self.maps.contains_key(&map_name) {
+                self.load_map(&map_name)?;
+            }
+        }
+        Ok(self.maps.len())
     }
 
     // 保存世界元數據
     pub fn save_metadata(&self) -> Result<(), Box<dyn std::error::Error>> {
+        fs::create_dir_all(&self.world_dir)?;
         let metadata_path = format!("{}/world.json", self.world_dir);
         let mut metadata = self.metadata.clone();
         metadata.current_map = self.current_map_name.clone();
@@ -307,10 +530,85 @@ impl GameWorld {
             if !self.metadata.current_map.is_empty() {
                 self.current_map_name = self.metadata.current_map.clone();
             }
+            if let Some(seed) = self.metadata.seed {
+                self.rng = WorldRng::new(seed);
+            }
         }
+        self.set_property_schema(PropertySchema::load(&self.world_dir)?);
         Ok(())
     }
 
+    /// 更換地圖屬性宣告表：重新綁定已載入的地圖並重新編譯事件
+    pub fn set_property_schema(&mut self, schema: PropertySchema) {
+        self.property_schema = Arc::new(schema);
+        for map in self.maps.values_mut() {
+            map.properties.bind(&self.property_schema);
+        }
+        self.event_manager.set_property_schema(Arc::clone(&self.property_schema));
+    }
+
+    /// 訂閱地圖屬性變化（NPC AI、描述系統等），接收端被丟棄後自動取消訂閱
+    #[allow(dead_code)]
+    pub fn subscribe_property_changes(&mut self) -> mpsc::Receiver<PropertyChange> {
+        let (sender, receiver) = mpsc::channel();
+        self.property_subscribers.push(sender);
+        receiver
+    }
+
+    /// 讀取地圖屬性（地圖尚未載入時返回 None）
+    #[allow(dead_code)]
+    pub fn get_map_property(&self, map_name: &str, property: PropertyId) -> Option<PropertyValue> {
+        self.maps.get(map_name).and_then(|map| map.properties.get(property))
+    }
+
+    /// 設定地圖屬性（必要時載入地圖），值改變時通知訂閱者；返回值是否改變
+    pub fn set_map_property(&mut self, map_name: &str, property: PropertyId, value: PropertyValue) -> Result<bool, String> {
+        self.ensure_map_loaded(map_name);
+        let map = self.maps.get_mut(map_name).ok_or_else(|| format!("地圖 {map_name} 不存在"))?;
+        let old = map.properties.set(property, value);
+        if old == Some(value) {
+            return Ok(false);
+        }
+        self.notify_property_changes(vec![PropertyChange { map: map_name.to_string(), property, old, new: value }]);
+        Ok(true)
+    }
+
+    /// 把屬性變化送給所有訂閱者（丟棄已關閉的訂閱）
+    pub fn notify_property_changes(&mut self, changes: Vec<PropertyChange>) {
+        for change in &changes {
+            self.narrate_weather_change(change);
+        }
+        if changes.is_empty() || self.property_subscribers.is_empty() {
+            return;
+        }
+        self.property_subscribers.retain(|subscriber| {
+            changes.iter().all(|change| subscriber.send(change.clone()).is_ok())
+        });
+    }
+
+    /// 目前地圖的天氣或溫度改變時記下給玩家的描述（初次設定不描述；未取走時只保留最近幾筆）
+    fn narrate_weather_change(&mut self, change: &PropertyChange) {
+        if change.map != self.current_map_name || change.old.is_none() {
+            return;
+        }
+        let Some(map) = self.maps.get(&change.map) else {
+            return;
+        };
+        let property = &self.property_schema.decl(change.property).name;
+        let value = self.property_schema.format(change.property, change.new);
+        if let Some(text) = crate::weather::narration(property, &value, &map.map_type) {
+            if self.weather_narration.len() >= MAX_WEATHER_NARRATION {
+                self.weather_narration.remove(0);
+            }
+            self.weather_narration.push(format!("📢 {text}"));
+        }
+    }
+
+    /// 取走累積的天氣描述（終端主循環、pump 與排程事件執行時輸出）
+    pub fn take_weather_narration(&mut self) -> Vec<String> {
+        std::mem::take(&mut self.weather_narration)
+    }
+
     // 更新世界時間 (從時鐘線程同步)
     pub fn update_time(&mut self) {
         if let Some(ref time_thread) = self.time_thread {
@@ -325,6 +623,120 @@ impl GameWorld {
         
         // 更新所有 NPC 的年齡
         self.npc_manager.update_all_time(&time_info);
+        
+        self.update_weather();
+    }
+
+    /// 推進所有已載入地圖的天氣網格到目前的遊戲分鐘（同一分鐘內重複呼叫不做任何事）
+    /// 地圖屬性「天氣」「溫度」由網格的全圖平均決定，值改變時照常通知訂閱者
+    pub fn update_weather(&mut self) {
+        let minute = self.time.day as u64 * 1440 + self.time.hour as u64 * 60 + self.time.minute as u64;
+        let hour = self.time.hour as f32 + self.time.minute as f32 / 60.0;
+        let rng = self.rng.stream(RngStream::Weather);
+        let mut changed = Vec::new();
+        for (name, map) in &self.maps {
+            let mut created = false;
+            let grid = self.weather.entry(name.clone()).or_insert_with(|| {
+                created = true;
+                WeatherGrid::new(map.width, map.height, &map.map_type, hour, minute)
+            });
+            if grid.advance_to(minute, hour, rng) > 0 || created {
+                changed.push((name.clone(), grid.average()));
+            }
+        }
+        for (name, summary) in changed {
+            for (property, text) in [("天氣", summary.condition()), ("溫度", summary.temperature_label())] {
+                if let Some((id, value)) = self.property_schema.resolve(property, text) {
+                    let _ = self.set_map_property(&name, id, value);
+                }
+            }
+        }
+    }
+
+    /// 地圖座標所在區域的天氣（天氣網格尚未建立時返回 None）
+    pub fn weather_at(&self, map_name: &str, x: usize, y: usize) -> Option<RegionWeather> {
+        self.weather.get(map_name).map(|grid| grid.at(x, y))
+    }
+
+    /// 地圖座標是否可進入：地形可行走，且該區域不是暴風雨
+    pub fn is_passable(&self, map_name: &str, x: usize, y: usize) -> bool {
+        let walkable = self.maps.get(map_name).is_some_and(|map| map.is_walkable(x, y));
+        walkable && !self.weather_at(map_name, x, y).is_some_and(|w| w.blocks_movement())
+    }
+
+    /// 角色目前的視野（半徑 VIEW_RADIUS，依所在區域的能見度縮小）
+    pub fn visible_from(&self, entity_id: &str) -> Option<Arc<VisibleSet>> {
+        let person = self.npc_manager.get_npc(entity_id)?;
+        let map = self.maps.get(&person.map)?;
+        let visibility = self.weather_at(&person.map, person.x, person.y).map_or(1.0, |w| w.visibility);
+        let radius = ((VIEW_RADIUS as f32 * visibility).round() as usize).max(1);
+        Some(self.fov.visible(entity_id, map, person.x, person.y, radius))
+    }
+
+    /// look 使用的視野描述：視野內（所在格以外）的角色與物品，依距離排序
+    pub fn describe_visible(&self, entity_id: &str) -> Vec<String> {
+        let (Some(me), Some(fov)) = (self.npc_manager.get_npc(entity_id), self.visible_from(entity_id)) else {
+            return Vec::new();
+        };
+        let Some(map) = self.maps.get(&me.map) else {
+            return Vec::new();
+        };
+        let distance = |x: usize, y: usize| x.abs_diff(me.x).pow(2) + y.abs_diff(me.y).pow(2);
+        let mut seen: Vec<(usize, String)> = Vec::new();
+        for (id, npc) in self.npc_manager.iter() {
+            if id != entity_id && npc.map == me.map && (npc.x, npc.y) != (me.x, me.y) && fov.contains(npc.x, npc.y) {
+                seen.push((distance(npc.x, npc.y), format!("  👤 {} ({}, {})", npc.name, npc.x, npc.y)));
+            }
+        }
+        for (x, y) in fov.iter().filter(|&pos| pos != (me.x, me.y)) {
+            if let Some(point) = map.get_point(x, y) {
+                for (item, count) in point.objects {
+                    seen.push((distance(x, y), format!("  🎁 {item} x{count} ({x}, {y})")));
+                }
+            }
+        }
+        if seen.is_empty() {
+            return Vec::new();
+        }
+        seen.sort();
+        let mut lines = vec!["👀 視野內:".to_string()];
+        lines.extend(seen.into_iter().take(MAX_VISIBLE_LINES).map(|(_, line)| line));
+        lines
+    }
+
+    /// 生成事件 NPC：已生成的暫時 NPC 只移動位置，同 ID 的常駐 NPC 不受影響（返回 false），
+    /// 其餘從物件池取出以原型初始化的角色
+    pub fn spawn_npc(&mut self, npc_id: &str, map_name: &str, x: usize, y: usize) -> bool {
+        let place = |npc: &mut Person| {
+            npc.map.clear();
+            npc.map.push_str(map_name);
+            (npc.x, npc.y) = (x, y);
+        };
+        if self.npc_manager.is_transient(npc_id) {
+            if let Some(npc) = self.npc_manager.get_transient_mut(npc_id) {
+                place(npc);
+            }
+            return true;
+        }
+        if self.npc_manager.contains(npc_id) {
+            return false;
+        }
+        let mut npc = self.spawn_pool.acquire(npc_id, &self.world_dir);
+        place(&mut npc);
+        self.npc_manager.insert_transient(npc_id, npc);
+        true
+    }
+
+    /// 移除事件生成的 NPC 並回收到物件池；常駐 NPC 不會被移除
+    pub fn despawn_npc(&mut self, npc_id: &str) -> bool {
+        match self.npc_manager.remove_transient(npc_id) {
+            Some(npc) => {
+                self.fov.forget(npc_id);
+                self.spawn_pool.release(npc);
+                true
+            }
+            None => false,
+        }
     }
 
     // 獲取當前時間信息
@@ -339,6 +751,7 @@ impl GameWorld {
 
     // 保存世界時間
     pub fn save_time(&self) -> Result<(), Box<dyn std::error::Error>> {
+        fs::create_dir_all(&self.world_dir)?;
         let time_path = format!("{}/time.json", self.world_dir);
         let json = serde_json::to_string_pretty(&self.time)?;
         fs::write(time_path, json)?;
@@ -351,11 +764,7 @@ impl GameWorld {
         if Path::new(&time_path).exists() {
             let json = fs::read_to_string(time_path)?;
             let mut loaded_time: WorldTime = serde_json::from_str(&json)?;
-            // 重置 last_update 為當前時間，避免時間跳躍
-            loaded_time.last_update = SystemTime::now()
-                .duration_since(UNIX_EPOCH)
-                .unwrap()
-                .as_millis() as u64;
+            loaded_time.resync();
             
             self.time = loaded_time.clone();
             
@@ -428,23 +837,26 @@ impl GameWorld {
                     if let Some(point) = map.get_point(npc.x, npc.y) {
                         TerrainInfo {
                             walkable: point.walkable,
-                            description: point.description.clone(),
+                            description: point.description.to_string(),
+                            weather: self.weather_at(&npc.map, npc.x, npc.y),
                         }
                     } else {
                         TerrainInfo {
                             walkable: false,
                             description: "未知區域".to_string(),
+                            weather: None,
                         }
                     }
                 } else {
                     TerrainInfo {
                         walkable: false,
                         description: "未知區域".to_string(),
+                        weather: None,
                     }
                 };
                 
                 // 建立附近實體列表
-                let nearby_entities = self.get_nearby_entities_for_view(me, &npc.map, npc.x, npc.y, 5);
+                let nearby_entities = self.get_nearby_entities_for_view(me, &npc_id, npc);
                 
                 // 建立可見物品列表
                 let visible_items = self.get_visible_items_for_view(&npc.map, npc.x, npc.y);
@@ -487,45 +899,36 @@ impl GameWorld {
         views
     }
     
-    /// 獲取附近的實體（用於建立 NpcView）
+    /// 獲取附近的實體（用於建立 NpcView）：只包含 NPC 視野內（牆後看不到）的角色
     /// me: 當前玩家
-    fn get_nearby_entities_for_view(&self, me: &Person, map_name: &str, x: usize, y: usize, radius: usize) -> Vec<crate::npc_view::EntityInfo> {
+    fn get_nearby_entities_for_view(&self, me: &Person, npc_id: &str, viewer: &Person) -> Vec<crate::npc_view::EntityInfo> {
         use crate::npc_view::{EntityInfo, EntityType, Position};
         
         let mut entities = Vec::new();
+        let Some(fov) = self.visible_from(npc_id) else {
+            return entities;
+        };
+        let (map_name, x, y) = (&viewer.map, viewer.x, viewer.y);
         
-        // 檢查玩家是否在附近
-        if me.map == map_name {
-            let dist_x = (me.x as i32 - x as i32).unsigned_abs() as usize;
-            let dist_y = (me.y as i32 - y as i32).unsigned_abs() as usize;
-            
-            if dist_x <= radius && dist_y <= radius {
-                entities.push(EntityInfo {
-                    entity_type: EntityType::Player,
-                    id: "player".to_string(),
-                    pos: Position { x: me.x, y: me.y },
-                    name: me.name.clone(),
-                });
-            }
+        // 檢查玩家是否在視野內
+        if me.map == *map_name && fov.contains(me.x, me.y) {
+            entities.push(EntityInfo {
+                entity_type: EntityType::Player,
+                id: "player".to_string(),
+                pos: Position { x: me.x, y: me.y },
+                name: me.name.clone(),
+            });
         }
         
-        // 檢查其他 NPC 是否在附近
-        let all_npc_ids = self.npc_manager.get_all_npc_ids();
-        for npc_id in all_npc_ids {
-            if let Some(npc) = self.npc_manager.get_npc(&npc_id) {
-                if npc.map == map_name {
-                    let dist_x = (npc.x as i32 - x as i32).unsigned_abs() as usize;
-                    let dist_y = (npc.y as i32 - y as i32).unsigned_abs() as usize;
-                    
-                    if dist_x <= radius && dist_y <= radius && !(npc.x == x && npc.y == y) {
-                        entities.push(EntityInfo {
-                            entity_type: EntityType::Npc,
-                            id: npc_id.clone(),
-                            pos: Position { x: npc.x, y: npc.y },
-                            name: npc.name.clone(),
-                        });
-                    }
-                }
+        // 檢查其他 NPC 是否在視野內
+        for (npc_id, npc) in self.npc_manager.iter() {
+            if npc.map == *map_name && fov.contains(npc.x, npc.y) && !(npc.x == x && npc.y == y) {
+                entities.push(EntityInfo {
+                    entity_type: EntityType::Npc,
+                    id: npc_id.clone(),
+                    pos: Position { x: npc.x, y: npc.y },
+                    name: npc.name.clone(),
+                });
             }
         }
         
@@ -540,7 +943,7 @@ impl GameWorld {
         
         if let Some(map) = self.maps.get(map_name) {
             if let Some(point) = map.get_point(x, y) {
-                for (item_name, count) in &point.objects {
+                for (item_name, count) in point.objects {
                     items.push(ItemInfo {
                         item_name: item_name.clone(),
                         count: *count,
@@ -553,6 +956,33 @@ impl GameWorld {
         items
     }
     
+    /// 物品總數：(已載入的地圖數, 地圖上的物品數, 角色身上的物品數)
+    pub fn item_census(&self) -> (usize, u64, u64) {
+        let on_maps = self.maps.values()
+            .flat_map(|map| map.points_with_items())
+            .flat_map(|(_, items)| items.objects.values())
+            .map(|&count| count as u64)
+            .sum();
+        let carried = self.npc_manager.iter()
+            .flat_map(|(_, person)| person.items.values())
+            .map(|&count| count as u64)
+            .sum();
+        (self.maps.len(), on_maps, carried)
+    }
+
+    /// 執行一次 NPC AI：建立視圖、決定行為（原生 AI 外掛或內建策略）並套用，返回產生的訊息
+    pub fn run_ai_tick(&mut self, builtin: &crate::npc_ai::NpcAiController) -> Vec<crate::message::Message> {
+        // 事件或命令可能把角色送到尚未載入的地圖
+        self.load_resident_maps();
+        let views = self.build_npc_views();
+        let mut messages = Vec::new();
+        for (npc_id, action) in crate::native_ai::decide_all(&views, builtin) {
+            let event = crate::game_event::GameEvent::NpcActions { npc_id, actions: vec![action] };
+            messages.extend(self.apply_event(event));
+        }
+        messages
+    }
+
     /// 套用遊戲事件（新架構的核心方法）
     /// 這是 GameWorld 的單一寫入點
     pub fn apply_event(&mut self, event: crate::game_event::GameEvent) -> Vec<crate::message::Message> {
@@ -637,20 +1067,8 @@ impl GameWorld {
             let npc_name = npc.name.clone();
             let npc_map = npc.map.clone();
             
-            // 檢查是否可行走
-            let can_walk = if let Some(map) = self.maps.get(&npc_map) {
-                if new_x < map.width && new_y < map.height {
-                    if let Some(point) = map.get_point(new_x, new_y) {
-                        point.walkable
-                    } else {
-                        false
-                    }
-                } else {
-                    false
-                }
-            } else {
-                false
-            };
+            // 檢查是否可行走（含暴風雨區域）
+            let can_walk = self.ensure_map_loaded(&npc_map) && self.is_passable(&npc_map, new_x, new_y);
             
             if can_walk {
                 if let Some(npc_mut) = self.npc_manager.get_npc_mut(npc_id) {
@@ -680,8 +1098,9 @@ impl GameWorld {
             let npc_name = npc.name.clone();
             
             // 從地圖移除物品
+            self.ensure_map_loaded(&npc_map);
             if let Some(map) = self.maps.get_mut(&npc_map) {
-                if let Some(point) = map.get_point_mut(npc_x, npc_y) {
+                if let Some(point) = map.items_mut(npc_x, npc_y) {
                     if let Some(count) = point.objects.get_mut(&item_name) {
                         let actual_quantity = (*count).min(quantity);
                         *count -= actual_quantity;
@@ -767,7 +1186,7 @@ impl GameWorld {
                     
                     // 添加到地圖
                     if let Some(map) = self.maps.get_mut(&npc_map) {
-                        if let Some(point) = map.get_point_mut(npc_x, npc_y) {
+                        if let Some(point) = map.items_mut(npc_x, npc_y) {
                             point.add_objects(item_name.clone(), actual_quantity);
                             
                             messages.push(Message::Log(
@@ -796,7 +1215,7 @@ impl GameWorld {
                 return messages;
             }
             
-            let skill_dialogue = npc.get_skill_dialogue(skill_name);
+            let skill_dialogue = npc.get_skill_dialogue(skill_name, self.rng.stream(RngStream::Combat));
             let damage = npc.combat_skills.get(skill_name)
                 .map(|s| s.damage)
                 .unwrap_or(1);
@@ -825,9 +1244,93 @@ impl GameWorld {
 }
 
 impl GameWorld {
+    /// 各子系統的記憶體估算（地圖、角色、對話表、事件、任務）
+    /// 輸出緩衝區由 UI 層自行加入
+    pub fn memory_report(&self) -> crate::mem_stats::MemoryReport {
+        use crate::mem_stats::HeapSize;
+        let dialogues = self.npc_manager.dialogue_heap_size();
+        let mut report = crate::mem_stats::MemoryReport::default();
+        report.add("maps", self.maps.heap_size());
+        report.add("npcs", self.npc_manager.heap_size() - dialogues + self.original_player.heap_size());
+        report.add("dialogues", dialogues);
+        report.add("events", self.event_manager.heap_size());
+        report.add("quests", self.quest_manager.heap_size());
+        report.add("weather", self.weather.heap_size());
+        report.add("spawn_pool", self.spawn_pool.heap_size());
+        report.add("map_editor", self.map_editor.heap_size());
+        report.add("overworld", self.overworld.heap_size());
+        report
+    }
+
     /// 執行命令（無 UI 模式）
     /// 返回 true=繼續, false=退出
     pub fn execute_command(&mut self, command: &str) -> bool {
+        let _scope = self.alloc_scope.enter();
         crate::command_executor::execute_command(self, command)
     }
+
+    /// 事件觸發的日誌行：「🎭 事件: 名稱 在 地圖(x, y) - 描述」（事件不存在時返回 None）
+    pub fn event_log_line(&self, event_id: &str) -> Option<String> {
+        let event = self.event_manager.get_event(event_id)?;
+        let location = match &event.r#where.map {
+            Some(map_name) => match (&event.r#where.positions, &event.r#where.area) {
+                (Some(positions), _) if !positions.is_empty() => {
+                    let (x, y) = (positions[0][0], positions[0][1]);
+                    match self.maps.get(map_name).and_then(|map| map.get_point(x, y)) {
+                        Some(point) => format!(" 在 {map_name}({x}, {y}) - {}", point.description),
+                        None => format!(" 在 {map_name}({x}, {y})"),
+                    }
+                }
+                (None, Some(area)) => format!(" 在 {map_name} 區域({}-{}, {}-{})", area.x[0], area.x[1], area.y[0], area.y[1]),
+                _ => format!(" 在 {map_name}"),
+            },
+            None => String::new(),
+        };
+        Some(format!("🎭 事件: {}{location}", event.name))
+    }
+
+    /// 收集本分鐘應觸發的事件並標記為已觸發（同一分鐘重複呼叫返回空列表）
+    /// 觸發判斷只讀取世界，事件由呼叫者以一個批次執行
+    pub fn collect_due_events(&mut self) -> Vec<String> {
+        let now = (self.time.day, self.time.hour, self.time.minute);
+        if now == self.event_scheduler.last_check_time {
+            return Vec::new();
+        }
+        self.event_scheduler.last_check_time = now;
+
+        let scheduler = crate::event_scheduler::EventScheduler::new();
+        let mut due = Vec::new();
+        if let Some(me) = self.npc_manager.get_npc("me") {
+            for event in self.event_manager.list_events() {
+                if let Some(runtime_state) = self.event_manager.get_runtime_state(&event.id) {
+                    if !event.can_trigger(runtime_state) {
+                        continue;
+                    }
+                }
+                if scheduler.check_trigger(event, self) && scheduler.check_conditions(event, self, me) {
+                    due.push(event.id.clone());
+                }
+            }
+        }
+        for event_id in &due {
+            self.event_manager.trigger_event(event_id);
+        }
+        due
+    }
+
+    /// 檢查並執行本分鐘應觸發的事件（無 UI 模式，邏輯與 app 主循環一致）
+    /// 返回觸發的事件數量
+    #[allow(dead_code)]
+    pub fn run_scheduled_events<O: crate::event_executor::EventOutput>(&mut self, output: &mut O) -> usize {
+        output.print_batch(self.take_weather_narration());
+        let due = self.collect_due_events();
+        if due.is_empty() {
+            return 0;
+        }
+        let report = crate::event_executor::EventExecutor::execute_batch(&due, self, output);
+        for (_, e) in &report.failures {
+            output.print(format!("⚠️  事件執行錯誤: {e}"));
+        }
+        due.len()
+    }
 }
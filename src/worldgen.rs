@@ -0,0 +1,286 @@
+// 合成世界產生器
+// 產生可設定地圖數量/大小、NPC 數量、事件數量與物品密度的測試世界，
+// 供 scale_bench 量測引擎在不同規模下的載入、tick、記憶體與指令延遲。
+
+use std::error::Error;
+use std::fs;
+use std::path::Path;
+
+use crate::event::{
+    EventAction, EventState, GameEvent, Position, TriggerType, WeightedAction, WhereCondition,
+};
+use crate::map::{Map, MapType, SPAWNABLE_ITEMS};
+use crate::person::Person;
+use crate::rng::{Rng, RngStream, WorldRng};
+use crate::world::WorldMetadata;
+
+/// 世界產生參數
+#[derive(Debug, Clone)]
+pub struct WorldGenConfig {
+    pub name: String,
+    pub map_count: usize,
+    pub width: usize,
+    pub height: usize,
+    pub npc_count: usize,
+    pub event_count: usize,
+    pub events_per_file: usize,  // 每個事件檔案的事件數（0 表示全部寫入同一個檔案）
+    pub item_density: f32,  // 每個可行走點放置物品的機率 0.0-1.0
+    pub seed: u64,
+}
+
+impl Default for WorldGenConfig {
+    /// 預設規模與 beginWorld 相近：5 張 100x100 地圖、20 個角色
+    fn default() -> Self {
+        WorldGenConfig {
+            name: "synthWorld".to_string(),
+            map_count: 5,
+            width: 100,
+            height: 100,
+            npc_count: 20,
+            event_count: 10,
+            events_per_file: 0,
+            item_density: 0.02,
+            seed: 1,
+        }
+    }
+}
+
+impl WorldGenConfig {
+    /// 從命令列參數解析（未指定的參數使用預設值）
+    /// 支援: --maps N --size WxH --npcs N --events N --events-per-file N --items F --seed N --name S
+    pub fn from_args(args: &[String]) -> Result<Self, String> {
+        let mut config = WorldGenConfig::default();
+        let mut iter = args.iter();
+        while let Some(flag) = iter.next() {
+            let value = iter.next().ok_or(format!("參數 {flag} 缺少數值"))?;
+            let invalid = |_| format!("參數 {flag} 的數值無效: {value}");
+            match flag.as_str() {
+                "--maps" => config.map_count = value.parse().map_err(invalid)?,
+                "--npcs" => config.npc_count = value.parse().map_err(invalid)?,
+                "--events" => config.event_count = value.parse().map_err(invalid)?,
+                "--events-per-file" => config.events_per_file = value.parse().map_err(invalid)?,
+                "--seed" => config.seed = value.parse().map_err(invalid)?,
+                "--items" => config.item_density = value.parse::<f32>().map_err(|_| format!("參數 {flag} 的數值無效: {value}"))?,
+                "--name" => config.name = value.clone(),
+                "--size" => {
+                    let (w, h) = value.split_once('x').ok_or(format!("地圖大小格式應為 WxH: {value}"))?;
+                    config.width = w.parse().map_err(invalid)?;
+                    config.height = h.parse().map_err(invalid)?;
+                }
+                _ => return Err(format!("未知參數: {flag}")),
+            }
+        }
+        if config.map_count == 0 || config.width == 0 || config.height == 0 {
+            return Err("地圖數量與大小必須大於 0".to_string());
+        }
+        Ok(config)
+    }
+
+    /// 第 index 張地圖的名稱
+    pub fn map_name(&self, index: usize) -> String {
+        format!("map_{index:03}")
+    }
+}
+
+/// 產生結果統計
+#[derive(Debug, Clone, Default)]
+pub struct WorldGenReport {
+    pub maps: usize,
+    pub points: usize,
+    pub items: usize,
+    pub npcs: usize,
+    pub events: usize,
+    pub bytes_written: u64,
+}
+
+const MAP_TYPES: [MapType; 5] = [
+    MapType::Normal,
+    MapType::Forest,
+    MapType::Cave,
+    MapType::Desert,
+    MapType::Mountain,
+];
+
+/// 產生整個世界並寫入 world_dir（maps/、persons/、events/、world.json）
+/// 既有的 world_dir 會先被清空，確保結果只反映本次設定
+pub fn generate_world(world_dir: &str, config: &WorldGenConfig) -> Result<WorldGenReport, Box<dyn Error>> {
+    if Path::new(world_dir).exists() {
+        fs::remove_dir_all(world_dir)?;
+    }
+    let maps_dir = format!("{world_dir}/maps");
+    let person_dir = format!("{world_dir}/persons");
+    let events_dir = format!("{world_dir}/events");
+    fs::create_dir_all(&maps_dir)?;
+    fs::create_dir_all(&person_dir)?;
+    fs::create_dir_all(&events_dir)?;
+
+    // 同一 seed 產生相同的地圖/NPC/物品/事件；seed 也寫入 world.json，讓載入後的執行同樣可重現
+    let world_rng = WorldRng::new(config.seed);
+    let rng = world_rng.stream(RngStream::Items);
+    let mut report = WorldGenReport::default();
+
+    // 地圖與物品
+    let mut walkable_by_map = Vec::with_capacity(config.map_count);
+    for index in 0..config.map_count {
+        let map_type = MAP_TYPES[index % MAP_TYPES.len()].clone();
+        let mut map = Map::new_with_type(config.map_name(index), config.width, config.height, map_type, &world_rng);
+        let walkable = map.get_walkable_points();
+        for &(x, y) in &walkable {
+            if rng.chance(config.item_density as f64) {
+                if let Some(point) = map.items_mut(x, y) {
+                    let item = SPAWNABLE_ITEMS[rng.below(SPAWNABLE_ITEMS.len())];
+                    point.add_objects(item.to_string(), 1 + rng.below(3) as u32);
+                    report.items += 1;
+                }
+            }
+        }
+        let map_path = format!("{maps_dir}/{}.json", map.name);
+        map.save(&map_path)?;
+        report.bytes_written += fs::metadata(&map_path)?.len();
+        report.points += config.width * config.height;
+        walkable_by_map.push(walkable);
+    }
+    report.maps = config.map_count;
+
+    // 角色（me 放在第一張地圖的可行走點上）
+    let mut me = Person::new("創造者".to_string(), "合成世界的測試玩家".to_string());
+    place_person(&mut me, 0, config, &walkable_by_map, rng);
+    me.save(&person_dir, "me")?;
+    for index in 0..config.npc_count {
+        let mut npc = Person::new(format!("npc{index}"), format!("合成世界的第 {index} 號居民"));
+        let map_index = rng.below(config.map_count);
+        place_person(&mut npc, map_index, config, &walkable_by_map, rng);
+        npc.save(&person_dir, &format!("npc_{index:05}"))?;
+    }
+    report.npcs = config.npc_count;
+
+    // 事件
+    let events: Vec<GameEvent> = (0..config.event_count)
+        .map(|index| synth_event(index, config, &walkable_by_map, rng))
+        .collect();
+    if config.events_per_file == 0 {
+        let events_path = format!("{events_dir}/generated_events.json");
+        fs::write(&events_path, serde_json::to_string_pretty(&events)?)?;
+        report.bytes_written += fs::metadata(&events_path)?.len();
+    } else {
+        for (index, chunk) in events.chunks(config.events_per_file).enumerate() {
+            let events_path = format!("{events_dir}/generated_{index:05}.json");
+            fs::write(&events_path, serde_json::to_string_pretty(chunk)?)?;
+            report.bytes_written += fs::metadata(&events_path)?.len();
+        }
+    }
+    report.events = events.len();
+
+    // 世界元數據
+    let mut metadata = WorldMetadata::new(config.name.clone(), "由世界產生器建立的合成測試世界".to_string());
+    metadata.maps = (0..config.map_count).map(|i| config.map_name(i)).collect();
+    metadata.current_map = config.map_name(0);
+    metadata.seed = Some(config.seed);
+    fs::write(format!("{world_dir}/world.json"), serde_json::to_string_pretty(&metadata)?)?;
+
+    Ok(report)
+}
+
+/// 將角色放到指定地圖的隨機可行走點
+fn place_person(
+    person: &mut Person,
+    map_index: usize,
+    config: &WorldGenConfig,
+    walkable_by_map: &[Vec<(usize, usize)>],
+    rng: &Rng,
+) {
+    person.map = config.map_name(map_index);
+    let walkable = &walkable_by_map[map_index];
+    if !walkable.is_empty() {
+        let (x, y) = walkable[rng.below(walkable.len())];
+        person.x = x;
+        person.y = y;
+    }
+}
+
+/// 依序輪替四種事件模板：廣播訊息、天氣變化、物品生成、地點觸發
+fn synth_event(
+    index: usize,
+    config: &WorldGenConfig,
+    walkable_by_map: &[Vec<(usize, usize)>],
+    rng: &Rng,
+) -> GameEvent {
+    let map_index = rng.below(config.map_count);
+    let map_name = config.map_name(map_index);
+    let every_minutes = 1 + rng.below(10);
+    let time_trigger = TriggerType::Time {
+        schedule: format!("*/{every_minutes} * * * *"),
+        random_chance: Some(0.5),
+        day_range: None,
+        time_range: None,
+    };
+    let where_map = WhereCondition { map: Some(map_name.clone()), ..Default::default() };
+
+    let (trigger, where_cond, actions) = match index % 4 {
+        0 => (time_trigger, WhereCondition::default(), vec![EventAction::Message {
+            text: format!("📢 合成事件 {index} 的廣播"),
+        }]),
+        1 => {
+            let actions = ["晴天", "陰天", "雨天", "霧天"]
+                .iter()
+                .map(|weather| WeightedAction {
+                    weight: 0.25,
+                    action: Box::new(EventAction::SetMapProperty {
+                        map: map_name.clone(),
+                        property: "天氣".to_string(),
+                        value: weather.to_string(),
+                    }),
+                })
+                .collect();
+            (time_trigger, where_map, vec![EventAction::RandomAction { actions }])
+        }
+        2 => (time_trigger, where_map, vec![EventAction::AddItem {
+            item: SPAWNABLE_ITEMS[rng.below(SPAWNABLE_ITEMS.len())].to_string(),
+            position: Position::Random("random".to_string()),
+        }]),
+        _ => {
+            let walkable = &walkable_by_map[map_index];
+            let positions = (0..4)
+                .filter(|_| !walkable.is_empty())
+                .map(|_| {
+                    let (x, y) = walkable[rng.below(walkable.len())];
+                    [x, y]
+                })
+                .collect();
+            (TriggerType::Location { positions }, where_map, vec![EventAction::Message {
+                text: format!("👣 你觸發了合成事件 {index}"),
+            }])
+        }
+    };
+
+    GameEvent {
+        id: format!("synth_{index:05}"),
+        name: format!("合成事件 {index}"),
+        description: "世界產生器建立的事件".to_string(),
+        trigger,
+        who: Default::default(),
+        r#where: where_cond,
+        what: Default::default(),
+        actions,
+        state: EventState::default(),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_config_from_args() {
+        let args: Vec<String> = ["--maps", "3", "--size", "40x20", "--items", "0.5"]
+            .iter().map(|s| s.to_string()).collect();
+        let config = WorldGenConfig::from_args(&args).unwrap();
+        assert_eq!(config.map_count, 3);
+        assert_eq!((config.width, config.height), (40, 20));
+        assert_eq!(config.item_density, 0.5);
+        assert_eq!(config.npc_count, WorldGenConfig::default().npc_count);
+
+        assert!(WorldGenConfig::from_args(&["--size".to_string(), "40".to_string()]).is_err());
+        assert!(WorldGenConfig::from_args(&["--maps".to_string(), "0".to_string()]).is_err());
+    }
+}
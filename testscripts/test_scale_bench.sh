@@ -0,0 +1,12 @@
+#!/bin/bash
+
+# 規模基準測試：產生合成世界並量測載入/tick/記憶體/指令延遲
+# 用法: ./testscripts/test_scale_bench.sh [--full]
+#   預設為 quick 模式（每個維度取前三個規模），--full 跑完整序列
+
+MODE="--quick"
+if [ "$1" == "--full" ]; then
+    MODE=""
+fi
+
+cargo run --release --features count-alloc --bin scale_bench -- $MODE --csv bench_output.txt